@@ -27,6 +27,15 @@
 #include "Assertion_Private.h"
 #include "CallbackAllocator.h"
 #include "DebugAllocator.h"
+#include "Metrics.h"
+
+#if defined(__SANITIZE_THREAD__)
+#define CC_ALLOCATOR_THREAD_SANITIZER 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define CC_ALLOCATOR_THREAD_SANITIZER 1
+#endif
+#endif
 
 #pragma mark - Standard Allocator Implementation
 static void *StandardAllocator(void *Data, size_t Size)
@@ -279,6 +288,9 @@ void *CCMemoryAllocate(CCAllocatorType Type, size_t Size)
                 .refCount = 1,
                 .destructor = NULL
             };
+            
+            CC_METRICS_COUNTER_ADD("allocator.allocate", 1);
+            CC_METRICS_HISTOGRAM_RECORD("allocator.size", Size);
         }
         
         else CC_LOG_DEBUG("Internal error: Integer overflow. Try reducing allocation size (%zu). #Attention #Error", Size);
@@ -373,7 +385,11 @@ void CCMemoryDeallocate(void *Ptr)
     if (Count == 0)
     {
 #if CC_ALLOCATOR_USING_STDATOMIC
+#if CC_ALLOCATOR_THREAD_SANITIZER
+        atomic_load_explicit(&Header->refCount, memory_order_acquire); //TSan doesn't model fences, so acquire the releases with a load instead
+#else
         atomic_thread_fence(memory_order_acquire);
+#endif
 #elif CC_ALLOCATOR_USING_OSATOMIC
         OSMemoryBarrier();
 #endif
@@ -383,6 +399,8 @@ void CCMemoryDeallocate(void *Ptr)
         const CCDeallocatorFunction Deallocator = Allocators.allocators[Index].deallocator;
         
         if (Deallocator) Deallocator(Header);
+        
+        CC_METRICS_COUNTER_ADD("allocator.deallocate", 1);
     }
 }
 
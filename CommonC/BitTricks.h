@@ -92,6 +92,13 @@ static CC_FORCE_INLINE uint64_t CCBitMaskForUnsetValue(uint64_t x) CC_CONSTANT_F
  */
 static CC_FORCE_INLINE uint64_t CCBitCountSet(uint64_t x) CC_CONSTANT_FUNCTION;
 
+/*!
+ * @brief Counts the number of unset bits below the lowest set bit.
+ * @example (00010110 -> 00000001, 00001000 -> 00000011)
+ * @return The index of the lowest set bit, or 64 if no bits are set.
+ */
+static CC_FORCE_INLINE uint64_t CCBitCountTrailingZeros(uint64_t x) CC_CONSTANT_FUNCTION;
+
 /*!
  * @brief Set n least significant bits
  * @return Set n bits.
@@ -199,6 +206,16 @@ static CC_FORCE_INLINE CC_CONSTANT_FUNCTION uint64_t CCBitCountSet(uint64_t x)
     return x;
 }
 
+//Counts the number of unset bits below the lowest set bit (00010110 -> 00000001, 00001000 -> 00000011)
+static CC_FORCE_INLINE CC_CONSTANT_FUNCTION uint64_t CCBitCountTrailingZeros(uint64_t x)
+{
+#if __has_builtin(__builtin_ctzll) || defined(__GNUC__)
+    return x ? __builtin_ctzll(x) : 64;
+#else
+    return CCBitCountSet(CCBitLowestSet(x) - 1);
+#endif
+}
+
 //Set n least significant bits
 static CC_FORCE_INLINE CC_CONSTANT_FUNCTION uint64_t CCBitSet(uint64_t n)
 {
@@ -408,7 +408,7 @@ CCString CCStringCreateWithSize(CCAllocatorType Allocator, CCStringHint Hint, co
 {
     CCAssertLog(String, "String must not be null");
     
-    return CCStringCreateFromString(Allocator, Hint, String, Size, Size == strlen(String));
+    return CCStringCreateFromString(Allocator, Hint, String, Size, strnlen(String, Size + 1) == Size);
 }
 
 CCString CCStringCreateByInsertingString(CCString String, size_t Index, CCString Insert)
@@ -55,6 +55,8 @@
 
 #include <CommonC/SystemInfo.h>
 #include <CommonC/ProcessInfo.h>
+#include <CommonC/Metrics.h>
+#include <CommonC/Trace.h>
 
 #include <CommonC/Maths.h>
 #include <CommonC/BitTricks.h>
@@ -67,6 +69,8 @@
 #include <CommonC/LinkedList.h>
 #include <CommonC/Array.h>
 #include <CommonC/ConcurrentIndexMap.h>
+#include <CommonC/ConcurrentArray.h>
+#include <CommonC/ConcurrentTree.h>
 #include <CommonC/Collection.h>
 #include <CommonC/OrderedCollection.h>
 #include <CommonC/CollectionEnumerator.h>
@@ -78,11 +82,15 @@
 #include <CommonC/Path.h>
 #include <CommonC/FileSystem.h>
 #include <CommonC/FileHandle.h>
+#include <CommonC/FileIOQueue.h>
+#include <CommonC/FileReader.h>
 
 #include <CommonC/Buffer.h>
 #include <CommonC/Data.h>
 #include <CommonC/Hash.h>
 #include <CommonC/DataBuffer.h>
+#include <CommonC/DataComposite.h>
+#include <CommonC/DataFile.h>
 
 #include <CommonC/CCString.h>
 #include <CommonC/CCStringEnumerator.h>
@@ -114,5 +122,6 @@
 
 #include <CommonC/ConcurrentIDGenerator.h>
 #include <CommonC/ConsecutiveIDGenerator.h>
+#include <CommonC/GrowableIDGenerator.h>
 
 #endif
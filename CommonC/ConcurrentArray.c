@@ -26,61 +26,604 @@
 #include "ConcurrentArray.h"
 #include "MemoryAllocation.h"
 #include "Assertion.h"
+#include "BitTricks.h"
 #include <stdatomic.h>
 #include <string.h>
 
-/*
- CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE enforces standard compliant usage of atomic types. This however will
- result in all operations requiring CAS-loops.
- */
-#define CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE 0
+#define CC_CONCURRENT_ARRAY_SEGMENT_MAX (sizeof(size_t) * 8)
 
-#if !CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE
-#if !CC_HARDWARE_PTR_64 && !CC_HARDWARE_PTR_32
-#undef CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE
-#define CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE 1
-#endif
-#endif
+enum {
+    CCConcurrentArrayTagSet = (1 << 0),
+    CCConcurrentArrayTagFrozen = (1 << 1)
+};
 
 typedef struct {
     void *element;
     uintptr_t tag;
 } CCConcurrentArrayBufferPointer;
 
+typedef _Atomic(CCConcurrentArrayBufferPointer) CCConcurrentArraySlot;
+
+typedef struct {
+    size_t index;
+    void *element;
+    _Bool insert;
+} CCConcurrentArrayOperation;
+
 typedef struct {
     CCConcurrentArray array;
     _Atomic(size_t) count;
-    _Atomic(CCConcurrentArrayBufferPointer) buffer[];
+    _Atomic(CCConcurrentArrayOperation*) operation;
+    _Atomic(CCConcurrentArraySlot*) segments[CC_CONCURRENT_ARRAY_SEGMENT_MAX];
 } CCConcurrentArrayData;
 
 typedef struct {
-#if CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE
-#if CC_HARDWARE_PTR_64
-    uint64_t mutate;
-#else
-    uint32_t mutate;
-#endif
-#else
-#if CC_HARDWARE_PTR_64
-    _Atomic(uint64_t) mutate;
-#else
-    _Atomic(uint32_t) mutate;
-#endif
-#endif
-    CCConcurrentArrayData *data;
-} CCConcurrentArrayDataPointer;
-
-#if !CC_CONCURRENT_INDEX_MAP_STRICT_COMPLIANCE
-#if CC_HARDWARE_PTR_64
-_Static_assert(sizeof(_Atomic(CCConcurrentArrayDataPointer)) == 16, "Native types are not atomic, please set CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE");
-#elif CC_HARDWARE_PTR_32
-_Static_assert(sizeof(_Atomic(CCConcurrentArrayDataPointer)) == 8, "Native types are not atomic, please set CC_CONCURRENT_ARRAY_STRICT_COMPLIANCE");
-#endif
-#endif
+    _Bool applied;
+    _Bool pending;
+    CCConcurrentArrayBufferPointer element;
+} CCConcurrentArrayOperationResult;
 
 typedef struct CCConcurrentArrayInfo {
     CCAllocatorType allocator;
     size_t size, chunkSize;
-    _Atomic(CCConcurrentArrayDataPointer) pointer;
+    _Atomic(CCConcurrentArrayData*) data;
     CCConcurrentGarbageCollector gc;
 } CCConcurrentArrayInfo;
+
+/*
+ Marks an unallocated segment of a frozen array, so no new segments can be published while it is being rebuilt.
+ */
+static CCConcurrentArraySlot CCConcurrentArrayFrozenSegment[1];
+
+static inline size_t CCConcurrentArrayGetSegment(CCConcurrentArray Array, size_t Index)
+{
+    return CCBitCountSet(CCBitHighestSet((Index / Array->chunkSize) + 1) - 1);
+}
+
+static inline size_t CCConcurrentArrayGetSegmentStart(CCConcurrentArray Array, size_t Segment)
+{
+    return Array->chunkSize * (((size_t)1 << Segment) - 1);
+}
+
+static inline size_t CCConcurrentArrayGetSegmentCount(CCConcurrentArray Array, size_t Segment)
+{
+    return Array->chunkSize << Segment;
+}
+
+static inline CCConcurrentArraySlot *CCConcurrentArrayGetSlot(CCConcurrentArrayData *Data, size_t Index, _Bool *Frozen)
+{
+    const size_t Segment = CCConcurrentArrayGetSegment(Data->array, Index);
+    if (Segment >= CC_CONCURRENT_ARRAY_SEGMENT_MAX) return NULL;
+    
+    CCConcurrentArraySlot *Slots = atomic_load_explicit(&Data->segments[Segment], memory_order_acquire);
+    if (Slots == CCConcurrentArrayFrozenSegment)
+    {
+        if (Frozen) *Frozen = TRUE;
+        return NULL;
+    }
+    
+    return Slots ? Slots + (Index - CCConcurrentArrayGetSegmentStart(Data->array, Segment)) : NULL;
+}
+
+static inline _Bool CCConcurrentArrayIsInline(CCConcurrentArray Array)
+{
+    return Array->size <= sizeof(void*);
+}
+
+static _Bool CCConcurrentArrayCreateElement(CCConcurrentArray Array, const void *Element, void **Result)
+{
+    if (CCConcurrentArrayIsInline(Array))
+    {
+        *Result = NULL;
+        memcpy(Result, Element, Array->size);
+    }
+    
+    else
+    {
+        void *Copy = CCMalloc(Array->allocator, Array->size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        if (!Copy) return FALSE;
+        
+        memcpy(Copy, Element, Array->size);
+        *Result = Copy;
+    }
+    
+    return TRUE;
+}
+
+static inline const void *CCConcurrentArrayGetElement(CCConcurrentArray Array, void * const *Element)
+{
+    return CCConcurrentArrayIsInline(Array) ? (const void*)Element : *Element;
+}
+
+static inline void CCConcurrentArrayDiscardElement(CCConcurrentArray Array, void *Element)
+{
+    if (!CCConcurrentArrayIsInline(Array)) CCFree(Element);
+}
+
+static inline void CCConcurrentArrayRetireElement(CCConcurrentArray Array, void *Element)
+{
+    if (!CCConcurrentArrayIsInline(Array)) CCConcurrentGarbageCollectorManage(Array->gc, Element, CCFree);
+}
+
+static void CCConcurrentArrayDataDestructor(CCConcurrentArrayData *Data)
+{
+    for (size_t Loop = 0; Loop < CC_CONCURRENT_ARRAY_SEGMENT_MAX; Loop++)
+    {
+        CCConcurrentArraySlot *Slots = atomic_load_explicit(&Data->segments[Loop], memory_order_relaxed);
+        if ((!Slots) || (Slots == CCConcurrentArrayFrozenSegment)) break;
+        
+        CCFree(Slots);
+    }
+    
+    CCConcurrentArrayOperation *Operation = atomic_load_explicit(&Data->operation, memory_order_relaxed);
+    if (Operation) CCFree(Operation);
+}
+
+static CCConcurrentArraySlot *CCConcurrentArrayCreateSegment(CCConcurrentArray Array, size_t Segment)
+{
+    const size_t Count = CCConcurrentArrayGetSegmentCount(Array, Segment);
+    
+    CCConcurrentArraySlot *Slots = CCMalloc(Array->allocator, sizeof(CCConcurrentArraySlot) * Count, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Slots)
+    {
+        for (size_t Loop = 0; Loop < Count; Loop++) atomic_init(&Slots[Loop], ((CCConcurrentArrayBufferPointer){ .element = NULL, .tag = 0 }));
+    }
+    
+    return Slots;
+}
+
+static CCConcurrentArrayData *CCConcurrentArrayCreateData(CCConcurrentArray Array, size_t Count)
+{
+    CCConcurrentArrayData *Data = CCMalloc(Array->allocator, sizeof(CCConcurrentArrayData), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Data)
+    {
+        Data->array = Array;
+        atomic_init(&Data->count, Count);
+        atomic_init(&Data->operation, NULL);
+        for (size_t Loop = 0; Loop < CC_CONCURRENT_ARRAY_SEGMENT_MAX; Loop++) atomic_init(&Data->segments[Loop], NULL);
+        
+        CCMemorySetDestructor(Data, (CCMemoryDestructorCallback)CCConcurrentArrayDataDestructor);
+        
+        for (size_t Segment = 0, Capacity = 0; (Capacity < Count) || (!Segment); Segment++)
+        {
+            CCConcurrentArraySlot *Slots = CCConcurrentArrayCreateSegment(Array, Segment);
+            if (!Slots)
+            {
+                CCFree(Data);
+                return NULL;
+            }
+            
+            atomic_init(&Data->segments[Segment], Slots);
+            Capacity += CCConcurrentArrayGetSegmentCount(Array, Segment);
+        }
+    }
+    
+    return Data;
+}
+
+static void CCConcurrentArrayDestructor(CCConcurrentArray Array)
+{
+    CCConcurrentArrayData *Data = atomic_load_explicit(&Array->data, memory_order_relaxed);
+    
+    if (!CCConcurrentArrayIsInline(Array))
+    {
+        for (size_t Segment = 0; Segment < CC_CONCURRENT_ARRAY_SEGMENT_MAX; Segment++)
+        {
+            CCConcurrentArraySlot *Slots = atomic_load_explicit(&Data->segments[Segment], memory_order_relaxed);
+            if ((!Slots) || (Slots == CCConcurrentArrayFrozenSegment)) break;
+            
+            for (size_t Loop = 0, Count = CCConcurrentArrayGetSegmentCount(Array, Segment); Loop < Count; Loop++)
+            {
+                CCConcurrentArrayBufferPointer Value = atomic_load_explicit(&Slots[Loop], memory_order_relaxed);
+                if (Value.tag & CCConcurrentArrayTagSet) CCFree(Value.element);
+            }
+        }
+        
+        CCConcurrentArrayOperation *Operation = atomic_load_explicit(&Data->operation, memory_order_relaxed);
+        if ((Operation) && (Operation->insert)) CCFree(Operation->element);
+    }
+    
+    CCFree(Data);
+    
+    CCConcurrentGarbageCollectorDestroy(Array->gc);
+}
+
+CCConcurrentArray CCConcurrentArrayCreate(CCAllocatorType Allocator, size_t ElementSize, size_t ChunkSize, CCConcurrentGarbageCollector GC)
+{
+    CCAssertLog(ChunkSize >= 1, "ChunkSize must be at least 1");
+    CCAssertLog(GC, "GC must not be null");
+    
+    CCConcurrentArray Array = CCMalloc(Allocator, sizeof(CCConcurrentArrayInfo), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Array)
+    {
+        *Array = (CCConcurrentArrayInfo){
+            .allocator = Allocator,
+            .size = ElementSize,
+            .chunkSize = ChunkSize,
+            .gc = GC
+        };
+        
+        CCConcurrentArrayData *Data = CCConcurrentArrayCreateData(Array, 0);
+        if (!Data)
+        {
+            CC_LOG_ERROR("Failed to create array: Failed to allocate memory of size (%zu)", sizeof(CCConcurrentArraySlot) * ChunkSize);
+            CCFree(Array);
+            CCConcurrentGarbageCollectorDestroy(GC);
+            
+            return NULL;
+        }
+        
+        atomic_init(&Array->data, Data);
+        
+        CCMemorySetDestructor(Array, (CCMemoryDestructorCallback)CCConcurrentArrayDestructor);
+    }
+    
+    return Array;
+}
+
+void CCConcurrentArrayDestroy(CCConcurrentArray Array)
+{
+    CCAssertLog(Array, "Array must not be null");
+    
+    CCFree(Array);
+}
+
+static CCConcurrentArrayOperationResult CCConcurrentArrayFreeze(CCConcurrentArrayData *Data, const CCConcurrentArrayOperation *Operation, size_t *Count)
+{
+    CCConcurrentArrayOperationResult Result = { .applied = FALSE, .pending = FALSE, .element = { .element = NULL, .tag = 0 } };
+    
+    *Count = 0;
+    for (size_t Segment = 0; Segment < CC_CONCURRENT_ARRAY_SEGMENT_MAX; Segment++)
+    {
+        CCConcurrentArraySlot *Slots = NULL;
+        if ((atomic_compare_exchange_strong_explicit(&Data->segments[Segment], &Slots, CCConcurrentArrayFrozenSegment, memory_order_acquire, memory_order_acquire)) || (Slots == CCConcurrentArrayFrozenSegment)) break;
+        
+        const size_t Start = CCConcurrentArrayGetSegmentStart(Data->array, Segment);
+        for (size_t Loop = 0, SegmentCount = CCConcurrentArrayGetSegmentCount(Data->array, Segment); Loop < SegmentCount; Loop++)
+        {
+            CCConcurrentArrayBufferPointer Value = atomic_load_explicit(&Slots[Loop], memory_order_acquire);
+            while ((!(Value.tag & CCConcurrentArrayTagFrozen)) && (!atomic_compare_exchange_weak_explicit(&Slots[Loop], &Value, ((CCConcurrentArrayBufferPointer){ .element = Value.element, .tag = Value.tag | CCConcurrentArrayTagFrozen }), memory_order_acquire, memory_order_acquire)));
+            
+            if (Value.tag & CCConcurrentArrayTagSet)
+            {
+                *Count = Start + Loop + 1;
+                
+                if ((!Operation->insert) && (Operation->index == (Start + Loop))) Result.element = Value;
+            }
+        }
+    }
+    
+    Result.applied = Operation->insert ? Operation->index <= *Count : Operation->index < *Count;
+    
+    return Result;
+}
+
+static CCConcurrentArrayData *CCConcurrentArrayRebuild(CCConcurrentArray Array, CCConcurrentArrayData *PrevData, const CCConcurrentArrayOperation *Operation, size_t Count, _Bool Applied)
+{
+    const size_t SkipIndex = (Applied) && (!Operation->insert) ? Operation->index : SIZE_MAX;
+    const size_t ExtraIndex = (Applied) && (Operation->insert) ? Operation->index : SIZE_MAX;
+    const size_t CopyCount = SkipIndex == SIZE_MAX ? Count : Count - 1;
+    
+    CCConcurrentArrayData *Data = CCConcurrentArrayCreateData(Array, CopyCount + (ExtraIndex != SIZE_MAX));
+    if (Data)
+    {
+        for (size_t Loop = 0; Loop < CopyCount; Loop++)
+        {
+            CCConcurrentArrayBufferPointer Value = atomic_load_explicit(CCConcurrentArrayGetSlot(PrevData, (Loop < SkipIndex ? Loop : Loop + 1), NULL), memory_order_relaxed);
+            atomic_init(CCConcurrentArrayGetSlot(Data, (Loop < ExtraIndex ? Loop : Loop + 1), NULL), ((CCConcurrentArrayBufferPointer){ .element = Value.element, .tag = CCConcurrentArrayTagSet }));
+        }
+        
+        if (ExtraIndex != SIZE_MAX) atomic_init(CCConcurrentArrayGetSlot(Data, ExtraIndex, NULL), ((CCConcurrentArrayBufferPointer){ .element = Operation->element, .tag = CCConcurrentArrayTagSet }));
+    }
+    
+    return Data;
+}
+
+/*
+ Completes the pending operation of the data (if any). This may be called by any thread that encounters a
+ frozen array, the first thread to publish its rebuilt copy is responsible for retiring the previous data.
+ 
+ If the rebuilt copy cannot be allocated the frozen data can no longer be modified, so a helper gives up and the
+ result is marked as pending. The thread that published the operation (Owner) instead keeps retrying until it has
+ been applied, so once an operation is published its result is always reported to the caller that made it.
+ */
+static CCConcurrentArrayOperationResult CCConcurrentArrayComplete(CCConcurrentArray Array, CCConcurrentArrayData *Data, _Bool Owner)
+{
+    CCConcurrentArrayOperation *Operation = atomic_load_explicit(&Data->operation, memory_order_acquire);
+    if (!Operation) return (CCConcurrentArrayOperationResult){ .applied = FALSE, .pending = FALSE };
+    
+    size_t Count;
+    const CCConcurrentArrayOperationResult Result = CCConcurrentArrayFreeze(Data, Operation, &Count);
+    
+    while (atomic_load_explicit(&Array->data, memory_order_acquire) == Data)
+    {
+        CCConcurrentArrayData *NewData = CCConcurrentArrayRebuild(Array, Data, Operation, Count, Result.applied);
+        if (!NewData)
+        {
+            if (!Owner) return (CCConcurrentArrayOperationResult){ .applied = FALSE, .pending = TRUE };
+            
+            CC_SPIN_WAIT();
+            continue;
+        }
+        
+        CCConcurrentArrayData *Expected = Data;
+        if (atomic_compare_exchange_strong_explicit(&Array->data, &Expected, NewData, memory_order_release, memory_order_acquire))
+        {
+            if (Result.applied)
+            {
+                if (!Operation->insert) CCConcurrentArrayRetireElement(Array, Result.element.element);
+            }
+            
+            else if (Operation->insert) CCConcurrentArrayRetireElement(Array, Operation->element);
+            
+            CCConcurrentGarbageCollectorManage(Array->gc, Data, CCFree);
+        }
+        
+        else CCFree(NewData);
+    }
+    
+    return Result;
+}
+
+static CCConcurrentArrayOperationResult CCConcurrentArrayPerformOperation(CCConcurrentArray Array, CCConcurrentArrayOperation *Operation)
+{
+    for ( ; ; )
+    {
+        CCConcurrentArrayData *Data = atomic_load_explicit(&Array->data, memory_order_acquire);
+        
+        CCConcurrentArrayOperation *Pending = NULL;
+        if (atomic_compare_exchange_strong_explicit(&Data->operation, &Pending, Operation, memory_order_release, memory_order_acquire)) return CCConcurrentArrayComplete(Array, Data, TRUE);
+        
+        const CCConcurrentArrayOperationResult Result = CCConcurrentArrayComplete(Array, Data, FALSE);
+        if (Result.pending)
+        {
+            //the operation was never published so it is still owned by the caller
+            if (Operation->insert) CCConcurrentArrayDiscardElement(Array, Operation->element);
+            CCFree(Operation);
+            
+            return Result;
+        }
+    }
+}
+
+size_t CCConcurrentArrayGetCount(CCConcurrentArray Array)
+{
+    CCAssertLog(Array, "Array must not be null");
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    const size_t Count = atomic_load_explicit(&atomic_load_explicit(&Array->data, memory_order_acquire)->count, memory_order_relaxed);
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    return Count;
+}
+
+size_t CCConcurrentArrayGetElementSize(CCConcurrentArray Array)
+{
+    CCAssertLog(Array, "Array must not be null");
+    
+    return Array->size;
+}
+
+_Bool CCConcurrentArrayGetElementAtIndex(CCConcurrentArray Array, size_t Index, void *Element)
+{
+    CCAssertLog(Array, "Array must not be null");
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    CCConcurrentArraySlot *Slot = CCConcurrentArrayGetSlot(atomic_load_explicit(&Array->data, memory_order_acquire), Index, NULL);
+    CCConcurrentArrayBufferPointer Value = Slot ? atomic_load_explicit(Slot, memory_order_acquire) : (CCConcurrentArrayBufferPointer){ .element = NULL, .tag = 0 };
+    
+    const _Bool Exists = Value.tag & CCConcurrentArrayTagSet;
+    if ((Exists) && (Element)) memcpy(Element, CCConcurrentArrayGetElement(Array, &Value.element), Array->size);
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    return Exists;
+}
+
+size_t CCConcurrentArrayAppendElement(CCConcurrentArray Array, const void *Element)
+{
+    CCAssertLog(Array, "Array must not be null");
+    CCAssertLog(Element, "Element must not be null");
+    
+    void *NewElement;
+    if (!CCConcurrentArrayCreateElement(Array, Element, &NewElement)) return SIZE_MAX;
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    size_t Index = SIZE_MAX;
+    for (_Bool Appended = FALSE; !Appended; )
+    {
+        CCConcurrentArrayData *Data = atomic_load_explicit(&Array->data, memory_order_acquire);
+        
+        Index = atomic_load_explicit(&Data->count, memory_order_relaxed);
+        for (size_t Segment = CCConcurrentArrayGetSegment(Array, Index); (!Appended) && (Segment < CC_CONCURRENT_ARRAY_SEGMENT_MAX); Segment++)
+        {
+            CCConcurrentArraySlot *Slots = atomic_load_explicit(&Data->segments[Segment], memory_order_acquire);
+            if (!Slots)
+            {
+                CCConcurrentArraySlot *NewSlots = CCConcurrentArrayCreateSegment(Array, Segment);
+                if (!NewSlots)
+                {
+                    CCConcurrentGarbageCollectorEnd(Array->gc);
+                    CCConcurrentArrayDiscardElement(Array, NewElement);
+                    
+                    return SIZE_MAX;
+                }
+                
+                if (atomic_compare_exchange_strong_explicit(&Data->segments[Segment], &Slots, NewSlots, memory_order_release, memory_order_acquire)) Slots = NewSlots;
+                else CCFree(NewSlots);
+            }
+            
+            if (Slots == CCConcurrentArrayFrozenSegment) break;
+            
+            const size_t Start = CCConcurrentArrayGetSegmentStart(Array, Segment), SegmentCount = CCConcurrentArrayGetSegmentCount(Array, Segment);
+            for (size_t Loop = Index - Start; Loop < SegmentCount; Loop++)
+            {
+                CCConcurrentArrayBufferPointer Value = atomic_load_explicit(&Slots[Loop], memory_order_relaxed);
+                while (!(Value.tag & (CCConcurrentArrayTagSet | CCConcurrentArrayTagFrozen)))
+                {
+                    if (atomic_compare_exchange_weak_explicit(&Slots[Loop], &Value, ((CCConcurrentArrayBufferPointer){ .element = NewElement, .tag = CCConcurrentArrayTagSet }), memory_order_release, memory_order_relaxed))
+                    {
+                        Index = Start + Loop;
+                        Appended = TRUE;
+                        break;
+                    }
+                }
+                
+                if ((Appended) || (Value.tag & CCConcurrentArrayTagFrozen)) break;
+            }
+            
+            if (Appended) atomic_fetch_add_explicit(&Data->count, 1, memory_order_relaxed);
+            else if (atomic_load_explicit(&Data->operation, memory_order_relaxed)) break;
+            else Index = Start + SegmentCount;
+        }
+        
+        if ((!Appended) && (CCConcurrentArrayComplete(Array, Data, FALSE).pending))
+        {
+            CCConcurrentGarbageCollectorEnd(Array->gc);
+            CCConcurrentArrayDiscardElement(Array, NewElement);
+            
+            return SIZE_MAX;
+        }
+    }
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    return Index;
+}
+
+static _Bool CCConcurrentArrayReplace(CCConcurrentArray Array, size_t Index, const void *Element, const void *Match, void *ReplacedElement)
+{
+    void *NewElement;
+    if (!CCConcurrentArrayCreateElement(Array, Element, &NewElement)) return FALSE;
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    _Bool Replaced = FALSE;
+    for ( ; ; )
+    {
+        CCConcurrentArrayData *Data = atomic_load_explicit(&Array->data, memory_order_acquire);
+        
+        _Bool Frozen = FALSE;
+        CCConcurrentArraySlot *Slot = CCConcurrentArrayGetSlot(Data, Index, &Frozen);
+        if (Slot)
+        {
+            CCConcurrentArrayBufferPointer Value = atomic_load_explicit(Slot, memory_order_acquire);
+            while ((Value.tag & CCConcurrentArrayTagSet) && (!(Value.tag & CCConcurrentArrayTagFrozen)))
+            {
+                if ((Match) && (memcmp(CCConcurrentArrayGetElement(Array, &Value.element), Match, Array->size))) break;
+                
+                if (atomic_compare_exchange_weak_explicit(Slot, &Value, ((CCConcurrentArrayBufferPointer){ .element = NewElement, .tag = CCConcurrentArrayTagSet }), memory_order_acq_rel, memory_order_acquire))
+                {
+                    if (ReplacedElement) memcpy(ReplacedElement, CCConcurrentArrayGetElement(Array, &Value.element), Array->size);
+                    CCConcurrentArrayRetireElement(Array, Value.element);
+                    
+                    Replaced = TRUE;
+                    break;
+                }
+            }
+            
+            Frozen = Value.tag & CCConcurrentArrayTagFrozen;
+        }
+        
+        if ((Replaced) || (!Frozen) || (CCConcurrentArrayComplete(Array, Data, FALSE).pending)) break;
+    }
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    if (!Replaced) CCConcurrentArrayDiscardElement(Array, NewElement);
+    
+    return Replaced;
+}
+
+_Bool CCConcurrentArrayReplaceElementAtIndex(CCConcurrentArray Array, size_t Index, const void *Element, void *ReplacedElement)
+{
+    CCAssertLog(Array, "Array must not be null");
+    CCAssertLog(Element, "Element must not be null");
+    
+    return CCConcurrentArrayReplace(Array, Index, Element, NULL, ReplacedElement);
+}
+
+_Bool CCConcurrentArrayReplaceExactElementAtIndex(CCConcurrentArray Array, size_t Index, const void *Element, const void *Match)
+{
+    CCAssertLog(Array, "Array must not be null");
+    CCAssertLog(Element, "Element must not be null");
+    CCAssertLog(Match, "Match must not be null");
+    
+    return CCConcurrentArrayReplace(Array, Index, Element, Match, NULL);
+}
+
+_Bool CCConcurrentArrayRemoveElementAtIndex(CCConcurrentArray Array, size_t Index, void *RemovedElement)
+{
+    CCAssertLog(Array, "Array must not be null");
+    
+    CCConcurrentArrayOperation *Operation = CCMalloc(Array->allocator, sizeof(CCConcurrentArrayOperation), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Operation) return FALSE;
+    
+    *Operation = (CCConcurrentArrayOperation){ .index = Index, .element = NULL, .insert = FALSE };
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    const CCConcurrentArrayOperationResult Result = CCConcurrentArrayPerformOperation(Array, Operation);
+    if ((Result.applied) && (RemovedElement)) memcpy(RemovedElement, CCConcurrentArrayGetElement(Array, &Result.element.element), Array->size);
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    return Result.applied;
+}
+
+_Bool CCConcurrentArrayInsertElementAtIndex(CCConcurrentArray Array, size_t Index, void *Element)
+{
+    CCAssertLog(Array, "Array must not be null");
+    CCAssertLog(Element, "Element must not be null");
+    
+    CCConcurrentArrayOperation *Operation = CCMalloc(Array->allocator, sizeof(CCConcurrentArrayOperation), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Operation) return FALSE;
+    
+    *Operation = (CCConcurrentArrayOperation){ .index = Index, .element = NULL, .insert = TRUE };
+    
+    if (!CCConcurrentArrayCreateElement(Array, Element, &Operation->element))
+    {
+        CCFree(Operation);
+        return FALSE;
+    }
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    const CCConcurrentArrayOperationResult Result = CCConcurrentArrayPerformOperation(Array, Operation);
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    return Result.applied;
+}
+
+size_t CCConcurrentArrayEnumerate(CCConcurrentArray Array, CCConcurrentArrayEnumerator Enumerator, void *Data)
+{
+    CCAssertLog(Array, "Array must not be null");
+    CCAssertLog(Enumerator, "Enumerator must not be null");
+    
+    CCConcurrentGarbageCollectorBegin(Array->gc);
+    
+    CCConcurrentArrayData *Snapshot = atomic_load_explicit(&Array->data, memory_order_acquire);
+    
+    size_t Enumerated = 0;
+    for (size_t Loop = 0, Count = atomic_load_explicit(&Snapshot->count, memory_order_relaxed); Loop < Count; Loop++)
+    {
+        CCConcurrentArraySlot *Slot = CCConcurrentArrayGetSlot(Snapshot, Loop, NULL);
+        if (!Slot) break;
+        
+        CCConcurrentArrayBufferPointer Value = atomic_load_explicit(Slot, memory_order_acquire);
+        if (!(Value.tag & CCConcurrentArrayTagSet)) break;
+        
+        Enumerated++;
+        
+        if (!Enumerator(CCConcurrentArrayGetElement(Array, &Value.element), Loop, Data)) break;
+    }
+    
+    CCConcurrentGarbageCollectorEnd(Array->gc);
+    
+    return Enumerated;
+}
@@ -26,6 +26,17 @@
 #ifndef CommonC_ConcurrentArray_h
 #define CommonC_ConcurrentArray_h
 
+/*
+ Lock-free array. Elements are stored in segments that are never relocated, the first segment
+ holds chunk size elements and each additional segment doubles the capacity. Appends, lookups
+ and replacements operate directly on the segments. Insertions and removals freeze the current
+ segments and publish a rebuilt copy, any thread that encounters a frozen array will help to
+ complete the rebuild so no operation can be blocked by another thread. Retired segments and
+ elements are reclaimed by the garbage collector.
+ 
+ Allows for many producer-consumer access.
+ */
+
 #include <CommonC/Base.h>
 #include <CommonC/Ownership.h>
 #include <CommonC/Allocator.h>
@@ -38,14 +49,25 @@
  */
 typedef struct CCConcurrentArrayInfo *CCConcurrentArray;
 
+/*!
+ * @brief The callback used when enumerating the array.
+ * @param Element The pointer to the element. This is only valid for the duration of the callback.
+ * @param Index The index of the element.
+ * @param Data The data passed to the enumerate function.
+ * @return Whether the enumeration should continue (TRUE) or stop (FALSE).
+ */
+typedef _Bool (*CCConcurrentArrayEnumerator)(const void *Element, size_t Index, void *Data);
+
 #pragma mark - Creation / Destruction
 /*!
  * @brief Create a concurrent array.
  * @description This array allows for many producer-consumer access.
  * @param Allocator The allocator to be used for the allocation.
  * @param ElementSize The size of the data elements.
- * @param ChunkSize The number of elements to fit with each allocation. Must be at least 1.
- * @param GC The garbage collector to be used in this queue.
+ * @param ChunkSize The number of elements to fit in the first segment, each subsequent segment will be
+ *        double the size of the previous. Must be at least 1.
+ *
+ * @param GC The garbage collector to be used in this array.
  * @return An array, or NULL on failure. Must be destroyed to free the memory.
  */
 CC_NEW CCConcurrentArray CCConcurrentArrayCreate(CCAllocatorType Allocator, size_t ElementSize, size_t ChunkSize, CCConcurrentGarbageCollector CC_OWN(GC));
@@ -60,6 +82,9 @@ void CCConcurrentArrayDestroy(CCConcurrentArray CC_DESTROY(Array));
 /*!
  * @brief Appends the element to the end of the array.
  * @description Increases the array's count by 1.
+ * @performance This operation is lock-free. If there is no space remaining a new segment will be added,
+ *              the existing elements are not relocated.
+ *
  * @warning The size of element must be the same size as specified in the array creation.
  * @param Array The array to append the element to.
  * @param Element The pointer to the element to be copied to the end of the array. This must not
@@ -71,6 +96,7 @@ size_t CCConcurrentArrayAppendElement(CCConcurrentArray Array, const void *Eleme
 
 /*!
  * @brief Replace element at index with new element.
+ * @performance This operation is a O(1) lock-free operation.
  * @warning The size of element must be the same size as specified in the array creation.
  * @param Array The array to replace an element of.
  * @param Index The position of the element to be replaced.
@@ -83,6 +109,7 @@ _Bool CCConcurrentArrayReplaceElementAtIndex(CCConcurrentArray Array, size_t Ind
 
 /*!
  * @brief Replace element at index with new element if the existing element matches.
+ * @performance This operation is a O(1) lock-free operation.
  * @warning The size of element must be the same size as specified in the array creation.
  * @param Array The array to replace an element of.
  * @param Index The position of the element to be replaced.
@@ -97,6 +124,7 @@ _Bool CCConcurrentArrayReplaceExactElementAtIndex(CCConcurrentArray Array, size_
 /*!
  * @brief Removes an element at a given index from the array.
  * @description Decreases the array's count by 1.
+ * @performance This operation is a O(n) lock-free operation, as it rebuilds the array.
  * @warning The size of element must be the same size as specified in the array creation.
  * @param Array The array to remove an element from.
  * @param Index The position of the element to be removed.
@@ -110,6 +138,7 @@ _Bool CCConcurrentArrayRemoveElementAtIndex(CCConcurrentArray Array, size_t Inde
 /*!
  * @brief Insert an element at a given index into the array.
  * @description Increases the array's count by 1.
+ * @performance This operation is a O(n) lock-free operation, as it rebuilds the array.
  * @warning The size of element must be the same size as specified in the array creation.
  * @param Array The array to insert the element into.
  * @param Index The position in the array for the element to be inserted.
@@ -140,6 +169,7 @@ size_t CCConcurrentArrayGetElementSize(CCConcurrentArray Array);
 
 /*!
  * @brief Get the element at index.
+ * @performance Wait-free O(1) operation.
  * @param Array The array to get the element of.
  * @param Index The index of the element.
  * @param Element A pointer to where the value should be written to. If NULL this will be ignored.
@@ -147,4 +177,19 @@ size_t CCConcurrentArrayGetElementSize(CCConcurrentArray Array);
  */
 _Bool CCConcurrentArrayGetElementAtIndex(CCConcurrentArray Array, size_t Index, void *Element);
 
+#pragma mark - Enumeration
+/*!
+ * @brief Enumerate the elements of the array.
+ * @description The enumeration is performed over a snapshot of the array at the time of the call, so
+ *              concurrent insertions or removals will not affect the elements that are enumerated.
+ *              Replacements may or may not be reflected for elements that have not been visited yet.
+ *
+ * @warning The enumerator must not call into any structure that uses the same garbage collector.
+ * @param Array The array to enumerate.
+ * @param Enumerator The callback to be called for each element.
+ * @param Data The data to be passed to the enumerator.
+ * @return The number of elements that were enumerated.
+ */
+size_t CCConcurrentArrayEnumerate(CCConcurrentArray Array, CCConcurrentArrayEnumerator Enumerator, void *Data);
+
 #endif
@@ -26,6 +26,7 @@
 #include "ConcurrentIndexMap.h"
 #include "MemoryAllocation.h"
 #include "Assertion.h"
+#include "BitTricks.h"
 #include <stdatomic.h>
 #include <string.h>
 
@@ -44,10 +45,17 @@
 #endif
 #endif
 
+/*
+ The elements are stored in segments, where the first segment holds chunkSize elements and each following
+ segment holds double that of the previous. Segments are published atomically into the directory when an
+ append runs out of space, so elements are never relocated when growing.
+ */
+#define CC_CONCURRENT_INDEX_MAP_SEGMENT_MAX (sizeof(size_t) * 8)
+
 typedef struct {
     CCConcurrentIndexMap indexMap;
     _Atomic(size_t) count;
-    uint8_t buffer[];
+    _Atomic(uint8_t*) segments[CC_CONCURRENT_INDEX_MAP_SEGMENT_MAX];
 } CCConcurrentIndexMapData;
 
 typedef struct {
@@ -345,9 +353,62 @@ static inline const CCConcurrentIndexMapAtomicOperation *CCConcurrentIndexMapGet
     return CCConcurrentIndexMapRequiresExternalStorage(ElementSize) ? &CCConcurrentIndexMapAtomicPtrOperation : &CCConcurrentIndexMapAtomicOperations[ElementSize];
 }
 
-static inline size_t CCConcurrentIndexMapGetMaxCount(CCConcurrentIndexMap IndexMap, size_t Count)
+static inline size_t CCConcurrentIndexMapGetSegment(CCConcurrentIndexMap IndexMap, size_t Index)
+{
+    return CCBitCountSet(CCBitHighestSet((Index / IndexMap->chunkSize) + 1) - 1);
+}
+
+static inline size_t CCConcurrentIndexMapGetSegmentStart(CCConcurrentIndexMap IndexMap, size_t Segment)
+{
+    return IndexMap->chunkSize * (((size_t)1 << Segment) - 1);
+}
+
+static inline size_t CCConcurrentIndexMapGetSegmentCount(CCConcurrentIndexMap IndexMap, size_t Segment)
 {
-    return ((Count / IndexMap->chunkSize) + ((Count % IndexMap->chunkSize) || (!Count))) * IndexMap->chunkSize;
+    return IndexMap->chunkSize << Segment;
+}
+
+static inline uint8_t *CCConcurrentIndexMapGetElementSegment(CCConcurrentIndexMapData *Data, size_t Index, size_t *Offset)
+{
+    const size_t Segment = CCConcurrentIndexMapGetSegment(Data->indexMap, Index);
+    if (Segment >= CC_CONCURRENT_INDEX_MAP_SEGMENT_MAX)
+    {
+        *Offset = 0;
+        return NULL;
+    }
+    
+    *Offset = Index - CCConcurrentIndexMapGetSegmentStart(Data->indexMap, Segment);
+    
+    return atomic_load_explicit(&Data->segments[Segment], memory_order_acquire);
+}
+
+static uint8_t *CCConcurrentIndexMapCreateSegment(CCConcurrentIndexMap IndexMap, size_t Segment)
+{
+    const CCConcurrentIndexMapAtomicOperation *Atomic = CCConcurrentIndexMapGetAtomicOperation(IndexMap->size);
+    const size_t Count = CCConcurrentIndexMapGetSegmentCount(IndexMap, Segment);
+    
+    uint8_t *Buffer = CCMalloc(IndexMap->allocator, Count * Atomic->size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Buffer)
+    {
+        for (size_t Loop = 0; Loop < Count; Loop++) Atomic->initElement(IndexMap, Buffer, Loop, NULL);
+    }
+    
+    return Buffer;
+}
+
+static uint8_t *CCConcurrentIndexMapAcquireSegment(CCConcurrentIndexMapData *Data, size_t Segment)
+{
+    uint8_t *Buffer = atomic_load_explicit(&Data->segments[Segment], memory_order_acquire);
+    if (!Buffer)
+    {
+        uint8_t *NewBuffer = CCConcurrentIndexMapCreateSegment(Data->indexMap, Segment);
+        if (!NewBuffer) return NULL;
+        
+        if (atomic_compare_exchange_strong_explicit(&Data->segments[Segment], &Buffer, NewBuffer, memory_order_release, memory_order_acquire)) Buffer = NewBuffer;
+        else CCFree(NewBuffer);
+    }
+    
+    return Buffer;
 }
 
 static void CCConcurrentIndexMapDestructor(CCConcurrentIndexMap IndexMap)
@@ -361,7 +422,43 @@ static void CCConcurrentIndexMapDestructor(CCConcurrentIndexMap IndexMap)
 static void CleanupElements(CCConcurrentIndexMapData *Data)
 {
     const CCConcurrentIndexMapAtomicOperation *Atomic =  CCConcurrentIndexMapGetAtomicOperation(Data->indexMap->size);
-    for (size_t Loop = 0, MaxCount = CCConcurrentIndexMapGetMaxCount(Data->indexMap, atomic_load_explicit(&Data->count, memory_order_relaxed)); Loop < MaxCount; Loop++) Atomic->destroyElement(Data->indexMap, Data->buffer, Loop);
+    for (size_t Segment = 0; Segment < CC_CONCURRENT_INDEX_MAP_SEGMENT_MAX; Segment++)
+    {
+        uint8_t *Buffer = atomic_load_explicit(&Data->segments[Segment], memory_order_relaxed);
+        if (!Buffer) break;
+        
+        for (size_t Loop = 0, Count = CCConcurrentIndexMapGetSegmentCount(Data->indexMap, Segment); Loop < Count; Loop++) Atomic->destroyElement(Data->indexMap, Buffer, Loop);
+        
+        CCFree(Buffer);
+    }
+}
+
+static CCConcurrentIndexMapData *CCConcurrentIndexMapCreateData(CCConcurrentIndexMap IndexMap, size_t Count, size_t MaxCount)
+{
+    CCConcurrentIndexMapData *Data = CCMalloc(IndexMap->allocator, sizeof(CCConcurrentIndexMapData), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Data)
+    {
+        Data->indexMap = IndexMap;
+        atomic_init(&Data->count, Count);
+        for (size_t Loop = 0; Loop < CC_CONCURRENT_INDEX_MAP_SEGMENT_MAX; Loop++) atomic_init(&Data->segments[Loop], NULL);
+        
+        CCMemorySetDestructor(Data, (CCMemoryDestructorCallback)CleanupElements);
+        
+        for (size_t Segment = 0, Capacity = 0; (Capacity < MaxCount) || (!Segment); Segment++)
+        {
+            uint8_t *Buffer = CCConcurrentIndexMapCreateSegment(IndexMap, Segment);
+            if (!Buffer)
+            {
+                CCFree(Data);
+                return NULL;
+            }
+            
+            atomic_init(&Data->segments[Segment], Buffer);
+            Capacity += CCConcurrentIndexMapGetSegmentCount(IndexMap, Segment);
+        }
+    }
+    
+    return Data;
 }
 
 CCConcurrentIndexMap CCConcurrentIndexMapCreate(CCAllocatorType Allocator, size_t ElementSize, size_t ChunkSize, CCConcurrentGarbageCollector GC)
@@ -371,14 +468,21 @@ CCConcurrentIndexMap CCConcurrentIndexMapCreate(CCAllocatorType Allocator, size_
     CCConcurrentIndexMap IndexMap = CCMalloc(Allocator, sizeof(CCConcurrentIndexMapInfo), NULL, CC_DEFAULT_ERROR_CALLBACK);
     if (IndexMap)
     {
-        const CCConcurrentIndexMapAtomicOperation *Atomic = CCConcurrentIndexMapGetAtomicOperation(ElementSize);
-        CCConcurrentIndexMapData *Data = CCMalloc(Allocator, sizeof(CCConcurrentIndexMapData) + (ChunkSize * Atomic->size), NULL, CC_DEFAULT_ERROR_CALLBACK);
-        
-        Data->indexMap = IndexMap;
-        atomic_init(&Data->count, 0);
-        for (size_t Loop = 0; Loop < ChunkSize; Loop++) Atomic->initElement(IndexMap, Data->buffer, Loop, NULL);
+        *IndexMap = (CCConcurrentIndexMapInfo){
+            .allocator = Allocator,
+            .size = ElementSize,
+            .chunkSize = ChunkSize
+        };
         
-        CCMemorySetDestructor(Data, (CCMemoryDestructorCallback)CleanupElements);
+        CCConcurrentIndexMapData *Data = CCConcurrentIndexMapCreateData(IndexMap, 0, ChunkSize);
+        if (!Data)
+        {
+            CC_LOG_ERROR("Failed to create index map: Failed to allocate memory of size (%zu)", ChunkSize * CCConcurrentIndexMapGetAtomicOperation(ElementSize)->size);
+            CCFree(IndexMap);
+            CCConcurrentGarbageCollectorDestroy(GC);
+            
+            return NULL;
+        }
         
         *IndexMap = (CCConcurrentIndexMapInfo){
             .allocator = Allocator,
@@ -438,10 +542,11 @@ _Bool CCConcurrentIndexMapGetElementAtIndex(CCConcurrentIndexMap IndexMap, size_
     CCConcurrentGarbageCollectorBegin(IndexMap->gc);
     
     CCConcurrentIndexMapDataPointer Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
-    const size_t Count = atomic_load_explicit(&Pointer.data->count, memory_order_relaxed);
-    const size_t MaxCount = CCConcurrentIndexMapGetMaxCount(IndexMap, Count);
     
-    const _Bool Exists = Index < MaxCount ? CCConcurrentIndexMapGetAtomicOperation(IndexMap->size)->getElement(IndexMap, Pointer.data->buffer, Index, Element) : FALSE;
+    size_t Offset;
+    const uint8_t *Buffer = CCConcurrentIndexMapGetElementSegment(Pointer.data, Index, &Offset);
+    
+    const _Bool Exists = Buffer ? CCConcurrentIndexMapGetAtomicOperation(IndexMap->size)->getElement(IndexMap, Buffer, Offset, Element) : FALSE;
     
     CCConcurrentGarbageCollectorEnd(IndexMap->gc);
     
@@ -466,10 +571,10 @@ _Bool CCConcurrentIndexMapReplaceElementAtIndex(CCConcurrentIndexMap IndexMap, s
     CCConcurrentIndexMapDataPointer Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
 #endif
     
-    const size_t Count = atomic_load_explicit(&Pointer.data->count, memory_order_relaxed);
-    const size_t MaxCount = CCConcurrentIndexMapGetMaxCount(IndexMap, Count);
+    size_t Offset;
+    const uint8_t *Buffer = CCConcurrentIndexMapGetElementSegment(Pointer.data, Index, &Offset);
     
-    const _Bool Exists = Index < MaxCount ? CCConcurrentIndexMapGetAtomicOperation(IndexMap->size)->setElement(IndexMap, Pointer.data->buffer, Index, Element, ReplacedElement) : FALSE;
+    const _Bool Exists = Buffer ? CCConcurrentIndexMapGetAtomicOperation(IndexMap->size)->setElement(IndexMap, Buffer, Offset, Element, ReplacedElement) : FALSE;
     
 #if CC_CONCURRENT_INDEX_MAP_STRICT_COMPLIANCE
     if (!atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify + 1, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify, .mutate = Pointer.mutate + Exists, .data = Pointer.data }), memory_order_release, memory_order_relaxed))
@@ -507,10 +612,10 @@ _Bool CCConcurrentIndexMapReplaceExactElementAtIndex(CCConcurrentIndexMap IndexM
     CCConcurrentIndexMapDataPointer Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
 #endif
     
-    const size_t Count = atomic_load_explicit(&Pointer.data->count, memory_order_relaxed);
-    const size_t MaxCount = CCConcurrentIndexMapGetMaxCount(IndexMap, Count);
+    size_t Offset;
+    const uint8_t *Buffer = CCConcurrentIndexMapGetElementSegment(Pointer.data, Index, &Offset);
     
-    const _Bool Exists = Index < MaxCount ? CCConcurrentIndexMapGetAtomicOperation(IndexMap->size)->compareAndSwapElement(IndexMap, Pointer.data->buffer, Index, Element, Match) : FALSE;
+    const _Bool Exists = Buffer ? CCConcurrentIndexMapGetAtomicOperation(IndexMap->size)->compareAndSwapElement(IndexMap, Buffer, Offset, Element, Match) : FALSE;
     
 #if CC_CONCURRENT_INDEX_MAP_STRICT_COMPLIANCE
     if (!atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify + 1, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify, .mutate = Pointer.mutate + Exists, .data = Pointer.data }), memory_order_release, memory_order_relaxed))
@@ -529,19 +634,22 @@ _Bool CCConcurrentIndexMapReplaceExactElementAtIndex(CCConcurrentIndexMap IndexM
     return Exists;
 }
 
-static CCConcurrentIndexMapData *CCConcurrentIndexMapResize(CCConcurrentIndexMap IndexMap, CCConcurrentIndexMapData *PrevData, size_t Count, size_t MaxCount, size_t SkipIndex, size_t ExtraIndex)
+static CCConcurrentIndexMapData *CCConcurrentIndexMapResize(CCConcurrentIndexMap IndexMap, CCConcurrentIndexMapData *PrevData, size_t Count, size_t SkipIndex, size_t ExtraIndex)
 {
     const CCConcurrentIndexMapAtomicOperation *Atomic = CCConcurrentIndexMapGetAtomicOperation(IndexMap->size);
-    CCConcurrentIndexMapData *Data = CCMalloc(IndexMap->allocator, sizeof(CCConcurrentIndexMapData) + (MaxCount * Atomic->size), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    const size_t NewCount = Count + (SkipIndex == SIZE_MAX ? 1 : 0);
+    CCConcurrentIndexMapData *Data = CCConcurrentIndexMapCreateData(IndexMap, NewCount, NewCount);
     
     if (Data)
     {
-        Data->indexMap = IndexMap;
-        atomic_init(&Data->count, Count + (SkipIndex == SIZE_MAX ? 1 : 0));
-        for (size_t Loop = 0; Loop < Count; Loop++) Atomic->copyElement(Data->buffer, (Loop < ExtraIndex ? Loop : Loop + 1), PrevData->buffer, (Loop < SkipIndex ? Loop : Loop + 1));
-        for (size_t Loop = (Count < ExtraIndex ? Count : Count + 1); Loop < MaxCount; Loop++) Atomic->initElement(IndexMap, Data->buffer, Loop, NULL);
-        
-        CCMemorySetDestructor(Data, (CCMemoryDestructorCallback)CleanupElements);
+        for (size_t Loop = 0; Loop < Count; Loop++)
+        {
+            size_t Offset, SrcOffset;
+            uint8_t *Buffer = CCConcurrentIndexMapGetElementSegment(Data, (Loop < ExtraIndex ? Loop : Loop + 1), &Offset);
+            const uint8_t *SrcBuffer = CCConcurrentIndexMapGetElementSegment(PrevData, (Loop < SkipIndex ? Loop : Loop + 1), &SrcOffset);
+            
+            Atomic->copyElement(Buffer, Offset, SrcBuffer, SrcOffset);
+        }
     }
     
     return Data;
@@ -556,78 +664,68 @@ size_t CCConcurrentIndexMapAppendElement(CCConcurrentIndexMap IndexMap, const vo
     
     const CCConcurrentIndexMapAtomicOperation *Atomic =  CCConcurrentIndexMapGetAtomicOperation(IndexMap->size);
     
-    size_t Index;
-    void *State = NULL;
-    for ( ; ; )
-    {
 #if CC_CONCURRENT_INDEX_MAP_STRICT_COMPLIANCE
-        CCConcurrentIndexMapDataPointer Pointer;
-        do {
-            Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
-        } while (!atomic_compare_exchange_weak_explicit(&IndexMap->pointer, &Pointer, ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify + 1, .mutate = Pointer.mutate, .data = Pointer.data }), memory_order_acquire, memory_order_relaxed));
+    CCConcurrentIndexMapDataPointer Pointer;
+    do {
+        Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&IndexMap->pointer, &Pointer, ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify + 1, .mutate = Pointer.mutate, .data = Pointer.data }), memory_order_acquire, memory_order_relaxed));
 #else
-        atomic_fetch_add_explicit(&((CCConcurrentIndexMapDataPointer*)&IndexMap->pointer)->modify, 1, memory_order_acquire);
-        
-        CCConcurrentIndexMapDataPointer Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
+    atomic_fetch_add_explicit(&((CCConcurrentIndexMapDataPointer*)&IndexMap->pointer)->modify, 1, memory_order_acquire);
+    
+    CCConcurrentIndexMapDataPointer Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
 #endif
+    
+    size_t Index = atomic_load_explicit(&Pointer.data->count, memory_order_relaxed);
+    void *State = NULL;
+    _Bool Success = FALSE;
+    for (size_t Segment = CCConcurrentIndexMapGetSegment(IndexMap, Index); Segment < CC_CONCURRENT_INDEX_MAP_SEGMENT_MAX; Segment++)
+    {
+        uint8_t *Buffer = CCConcurrentIndexMapAcquireSegment(Pointer.data, Segment);
+        if (!Buffer) break;
         
-        Index = atomic_load_explicit(&Pointer.data->count, memory_order_relaxed);
-        const size_t MaxCount = CCConcurrentIndexMapGetMaxCount(IndexMap, Index);
+        const size_t Start = CCConcurrentIndexMapGetSegmentStart(IndexMap, Segment), MaxCount = CCConcurrentIndexMapGetSegmentCount(IndexMap, Segment);
+        size_t Offset = Index - Start;
         
-        const _Bool Success = Atomic->appendElement(IndexMap, Pointer.data->buffer, &Index, MaxCount, Element, &State);
-        if (Success)
+        Success = Atomic->appendElement(IndexMap, Buffer, &Offset, MaxCount, Element, &State);
+        if ((Success) || (CC_UNLIKELY(Offset == SIZE_MAX)))
         {
-            atomic_fetch_add_explicit(&Pointer.data->count, 1, memory_order_relaxed);
-            
+            Index = Success ? Start + Offset : SIZE_MAX;
+            break;
+        }
+        
+        Index = Start + MaxCount;
+    }
+    
+    if (Success)
+    {
+        atomic_fetch_add_explicit(&Pointer.data->count, 1, memory_order_relaxed);
+        
 #if !CC_CONCURRENT_INDEX_MAP_STRICT_COMPLIANCE
-            atomic_fetch_add_explicit(&((CCConcurrentIndexMapDataPointer*)&IndexMap->pointer)->mutate, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&((CCConcurrentIndexMapDataPointer*)&IndexMap->pointer)->mutate, 1, memory_order_relaxed);
 #endif
-            
-            State = NULL;
-        }
+    }
+    
+    else
+    {
+        //the element copy is only owned by the map once it has been appended
+        if (State) CCFree(State);
         
+        Index = SIZE_MAX;
+    }
+    
 #if CC_CONCURRENT_INDEX_MAP_STRICT_COMPLIANCE
-        if (!atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify + 1, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify, .mutate = Pointer.mutate + Success, .data = Pointer.data }), memory_order_release, memory_order_relaxed))
-        {
-            do {
-                Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
-            } while (!atomic_compare_exchange_weak_explicit(&IndexMap->pointer, &Pointer, ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify - 1, .mutate = Pointer.mutate + Success, .data = Pointer.data }), memory_order_release, memory_order_relaxed));
-        }
+    if (!atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify + 1, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify, .mutate = Pointer.mutate + Success, .data = Pointer.data }), memory_order_release, memory_order_relaxed))
+    {
+        do {
+            Pointer = atomic_load_explicit(&IndexMap->pointer, memory_order_relaxed);
+        } while (!atomic_compare_exchange_weak_explicit(&IndexMap->pointer, &Pointer, ((CCConcurrentIndexMapDataPointer){ .modify = Pointer.modify - 1, .mutate = Pointer.mutate + Success, .data = Pointer.data }), memory_order_release, memory_order_relaxed));
+    }
 #else
-        atomic_fetch_sub_explicit(&((CCConcurrentIndexMapDataPointer*)&IndexMap->pointer)->modify, 1, memory_order_release);
+    atomic_fetch_sub_explicit(&((CCConcurrentIndexMapDataPointer*)&IndexMap->pointer)->modify, 1, memory_order_release);
 #endif
-        
-        if ((Success) || (CC_UNLIKELY(Index == SIZE_MAX))) break;
-        
-        if (Index == atomic_load_explicit(&Pointer.data->count, memory_order_relaxed))
-        {
-            CCConcurrentIndexMapData *Data = CCConcurrentIndexMapResize(IndexMap, Pointer.data, Index, MaxCount + IndexMap->chunkSize, SIZE_MAX, SIZE_MAX);
-            if ((!Data) || (!Atomic->initElement(IndexMap, Data->buffer, Index, Element)))
-            {
-                if (Data)
-                {
-                    for (size_t Loop = 0, Count = atomic_load_explicit(&Data->count, memory_order_relaxed); Loop < Count; Loop++) Atomic->removeElement(IndexMap, Data->buffer, Loop);
-                    CCFree(Data);
-                }
-                
-                Index = SIZE_MAX;
-                break;
-            }
-            
-            else if (atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate + 1, .data = Data }), memory_order_release, memory_order_relaxed))
-            {
-                CCConcurrentGarbageCollectorManage(IndexMap->gc, Pointer.data, CCFree);
-                break;
-            }
-            
-            else CCFree(Data);
-        }
-    }
     
     CCConcurrentGarbageCollectorEnd(IndexMap->gc);
     
-    if (State) CCFree(State);
-    
     return Index;
 }
 
@@ -645,12 +743,14 @@ _Bool CCConcurrentIndexMapRemoveElementAtIndex(CCConcurrentIndexMap IndexMap, si
         
         if ((Index >= Count) || (!Count)) break;
         
-        CCConcurrentIndexMapData *Data = CCConcurrentIndexMapResize(IndexMap, Pointer.data, Count - 1, CCConcurrentIndexMapGetMaxCount(IndexMap, Count - 1), Index, SIZE_MAX);
+        CCConcurrentIndexMapData *Data = CCConcurrentIndexMapResize(IndexMap, Pointer.data, Count - 1, Index, SIZE_MAX);
         if (Data)
         {
             if (atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate + 1, .data = Data }), memory_order_release, memory_order_relaxed))
             {
-                Atomic->getElement(IndexMap, Pointer.data->buffer, Index, RemovedElement);
+                size_t Offset;
+                const uint8_t *Buffer = CCConcurrentIndexMapGetElementSegment(Pointer.data, Index, &Offset);
+                Atomic->getElement(IndexMap, Buffer, Offset, RemovedElement);
                 CCConcurrentGarbageCollectorManage(IndexMap->gc, Pointer.data, CCFree);
                 
                 Removed = TRUE;
@@ -680,10 +780,13 @@ _Bool CCConcurrentIndexMapInsertElementAtIndex(CCConcurrentIndexMap IndexMap, si
         
         if ((Index >= Count) || (!Count)) break;
         
-       CCConcurrentIndexMapData *Data = CCConcurrentIndexMapResize(IndexMap, Pointer.data, Count, CCConcurrentIndexMapGetMaxCount(IndexMap, Count + 1), SIZE_MAX, Index);
+        CCConcurrentIndexMapData *Data = CCConcurrentIndexMapResize(IndexMap, Pointer.data, Count, SIZE_MAX, Index);
         if (Data)
         {
-            if ((Atomic->initElement(IndexMap, Data->buffer, Index, Element)) && (atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate + 1, .data = Data }), memory_order_release, memory_order_relaxed)))
+            size_t Offset;
+            uint8_t *Buffer = CCConcurrentIndexMapGetElementSegment(Data, Index, &Offset);
+            
+            if ((Atomic->initElement(IndexMap, Buffer, Offset, Element)) && (atomic_compare_exchange_strong_explicit(&IndexMap->pointer, &((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate, .data = Pointer.data }), ((CCConcurrentIndexMapDataPointer){ .modify = 0, .mutate = Pointer.mutate + 1, .data = Data }), memory_order_release, memory_order_relaxed)))
             {
                 CCConcurrentGarbageCollectorManage(IndexMap->gc, Pointer.data, CCFree);
                 
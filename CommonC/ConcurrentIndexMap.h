@@ -28,14 +28,15 @@
 
 /*
  Lock-free index map. This is an array (O(1) lookup) that has wait-free guarantees for
- indexed lookups and replacements. While it supports all the common array conventions,
- it can however block resize operations. To avoid this issue it is recommended that you
- use it with a large chunk size (so resize requests are more spread out or ideally
- never occur). But this doesn't completely avoid the issue, if a thread dies during a
- mutation operation, any future thread that attempts to make a resize will block
- indefinitely. If you need a concurrent array without this limitation, use a
- CCConcurrentArray. However in doing so you lose the wait-free guarantees for
- replacement operations, but the structure is completely lock-free.
+ indexed lookups and replacements. Elements are stored in segments that are never
+ relocated, the first segment holds chunk size elements and each additional segment
+ doubles the capacity. So growing through appends is lock-free and never copies the
+ existing elements. While it supports all the common array conventions, insertions
+ and removals however need to rebuild the index map and these can block. If a thread
+ dies during a mutation operation, any future thread that attempts an insertion or
+ removal will block indefinitely. If you need a concurrent array without this
+ limitation, use a CCConcurrentArray. However in doing so you lose the wait-free
+ guarantees for replacement operations, but the structure is completely lock-free.
  
  Allows for many producer-consumer access.
  */
@@ -58,7 +59,9 @@ typedef struct CCConcurrentIndexMapInfo *CCConcurrentIndexMap;
  * @description This index map allows for many producer-consumer access.
  * @param Allocator The allocator to be used for the allocation.
  * @param ElementSize The size of the data elements.
- * @param ChunkSize The number of elements to fit with each allocation. Must be at least 1.
+ * @param ChunkSize The number of elements to fit in the first segment, each subsequent segment will be
+ *        double the size of the previous. Must be at least 1.
+ *
  * @param GC The garbage collector to be used in this queue.
  * @return An index map, or NULL on failure. Must be destroyed to free the memory.
  */
@@ -74,8 +77,8 @@ void CCConcurrentIndexMapDestroy(CCConcurrentIndexMap CC_DESTROY(IndexMap));
 /*!
  * @brief Appends the element to the end of the index map.
  * @description Increases the index map's count by 1.
- * @performance This operation is lock-free if it can be performed without a resize. If it cannot and
- *              then it will require a resize and so will block.
+ * @performance This operation is lock-free. If there is no space remaining a new segment will be added,
+ *              the existing elements are not relocated.
  *
  * @warning The size of element must be the same size as specified in the index map creation.
  * @param IndexMap The index map to append the element to.
@@ -122,7 +125,7 @@ _Bool CCConcurrentIndexMapReplaceExactElementAtIndex(CCConcurrentIndexMap IndexM
 /*!
  * @brief Removes an element at a given index from the index map.
  * @description Decreases the index map's count by 1.
- * @performance This operation always performs a resize and so will block.
+ * @performance This operation always rebuilds the index map and so will block.
  * @warning The size of element must be the same size as specified in the index map creation.
  * @param IndexMap The index map to remove an element from.
  * @param Index The position of the element to be removed.
@@ -136,7 +139,7 @@ _Bool CCConcurrentIndexMapRemoveElementAtIndex(CCConcurrentIndexMap IndexMap, si
 /*!
  * @brief Insert an element at a given index into the index map.
  * @description Increases the index map's count by 1.
- * @performance This operation always performs a resize and so will block.
+ * @performance This operation always rebuilds the index map and so will block.
  * @warning The size of element must be the same size as specified in the index map creation.
  * @param IndexMap The index map to insert the element into.
  * @param Index The position in the index map for the element to be inserted.
@@ -26,6 +26,7 @@
 #include "ConcurrentQueue.h"
 #include "MemoryAllocation.h"
 #include "Assertion.h"
+#include "Metrics.h"
 #include <stdatomic.h>
 #include <string.h>
 
@@ -41,8 +42,8 @@ CCConcurrentQueueNode *CCConcurrentQueueCreateNode(CCAllocatorType Allocator, si
 
     if (Node)
     {
-        atomic_init(&Node->next, (CCConcurrentQueuePointer){ .node = NULL, .tag = 0 });
-        atomic_init(&Node->prev, (CCConcurrentQueuePointer){ .node = NULL, .tag = 0 });
+        atomic_init(&Node->next, ((CCConcurrentQueuePointer){ .node = NULL, .tag = 0 }));
+        atomic_init(&Node->prev, ((CCConcurrentQueuePointer){ .node = NULL, .tag = 0 }));
         if (Data) memcpy(((CCConcurrentQueueNodeData*)Node)->data, Data, Size);
     }
 
@@ -86,8 +87,8 @@ CCConcurrentQueue CCConcurrentQueueCreate(CCAllocatorType Allocator, CCConcurren
     if (Queue)
     {
         CCConcurrentQueueNode *Dummy = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
-        atomic_init(&Queue->head, (CCConcurrentQueuePointer){ .node = Dummy, .tag = 0 });
-        atomic_init(&Queue->tail, (CCConcurrentQueuePointer){ .node = Dummy, .tag = 0 });
+        atomic_init(&Queue->head, ((CCConcurrentQueuePointer){ .node = Dummy, .tag = 0 }));
+        atomic_init(&Queue->tail, ((CCConcurrentQueuePointer){ .node = Dummy, .tag = 0 }));
         Queue->gc = GC;
         
         CCMemorySetDestructor(Queue, (CCMemoryDestructorCallback)CCConcurrentQueueDestructor);
@@ -119,7 +120,7 @@ void CCConcurrentQueuePush(CCConcurrentQueue Queue, CCConcurrentQueueNode *Node)
     
     for ( ; ; )
     {
-        CCConcurrentQueuePointer Tail = atomic_load_explicit(&Queue->tail, memory_order_relaxed);
+        CCConcurrentQueuePointer Tail = atomic_load_explicit(&Queue->tail, memory_order_acquire);
         
         atomic_store_explicit(&Node->next, ((CCConcurrentQueuePointer){ .node = Tail.node, .tag = Tail.tag + 1 }), memory_order_relaxed);
         if (atomic_compare_exchange_weak_explicit(&Queue->tail, &Tail, ((CCConcurrentQueuePointer){ .node = Node, .tag = Tail.tag + 1 }), memory_order_release, memory_order_relaxed))
@@ -130,13 +131,16 @@ void CCConcurrentQueuePush(CCConcurrentQueue Queue, CCConcurrentQueueNode *Node)
     }
     
     CCConcurrentGarbageCollectorEnd(Queue->gc);
+    
+    CC_METRICS_COUNTER_ADD("concurrent-queue.push", 1);
+    CC_METRICS_GAUGE_ADD("concurrent-queue.depth", 1);
 }
 
 static void CCConcurrentQueueFixList(CCConcurrentQueue Queue, CCConcurrentQueuePointer Tail, CCConcurrentQueuePointer Head)
 {
     for (CCConcurrentQueuePointer CurNode = Tail; CCConcurrentQueuePointerIsEqual(Head, atomic_load_explicit(&Queue->head, memory_order_relaxed)) && !CCConcurrentQueuePointerIsEqual(CurNode, Head); )
     {
-        CCConcurrentQueuePointer CurNodeNext = atomic_load_explicit(&CurNode.node->next, memory_order_relaxed);
+        CCConcurrentQueuePointer CurNodeNext = atomic_load_explicit(&CurNode.node->next, memory_order_acquire);
         atomic_store_explicit(&CurNodeNext.node->prev, ((CCConcurrentQueuePointer){ .node = CurNode.node, .tag = CurNode.tag - 1 }), memory_order_release);
         
         CurNode = (CCConcurrentQueuePointer){ .node = CurNodeNext.node, .tag = CurNode.tag - 1 };
@@ -151,8 +155,8 @@ CCConcurrentQueueNode *CCConcurrentQueuePop(CCConcurrentQueue Queue)
     
     for ( ; ; )
     {
-        CCConcurrentQueuePointer Head = atomic_load_explicit(&Queue->head, memory_order_relaxed), Tail = atomic_load_explicit(&Queue->tail, memory_order_relaxed);
-        CCConcurrentQueuePointer FirstNodePrev = atomic_load_explicit(&Head.node->prev, memory_order_relaxed);
+        CCConcurrentQueuePointer Head = atomic_load_explicit(&Queue->head, memory_order_acquire), Tail = atomic_load_explicit(&Queue->tail, memory_order_acquire);
+        CCConcurrentQueuePointer FirstNodePrev = atomic_load_explicit(&Head.node->prev, memory_order_acquire);
         
         if (CCConcurrentQueuePointerIsEqual(Head, atomic_load_explicit(&Queue->head, memory_order_acquire)))
         {
@@ -169,6 +173,9 @@ CCConcurrentQueueNode *CCConcurrentQueuePop(CCConcurrentQueue Queue)
                     CCConcurrentGarbageCollectorManage(Queue->gc, Head.node, (CCConcurrentGarbageCollectorReclaimer)CCConcurrentQueueClearNode);
                     CCConcurrentGarbageCollectorEnd(Queue->gc);
                     
+                    CC_METRICS_COUNTER_ADD("concurrent-queue.pop", 1);
+                    CC_METRICS_GAUGE_ADD("concurrent-queue.depth", -1);
+                    
                     return FirstNodePrev.node;
                 }
             }
@@ -1,9 +1,385 @@
-//
-//  ConcurrentTree.c
-//  CommonC
-//
-//  Created by Stefan Johnson on 8/4/18.
-//  Copyright © 2018 Stefan Johnson. All rights reserved.
-//
+/*
+ *  Copyright (c) 2018, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
 
 #include "ConcurrentTree.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#define CC_CONCURRENT_TREE_MAX_LEVEL 32
+
+typedef struct CCConcurrentTreeNode {
+    /*
+     The node is referenced by its inserter and its remover, it may only be reclaimed once both
+     have finished linking and unlinking it.
+     */
+    _Atomic(uint8_t) refCount;
+    uint8_t level;
+    _Atomic(uintptr_t) next[];
+} CCConcurrentTreeNode;
+
+typedef struct CCConcurrentTreeInfo {
+    CCAllocatorType allocator;
+    size_t keySize, valueSize;
+    CCComparator comparator;
+    CCConcurrentGarbageCollector gc;
+    _Atomic(size_t) count;
+    _Atomic(uint64_t) seed;
+    CCConcurrentTreeNode *head;
+} CCConcurrentTreeInfo;
+
+#define CC_CONCURRENT_TREE_MARK (uintptr_t)1
+
+static inline CCConcurrentTreeNode *CCConcurrentTreeGetNode(uintptr_t Link)
+{
+    return (CCConcurrentTreeNode*)(Link & ~CC_CONCURRENT_TREE_MARK);
+}
+
+static inline _Bool CCConcurrentTreeIsMarked(uintptr_t Link)
+{
+    return Link & CC_CONCURRENT_TREE_MARK;
+}
+
+static inline size_t CCConcurrentTreeGetKeyOffset(size_t Level)
+{
+    return sizeof(CCConcurrentTreeNode) + (sizeof(uintptr_t) * Level);
+}
+
+static inline void *CCConcurrentTreeGetKey(CCConcurrentTreeNode *Node)
+{
+    return (void*)Node + CCConcurrentTreeGetKeyOffset(Node->level);
+}
+
+static inline void *CCConcurrentTreeGetValue(CCConcurrentTree Tree, CCConcurrentTreeNode *Node)
+{
+    return CCConcurrentTreeGetKey(Node) + ((Tree->keySize + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1));
+}
+
+static CCConcurrentTreeNode *CCConcurrentTreeCreateNode(CCConcurrentTree Tree, size_t Level)
+{
+    const size_t Size = CCConcurrentTreeGetKeyOffset(Level) + ((Tree->keySize + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1)) + Tree->valueSize;
+    
+    CCConcurrentTreeNode *Node = CCMalloc(Tree->allocator, Size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Node)
+    {
+        atomic_init(&Node->refCount, 2);
+        Node->level = Level;
+        for (size_t Loop = 0; Loop < Level; Loop++) atomic_init(&Node->next[Loop], 0);
+    }
+    
+    return Node;
+}
+
+static void CCConcurrentTreeReleaseNode(CCConcurrentTree Tree, CCConcurrentTreeNode *Node)
+{
+    if (atomic_fetch_sub_explicit(&Node->refCount, 1, memory_order_acq_rel) == 1) CCConcurrentGarbageCollectorManage(Tree->gc, Node, CCFree);
+}
+
+static size_t CCConcurrentTreeRandomLevel(CCConcurrentTree Tree)
+{
+    uint64_t Bits = atomic_fetch_add_explicit(&Tree->seed, 0x9e3779b97f4a7c15, memory_order_relaxed) + 0x9e3779b97f4a7c15;
+    Bits = (Bits ^ (Bits >> 30)) * 0xbf58476d1ce4e5b9;
+    Bits = (Bits ^ (Bits >> 27)) * 0x94d049bb133111eb;
+    Bits ^= Bits >> 31;
+    
+    size_t Level = 1;
+    for ( ; (Bits & 1) && (Level < CC_CONCURRENT_TREE_MAX_LEVEL); Bits >>= 1) Level++;
+    
+    return Level;
+}
+
+static void CCConcurrentTreeDestructor(CCConcurrentTree Tree)
+{
+    for (CCConcurrentTreeNode *Node = Tree->head; Node; )
+    {
+        CCConcurrentTreeNode *Next = CCConcurrentTreeGetNode(atomic_load_explicit(&Node->next[0], memory_order_relaxed));
+        CCFree(Node);
+        Node = Next;
+    }
+    
+    CCConcurrentGarbageCollectorDestroy(Tree->gc);
+}
+
+CCConcurrentTree CCConcurrentTreeCreate(CCAllocatorType Allocator, size_t KeySize, size_t ValueSize, CCComparator KeyComparator, CCConcurrentGarbageCollector GC)
+{
+    CCAssertLog(KeyComparator, "KeyComparator must not be null");
+    CCAssertLog(GC, "GC must not be null");
+    
+    CCConcurrentTree Tree = CCMalloc(Allocator, sizeof(CCConcurrentTreeInfo), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Tree)
+    {
+        *Tree = (CCConcurrentTreeInfo){
+            .allocator = Allocator,
+            .keySize = KeySize,
+            .valueSize = ValueSize,
+            .comparator = KeyComparator,
+            .gc = GC
+        };
+        
+        atomic_init(&Tree->count, 0);
+        atomic_init(&Tree->seed, (uintptr_t)Tree);
+        
+        Tree->head = CCConcurrentTreeCreateNode(Tree, CC_CONCURRENT_TREE_MAX_LEVEL);
+        if (!Tree->head)
+        {
+            CC_LOG_ERROR("Failed to create tree: Failed to allocate memory of size (%zu)", CCConcurrentTreeGetKeyOffset(CC_CONCURRENT_TREE_MAX_LEVEL) + KeySize + ValueSize);
+            CCFree(Tree);
+            CCConcurrentGarbageCollectorDestroy(GC);
+            
+            return NULL;
+        }
+        
+        CCMemorySetDestructor(Tree, (CCMemoryDestructorCallback)CCConcurrentTreeDestructor);
+    }
+    
+    return Tree;
+}
+
+void CCConcurrentTreeDestroy(CCConcurrentTree Tree)
+{
+    CCAssertLog(Tree, "Tree must not be null");
+    
+    CCFree(Tree);
+}
+
+/*
+ Finds the predecessors and successors of the key at each level, unlinking any marked nodes along the way.
+ If Inclusive is set the successors will be the first nodes greater than the key, otherwise they will be the
+ first nodes greater than or equal to the key.
+ */
+static CCConcurrentTreeNode *CCConcurrentTreeSearch(CCConcurrentTree Tree, const void *Key, _Bool Inclusive, CCConcurrentTreeNode **Preds, CCConcurrentTreeNode **Succs)
+{
+    const CCComparisonResult Stop = Inclusive ? CCComparisonResultDescending : CCComparisonResultEqual;
+    
+Retry:;
+    CCConcurrentTreeNode *Pred = Tree->head;
+    for (size_t Level = CC_CONCURRENT_TREE_MAX_LEVEL; Level--; )
+    {
+        CCConcurrentTreeNode *Curr = CCConcurrentTreeGetNode(atomic_load_explicit(&Pred->next[Level], memory_order_acquire));
+        
+        while (Curr)
+        {
+            uintptr_t Succ = atomic_load_explicit(&Curr->next[Level], memory_order_acquire);
+            while (CCConcurrentTreeIsMarked(Succ))
+            {
+                uintptr_t Expected = (uintptr_t)Curr;
+                if (!atomic_compare_exchange_strong_explicit(&Pred->next[Level], &Expected, Succ & ~CC_CONCURRENT_TREE_MARK, memory_order_acq_rel, memory_order_acquire)) goto Retry;
+                
+                Curr = CCConcurrentTreeGetNode(Succ);
+                if (!Curr) break;
+                
+                Succ = atomic_load_explicit(&Curr->next[Level], memory_order_acquire);
+            }
+            
+            if ((!Curr) || (Tree->comparator(CCConcurrentTreeGetKey(Curr), Key) >= Stop)) break;
+            
+            Pred = Curr;
+            Curr = CCConcurrentTreeGetNode(Succ);
+        }
+        
+        if (Preds) Preds[Level] = Pred;
+        if (Succs) Succs[Level] = Curr;
+    }
+    
+    return Succs ? Succs[0] : NULL;
+}
+
+/*
+ Finds the first unmarked node greater than or equal to the key without modifying the tree.
+ */
+static CCConcurrentTreeNode *CCConcurrentTreeLookup(CCConcurrentTree Tree, const void *Key)
+{
+    CCConcurrentTreeNode *Pred = Tree->head, *Curr = NULL;
+    for (size_t Level = CC_CONCURRENT_TREE_MAX_LEVEL; Level--; )
+    {
+        Curr = CCConcurrentTreeGetNode(atomic_load_explicit(&Pred->next[Level], memory_order_acquire));
+        
+        while (Curr)
+        {
+            const uintptr_t Succ = atomic_load_explicit(&Curr->next[Level], memory_order_acquire);
+            if ((!CCConcurrentTreeIsMarked(Succ)) && (Tree->comparator(CCConcurrentTreeGetKey(Curr), Key) >= CCComparisonResultEqual)) break;
+            
+            if (!CCConcurrentTreeIsMarked(Succ)) Pred = Curr;
+            Curr = CCConcurrentTreeGetNode(Succ);
+        }
+    }
+    
+    return Curr;
+}
+
+size_t CCConcurrentTreeGetCount(CCConcurrentTree Tree)
+{
+    CCAssertLog(Tree, "Tree must not be null");
+    
+    return atomic_load_explicit(&Tree->count, memory_order_relaxed);
+}
+
+_Bool CCConcurrentTreeFind(CCConcurrentTree Tree, const void *Key, void *Value)
+{
+    CCAssertLog(Tree, "Tree must not be null");
+    CCAssertLog(Key, "Key must not be null");
+    
+    CCConcurrentGarbageCollectorBegin(Tree->gc);
+    
+    CCConcurrentTreeNode *Node = CCConcurrentTreeLookup(Tree, Key);
+    
+    const _Bool Found = (Node) && (Tree->comparator(CCConcurrentTreeGetKey(Node), Key) == CCComparisonResultEqual);
+    if ((Found) && (Value)) memcpy(Value, CCConcurrentTreeGetValue(Tree, Node), Tree->valueSize);
+    
+    CCConcurrentGarbageCollectorEnd(Tree->gc);
+    
+    return Found;
+}
+
+_Bool CCConcurrentTreeInsert(CCConcurrentTree Tree, const void *Key, const void *Value)
+{
+    CCAssertLog(Tree, "Tree must not be null");
+    CCAssertLog(Key, "Key must not be null");
+    CCAssertLog(Value || !Tree->valueSize, "Value must not be null");
+    
+    CCConcurrentTreeNode *Node = CCConcurrentTreeCreateNode(Tree, CCConcurrentTreeRandomLevel(Tree));
+    if (!Node) return FALSE;
+    
+    memcpy(CCConcurrentTreeGetKey(Node), Key, Tree->keySize);
+    if (Tree->valueSize) memcpy(CCConcurrentTreeGetValue(Tree, Node), Value, Tree->valueSize);
+    
+    CCConcurrentGarbageCollectorBegin(Tree->gc);
+    
+    CCConcurrentTreeNode *Preds[CC_CONCURRENT_TREE_MAX_LEVEL], *Succs[CC_CONCURRENT_TREE_MAX_LEVEL];
+    for ( ; ; )
+    {
+        CCConcurrentTreeNode *Found = CCConcurrentTreeSearch(Tree, Key, FALSE, Preds, Succs);
+        if ((Found) && (Tree->comparator(CCConcurrentTreeGetKey(Found), Key) == CCComparisonResultEqual))
+        {
+            CCConcurrentGarbageCollectorEnd(Tree->gc);
+            CCFree(Node);
+            
+            return FALSE;
+        }
+        
+        for (size_t Loop = 0; Loop < Node->level; Loop++) atomic_store_explicit(&Node->next[Loop], (uintptr_t)Succs[Loop], memory_order_relaxed);
+        
+        uintptr_t Expected = (uintptr_t)Succs[0];
+        if (atomic_compare_exchange_strong_explicit(&Preds[0]->next[0], &Expected, (uintptr_t)Node, memory_order_release, memory_order_relaxed)) break;
+    }
+    
+    atomic_fetch_add_explicit(&Tree->count, 1, memory_order_relaxed);
+    
+    for (size_t Level = 1; Level < Node->level; Level++)
+    {
+        for ( ; ; )
+        {
+            uintptr_t Succ = atomic_load_explicit(&Node->next[Level], memory_order_acquire);
+            if (CCConcurrentTreeIsMarked(Succ)) goto Linked;
+            
+            if ((Succ != (uintptr_t)Succs[Level]) && (!atomic_compare_exchange_strong_explicit(&Node->next[Level], &Succ, (uintptr_t)Succs[Level], memory_order_release, memory_order_relaxed))) goto Linked;
+            
+            uintptr_t Expected = (uintptr_t)Succs[Level];
+            if (atomic_compare_exchange_strong_explicit(&Preds[Level]->next[Level], &Expected, (uintptr_t)Node, memory_order_release, memory_order_relaxed)) break;
+            
+            if (CCConcurrentTreeSearch(Tree, Key, FALSE, Preds, Succs) != Node) goto Linked;
+        }
+    }
+    
+Linked:
+    /*
+     The node may have been removed while it was still being linked, in which case the remover's search may
+     have missed the levels linked afterwards.
+     */
+    if (CCConcurrentTreeIsMarked(atomic_load_explicit(&Node->next[0], memory_order_acquire))) CCConcurrentTreeSearch(Tree, Key, TRUE, NULL, NULL);
+    
+    CCConcurrentTreeReleaseNode(Tree, Node);
+    
+    CCConcurrentGarbageCollectorEnd(Tree->gc);
+    
+    return TRUE;
+}
+
+_Bool CCConcurrentTreeRemove(CCConcurrentTree Tree, const void *Key, void *RemovedValue)
+{
+    CCAssertLog(Tree, "Tree must not be null");
+    CCAssertLog(Key, "Key must not be null");
+    
+    CCConcurrentGarbageCollectorBegin(Tree->gc);
+    
+    _Bool Removed = FALSE;
+    CCConcurrentTreeNode *Node = CCConcurrentTreeLookup(Tree, Key);
+    if ((Node) && (Tree->comparator(CCConcurrentTreeGetKey(Node), Key) == CCComparisonResultEqual))
+    {
+        for (size_t Level = Node->level; --Level; )
+        {
+            uintptr_t Succ = atomic_load_explicit(&Node->next[Level], memory_order_relaxed);
+            while ((!CCConcurrentTreeIsMarked(Succ)) && (!atomic_compare_exchange_weak_explicit(&Node->next[Level], &Succ, Succ | CC_CONCURRENT_TREE_MARK, memory_order_acq_rel, memory_order_relaxed)));
+        }
+        
+        uintptr_t Succ = atomic_load_explicit(&Node->next[0], memory_order_relaxed);
+        while ((!CCConcurrentTreeIsMarked(Succ)) && (!(Removed = atomic_compare_exchange_weak_explicit(&Node->next[0], &Succ, Succ | CC_CONCURRENT_TREE_MARK, memory_order_acq_rel, memory_order_relaxed))));
+        
+        if (Removed)
+        {
+            atomic_fetch_sub_explicit(&Tree->count, 1, memory_order_relaxed);
+            
+            if (RemovedValue) memcpy(RemovedValue, CCConcurrentTreeGetValue(Tree, Node), Tree->valueSize);
+            
+            CCConcurrentTreeSearch(Tree, Key, TRUE, NULL, NULL);
+            CCConcurrentTreeReleaseNode(Tree, Node);
+        }
+    }
+    
+    CCConcurrentGarbageCollectorEnd(Tree->gc);
+    
+    return Removed;
+}
+
+size_t CCConcurrentTreeEnumerateRange(CCConcurrentTree Tree, const void *Min, const void *Max, CCConcurrentTreeEnumerator Enumerator, void *Data)
+{
+    CCAssertLog(Tree, "Tree must not be null");
+    CCAssertLog(Enumerator, "Enumerator must not be null");
+    
+    CCConcurrentGarbageCollectorBegin(Tree->gc);
+    
+    size_t Count = 0;
+    for (CCConcurrentTreeNode *Node = Min ? CCConcurrentTreeLookup(Tree, Min) : CCConcurrentTreeGetNode(atomic_load_explicit(&Tree->head->next[0], memory_order_acquire)); Node; )
+    {
+        const uintptr_t Next = atomic_load_explicit(&Node->next[0], memory_order_acquire);
+        
+        if (!CCConcurrentTreeIsMarked(Next))
+        {
+            const void *Key = CCConcurrentTreeGetKey(Node);
+            if ((Max) && (Tree->comparator(Key, Max) >= CCComparisonResultEqual)) break;
+            
+            Count++;
+            
+            if (!Enumerator(Key, CCConcurrentTreeGetValue(Tree, Node), Data)) break;
+        }
+        
+        Node = CCConcurrentTreeGetNode(Next);
+    }
+    
+    CCConcurrentGarbageCollectorEnd(Tree->gc);
+    
+    return Count;
+}
@@ -1,14 +1,143 @@
-//
-//  ConcurrentTree.h
-//  CommonC
-//
-//  Created by Stefan Johnson on 8/4/18.
-//  Copyright © 2018 Stefan Johnson. All rights reserved.
-//
+/*
+ *  Copyright (c) 2018, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
 
-#ifndef ConcurrentTree_h
-#define ConcurrentTree_h
+#ifndef CommonC_ConcurrentTree_h
+#define CommonC_ConcurrentTree_h
 
-#include <stdio.h>
+/*
+ Lock-free ordered map implemented as a skip list: https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf
+ Nodes are logically removed by marking their links and then physically unlinked by any thread that
+ traverses past them, unlinked nodes are reclaimed by the garbage collector.
+ 
+ Allows for many producer-consumer access.
+ */
 
-#endif /* ConcurrentTree_h */
+#include <CommonC/Base.h>
+#include <CommonC/Ownership.h>
+#include <CommonC/Allocator.h>
+#include <CommonC/Comparator.h>
+#include <CommonC/ConcurrentGarbageCollector.h>
+
+
+/*!
+ * @brief The concurrent tree.
+ * @description Allows @b CCRetain.
+ */
+typedef struct CCConcurrentTreeInfo *CCConcurrentTree;
+
+/*!
+ * @brief The callback used when enumerating the tree.
+ * @param Key The pointer to the key. This is only valid for the duration of the callback.
+ * @param Value The pointer to the value. This is only valid for the duration of the callback.
+ * @param Data The data passed to the enumerate function.
+ * @return Whether the enumeration should continue (TRUE) or stop (FALSE).
+ */
+typedef _Bool (*CCConcurrentTreeEnumerator)(const void *Key, const void *Value, void *Data);
+
+#pragma mark - Creation / Destruction
+/*!
+ * @brief Create a concurrent tree.
+ * @description This tree allows for many producer-consumer access. Keys are kept in the order
+ *              defined by the comparator.
+ *
+ * @param Allocator The allocator to be used for the allocation.
+ * @param KeySize The size of the keys.
+ * @param ValueSize The size of the values.
+ * @param KeyComparator The comparator to be used to order the keys. Must not be NULL.
+ * @param GC The garbage collector to be used in this tree.
+ * @return A tree, or NULL on failure. Must be destroyed to free the memory.
+ */
+CC_NEW CCConcurrentTree CCConcurrentTreeCreate(CCAllocatorType Allocator, size_t KeySize, size_t ValueSize, CCComparator KeyComparator, CCConcurrentGarbageCollector CC_OWN(GC));
+
+/*!
+ * @brief Destroy a tree.
+ * @param Tree The tree to be destroyed.
+ */
+void CCConcurrentTreeDestroy(CCConcurrentTree CC_DESTROY(Tree));
+
+#pragma mark - Insertions/Deletions
+/*!
+ * @brief Insert a key and value into the tree.
+ * @performance This operation is an expected O(log n) lock-free operation.
+ * @param Tree The tree to insert the entry into.
+ * @param Key The pointer to the key to be copied into the tree. This must not be NULL.
+ * @param Value The pointer to the value to be copied into the tree. May be NULL if the value
+ *        size is 0.
+ *
+ * @return Whether or not the entry was inserted. This will fail if the key already exists.
+ */
+_Bool CCConcurrentTreeInsert(CCConcurrentTree Tree, const void *Key, const void *Value);
+
+/*!
+ * @brief Remove the entry for a key from the tree.
+ * @performance This operation is an expected O(log n) lock-free operation.
+ * @param Tree The tree to remove the entry from.
+ * @param Key The pointer to the key of the entry to be removed. This must not be NULL.
+ * @param RemovedValue A pointer to where the value that was removed can be written to. If NULL
+ *        this will be ignored.
+ *
+ * @return Whether or not an entry was removed for the key.
+ */
+_Bool CCConcurrentTreeRemove(CCConcurrentTree Tree, const void *Key, void *RemovedValue);
+
+#pragma mark - Query
+/*!
+ * @brief Get the number of entries in the tree.
+ * @param Tree The tree to get the count of.
+ * @return The number of entries.
+ */
+size_t CCConcurrentTreeGetCount(CCConcurrentTree Tree);
+
+/*!
+ * @brief Find the value for a key in the tree.
+ * @performance This operation is an expected O(log n) lock-free operation.
+ * @param Tree The tree to search.
+ * @param Key The pointer to the key to find. This must not be NULL.
+ * @param Value A pointer to where the value can be written to. If NULL this will be ignored.
+ * @return Whether or not an entry exists for the key.
+ */
+_Bool CCConcurrentTreeFind(CCConcurrentTree Tree, const void *Key, void *Value);
+
+#pragma mark - Enumeration
+/*!
+ * @brief Enumerate the entries of the tree in ascending key order.
+ * @description Entries inserted or removed during the enumeration may or may not be visited.
+ * @performance This operation is an expected O(log n + m) lock-free operation, where m is the
+ *              number of entries in the range.
+ *
+ * @param Tree The tree to enumerate.
+ * @param Min The pointer to the lowest key (inclusive) to be enumerated. If NULL the enumeration
+ *        will start at the first entry.
+ *
+ * @param Max The pointer to the key (exclusive) the enumeration should stop at. If NULL the
+ *        enumeration will continue until the last entry.
+ *
+ * @param Enumerator The callback to be called for each entry. This must not be NULL.
+ * @param Data The data to be passed to the enumerator.
+ * @return The number of entries that were enumerated.
+ */
+size_t CCConcurrentTreeEnumerateRange(CCConcurrentTree Tree, const void *Min, const void *Max, CCConcurrentTreeEnumerator Enumerator, void *Data);
+
+#endif
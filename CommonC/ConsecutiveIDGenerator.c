@@ -26,49 +26,39 @@
 #include "ConsecutiveIDGenerator.h"
 #include "MemoryAllocation.h"
 #include "Assertion.h"
+#include "BitTricks.h"
 #include <stdatomic.h>
 
 /*
- CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE enforces standard compliant usage of atomic types. This however will
- result in no batched operations.
+ IDs are tracked by a bitmap where a set bit is an assigned ID. Above it sits a hierarchy of summary bitmaps, where
+ a set bit in a summary word indicates the corresponding word in the level below it is full. Assigning descends the
+ hierarchy to find a word with a free bit, so only O(log64 n) words need to be visited.
+ 
+ The summary levels are only hints, an assigner that finds a full word through a stale summary bit will repair the
+ summary and retry. When marking a word as full the word is checked again afterwards, in case it was concurrently
+ recycled, so a free ID can never remain hidden behind a summary bit.
  */
-#ifndef CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-#define CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE 0
-#endif
-
-#if !CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-#if !CC_HARDWARE_PTR_64 && !CC_HARDWARE_PTR_32
-#undef CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-#define CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE 1
-#endif
-#endif
+#define CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS 64
+#define CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT 6
+#define CC_CONSECUTIVE_ID_GENERATOR_MAX_LEVEL 11
 
 typedef struct {
     size_t size;
-#if CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-    atomic_flag pool[];
-#else
-    _Atomic(uint8_t) pool[];
-#endif
+    size_t levelCount;
+    size_t offset[CC_CONSECUTIVE_ID_GENERATOR_MAX_LEVEL];
+    _Atomic(uint64_t) words[];
 } CCConsecutiveIDGeneratorInternal;
 
-#if !CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-#if CC_HARDWARE_PTR_64
-typedef uint64_t CCConsecutiveIDGeneratorSample;
-#define CC_CONCURRENT_ID_POOL_SAMPLE_MAX UINT64_MAX
-#else
-typedef uint32_t CCConsecutiveIDGeneratorSample;
-#define CC_CONCURRENT_ID_POOL_SAMPLE_MAX UINT32_MAX
-#endif
-#endif
-
-#if !CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-#if CC_HARDWARE_PTR_64
-_Static_assert(sizeof(_Atomic(CCConsecutiveIDGeneratorSample)) == 8, "Native types are not atomic, please set CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE");
-#elif CC_HARDWARE_PTR_32
-_Static_assert(sizeof(_Atomic(CCConsecutiveIDGeneratorSample)) == 4, "Native types are not atomic, please set CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE");
-#endif
-#endif
+/*
+ The hint is shared across all generators used by a thread, it is the ID after the last ID the thread had assigned.
+ New threads are given hints spread across the bitmap so they start on different cache lines.
+ */
+static _Thread_local struct {
+    uintptr_t next;
+    _Bool set;
+} CCConsecutiveIDGeneratorHint = { .next = 0, .set = FALSE };
+
+static _Atomic(uintptr_t) CCConsecutiveIDGeneratorHintSeed = ATOMIC_VAR_INIT(0);
 
 
 static void *CCConsecutiveIDGeneratorConstructor(CCAllocatorType Allocator, size_t Count);
@@ -88,24 +78,48 @@ const CCConcurrentIDGeneratorInterface CCConsecutiveIDGeneratorInterface = {
 
 const CCConcurrentIDGeneratorInterface * const CCConsecutiveIDGenerator = &CCConsecutiveIDGeneratorInterface;
 
+static inline size_t CCConsecutiveIDGeneratorGetWordCount(size_t BitCount)
+{
+    return (BitCount + (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1)) >> CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT;
+}
+
+static inline _Atomic(uint64_t) *CCConsecutiveIDGeneratorGetWord(CCConsecutiveIDGeneratorInternal *IDPool, size_t Level, size_t Index)
+{
+    return &IDPool->words[IDPool->offset[Level] + Index];
+}
+
 void *CCConsecutiveIDGeneratorConstructor(CCAllocatorType Allocator, size_t PoolSize)
 {
-    CCConsecutiveIDGeneratorInternal *IDPool;
-#if CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-    const size_t PaddedPoolCount = PoolSize;
-#else
-    const size_t PaddedPoolCount = ((((PoolSize - 1) / (sizeof(CCConsecutiveIDGeneratorSample) / sizeof(typeof(IDPool->pool[0])))) + 1) * (sizeof(CCConsecutiveIDGeneratorSample) / sizeof(typeof(IDPool->pool[0]))));
-#endif
-    IDPool = CCMalloc(Allocator, sizeof(CCConsecutiveIDGeneratorInternal) + (PaddedPoolCount * sizeof(typeof(IDPool->pool[0]))), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    size_t WordCount = 0, LevelCount = 0;
+    for (size_t BitCount = PoolSize; ; BitCount = CCConsecutiveIDGeneratorGetWordCount(BitCount))
+    {
+        WordCount += CCConsecutiveIDGeneratorGetWordCount(BitCount);
+        LevelCount++;
+        
+        if (BitCount <= CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS) break;
+    }
+    
+    CCConsecutiveIDGeneratorInternal *IDPool = CCMalloc(Allocator, sizeof(CCConsecutiveIDGeneratorInternal) + (WordCount * sizeof(typeof(IDPool->words[0]))), NULL, CC_DEFAULT_ERROR_CALLBACK);
     if (IDPool)
     {
         IDPool->size = PoolSize;
-#if CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-        for (size_t Loop = 0; Loop < PoolSize; Loop++) atomic_flag_clear_explicit(&IDPool->pool[Loop], memory_order_relaxed);
-#else
-        for (size_t Loop = 0; Loop < PoolSize; Loop++) atomic_init(&IDPool->pool[Loop], 0);
-        for (size_t Loop = PoolSize, PadCount = PaddedPoolCount; Loop < PadCount; Loop++) atomic_init(&IDPool->pool[Loop], UINT8_MAX);
-#endif
+        IDPool->levelCount = LevelCount;
+        
+        for (size_t Level = 0, Offset = 0, BitCount = PoolSize; Level < LevelCount; Level++)
+        {
+            const size_t Count = CCConsecutiveIDGeneratorGetWordCount(BitCount);
+            
+            IDPool->offset[Level] = Offset;
+            
+            /*
+             Bits past the end of a level can never be assigned, so they're permanently marked as taken.
+             */
+            for (size_t Loop = 0; Loop < Count; Loop++) atomic_init(&IDPool->words[Offset + Loop], 0);
+            if (BitCount & (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1)) atomic_init(&IDPool->words[Offset + Count - 1], ~CCBitSet(BitCount & (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1)));
+            
+            Offset += Count;
+            BitCount = Count;
+        }
     }
     
     return IDPool;
@@ -116,51 +130,96 @@ void CCConsecutiveIDGeneratorDestructor(CCConsecutiveIDGeneratorInternal *IDPool
     CCFree(IDPool);
 }
 
-_Bool CCConsecutiveIDGeneratorTryAssign(CCConsecutiveIDGeneratorInternal *IDPool, uintptr_t *ID)
+static void CCConsecutiveIDGeneratorMarkAvailable(CCConsecutiveIDGeneratorInternal *IDPool, size_t Level, size_t Index)
+{
+    for ( ; ++Level < IDPool->levelCount; Index >>= CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT)
+    {
+        const uint64_t Bit = (uint64_t)1 << (Index & (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1));
+        if (atomic_fetch_and(CCConsecutiveIDGeneratorGetWord(IDPool, Level, Index >> CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT), ~Bit) != UINT64_MAX) break;
+    }
+}
+
+static void CCConsecutiveIDGeneratorMarkFull(CCConsecutiveIDGeneratorInternal *IDPool, size_t Level, size_t Index)
 {
-#if CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-    for (size_t Loop = 0, Count = IDPool->size; Loop < Count; Loop++)
+    for ( ; Level + 1 < IDPool->levelCount; Level++, Index >>= CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT)
     {
-        if (!atomic_flag_test_and_set_explicit(&IDPool->pool[Loop], memory_order_relaxed))
+        const uint64_t Bit = (uint64_t)1 << (Index & (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1));
+        const uint64_t Summary = atomic_fetch_or(CCConsecutiveIDGeneratorGetWord(IDPool, Level + 1, Index >> CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT), Bit);
+        
+        if (atomic_load(CCConsecutiveIDGeneratorGetWord(IDPool, Level, Index)) != UINT64_MAX)
         {
-            *ID = Loop;
-            atomic_thread_fence(memory_order_acquire);
-            return TRUE;
+            CCConsecutiveIDGeneratorMarkAvailable(IDPool, Level, Index);
+            break;
         }
+        
+        if ((Summary | Bit) != UINT64_MAX) break;
+    }
+}
+
+static inline size_t CCConsecutiveIDGeneratorFindFree(uint64_t Word, size_t Start)
+{
+    const uint64_t Free = ~Word, Ahead = Free & (UINT64_MAX << Start);
+    
+    return CCBitCountTrailingZeros(Ahead ? Ahead : Free);
+}
+
+_Bool CCConsecutiveIDGeneratorTryAssign(CCConsecutiveIDGeneratorInternal *IDPool, uintptr_t *ID)
+{
+    if (!CCConsecutiveIDGeneratorHint.set)
+    {
+        CCConsecutiveIDGeneratorHint.next = atomic_fetch_add_explicit(&CCConsecutiveIDGeneratorHintSeed, (uintptr_t)0x9e3779b97f4a7c15, memory_order_relaxed);
+        CCConsecutiveIDGeneratorHint.set = TRUE;
     }
-#else
-    for (size_t Loop = 0, Count = IDPool->size; Loop < Count; Loop += (sizeof(CCConsecutiveIDGeneratorSample) / sizeof(typeof(IDPool->pool[0]))))
+    
+    const size_t Hint = CCConsecutiveIDGeneratorHint.next % IDPool->size;
+    
+    for ( ; ; )
     {
-        CCConsecutiveIDGeneratorSample Sample = atomic_load_explicit((_Atomic(CCConsecutiveIDGeneratorSample)*)&IDPool->pool[Loop], memory_order_relaxed);
-        if (Sample != CC_CONCURRENT_ID_POOL_SAMPLE_MAX)
+        size_t Index = 0;
+        for (size_t Level = IDPool->levelCount; Level--; )
         {
-            for (size_t Loop2 = Loop, SampleCount = Loop + (sizeof(CCConsecutiveIDGeneratorSample) / sizeof(typeof(IDPool->pool[0]))); Loop2 < SampleCount; Loop2++)
+            const uint64_t Word = atomic_load_explicit(CCConsecutiveIDGeneratorGetWord(IDPool, Level, Index), memory_order_relaxed);
+            if (Word == UINT64_MAX)
+            {
+                if (Level + 1 == IDPool->levelCount) return FALSE;
+                
+                CCConsecutiveIDGeneratorMarkFull(IDPool, Level, Index);
+                break;
+            }
+            
+            const size_t Bit = CCConsecutiveIDGeneratorFindFree(Word, (Hint >> (Level * CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT)) & (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1));
+            
+            if (Level)
             {
-                if (atomic_exchange_explicit(&IDPool->pool[Loop2], UINT8_MAX, memory_order_relaxed) == 0)
-                {
-                    *ID = Loop2;
-                    atomic_thread_fence(memory_order_acquire);
-                    return TRUE;
-                }
+                Index = (Index << CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT) + Bit;
+                continue;
             }
+            
+            const uint64_t Mask = (uint64_t)1 << Bit;
+            const uint64_t Prev = atomic_fetch_or_explicit(CCConsecutiveIDGeneratorGetWord(IDPool, 0, Index), Mask, memory_order_acquire);
+            if (Prev & Mask) break;
+            
+            if ((Prev | Mask) == UINT64_MAX) CCConsecutiveIDGeneratorMarkFull(IDPool, 0, Index);
+            
+            *ID = (Index << CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT) + Bit;
+            CCConsecutiveIDGeneratorHint.next = *ID + 1;
+            
+            return TRUE;
         }
     }
-#endif
-    
-    return FALSE;
 }
 
 void CCConsecutiveIDGeneratorRecycle(CCConsecutiveIDGeneratorInternal *IDPool, uintptr_t ID)
 {
     CCAssertLog(ID < IDPool->size, "ID must have been assigned from this pool");
     
-#if CC_CONSECUTIVE_ID_GENERATOR_STRICT_COMPLIANCE
-    CCAssertLog(atomic_flag_test_and_set_explicit(&IDPool->pool[ID], memory_order_relaxed), "ID must be assigned");
-    atomic_flag_clear_explicit(&IDPool->pool[ID], memory_order_release);
-#else
-    CCAssertLog(atomic_load_explicit(&IDPool->pool[ID], memory_order_relaxed), "ID must be assigned");
-    atomic_store_explicit(&IDPool->pool[ID], 0, memory_order_release);
-#endif
+    const size_t Index = ID >> CC_CONSECUTIVE_ID_GENERATOR_WORD_SHIFT;
+    const uint64_t Mask = (uint64_t)1 << (ID & (CC_CONSECUTIVE_ID_GENERATOR_WORD_BITS - 1));
+    const uint64_t Prev = atomic_fetch_and_explicit(CCConsecutiveIDGeneratorGetWord(IDPool, 0, Index), ~Mask, memory_order_release);
+    
+    CCAssertLog(Prev & Mask, "ID must be assigned");
+    
+    if (Prev == UINT64_MAX) CCConsecutiveIDGeneratorMarkAvailable(IDPool, 0, Index);
 }
 
 size_t CCConsecutiveIDGeneratorGetMaxID(CCConsecutiveIDGeneratorInternal *IDPool)
@@ -31,11 +31,13 @@
  * Those accessors can then retrieve or recycle as frequently or infrequently
  * as they want.
  *
+ * IDs are tracked by a bitmap with a hierarchy of summary bitmaps above it, and each thread
+ * starts searching from after the last ID it was assigned. So threads tend to work on different
+ * parts of the bitmap, and retrieval time only grows logarithmically with the size of the pool.
+ *
  * This ID creation pattern is not suited for small pools where IDs are not recycled frequently,
  * but lots of threads are attempting to retrieve an ID, as this will result in many threads
- * being starved. Nor is it suited for situations where a large number of IDs needs to be
- * distributed, as this will result in retrieval time taking too long (if those IDs are not being
- * recycled frequently enough).
+ * being starved.
  *
  * Allows for many producer-consumer access.
  */
@@ -49,8 +51,9 @@
  * @description The base ID will start at 0 and go up to (Count - 1). Due to this if the
  *              Count = 2^8 then the ID will be one that can fit within an uint8_t.
  *
- * @performance Assigning is lock-free and has a worst case of O(n + n/8). While recycling
- *              is a wait-free O(1) operation.
+ * @performance Assigning is lock-free and visits O(log64 n) words. While recycling is a lock-free
+ *              operation that is O(1) unless the recycled ID's word was full, in which case it is
+ *              O(log64 n).
  */
 extern const CCConcurrentIDGeneratorInterface * const CCConsecutiveIDGenerator;
 
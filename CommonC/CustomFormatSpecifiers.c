@@ -26,6 +26,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <wchar.h>
+#include <stdarg.h>
 #include "CustomFormatSpecifiers.h"
 #include "BitTricks.h"
 #include "MemoryAllocation.h"
@@ -29,14 +29,141 @@
 #include "Assertion.h"
 #include "Hash.h"
 #include "Types.h"
+#include "BitTricks.h"
 #include <string.h>
 
 static void CCDataDestructor(CCData Data)
 {
     if (Data->destructor) Data->destructor(Data);
     Data->interface->destroy(Data->internal);
+    
+    CC_SAFE_Free(Data->chunks.hashes);
+}
+
+#pragma mark - Chunked Hashing
+
+static void CCDataMarkModified(CCData Data, ptrdiff_t Offset, size_t Size)
+{
+    if ((Data->mutated) || (!Size)) return;
+    
+    if (!Data->chunks.hashes)
+    {
+        Data->mutated = TRUE;
+        return;
+    }
+    
+    for (size_t Loop = Offset / CC_DATA_HASH_CHUNK_SIZE, Last = (Offset + Size - 1) / CC_DATA_HASH_CHUNK_SIZE; Loop <= Last; Loop++)
+    {
+        Data->chunks.dirty[Loop / 64] |= UINT64_C(1) << (Loop % 64);
+    }
+    
+    Data->chunks.modified = TRUE;
+}
+
+static void CCDataHashChunks(CCData Data, size_t Index, size_t Count, size_t Size)
+{
+    //Chunks are hashed from windows of the preferred map size, as mapping each chunk separately is costly for file backed data
+    const size_t PreferredMapSize = CCDataGetPreferredMapSize(Data);
+    const size_t WindowCount = PreferredMapSize > CC_DATA_HASH_CHUNK_SIZE ? PreferredMapSize / CC_DATA_HASH_CHUNK_SIZE : 1;
+    
+    for (const size_t End = Index + Count; Index < End; )
+    {
+        const size_t Offset = Index * CC_DATA_HASH_CHUNK_SIZE;
+        const size_t Chunks = (End - Index) < WindowCount ? (End - Index) : WindowCount;
+        const size_t WindowSize = (Size - Offset) < (Chunks * CC_DATA_HASH_CHUNK_SIZE) ? (Size - Offset) : (Chunks * CC_DATA_HASH_CHUNK_SIZE);
+        
+        CCBufferMap Map = CCDataMapBuffer(Data, Offset, WindowSize, CCDataHintRead);
+        
+        for (size_t Loop = 0; Loop < Chunks; Loop++, Index++)
+        {
+            const size_t ChunkOffset = Loop * CC_DATA_HASH_CHUNK_SIZE;
+            size_t ChunkSize = (WindowSize - ChunkOffset) < CC_DATA_HASH_CHUNK_SIZE ? (WindowSize - ChunkOffset) : CC_DATA_HASH_CHUNK_SIZE;
+            
+            if ((ChunkOffset + ChunkSize) > Map.size)
+            {
+                //Remap from any chunk the window did not fully cover, unless it is the first
+                if (Loop) break;
+                
+                ChunkSize = Map.size;
+            }
+            
+            const uint32_t Hash = CCHashMurmur32Buffer(Map.ptr + ChunkOffset, ChunkSize, (uint32_t)Index);
+            
+            Data->chunks.sum += Hash - Data->chunks.hashes[Index];
+            Data->chunks.hashes[Index] = Hash;
+        }
+        
+        CCDataUnmapBuffer(Data, Map);
+    }
+}
+
+static uint32_t CCDataHashChunksCombine(CCData Data)
+{
+    //Chunk hashes are seeded by their index so the sum is order dependent, and can be updated per chunk
+    uint32_t Hash = Data->chunks.sum ^ (uint32_t)Data->chunks.count;
+    Hash ^= (Hash >> 16);
+    Hash *= 0x85ebca6b;
+    Hash ^= (Hash >> 13);
+    Hash *= 0xc2b2ae35;
+    Hash ^= (Hash >> 16);
+    
+    return Hash;
 }
 
+static _Bool CCDataHashChunksRebuild(CCData Data, size_t Size)
+{
+    const size_t Count = (Size + CC_DATA_HASH_CHUNK_SIZE - 1) / CC_DATA_HASH_CHUNK_SIZE;
+    const size_t DirtyOffset = ((Count * sizeof(uint32_t)) + (sizeof(uint64_t) - 1)) & ~(sizeof(uint64_t) - 1);
+    const size_t DirtyCount = (Count + 63) / 64;
+    
+    if (Data->chunks.count != Count)
+    {
+        CC_SAFE_Free(Data->chunks.hashes);
+        Data->chunks.count = 0;
+        
+        uint32_t *Hashes = CCMalloc(Data->allocator, DirtyOffset + (DirtyCount * sizeof(uint64_t)), NULL, CC_DEFAULT_ERROR_CALLBACK);
+        if (!Hashes) return FALSE;
+        
+        Data->chunks.hashes = Hashes;
+        Data->chunks.dirty = (void*)Hashes + DirtyOffset;
+        Data->chunks.count = Count;
+    }
+    
+    memset(Data->chunks.hashes, 0, Count * sizeof(uint32_t));
+    memset(Data->chunks.dirty, 0, DirtyCount * sizeof(uint64_t));
+    
+    Data->chunks.sum = 0;
+    CCDataHashChunks(Data, 0, Count, Size);
+    
+    Data->chunks.modified = FALSE;
+    
+    return TRUE;
+}
+
+static void CCDataHashChunksUpdate(CCData Data)
+{
+    const size_t Size = CCDataGetSize(Data);
+    for (size_t Loop = 0, Count = (Data->chunks.count + 63) / 64; Loop < Count; Loop++)
+    {
+        for (uint64_t Dirty = Data->chunks.dirty[Loop]; Dirty; )
+        {
+            //Hash each run of dirty chunks together
+            const size_t Start = (size_t)CCBitCountTrailingZeros(Dirty);
+            const size_t Run = (size_t)CCBitCountTrailingZeros(~(Dirty >> Start));
+            
+            CCDataHashChunks(Data, (Loop * 64) + Start, Run, Size);
+            
+            Dirty &= ~CCBitSet(Start + Run);
+        }
+        
+        Data->chunks.dirty[Loop] = 0;
+    }
+    
+    Data->chunks.modified = FALSE;
+}
+
+#pragma mark -
+
 CCData CCDataCreate(CCAllocatorType Allocator, CCDataHint Hint, void *InitData, CCDataBufferHash Hash, CCDataBufferDestructor Destructor, const CCDataInterface *Interface)
 {
     CCAssertLog(Interface, "Interface must not be null");
@@ -102,7 +229,13 @@ _Bool CCDataSetSize(CCData Data, size_t Size)
 {
     CCAssertLog(Data, "Data must not be null");
     
-    return Data->interface->optional.resize ? Data->interface->optional.resize(Data->internal, Size) : FALSE;
+    if ((Data->interface->optional.resize) && (Data->interface->optional.resize(Data->internal, Size)))
+    {
+        Data->mutated = TRUE;
+        return TRUE;
+    }
+    
+    return FALSE;
 }
 
 uint32_t CCDataGetHash(CCData Data)
@@ -113,11 +246,28 @@ uint32_t CCDataGetHash(CCData Data)
     {
         if (Data->hasher) Data->hash = Data->hasher(Data);
         else if (Data->interface->optional.hash) Data->hash = Data->interface->optional.hash(Data->internal);
-        else Data->hash = CCHashMurmur32(Data);
+        else
+        {
+            const size_t Size = CCDataGetSize(Data);
+            if ((Size > CC_DATA_HASH_CHUNK_SIZE) && (CCDataHashChunksRebuild(Data, Size))) Data->hash = CCDataHashChunksCombine(Data);
+            else
+            {
+                CC_SAFE_Free(Data->chunks.hashes);
+                Data->chunks.count = 0;
+                
+                Data->hash = CCHashMurmur32(Data);
+            }
+        }
         
         Data->mutated = FALSE;
     }
     
+    else if (Data->chunks.modified)
+    {
+        CCDataHashChunksUpdate(Data);
+        Data->hash = CCDataHashChunksCombine(Data);
+    }
+    
     return Data->hash;
 }
 
@@ -158,7 +308,7 @@ void CCDataModifiedRange(CCData Data, ptrdiff_t Offset, size_t Size)
     CCAssertLog(CCDataGetHints(Data) & CCDataHintWrite, "Must have write access");
     
     if (Data->interface->optional.modifiedBuffer) Data->interface->optional.modifiedBuffer(Data->internal, Offset, Size);
-    Data->mutated = TRUE;
+    CCDataMarkModified(Data, Offset, Size);
 }
 
 CCBufferMap CCDataMapBuffer(CCData Data, ptrdiff_t Offset, size_t Size, CCDataHint Access)
@@ -176,7 +326,7 @@ void CCDataUnmapBuffer(CCData Data, CCBufferMap MappedBuffer)
     CCAssertLog(Data, "Data must not be null");
     
     Data->interface->unmap(Data->internal, MappedBuffer);
-    Data->mutated = TRUE;
+    if (MappedBuffer.hint & CCDataHintWrite) CCDataMarkModified(Data, MappedBuffer.offset, MappedBuffer.size);
 }
 
 size_t CCDataReadBuffer(CCData Data, ptrdiff_t Offset, size_t Size, void *Buffer)
@@ -238,7 +388,7 @@ size_t CCDataWriteBuffer(CCData Data, ptrdiff_t Offset, size_t Size, const void
         Written += Map.size;
     }
     
-    Data->mutated = TRUE;
+    CCDataMarkModified(Data, Offset, Written);
     
     return Written;
 }
@@ -277,7 +427,7 @@ size_t CCDataCopyBuffer(CCData SrcData, ptrdiff_t SrcOffset, size_t Size, CCData
         Copied += DstMap.size;
     }
     
-    DstData->mutated = TRUE;
+    CCDataMarkModified(DstData, DstOffset, Copied);
     
     return Copied;
 }
@@ -310,7 +460,7 @@ size_t CCDataFillBuffer(CCData Data, ptrdiff_t Offset, size_t Size, uint8_t Fill
         Filled += Map.size;
     }
     
-    Data->mutated = TRUE;
+    CCDataMarkModified(Data, Offset, Filled);
     
     return Filled;
 }
@@ -32,6 +32,10 @@
 #include <CommonC/DataInterface.h>
 #include <CommonC/Buffer.h>
 
+#ifndef CC_DATA_HASH_CHUNK_SIZE
+#define CC_DATA_HASH_CHUNK_SIZE (64 * 1024)
+#endif
+
 
 /*!
  * @brief A callback to handle custom destruction of a data buffer.
@@ -54,6 +58,13 @@ typedef struct CCDataInfo {
     uint32_t hash;
     void *internal;
     _Bool mutated;
+    struct {
+        uint32_t *hashes;
+        uint64_t *dirty;
+        size_t count;
+        uint32_t sum;
+        _Bool modified;
+    } chunks;
 } CCDataInfo;
 
 #pragma mark - Creation/Destruction
@@ -110,6 +121,14 @@ _Bool CCDataSetSize(CCData Data, size_t Size);
 
 /*!
  * @brief Get the hash of the data container.
+ * @description The hash is cached until the data is modified. When no custom hashing function is
+ *              provided, data larger than @b CC_DATA_HASH_CHUNK_SIZE is hashed in chunks that are
+ *              combined, so only the chunks that have been modified since the last call need to
+ *              be rehashed.
+ *
+ * @performance O(1) if unmodified since the last call, O(n) where n is the size of the modified
+ *              chunks when chunked, otherwise O(n) where n is the size of the data.
+ *
  * @param Data The data container to retrieve the hash for.
  * @return The hash of the data.
  */
@@ -0,0 +1,314 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "DataComposite.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "Logging.h"
+
+
+typedef struct {
+    CCAllocatorType allocator;
+    CCDataHint hint;
+    size_t size;
+    size_t count;
+    CCDataCompositeRange *ranges;
+    size_t *starts;
+} CCDataCompositeInternal;
+
+
+static void *CCDataCompositeConstructor(CCAllocatorType Allocator, CCDataHint Hint, CCDataCompositeInit *Data);
+static void CCDataCompositeDestroy(CCDataCompositeInternal *Internal);
+static CCDataHint CCDataCompositeGetHint(CCDataCompositeInternal *Internal);
+static size_t CCDataCompositeSize(CCDataCompositeInternal *Internal);
+static CCBufferMap CCDataCompositeMapBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, CCDataHint Access);
+static void CCDataCompositeUnmapBuffer(CCDataCompositeInternal *Internal, CCBufferMap MappedBuffer);
+static void CCDataCompositeSync(CCDataCompositeInternal *Internal);
+static void CCDataCompositePurge(CCDataCompositeInternal *Internal);
+static size_t CCDataCompositeReadBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, void *Buffer);
+static size_t CCDataCompositeWriteBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, const void *Buffer);
+static size_t CCDataCompositeFillBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, uint8_t Fill);
+
+const CCDataInterface CCDataCompositeInterface = {
+    .create = (CCDataConstructorCallback)CCDataCompositeConstructor,
+    .destroy = (CCDataDestructorCallback)CCDataCompositeDestroy,
+    .hints = (CCDataGetHintCallback)CCDataCompositeGetHint,
+    .size = (CCDataGetSizeCallback)CCDataCompositeSize,
+    .map = (CCDataMapBufferCallback)CCDataCompositeMapBuffer,
+    .unmap = (CCDataUnmapBufferCallback)CCDataCompositeUnmapBuffer,
+    .optional = {
+        .sync = (CCDataSyncCallback)CCDataCompositeSync,
+        .purge = (CCDataPurgeCallback)CCDataCompositePurge,
+        .read = (CCDataReadBufferCallback)CCDataCompositeReadBuffer,
+        .write = (CCDataWriteBufferCallback)CCDataCompositeWriteBuffer,
+        .fill = (CCDataFillBufferCallback)CCDataCompositeFillBuffer
+    }
+};
+
+const CCDataInterface * const CCDataComposite = &CCDataCompositeInterface;
+
+CCData CCDataCompositeCreate(CCAllocatorType Allocator, CCDataHint Hint, const CCDataCompositeRange *Ranges, size_t Count, CCDataBufferHash Hash, CCDataBufferDestructor Destructor)
+{
+    return CCDataCreate(Allocator, Hint, &(CCDataCompositeInit){ .ranges = Ranges, .count = Count }, Hash, Destructor, CCDataComposite);
+}
+
+static void *CCDataCompositeConstructor(CCAllocatorType Allocator, CCDataHint Hint, CCDataCompositeInit *Data)
+{
+    CCAssertLog(Data, "Init data cannot be null");
+    CCAssertLog(Data->ranges || !Data->count, "Ranges cannot be null");
+    CCAssertLog(!(Hint & CCDataHintResize), "Resizing is not supported");
+    
+    CCDataCompositeInternal *Internal = CCMalloc(Allocator, sizeof(CCDataCompositeInternal) + ((sizeof(CCDataCompositeRange) + sizeof(size_t)) * Data->count), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Internal)
+    {
+        *Internal = (CCDataCompositeInternal){
+            .allocator = Allocator,
+            .hint = Hint,
+            .size = 0,
+            .count = 0,
+            .ranges = (void*)Internal + sizeof(CCDataCompositeInternal),
+            .starts = (void*)Internal + sizeof(CCDataCompositeInternal) + (sizeof(CCDataCompositeRange) * Data->count)
+        };
+        
+        for (size_t Loop = 0; Loop < Data->count; Loop++)
+        {
+            const CCDataCompositeRange *Range = &Data->ranges[Loop];
+            
+            CCAssertLog(Range->data, "Range data cannot be null");
+            CCAssertLog((Range->offset + Range->size) <= CCDataGetSize(Range->data), "Range must not exceed the bounds of its data");
+            CCAssertLog(!(Hint & CCDataHintRead) || (CCDataGetHints(Range->data) & CCDataHintRead), "Range data must have read access");
+            CCAssertLog(!(Hint & CCDataHintWrite) || (CCDataGetHints(Range->data) & CCDataHintWrite), "Range data must have write access");
+            
+            if (Range->size)
+            {
+                Internal->ranges[Internal->count] = (CCDataCompositeRange){
+                    .data = CCRetain(Range->data),
+                    .offset = Range->offset,
+                    .size = Range->size
+                };
+                Internal->starts[Internal->count++] = Internal->size;
+                Internal->size += Range->size;
+            }
+        }
+    }
+    
+    return Internal;
+}
+
+static void CCDataCompositeDestroy(CCDataCompositeInternal *Internal)
+{
+    for (size_t Loop = 0; Loop < Internal->count; Loop++) CCDataDestroy(Internal->ranges[Loop].data);
+    
+    CCFree(Internal);
+}
+
+static CCDataHint CCDataCompositeGetHint(CCDataCompositeInternal *Internal)
+{
+    return Internal->hint;
+}
+
+static size_t CCDataCompositeSize(CCDataCompositeInternal *Internal)
+{
+    return Internal->size;
+}
+
+static size_t CCDataCompositeFindRange(CCDataCompositeInternal *Internal, size_t Offset)
+{
+    size_t Min = 0, Max = Internal->count;
+    while ((Max - Min) > 1)
+    {
+        const size_t Mid = (Min + Max) / 2;
+        if (Internal->starts[Mid] <= Offset) Min = Mid;
+        else Max = Mid;
+    }
+    
+    return Min;
+}
+
+static CCBufferMap CCDataCompositeMapBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, CCDataHint Access)
+{
+    if (!Size) return (CCBufferMap){ .ptr = NULL, .offset = Offset, .size = 0, .hint = Access };
+    
+    const size_t Index = CCDataCompositeFindRange(Internal, Offset);
+    const CCDataCompositeRange *Range = &Internal->ranges[Index];
+    const size_t Local = Offset - Internal->starts[Index];
+    
+    if ((Local + Size) <= Range->size)
+    {
+        CCBufferMap Map = CCDataMapBuffer(Range->data, Range->offset + Local, Size, Access);
+        
+        return (CCBufferMap){ .ptr = Map.ptr, .offset = Offset, .size = Map.size, .hint = Access };
+    }
+    
+    void *Buffer = CCMalloc(Internal->allocator, Size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Buffer)
+    {
+        CC_LOG_ERROR("Failed to map composite region (%td:%zu) due to allocation failure", Offset, Size);
+        return (CCBufferMap){ .ptr = NULL, .offset = Offset, .size = 0, .hint = Access };
+    }
+    
+    if (Access & CCDataHintRead) CCDataCompositeReadBuffer(Internal, Offset, Size, Buffer);
+    
+    return (CCBufferMap){ .ptr = Buffer, .offset = Offset, .size = Size, .hint = Access };
+}
+
+static void CCDataCompositeUnmapBuffer(CCDataCompositeInternal *Internal, CCBufferMap MappedBuffer)
+{
+    if (!MappedBuffer.size) return;
+    
+    const size_t Index = CCDataCompositeFindRange(Internal, MappedBuffer.offset);
+    const CCDataCompositeRange *Range = &Internal->ranges[Index];
+    const size_t Local = MappedBuffer.offset - Internal->starts[Index];
+    
+    if ((Local + MappedBuffer.size) <= Range->size)
+    {
+        CCDataUnmapBuffer(Range->data, (CCBufferMap){ .ptr = MappedBuffer.ptr, .offset = Range->offset + Local, .size = MappedBuffer.size, .hint = MappedBuffer.hint });
+    }
+    
+    else
+    {
+        if (MappedBuffer.hint & CCDataHintWrite) CCDataCompositeWriteBuffer(Internal, MappedBuffer.offset, MappedBuffer.size, MappedBuffer.ptr);
+        
+        CCFree(MappedBuffer.ptr);
+    }
+}
+
+static void CCDataCompositeSync(CCDataCompositeInternal *Internal)
+{
+    for (size_t Loop = 0; Loop < Internal->count; Loop++) CCDataSync(Internal->ranges[Loop].data);
+}
+
+static void CCDataCompositePurge(CCDataCompositeInternal *Internal)
+{
+    for (size_t Loop = 0; Loop < Internal->count; Loop++) CCDataPurge(Internal->ranges[Loop].data);
+}
+
+static size_t CCDataCompositeReadBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, void *Buffer)
+{
+    size_t Read = 0;
+    for (size_t Index = CCDataCompositeFindRange(Internal, Offset); (Read < Size) && (Index < Internal->count); Index++)
+    {
+        const CCDataCompositeRange *Range = &Internal->ranges[Index];
+        const size_t Local = (Offset + Read) - Internal->starts[Index];
+        const size_t ChunkSize = (Range->size - Local) < (Size - Read) ? (Range->size - Local) : (Size - Read);
+        
+        const size_t Count = CCDataReadBuffer(Range->data, Range->offset + Local, ChunkSize, Buffer + Read);
+        
+        Read += Count;
+        if (Count != ChunkSize) break;
+    }
+    
+    return Read;
+}
+
+static size_t CCDataCompositeWriteBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, const void *Buffer)
+{
+    size_t Written = 0;
+    for (size_t Index = CCDataCompositeFindRange(Internal, Offset); (Written < Size) && (Index < Internal->count); Index++)
+    {
+        const CCDataCompositeRange *Range = &Internal->ranges[Index];
+        const size_t Local = (Offset + Written) - Internal->starts[Index];
+        const size_t ChunkSize = (Range->size - Local) < (Size - Written) ? (Range->size - Local) : (Size - Written);
+        
+        const size_t Count = CCDataWriteBuffer(Range->data, Range->offset + Local, ChunkSize, Buffer + Written);
+        
+        Written += Count;
+        if (Count != ChunkSize) break;
+    }
+    
+    return Written;
+}
+
+static size_t CCDataCompositeFillBuffer(CCDataCompositeInternal *Internal, ptrdiff_t Offset, size_t Size, uint8_t Fill)
+{
+    size_t Filled = 0;
+    for (size_t Index = CCDataCompositeFindRange(Internal, Offset); (Filled < Size) && (Index < Internal->count); Index++)
+    {
+        const CCDataCompositeRange *Range = &Internal->ranges[Index];
+        const size_t Local = (Offset + Filled) - Internal->starts[Index];
+        const size_t ChunkSize = (Range->size - Local) < (Size - Filled) ? (Range->size - Local) : (Size - Filled);
+        
+        const size_t Count = CCDataFillBuffer(Range->data, Range->offset + Local, ChunkSize, Fill);
+        
+        Filled += Count;
+        if (Count != ChunkSize) break;
+    }
+    
+    return Filled;
+}
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+size_t CCDataCompositeMapIOVec(CCData Data, ptrdiff_t Offset, size_t Size, struct iovec *IOVec, size_t Count)
+{
+    CCAssertLog(Data, "Data must not be null");
+    CCAssertLog(Data->interface == CCDataComposite, "Data must be a composite");
+    CCAssertLog((Offset + Size) <= CCDataGetSize(Data), "Must not exceed bounds");
+    CCAssertLog(CCDataGetHints(Data) & CCDataHintRead, "Must have read access");
+    
+    if (!Size) return 0;
+    
+    CCDataCompositeInternal *Internal = Data->internal;
+    const size_t First = CCDataCompositeFindRange(Internal, Offset), Required = (CCDataCompositeFindRange(Internal, Offset + Size - 1) - First) + 1;
+    
+    if ((!IOVec) || (Required > Count)) return Required;
+    
+    size_t Mapped = 0;
+    for (size_t Loop = 0; Loop < Required; Loop++)
+    {
+        const CCDataCompositeRange *Range = &Internal->ranges[First + Loop];
+        const size_t Local = (Offset + Mapped) - Internal->starts[First + Loop];
+        const size_t ChunkSize = (Range->size - Local) < (Size - Mapped) ? (Range->size - Local) : (Size - Mapped);
+        
+        CCBufferMap Map = CCDataMapBuffer(Range->data, Range->offset + Local, ChunkSize, CCDataHintRead);
+        IOVec[Loop] = (struct iovec){ .iov_base = Map.ptr, .iov_len = Map.size };
+        
+        Mapped += ChunkSize;
+    }
+    
+    return Required;
+}
+
+void CCDataCompositeUnmapIOVec(CCData Data, ptrdiff_t Offset, size_t Size, struct iovec *IOVec, size_t Count)
+{
+    CCAssertLog(Data, "Data must not be null");
+    CCAssertLog(Data->interface == CCDataComposite, "Data must be a composite");
+    CCAssertLog(IOVec || !Count, "IOVec must not be null");
+    
+    CCDataCompositeInternal *Internal = Data->internal;
+    const size_t First = CCDataCompositeFindRange(Internal, Offset);
+    
+    size_t Mapped = 0;
+    for (size_t Loop = 0; (Loop < Count) && (Mapped < Size); Loop++)
+    {
+        const CCDataCompositeRange *Range = &Internal->ranges[First + Loop];
+        const size_t Local = (Offset + Mapped) - Internal->starts[First + Loop];
+        const size_t ChunkSize = (Range->size - Local) < (Size - Mapped) ? (Range->size - Local) : (Size - Mapped);
+        
+        CCDataUnmapBuffer(Range->data, (CCBufferMap){ .ptr = IOVec[Loop].iov_base, .offset = Range->offset + Local, .size = IOVec[Loop].iov_len, .hint = CCDataHintRead });
+        
+        Mapped += ChunkSize;
+    }
+}
+#endif
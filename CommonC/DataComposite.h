@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_DataComposite_h
+#define CommonC_DataComposite_h
+
+#include <CommonC/Base.h>
+#include <CommonC/Data.h>
+#include <CommonC/Platform.h>
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <sys/uio.h>
+#endif
+
+/*!
+ * @brief A region of a data container to be referenced by a composite.
+ */
+typedef struct {
+    ///The data container the region belongs to.
+    CCData data;
+    ///The offset of the region in the data container.
+    ptrdiff_t offset;
+    ///The size of the region.
+    size_t size;
+} CCDataCompositeRange;
+
+typedef struct {
+    const CCDataCompositeRange *ranges;
+    size_t count;
+} CCDataCompositeInit;
+
+extern const CCDataInterface * const CCDataComposite;
+
+/*!
+ * @brief Create a data container that is the concatenation of regions of other data containers.
+ * @description The regions are referenced rather than copied. Maps that fall within a single region
+ *              are views of that region, maps that span multiple regions are gathered into (and on
+ *              unmap scattered from) a temporary buffer.
+ *
+ *              Modifications made directly to the referenced data containers are not tracked by
+ *              the composite, @b CCDataInvalidate should be used after making such changes.
+ *
+ * @param Allocator The allocator to be used for the allocations.
+ * @param Hint The hints for the intended usage of this data container. Resizing is not supported.
+ * @param Ranges The ordered regions that make up the data. The data containers are retained.
+ * @param Count The number of regions.
+ * @param Hash An optional hashing function to be performed instead of the default for the internal
+ *        implementation.
+ *
+ * @param Destructor An optional destructor to perform any custom cleanup on destroy.
+ * @return A data composite, or NULL on failure. Must be destroyed to free the memory.
+ */
+CC_NEW CCData CCDataCompositeCreate(CCAllocatorType Allocator, CCDataHint Hint, const CCDataCompositeRange *Ranges, size_t Count, CCDataBufferHash Hash, CCDataBufferDestructor Destructor);
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+/*!
+ * @brief Map a region of the composite as an I/O vector.
+ * @description This allows the composite to be written using @b writev without gathering the regions
+ *              into a single buffer.
+ *
+ * @warning Must be unmapped using @b CCDataCompositeUnmapIOVec with the same arguments once finished.
+ * @param Data The data composite to map.
+ * @param Offset The starting point to map.
+ * @param Size The size of the mapped region.
+ * @param IOVec The I/O vector to be filled in, or NULL if only the count is required.
+ * @param Count The maximum number of entries of @p IOVec.
+ * @return The number of entries required to map the region. If this exceeds @p Count nothing
+ *         is mapped.
+ */
+size_t CCDataCompositeMapIOVec(CCData Data, ptrdiff_t Offset, size_t Size, struct iovec *IOVec, size_t Count);
+
+/*!
+ * @brief Unmap an I/O vector mapped by @b CCDataCompositeMapIOVec.
+ * @param Data The data composite the I/O vector was mapped from.
+ * @param Offset The starting point that was mapped.
+ * @param Size The size of the mapped region.
+ * @param IOVec The mapped I/O vector.
+ * @param Count The number of entries in the mapped @p IOVec.
+ */
+void CCDataCompositeUnmapIOVec(CCData Data, ptrdiff_t Offset, size_t Size, struct iovec *IOVec, size_t Count);
+#endif
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "DataFile.h"
+#include "FileHandle.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "Logging.h"
+#include "Platform.h"
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#elif CC_PLATFORM_WINDOWS
+#error Add support for windows
+#else
+#warning Unsupported platform
+#endif
+
+#ifndef CC_DATA_FILE_DEFAULT_MAP_SIZE
+#define CC_DATA_FILE_DEFAULT_MAP_SIZE (4 * 1024 * 1024)
+#endif
+
+
+typedef struct {
+    FSHandle handle;
+    int fd;
+    size_t size;
+    size_t pageSize;
+    size_t mapSize;
+    CCDataFileHint hint;
+} CCDataFileInternal;
+
+
+static void *CCDataFileConstructor(CCAllocatorType Allocator, CCDataFileHint Hint, CCDataFileInit *Data);
+static void CCDataFileDestroy(CCDataFileInternal *Internal);
+static CCDataHint CCDataFileGetHint(CCDataFileInternal *Internal);
+static size_t CCDataFileSize(CCDataFileInternal *Internal);
+static CCBufferMap CCDataFileMapBuffer(CCDataFileInternal *Internal, ptrdiff_t Offset, size_t Size, CCDataHint Access);
+static void CCDataFileUnmapBuffer(CCDataFileInternal *Internal, CCBufferMap MappedBuffer);
+static size_t CCDataFileGetPreferredMapSize(CCDataFileInternal *Internal);
+static _Bool CCDataFileResize(CCDataFileInternal *Internal, size_t Size);
+static void CCDataFileSync(CCDataFileInternal *Internal);
+static void CCDataFileInvalidate(CCDataFileInternal *Internal);
+static void CCDataFilePurge(CCDataFileInternal *Internal);
+static size_t CCDataFileReadBuffer(CCDataFileInternal *Internal, ptrdiff_t Offset, size_t Size, void *Buffer);
+static size_t CCDataFileWriteBuffer(CCDataFileInternal *Internal, ptrdiff_t Offset, size_t Size, const void *Buffer);
+
+const CCDataInterface CCDataFileInterface = {
+    .create = (CCDataConstructorCallback)CCDataFileConstructor,
+    .destroy = (CCDataDestructorCallback)CCDataFileDestroy,
+    .hints = (CCDataGetHintCallback)CCDataFileGetHint,
+    .size = (CCDataGetSizeCallback)CCDataFileSize,
+    .map = (CCDataMapBufferCallback)CCDataFileMapBuffer,
+    .unmap = (CCDataUnmapBufferCallback)CCDataFileUnmapBuffer,
+    .optional = {
+        .preferredMapSize = (CCDataGetPreferredMapSizeCallback)CCDataFileGetPreferredMapSize,
+        .resize = (CCDataResizeCallback)CCDataFileResize,
+        .sync = (CCDataSyncCallback)CCDataFileSync,
+        .invalidate = (CCDataInvalidateCallback)CCDataFileInvalidate,
+        .purge = (CCDataPurgeCallback)CCDataFilePurge,
+        .read = (CCDataReadBufferCallback)CCDataFileReadBuffer,
+        .write = (CCDataWriteBufferCallback)CCDataFileWriteBuffer
+    }
+};
+
+const CCDataInterface * const CCDataFile = &CCDataFileInterface;
+
+CCData CCDataFileCreate(CCAllocatorType Allocator, CCDataFileHint Hint, FSPath Path, size_t MapSize, CCDataBufferHash Hash, CCDataBufferDestructor Destructor)
+{
+    return CCDataCreate(Allocator, (CCDataHint)Hint, &(CCDataFileInit){ .path = Path, .mapSize = MapSize }, Hash, Destructor, CCDataFile);
+}
+
+static void *CCDataFileConstructor(CCAllocatorType Allocator, CCDataFileHint Hint, CCDataFileInit *Data)
+{
+    CCAssertLog(Data, "Init data cannot be null");
+    CCAssertLog(Data->path, "Path cannot be null");
+    CCAssertLog(!((Hint & CCDataFileHintSequential) && (Hint & CCDataFileHintRandom)), "Cannot hint both sequential and random access");
+    
+    FSHandle Handle;
+    if (FSHandleOpen(Data->path, (Hint & CCDataHintWrite ? FSHandleTypeUpdate : FSHandleTypeRead) | FSHandleTypeUnbuffered, &Handle) != FSOperationSuccess)
+    {
+        CC_LOG_ERROR("Failed to open file (%s) for data", FSPathGetPathString(Data->path));
+        return NULL;
+    }
+    
+    const int fd = FSHandleGetFileDescriptor(Handle);
+    
+    struct stat Stat;
+    if (fstat(fd, &Stat))
+    {
+        CC_LOG_ERROR("Failed to retrieve the size of file (%s) for data", FSPathGetPathString(Data->path));
+        FSHandleClose(Handle);
+        return NULL;
+    }
+    
+    CCDataFileInternal *Internal = CCMalloc(Allocator, sizeof(CCDataFileInternal), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Internal)
+    {
+        const size_t PageSize = (size_t)sysconf(_SC_PAGESIZE);
+        const size_t MapSize = Data->mapSize ? Data->mapSize : CC_DATA_FILE_DEFAULT_MAP_SIZE;
+        
+        *Internal = (CCDataFileInternal){
+            .handle = Handle,
+            .fd = fd,
+            .size = (size_t)Stat.st_size,
+            .pageSize = PageSize,
+            .mapSize = ((MapSize + PageSize - 1) / PageSize) * PageSize,
+            .hint = Hint
+        };
+    }
+    
+    else FSHandleClose(Handle);
+    
+    return Internal;
+}
+
+static void CCDataFileDestroy(CCDataFileInternal *Internal)
+{
+    FSHandleClose(Internal->handle);
+    
+    CCFree(Internal);
+}
+
+static CCDataHint CCDataFileGetHint(CCDataFileInternal *Internal)
+{
+    return (CCDataHint)Internal->hint;
+}
+
+static size_t CCDataFileSize(CCDataFileInternal *Internal)
+{
+    return Internal->size;
+}
+
+static CCBufferMap CCDataFileMapBuffer(CCDataFileInternal *Internal, ptrdiff_t Offset, size_t Size, CCDataHint Access)
+{
+    if (!Size) return (CCBufferMap){ .ptr = NULL, .offset = Offset, .size = 0, .hint = Access };
+    
+    const size_t Alignment = (size_t)Offset & (Internal->pageSize - 1);
+    
+    int Flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (Internal->hint & CCDataFileHintPopulate) Flags |= MAP_POPULATE;
+#endif
+    
+    void *Base = mmap(NULL, Size + Alignment, PROT_READ | (Access & CCDataHintWrite ? PROT_WRITE : 0), Flags, Internal->fd, (off_t)(Offset - Alignment));
+    if (Base == MAP_FAILED)
+    {
+        CC_LOG_ERROR("Failed to map file region (%td:%zu)", Offset, Size);
+        return (CCBufferMap){ .ptr = NULL, .offset = Offset, .size = 0, .hint = Access };
+    }
+    
+    if (Internal->hint & CCDataFileHintSequential) madvise(Base, Size + Alignment, MADV_SEQUENTIAL);
+    else if (Internal->hint & CCDataFileHintRandom) madvise(Base, Size + Alignment, MADV_RANDOM);
+    
+    return (CCBufferMap){ .ptr = Base + Alignment, .offset = Offset, .size = Size, .hint = Access };
+}
+
+static void CCDataFileUnmapBuffer(CCDataFileInternal *Internal, CCBufferMap MappedBuffer)
+{
+    if (!MappedBuffer.ptr) return;
+    
+    const size_t Alignment = (size_t)MappedBuffer.offset & (Internal->pageSize - 1);
+    void *Base = MappedBuffer.ptr - Alignment;
+    
+    //Schedule the writeback while the window still exists, CCDataFileSync will wait on it
+    if (MappedBuffer.hint & CCDataHintWrite) msync(Base, MappedBuffer.size + Alignment, MS_ASYNC);
+    
+    munmap(Base, MappedBuffer.size + Alignment);
+}
+
+static size_t CCDataFileGetPreferredMapSize(CCDataFileInternal *Internal)
+{
+    return Internal->mapSize;
+}
+
+static _Bool CCDataFileResize(CCDataFileInternal *Internal, size_t Size)
+{
+    if ((Internal->hint & CCDataHintResize) && (Internal->hint & CCDataHintWrite))
+    {
+        if (!ftruncate(Internal->fd, (off_t)Size))
+        {
+            Internal->size = Size;
+            return TRUE;
+        }
+    }
+    
+    return FALSE;
+}
+
+static void CCDataFileSync(CCDataFileInternal *Internal)
+{
+    if (Internal->hint & CCDataHintWrite) FSHandleSync(Internal->handle);
+}
+
+static void CCDataFileInvalidate(CCDataFileInternal *Internal)
+{
+    CCDataFilePurge(Internal);
+    
+    struct stat Stat;
+    if (!fstat(Internal->fd, &Stat)) Internal->size = (size_t)Stat.st_size;
+}
+
+static void CCDataFilePurge(CCDataFileInternal *Internal)
+{
+#if defined(POSIX_FADV_DONTNEED)
+    posix_fadvise(Internal->fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+static size_t CCDataFileReadBuffer(CCDataFileInternal *Internal, ptrdiff_t Offset, size_t Size, void *Buffer)
+{
+    size_t Read = 0;
+    while (Read < Size)
+    {
+        const ssize_t Count = pread(Internal->fd, Buffer + Read, Size - Read, (off_t)(Offset + Read));
+        if (Count <= 0) break;
+        
+        Read += (size_t)Count;
+    }
+    
+    return Read;
+}
+
+static size_t CCDataFileWriteBuffer(CCDataFileInternal *Internal, ptrdiff_t Offset, size_t Size, const void *Buffer)
+{
+    size_t Written = 0;
+    while (Written < Size)
+    {
+        const ssize_t Count = pwrite(Internal->fd, Buffer + Written, Size - Written, (off_t)(Offset + Written));
+        if (Count <= 0) break;
+        
+        Written += (size_t)Count;
+    }
+    
+    return Written;
+}
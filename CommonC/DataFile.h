@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_DataFile_h
+#define CommonC_DataFile_h
+
+#include <CommonC/Base.h>
+#include <CommonC/Data.h>
+#include <CommonC/Path.h>
+
+/*!
+ * @typedef CCDataFileHint
+ * @brief Hints specific to CCDataFile.
+ */
+enum {
+    ///Mask for hints for a data container.
+    CCDataFileHintMask = 0xff00,
+    ///Pre-fault the pages of a map (where supported) so the access doesn't incur page faults.
+    CCDataFileHintPopulate = (1 << 8),
+    ///Maps will be accessed sequentially, so the kernel should read ahead aggressively.
+    CCDataFileHintSequential = (1 << 9),
+    ///Maps will be accessed randomly, so the kernel should not read ahead.
+    CCDataFileHintRandom = (1 << 10)
+};
+
+typedef CCDataHint CCDataFileHint;
+
+typedef struct {
+    FSPath path;
+    size_t mapSize;
+} CCDataFileInit;
+
+extern const CCDataInterface * const CCDataFile;
+
+/*!
+ * @brief Create a data container for a memory mapped file.
+ * @description Maps are windows into the file that are aligned to the page size, so mapping
+ *              a region does not require reading it into an intermediate buffer. Writes to a
+ *              map are written back to the file.
+ *
+ * @param Allocator The allocator to be used for the allocations.
+ * @param Hint The hints for the intended usage of this data container.
+ *
+ *        @b CCDataHintWrite indicates that the file should be opened for writing, otherwise
+ *        it will be opened as read only.
+ *
+ *        @b CCDataHintResize indicates that the file may be resized.
+ *
+ *        @b CCDataFileHintPopulate indicates that the pages of a map should be pre-faulted.
+ *
+ *        @b CCDataFileHintSequential indicates that the file will be accessed sequentially.
+ *
+ *        @b CCDataFileHintRandom indicates that the file will be accessed randomly.
+ *
+ * @param Path The path to the file, the file must exist.
+ * @param MapSize The size of the window to be used when mapping the whole file in chunks.
+ *        This is rounded up to a multiple of the page size. Use 0 for the default size.
+ *
+ * @param Hash An optional hashing function to be performed instead of the default for the internal
+ *        implementation.
+ *
+ * @param Destructor An optional destructor to perform any custom cleanup on destroy.
+ * @return A data file, or NULL on failure. Must be destroyed to free the memory.
+ */
+CC_NEW CCData CCDataFileCreate(CCAllocatorType Allocator, CCDataFileHint Hint, FSPath Path, size_t MapSize, CCDataBufferHash Hash, CCDataBufferDestructor Destructor);
+
+#endif
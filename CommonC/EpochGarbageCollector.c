@@ -28,6 +28,8 @@
 #include "Assertion.h"
 #include "Logging.h"
 #include "Platform.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <stdatomic.h>
 #include <string.h>
 
@@ -65,9 +67,11 @@ typedef uint64_t CCEpochGarbageCollectorEpoch;
 
 typedef struct {
     CCEpochGarbageCollectorNode *list;
-    uint32_t refCount;
+    uintptr_t refCount; //pointer sized so the struct has no padding, which would otherwise be compared by the CAS
 } CCEpochGarbageCollectorManagedList;
 
+_Static_assert(sizeof(CCEpochGarbageCollectorManagedList) == (sizeof(CCEpochGarbageCollectorNode*) + sizeof(uintptr_t)), "CCEpochGarbageCollectorManagedList must not contain padding");
+
 typedef struct {
     _Atomic(CCEpochGarbageCollectorManagedList) managed[3];
     _Atomic(CCEpochGarbageCollectorEpoch) epoch;
@@ -151,9 +155,9 @@ static void *CCEpochGarbageCollectorConstructor(CCAllocatorType Allocator)
             return NULL;
         }
         
-        atomic_init(&GC->managed[0], (CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 });
-        atomic_init(&GC->managed[1], (CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 });
-        atomic_init(&GC->managed[2], (CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 });
+        atomic_init(&GC->managed[0], ((CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 }));
+        atomic_init(&GC->managed[1], ((CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 }));
+        atomic_init(&GC->managed[2], ((CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 }));
         atomic_init(&GC->epoch, 0);        
     }
     
@@ -162,9 +166,12 @@ static void *CCEpochGarbageCollectorConstructor(CCAllocatorType Allocator)
 
 void CCEpochGarbageCollectorDestructor(CCEpochGarbageCollectorInternal *GC)
 {
+    //key deletion won't call the destructor, so the destroying thread's state has to be freed here
 #if CC_GC_USING_PTHREADS
+    CCFree(pthread_getspecific(GC->key));
     pthread_key_delete(GC->key);
 #elif CC_GC_USING_STDTHREADS
+    CCFree(tss_get(GC->key));
     tss_delete(GC->key);
 #endif
     
@@ -226,6 +233,12 @@ void CCEpochGarbageCollectorBegin(CCEpochGarbageCollectorInternal *GC, CCAllocat
 
 static void CCEpochGarbageCollectorDrain(CCEpochGarbageCollectorInternal *GC, CCEpochGarbageCollectorNode *Node, CCEpochGarbageCollectorEpoch Epoch)
 {
+    CC_TRACE_SCOPE("CCEpochGarbageCollectorDrain");
+    
+#if CC_METRICS
+    int64_t Count = 0;
+#endif
+    
     while (Node)
     {
         ((CCEpochGarbageCollectorEntry*)CCEpochGarbageCollectorGetNodeData(Node))->reclaimer(((CCEpochGarbageCollectorEntry*)CCEpochGarbageCollectorGetNodeData(Node))->item);
@@ -233,8 +246,15 @@ static void CCEpochGarbageCollectorDrain(CCEpochGarbageCollectorInternal *GC, CC
         CCEpochGarbageCollectorNode *Temp = Node;
         Node = Node->next;
         CCEpochGarbageCollectorDestroyNode(Temp);
+        
+#if CC_METRICS
+        Count++;
+#endif
     }
     
+    CC_METRICS_GAUGE_ADD("gc.epoch.backlog", -Count);
+    CC_METRICS_HISTOGRAM_RECORD("gc.epoch.drain", Count);
+    
     atomic_compare_exchange_strong_explicit(&GC->epoch, &Epoch, Epoch + 1, memory_order_relaxed, memory_order_relaxed);
 }
 
@@ -261,14 +281,14 @@ void CCEpochGarbageCollectorEnd(CCEpochGarbageCollectorInternal *GC, CCAllocator
     {
         do {
             Managed = atomic_load_explicit(&GC->managed[Epoch], memory_order_relaxed);
-        } while (!atomic_compare_exchange_weak_explicit(&GC->managed[Epoch], &Managed, ((CCEpochGarbageCollectorManagedList){ .list = Managed.list, .refCount = Managed.refCount - 1 }), memory_order_relaxed, memory_order_relaxed));
+        } while (!atomic_compare_exchange_weak_explicit(&GC->managed[Epoch], &Managed, ((CCEpochGarbageCollectorManagedList){ .list = Managed.list, .refCount = Managed.refCount - 1 }), memory_order_release, memory_order_relaxed));
     }
     
     const CCEpochGarbageCollectorEpoch StaleEpoch = GlobalEpoch % 3;
     Managed = atomic_load_explicit(&GC->managed[StaleEpoch], memory_order_relaxed);
     if (Managed.refCount == 0)
     {
-        CCEpochGarbageCollectorManagedList NextManaged = atomic_load_explicit(&GC->managed[(StaleEpoch + 1) % 3], memory_order_relaxed);
+        CCEpochGarbageCollectorManagedList NextManaged = atomic_load_explicit(&GC->managed[(StaleEpoch + 1) % 3], memory_order_acquire);
         if ((NextManaged.refCount == 0) && (atomic_compare_exchange_strong_explicit(&GC->managed[StaleEpoch], &Managed, ((CCEpochGarbageCollectorManagedList){ .list = NULL, .refCount = 0 }), memory_order_acquire, memory_order_relaxed)))
         {
             if (GlobalEpoch == atomic_load_explicit(&GC->epoch, memory_order_relaxed)) CCEpochGarbageCollectorDrain(GC, Managed.list, GlobalEpoch);
@@ -323,4 +343,6 @@ void CCEpochGarbageCollectorManage(CCEpochGarbageCollectorInternal *GC, void *It
     LocalEpoch->head = Entry;
     
     if (!LocalEpoch->tail) LocalEpoch->tail = LocalEpoch->head;
+    
+    CC_METRICS_GAUGE_ADD("gc.epoch.backlog", 1);
 }
@@ -23,11 +23,17 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE //O_DIRECT
+#endif
+
 #include "FileHandle.h"
+#include "FileHandle_Private.h"
 #include "Platform.h"
 #include "Assertion.h"
 #include "MemoryAllocation.h"
 #include "Logging.h"
+#include "Trace.h"
 
 #if CC_PLATFORM_OS_X || CC_PLATFORM_IOS
 //SystemPath.m
@@ -42,6 +48,16 @@
 #warning Unsupported platform
 #endif
 
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+
 
 #if CC_PLATFORM_UNIX
 
@@ -57,39 +73,50 @@ FSOperation FSHandleOpen(FSPath Path, FSHandleType Type, FSHandle *Handle)
     CCAssertLog(Path, "Path must not be null");
     CCAssertLog(Handle, "Handle must not be null");
     
-    if (FSManagerExists(Path))
+    CC_TRACE_SCOPE("FSHandleOpen");
+    
+    const char *SystemPath = FSPathSystemInternalRepresentation(Path);
+    if (Type & FSHandleTypeUnbuffered) return FSHandleDescriptorOpen(Path, SystemPath, Type, Handle);
+    
+    FILE *File = NULL;
+    
+    if (Type == FSHandleTypeRead) File = fopen(SystemPath, "r");
+    else if (Type == FSHandleTypeWrite) File = fopen(SystemPath, "r+");
+    else if (Type == FSHandleTypeUpdate) File = fopen(SystemPath, "r+");
+    
+    if (!File) return FSHandleDescriptorOpenFailure(Path);
+    
+    //The path is only looked up once, so its type is checked against the opened file rather than beforehand
+    if (!FSHandleDescriptorMatchesPath(fileno(File), Path))
     {
-        const char *SystemPath = FSPathSystemInternalRepresentation(Path);
-        FILE *File = NULL;
-        
-        if (Type == FSHandleTypeRead) File = fopen(SystemPath, "r");
-        else if (Type == FSHandleTypeWrite) File = fopen(SystemPath, "r+");
-        else if (Type == FSHandleTypeUpdate) File = fopen(SystemPath, "r+");
-        
-        if (!File) return FSOperationFailure;
-        
-        CC_SAFE_Malloc(*Handle, sizeof(FSHandleInfo),
-                       CC_LOG_ERROR("Failed to open file handle due to memory allocation failure. Allocation size (%zu)", sizeof(FSHandleInfo));
-                       fclose(File);
-                       return FSOperationFailure;
-                       );
-        
-        **Handle = (FSHandleInfo){
-            .type = Type,
-            .path = FSPathCopy(Path),
-            .handle = File
-        };
-        
-        return FSOperationSuccess;
+        fclose(File);
+        return FSOperationPathNotExist;
     }
     
-    return FSOperationPathNotExist;
+    CC_SAFE_Malloc(*Handle, sizeof(FSHandleInfo),
+                   CC_LOG_ERROR("Failed to open file handle due to memory allocation failure. Allocation size (%zu)", sizeof(FSHandleInfo));
+                   fclose(File);
+                   return FSOperationFailure;
+                   );
+    
+    **Handle = (FSHandleInfo){
+        .type = Type,
+        .path = FSPathCopy(Path),
+        .handle = File,
+        .descriptor = -1
+    };
+    
+    return FSOperationSuccess;
 }
 
 FSOperation FSHandleClose(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    CC_TRACE_SCOPE("FSHandleClose");
+    
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorClose(Handle);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     FSPathDestroy(Handle->path);
@@ -105,6 +132,10 @@ FSOperation FSHandleSync(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    CC_TRACE_SCOPE("FSHandleSync");
+    
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorSync(Handle);
+    
     if (!Handle->handle) return FSOperationFailure;
     
 #if CC_PLATFORM_POSIX_COMPLIANT
@@ -120,6 +151,10 @@ FSOperation FSHandleRead(FSHandle Handle, size_t *Count, void *Data, FSBehaviour
     CCAssertLog(Count, "Count must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    CC_TRACE_SCOPE("FSHandleRead");
+    
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorReadFromOffset(Handle, Handle->offset, Count, Data, Behaviour);
+    
     if ((!Handle->handle) || (Handle->type == FSHandleTypeWrite))
     {
         *Count = 0;
@@ -142,6 +177,10 @@ FSOperation FSHandleReadFromOffset(FSHandle Handle, size_t Offset, size_t *Count
     CCAssertLog(Count, "Count must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    CC_TRACE_SCOPE("FSHandleReadFromOffset");
+    
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorReadFromOffset(Handle, Offset, Count, Data, Behaviour);
+    
     if (!Handle->handle)
     {
         *Count = 0;
@@ -163,6 +202,10 @@ FSOperation FSHandleWrite(FSHandle Handle, size_t Count, const void *Data, FSBeh
     CCAssertLog(Handle, "Handle must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    CC_TRACE_SCOPE("FSHandleWrite");
+    
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorWriteFromOffset(Handle, Handle->offset, Count, Data, Behaviour);
+    
     if ((!Handle->handle) || (Handle->type == FSHandleTypeRead)) return FSOperationFailure;
     
     const size_t Offset = FSHandleGetOffset(Handle);
@@ -176,49 +219,11 @@ FSOperation FSHandleWrite(FSHandle Handle, size_t Count, const void *Data, FSBeh
     {
         if (Handle->type != FSHandleTypeUpdate) return FSOperationFailure;
         
-        size_t ChunkSize = FSManagerGetPreferredIOBlockSize(Handle->path);
-        if (Count > ChunkSize) ChunkSize = Count;
-        
-        const size_t Size = FSManagerGetSize(Handle->path) - Offset;
-        void *Chunk, *NextChunk;
-        CC_SAFE_Malloc(Chunk, ChunkSize,
-                       return FSOperationFailure;
-                       );
-        
-        CC_SAFE_Malloc(NextChunk, ChunkSize,
-                       CC_SAFE_Free(Chunk);
-                       return FSOperationFailure;
-                       );
-        
-        size_t ChunkLength = ChunkSize;
-        FSHandleRead(Handle, &ChunkLength, Chunk, FSBehaviourPreserveOffset);
-        
-        fwrite(Data, Count, 1, Handle->handle);
+        //The stream is repositioned below, discarding anything it had buffered
+        fflush(Handle->handle);
         
-        for (size_t Shifted = 0; Shifted < Size; )
-        {
-            FSHandleSetOffset(Handle, Offset + Shifted + Count);
-            
-            size_t NextChunkLength = 0;
-            if (Shifted + ChunkLength < Size)
-            {
-                NextChunkLength = ChunkSize;
-                FSHandleRead(Handle, &NextChunkLength, NextChunk, FSBehaviourPreserveOffset);
-            }
-            
-            fwrite(Chunk, ChunkLength, 1, Handle->handle);
-            
-            Shifted += ChunkLength;
-            
-            ChunkLength = NextChunkLength;
-            
-            void *Temp = Chunk;
-            Chunk = NextChunk;
-            NextChunk = Temp;
-        }
-        
-        CC_SAFE_Free(Chunk);
-        CC_SAFE_Free(NextChunk);
+        FSHandleInfo View = FSHandleDescriptorView(Handle);
+        if (FSHandleDescriptorWriteFromOffset(&View, Offset, Count, Data, FSWritingBehaviourInsert) != FSOperationSuccess) return FSOperationFailure;
     }
     
     if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourPreserveOffset) return FSHandleSetOffset(Handle, Offset);
@@ -232,6 +237,10 @@ FSOperation FSHandleWriteFromOffset(FSHandle Handle, size_t Offset, size_t Count
     CCAssertLog(Handle, "Handle must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    CC_TRACE_SCOPE("FSHandleWriteFromOffset");
+    
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorWriteFromOffset(Handle, Offset, Count, Data, Behaviour);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     const size_t OldOffset = FSHandleGetOffset(Handle);
@@ -248,52 +257,17 @@ FSOperation FSHandleRemove(FSHandle Handle, size_t Count, FSBehaviour Behaviour)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorRemoveFromOffset(Handle, Handle->offset, Count, Behaviour);
+    
     if ((!Handle->handle) || (Handle->type != FSHandleTypeUpdate)) return FSOperationFailure;
     
     const size_t Offset = FSHandleGetOffset(Handle);
-    size_t Size = FSManagerGetSize(Handle->path);
     
-    if (Offset > Size) return FSOperationSuccess;
-    Size -= Offset;
+    //The stream is repositioned below, discarding anything it had buffered
+    fflush(Handle->handle);
     
-    if (Count >= Size)
-    {
-#if CC_PLATFORM_POSIX_COMPLIANT
-        ftruncate(FSHandleGetFileDescriptor(Handle), Offset);
-#else
-#error Missing support for truncation
-#endif
-    }
-    
-    else
-    {
-        size_t ChunkSize = FSManagerGetPreferredIOBlockSize(Handle->path);
-        
-        void *Chunk;
-        CC_SAFE_Malloc(Chunk, ChunkSize,
-                       return FSOperationFailure;
-                       );
-        
-        for (size_t Shifted = 0; Shifted < (Size - Count); )
-        {
-            size_t ChunkLength = ChunkSize;
-            FSHandleSetOffset(Handle, Offset + Shifted + Count);
-            FSHandleRead(Handle, &ChunkLength, Chunk, FSBehaviourDefault);
-            
-            FSHandleSetOffset(Handle, Offset + Shifted);
-            FSHandleWrite(Handle, ChunkLength, Chunk, FSBehaviourDefault);
-            
-            Shifted += ChunkLength;
-        }
-        
-#if CC_PLATFORM_POSIX_COMPLIANT
-        ftruncate(FSHandleGetFileDescriptor(Handle), Offset + Size - Count);
-#else
-#error Missing support for truncation
-#endif
-        
-        CC_SAFE_Free(Chunk);
-    }
+    FSHandleInfo View = FSHandleDescriptorView(Handle);
+    if (FSHandleDescriptorRemoveFromOffset(&View, Offset, Count, FSBehaviourDefault) != FSOperationSuccess) return FSOperationFailure;
     
     if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourPreserveOffset) return FSHandleSetOffset(Handle, Offset);
     else if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) return FSHandleSetOffset(Handle, Offset + Count);
@@ -305,6 +279,8 @@ FSOperation FSHandleRemoveFromOffset(FSHandle Handle, size_t Offset, size_t Coun
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorRemoveFromOffset(Handle, Offset, Count, Behaviour);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     const size_t OldOffset = FSHandleGetOffset(Handle);
@@ -321,6 +297,8 @@ size_t FSHandleGetOffset(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return Handle->offset;
+    
     if (Handle->handle)
     {
         return ftell(Handle->handle);
@@ -333,6 +311,12 @@ FSOperation FSHandleSetOffset(FSHandle Handle, size_t Offset)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered)
+    {
+        Handle->offset = Offset;
+        return FSOperationSuccess;
+    }
+    
     if (!Handle->handle) return FSOperationFailure;
     
     
@@ -344,6 +328,8 @@ int FSHandleGetFileDescriptor(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return Handle->descriptor;
+    
     if (Handle->handle)
     {
         return fileno(Handle->handle);
@@ -354,3 +340,493 @@ int FSHandleGetFileDescriptor(FSHandle Handle)
 #endif
 
 #endif
+
+size_t FSHandleGetAlignment(FSHandle Handle)
+{
+    CCAssertLog(Handle, "Handle must not be null");
+    
+    return Handle->alignment ? Handle->alignment : 1;
+}
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+
+#if defined(__linux__) || defined(__FreeBSD__)
+#define CC_FILE_HANDLE_VECTORED_POSITIONAL_IO 1
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#if !defined(CC_FILE_HANDLE_RANGE_ALLOCATION) && defined(__linux__) && defined(FALLOC_FL_INSERT_RANGE) && defined(FALLOC_FL_COLLAPSE_RANGE)
+#define CC_FILE_HANDLE_RANGE_ALLOCATION 1
+#endif
+
+#if !defined(CC_FILE_HANDLE_COPY_FILE_RANGE) && (defined(__linux__) || defined(__FreeBSD__))
+#define CC_FILE_HANDLE_COPY_FILE_RANGE 1
+#endif
+
+#ifndef CC_FILE_HANDLE_MOVE_CHUNK_SIZE
+#define CC_FILE_HANDLE_MOVE_CHUNK_SIZE (1024 * 1024)
+#endif
+
+#ifndef CC_FILE_HANDLE_COPY_CHUNK_SIZE
+#define CC_FILE_HANDLE_COPY_CHUNK_SIZE (64 * 1024 * 1024)
+#endif
+
+FSOperation FSHandleDescriptorOpenFailure(FSPath Path)
+{
+    //Opening a directory for writing fails with EISDIR, while FSManagerExists would report a file path to a directory as not existing
+    return (errno == ENOENT) || (errno == ENOTDIR) || ((errno == EISDIR) && (FSPathIsFile(Path))) ? FSOperationPathNotExist : FSOperationFailure;
+}
+
+_Bool FSHandleDescriptorMatchesPath(int Descriptor, FSPath Path)
+{
+    struct stat Info;
+    return (!fstat(Descriptor, &Info)) && ((_Bool)S_ISDIR(Info.st_mode) == FSPathIsDirectory(Path));
+}
+
+FSOperation FSHandleDescriptorOpen(FSPath Path, const char *SystemPath, FSHandleType Type, FSHandle *Handle)
+{
+    //Writing may need to read partial blocks back (direct I/O) or shift the file contents
+    const int Flags = (Type & FSHandleTypeMask) == FSHandleTypeRead ? O_RDONLY : O_RDWR;
+    
+    int Descriptor = -1;
+    size_t Alignment = 1;
+    
+#ifdef O_DIRECT
+    if ((Type & FSHandleTypeDirect) == FSHandleTypeDirect)
+    {
+        Descriptor = open(SystemPath, Flags | O_DIRECT);
+        
+        struct stat Info;
+        if (Descriptor != -1) Alignment = (!fstat(Descriptor, &Info) && (Info.st_blksize > 0)) ? (size_t)Info.st_blksize : 4096;
+    }
+#endif
+    
+    //Some file systems do not support O_DIRECT, in which case the file is opened as a regular unbuffered handle
+    if (Descriptor == -1) Descriptor = open(SystemPath, Flags);
+    if (Descriptor == -1) return FSHandleDescriptorOpenFailure(Path);
+    
+    if (!FSHandleDescriptorMatchesPath(Descriptor, Path))
+    {
+        close(Descriptor);
+        return FSOperationPathNotExist;
+    }
+    
+#ifdef F_NOCACHE
+    if ((Type & FSHandleTypeDirect) == FSHandleTypeDirect) fcntl(Descriptor, F_NOCACHE, 1);
+#endif
+    
+    CC_SAFE_Malloc(*Handle, sizeof(FSHandleInfo),
+                   CC_LOG_ERROR("Failed to open file handle due to memory allocation failure. Allocation size (%zu)", sizeof(FSHandleInfo));
+                   close(Descriptor);
+                   return FSOperationFailure;
+                   );
+    
+    **Handle = (FSHandleInfo){
+        .type = Type,
+        .path = FSPathCopy(Path),
+        .handle = NULL,
+        .descriptor = Descriptor,
+        .offset = 0,
+        .alignment = Alignment
+    };
+    
+    return FSOperationSuccess;
+}
+
+FSOperation FSHandleDescriptorClose(FSHandle Handle)
+{
+    FSPathDestroy(Handle->path);
+    
+    const int Result = close(Handle->descriptor);
+    
+    CC_SAFE_Free(Handle);
+    
+    return !Result ? FSOperationSuccess : FSOperationFailure;
+}
+
+FSOperation FSHandleDescriptorSync(FSHandle Handle)
+{
+    return !fsync(Handle->descriptor) ? FSOperationSuccess : FSOperationFailure;
+}
+
+static _Bool FSHandleDescriptorTransfer(FSHandle Handle, _Bool Write, size_t Offset, size_t Count, void *Data, size_t *Transferred)
+{
+    size_t Total = 0;
+    while (Total < Count)
+    {
+        const ssize_t Result = Write ? pwrite(Handle->descriptor, Data + Total, Count - Total, (off_t)(Offset + Total)) : pread(Handle->descriptor, Data + Total, Count - Total, (off_t)(Offset + Total));
+        if (Result > 0)
+        {
+            Total += (size_t)Result;
+            
+            //A partial block can only occur at the end of the file, continuing from an unaligned offset would fail
+            if ((size_t)Result & (Handle->alignment - 1)) break;
+        }
+        
+        else if (!Result) break;
+        else if (errno != EINTR)
+        {
+            *Transferred = Total;
+            return FALSE;
+        }
+    }
+    
+    *Transferred = Total;
+    
+    return TRUE;
+}
+
+static CC_FORCE_INLINE _Bool FSHandleDescriptorIsAligned(FSHandle Handle, size_t Offset, size_t Count, const void *Data)
+{
+    return !((Offset | Count | (uintptr_t)Data) & (Handle->alignment - 1));
+}
+
+//Macro so the aligned allocator's compound literal remains in scope of the caller
+#define FSHandleDescriptorAllocator(Handle) ((Handle)->alignment > 1 ? CC_ALIGNED_ALLOCATOR((Handle)->alignment) : CC_STD_ALLOCATOR)
+
+static _Bool FSHandleDescriptorRead(FSHandle Handle, size_t Offset, size_t Count, void *Data, size_t *Read)
+{
+    if (FSHandleDescriptorIsAligned(Handle, Offset, Count, Data)) return FSHandleDescriptorTransfer(Handle, FALSE, Offset, Count, Data, Read);
+    
+    const size_t Alignment = Handle->alignment;
+    const size_t Start = Offset & ~(Alignment - 1), End = (Offset + Count + (Alignment - 1)) & ~(Alignment - 1);
+    
+    void *Buffer = CCMalloc(FSHandleDescriptorAllocator(Handle), End - Start, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Buffer)
+    {
+        *Read = 0;
+        return FALSE;
+    }
+    
+    size_t Staged;
+    const _Bool Success = FSHandleDescriptorTransfer(Handle, FALSE, Start, End - Start, Buffer, &Staged);
+    
+    *Read = Staged > (Offset - Start) ? Staged - (Offset - Start) : 0;
+    if (*Read > Count) *Read = Count;
+    
+    memcpy(Data, Buffer + (Offset - Start), *Read);
+    CCFree(Buffer);
+    
+    return Success;
+}
+
+static _Bool FSHandleDescriptorWrite(FSHandle Handle, size_t Offset, size_t Count, const void *Data, size_t *Written)
+{
+    if (FSHandleDescriptorIsAligned(Handle, Offset, Count, Data)) return FSHandleDescriptorTransfer(Handle, TRUE, Offset, Count, (void*)Data, Written);
+    
+    *Written = 0;
+    
+    struct stat Info;
+    if (fstat(Handle->descriptor, &Info)) return FALSE;
+    
+    const size_t Alignment = Handle->alignment, Size = (size_t)Info.st_size;
+    const size_t Start = Offset & ~(Alignment - 1), End = (Offset + Count + (Alignment - 1)) & ~(Alignment - 1);
+    
+    void *Buffer = CCMalloc(FSHandleDescriptorAllocator(Handle), End - Start, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Buffer) return FALSE;
+    
+    //Preserve the contents of the partially overwritten first and last blocks
+    size_t Staged;
+    if (Offset != Start)
+    {
+        memset(Buffer, 0, Alignment);
+        if (!FSHandleDescriptorTransfer(Handle, FALSE, Start, Alignment, Buffer, &Staged))
+        {
+            CCFree(Buffer);
+            return FALSE;
+        }
+    }
+    
+    if (((Offset + Count) != End) && ((Offset == Start) || ((End - Alignment) != Start)))
+    {
+        memset(Buffer + (End - Alignment - Start), 0, Alignment);
+        if (!FSHandleDescriptorTransfer(Handle, FALSE, End - Alignment, Alignment, Buffer + (End - Alignment - Start), &Staged))
+        {
+            CCFree(Buffer);
+            return FALSE;
+        }
+    }
+    
+    memcpy(Buffer + (Offset - Start), Data, Count);
+    
+    const _Bool Success = FSHandleDescriptorTransfer(Handle, TRUE, Start, End - Start, Buffer, &Staged);
+    CCFree(Buffer);
+    
+    *Written = Staged > (Offset - Start) ? Staged - (Offset - Start) : 0;
+    if (*Written > Count) *Written = Count;
+    
+    //Remove the padding of the last block if it was written past the end of the file
+    if ((End > Size) && (End > (Offset + Count))) ftruncate(Handle->descriptor, (off_t)(Size > (Offset + Count) ? Size : (Offset + Count)));
+    
+    return Success;
+}
+
+static _Bool FSHandleDescriptorMoveBuffered(FSHandle Handle, size_t Source, size_t Destination, size_t Count)
+{
+    if (!Count) return TRUE;
+    
+    const size_t ChunkSize = CC_FILE_HANDLE_MOVE_CHUNK_SIZE > Handle->alignment ? CC_FILE_HANDLE_MOVE_CHUNK_SIZE : Handle->alignment;
+    void *Chunk = CCMalloc(FSHandleDescriptorAllocator(Handle), Count < ChunkSize ? Count : ChunkSize, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Chunk) return FALSE;
+    
+    //Copy from the end when moving forward so the source isn't overwritten before it is read
+    _Bool Success = TRUE;
+    for (size_t Moved = 0; (Success) && (Moved < Count); )
+    {
+        const size_t Length = (Count - Moved) < ChunkSize ? (Count - Moved) : ChunkSize;
+        const size_t Index = Destination > Source ? Count - Moved - Length : Moved;
+        
+        size_t Transferred;
+        Success = FSHandleDescriptorRead(Handle, Source + Index, Length, Chunk, &Transferred) && (Transferred == Length);
+        if (Success) Success = FSHandleDescriptorWrite(Handle, Destination + Index, Length, Chunk, &Transferred) && (Transferred == Length);
+        
+        Moved += Length;
+    }
+    
+    CCFree(Chunk);
+    
+    return Success;
+}
+
+static _Bool FSHandleDescriptorMove(FSHandle Handle, size_t Source, size_t Destination, size_t Count)
+{
+    if ((Source == Destination) || (!Count)) return TRUE;
+    
+#if CC_FILE_HANDLE_COPY_FILE_RANGE
+    //Chunks no larger than the distance never overlap, so the kernel can copy them without passing through user space
+    const size_t Distance = Destination > Source ? Destination - Source : Source - Destination;
+    if ((Handle->alignment <= 1) && (Distance >= CC_FILE_HANDLE_MOVE_CHUNK_SIZE))
+    {
+        const size_t ChunkSize = Distance < CC_FILE_HANDLE_COPY_CHUNK_SIZE ? Distance : CC_FILE_HANDLE_COPY_CHUNK_SIZE;
+        
+        for (size_t Moved = 0; Moved < Count; )
+        {
+            const size_t Length = (Count - Moved) < ChunkSize ? (Count - Moved) : ChunkSize;
+            const size_t Index = Destination > Source ? Count - Moved - Length : Moved;
+            
+            off_t From = (off_t)(Source + Index), To = (off_t)(Destination + Index);
+            size_t Copied = 0;
+            while (Copied < Length)
+            {
+                const ssize_t Result = copy_file_range(Handle->descriptor, &From, Handle->descriptor, &To, Length - Copied, 0);
+                
+                if (Result > 0) Copied += (size_t)Result;
+                else if ((Result == 0) || (errno != EINTR)) break;
+            }
+            
+            Moved += Length;
+            
+            if (Copied != Length)
+            {
+                //The file system does not support copying ranges, so the remaining chunks are copied through a buffer
+                if (!FSHandleDescriptorMoveBuffered(Handle, Source + Index + Copied, Destination + Index + Copied, Length - Copied)) return FALSE;
+                
+                return Destination > Source ? FSHandleDescriptorMoveBuffered(Handle, Source, Destination, Count - Moved) : FSHandleDescriptorMoveBuffered(Handle, Source + Moved, Destination + Moved, Count - Moved);
+            }
+        }
+        
+        return TRUE;
+    }
+#endif
+    
+    return FSHandleDescriptorMoveBuffered(Handle, Source, Destination, Count);
+}
+
+/*
+ Insert (or remove) Count bytes at Offset by shifting the remainder of the file, of Size bytes. When Count is a
+ multiple of the file system's block size the extents are shifted instead (O(1) in the size of the file), and
+ only the part of the block preceding Offset needs to be copied.
+ */
+static _Bool FSHandleDescriptorShift(FSHandle Handle, size_t Offset, size_t Count, size_t Size, size_t BlockSize, _Bool Insert)
+{
+#if CC_FILE_HANDLE_RANGE_ALLOCATION
+    if ((BlockSize) && (!(Count % BlockSize)))
+    {
+        const size_t Start = Offset - (Offset % BlockSize), Head = Offset - Start;
+        
+        if (Insert)
+        {
+            if (!fallocate(Handle->descriptor, FALLOC_FL_INSERT_RANGE, (off_t)Start, (off_t)Count))
+            {
+                return FSHandleDescriptorMove(Handle, Start + Count, Start, Head);
+            }
+        }
+        
+        else
+        {
+            void *Block = NULL;
+            if (Head)
+            {
+                size_t Transferred;
+                Block = CCMalloc(CC_STD_ALLOCATOR, Head, NULL, CC_DEFAULT_ERROR_CALLBACK);
+                if ((!Block) || (!FSHandleDescriptorRead(Handle, Start, Head, Block, &Transferred)) || (Transferred != Head))
+                {
+                    if (Block) CCFree(Block);
+                    return FALSE;
+                }
+            }
+            
+            _Bool Success = !fallocate(Handle->descriptor, FALLOC_FL_COLLAPSE_RANGE, (off_t)Start, (off_t)Count);
+            if ((Success) && (Head))
+            {
+                size_t Transferred;
+                Success = FSHandleDescriptorWrite(Handle, Start, Head, Block, &Transferred) && (Transferred == Head);
+                CCFree(Block);
+                
+                return Success;
+            }
+            
+            if (Block) CCFree(Block);
+            if (Success) return TRUE;
+        }
+        
+        //The file system does not support shifting extents, so the file is shifted by copying instead
+    }
+#endif
+    
+    if (Insert) return FSHandleDescriptorMove(Handle, Offset, Offset + Count, Size - Offset);
+    
+    return (FSHandleDescriptorMove(Handle, Offset + Count, Offset, Size - Offset - Count)) && (!ftruncate(Handle->descriptor, (off_t)(Size - Count)));
+}
+
+FSOperation FSHandleDescriptorReadFromOffset(FSHandle Handle, size_t Offset, size_t *Count, void *Data, FSBehaviour Behaviour)
+{
+    if ((Handle->type & FSHandleTypeMask) == FSHandleTypeWrite)
+    {
+        *Count = 0;
+        return FSOperationFailure;
+    }
+    
+    const _Bool Success = FSHandleDescriptorRead(Handle, Offset, *Count, Data, Count);
+    
+    if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) Handle->offset = Offset + *Count;
+    
+    return Success ? FSOperationSuccess : FSOperationFailure;
+}
+
+FSOperation FSHandleDescriptorWriteFromOffset(FSHandle Handle, size_t Offset, size_t Count, const void *Data, FSBehaviour Behaviour)
+{
+    if ((Handle->type & FSHandleTypeMask) == FSHandleTypeRead) return FSOperationFailure;
+    
+    if ((Behaviour & FSWritingBehaviourDestructiveMask) == FSWritingBehaviourInsert)
+    {
+        if ((Handle->type & FSHandleTypeMask) != FSHandleTypeUpdate) return FSOperationFailure;
+        
+        struct stat Info;
+        if (fstat(Handle->descriptor, &Info)) return FSOperationFailure;
+        
+        const size_t Size = (size_t)Info.st_size;
+        if ((Offset < Size) && (!FSHandleDescriptorShift(Handle, Offset, Count, Size, (size_t)Info.st_blksize, TRUE))) return FSOperationFailure;
+    }
+    
+    size_t Written;
+    const _Bool Success = FSHandleDescriptorWrite(Handle, Offset, Count, Data, &Written);
+    
+    if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) Handle->offset = Offset + Written;
+    
+    return (Success) && (Written == Count) ? FSOperationSuccess : FSOperationFailure;
+}
+
+FSOperation FSHandleDescriptorRemoveFromOffset(FSHandle Handle, size_t Offset, size_t Count, FSBehaviour Behaviour)
+{
+    if ((Handle->type & FSHandleTypeMask) != FSHandleTypeUpdate) return FSOperationFailure;
+    
+    struct stat Info;
+    if (fstat(Handle->descriptor, &Info)) return FSOperationFailure;
+    
+    const size_t Size = (size_t)Info.st_size;
+    if (Offset < Size)
+    {
+        if (Count >= (Size - Offset))
+        {
+            if (ftruncate(Handle->descriptor, (off_t)Offset)) return FSOperationFailure;
+        }
+        
+        else if (!FSHandleDescriptorShift(Handle, Offset, Count, Size, (size_t)Info.st_blksize, FALSE)) return FSOperationFailure;
+    }
+    
+    if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) Handle->offset = Offset + Count;
+    
+    return FSOperationSuccess;
+}
+
+FSOperation FSHandleReadVectorFromOffset(FSHandle Handle, size_t Offset, const struct iovec *IOVec, size_t IOVecCount, size_t *Count, FSBehaviour Behaviour)
+{
+    CCAssertLog(Handle, "Handle must not be null");
+    CCAssertLog(IOVec || !IOVecCount, "IOVec must not be null");
+    
+    FSOperation Result = FSOperationSuccess;
+    size_t Read = 0;
+    
+#if CC_FILE_HANDLE_VECTORED_POSITIONAL_IO
+    if (((Handle->type & FSHandleTypeDirect) == FSHandleTypeUnbuffered) && ((Handle->type & FSHandleTypeMask) != FSHandleTypeWrite) && (IOVecCount <= IOV_MAX))
+    {
+        ssize_t Transferred;
+        while (((Transferred = preadv(Handle->descriptor, IOVec, (int)IOVecCount, (off_t)Offset)) == -1) && (errno == EINTR));
+        
+        if (Transferred >= 0) Read = (size_t)Transferred;
+        else Result = FSOperationFailure;
+    }
+    
+    else
+#endif
+    {
+        for (size_t Loop = 0; Loop < IOVecCount; Loop++)
+        {
+            size_t Length = IOVec[Loop].iov_len;
+            Result = FSHandleReadFromOffset(Handle, Offset + Read, &Length, IOVec[Loop].iov_base, FSBehaviourPreserveOffset);
+            
+            Read += Length;
+            if ((Result != FSOperationSuccess) || (Length != IOVec[Loop].iov_len)) break;
+        }
+    }
+    
+    if (Count) *Count = Read;
+    
+    if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) FSHandleSetOffset(Handle, Offset + Read);
+    
+    return Result;
+}
+
+FSOperation FSHandleWriteVectorFromOffset(FSHandle Handle, size_t Offset, const struct iovec *IOVec, size_t IOVecCount, size_t *Count, FSBehaviour Behaviour)
+{
+    CCAssertLog(Handle, "Handle must not be null");
+    CCAssertLog(IOVec || !IOVecCount, "IOVec must not be null");
+    CCAssertLog((Behaviour & FSWritingBehaviourDestructiveMask) == FSWritingBehaviourOverwrite, "Only supports overwriting");
+    
+    FSOperation Result = FSOperationSuccess;
+    size_t Written = 0;
+    
+#if CC_FILE_HANDLE_VECTORED_POSITIONAL_IO
+    if (((Handle->type & FSHandleTypeDirect) == FSHandleTypeUnbuffered) && ((Handle->type & FSHandleTypeMask) != FSHandleTypeRead) && (IOVecCount <= IOV_MAX))
+    {
+        ssize_t Transferred;
+        while (((Transferred = pwritev(Handle->descriptor, IOVec, (int)IOVecCount, (off_t)Offset)) == -1) && (errno == EINTR));
+        
+        if (Transferred >= 0) Written = (size_t)Transferred;
+        else Result = FSOperationFailure;
+    }
+    
+    else
+#endif
+    {
+        for (size_t Loop = 0; Loop < IOVecCount; Loop++)
+        {
+            Result = FSHandleWriteFromOffset(Handle, Offset + Written, IOVec[Loop].iov_len, IOVec[Loop].iov_base, FSBehaviourPreserveOffset);
+            if (Result != FSOperationSuccess) break;
+            
+            Written += IOVec[Loop].iov_len;
+        }
+    }
+    
+    if (Count) *Count = Written;
+    
+    if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) FSHandleSetOffset(Handle, Offset + Written);
+    
+    return Result;
+}
+
+#endif
@@ -30,17 +30,40 @@
 #include <CommonC/Path.h>
 #include <CommonC/FileSystem.h>
 
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <sys/uio.h>
+#endif
+
 
 typedef enum {
     FSHandleTypeRead,
     FSHandleTypeWrite,
-    FSHandleTypeUpdate
+    FSHandleTypeUpdate,
+    FSHandleTypeMask = 0xff,
+    
+    /*
+     Access the file descriptor directly (POSIX only). No buffering is performed, and reading or
+     writing from an offset uses positional I/O, so it neither depends on nor changes the offset
+     of the handle (unless requested by the behaviour). Multiple threads may read or write from
+     independent offsets of the same handle.
+     */
+    FSHandleTypeUnbuffered = (1 << 8),
+    
+    /*
+     Bypass the system's file cache (O_DIRECT or F_NOCACHE). Implies FSHandleTypeUnbuffered.
+     Buffers, offsets and sizes that are not aligned to FSHandleGetAlignment are staged through
+     an aligned buffer.
+     */
+    FSHandleTypeDirect = (1 << 9) | FSHandleTypeUnbuffered
 } FSHandleType;
 
 typedef struct {
     FSHandleType type;
     FSPath path;
     void *handle;
+    int descriptor;
+    size_t offset;
+    size_t alignment;
 } FSHandleInfo, *FSHandle;
 
 typedef enum {
@@ -174,7 +197,48 @@ size_t FSHandleGetOffset(FSHandle Handle);
  */
 FSOperation FSHandleSetOffset(FSHandle Handle, size_t Offset);
 
+/*!
+ * @brief Get the required alignment of buffers, offsets and sizes to avoid staging I/O.
+ * @param Handle The file handle.
+ * @return The alignment, 1 if there is no requirement.
+ */
+size_t FSHandleGetAlignment(FSHandle Handle);
+
 #if CC_PLATFORM_POSIX_COMPLIANT
+/*!
+ * @brief Read the data at an offset from the file into multiple buffers.
+ * @description Uses a single vectored positional read when the handle is unbuffered.
+ * @param Handle The file handle.
+ * @param Offset The offset to begin reading from.
+ * @param IOVec The buffers to read into, in order.
+ * @param IOVecCount The number of buffers.
+ * @param Count A pointer to where the amount of data actually read should be stored. May
+ *        be NULL.
+ *
+ * @param Behaviour The behaviour of the operation.
+ * @return FSOperationSuccess if it successfully reads from the file handle. Otherwise the
+ *         type of failure.
+ */
+FSOperation FSHandleReadVectorFromOffset(FSHandle Handle, size_t Offset, const struct iovec *IOVec, size_t IOVecCount, size_t *Count, FSBehaviour Behaviour);
+
+/*!
+ * @brief Write the data from multiple buffers at an offset in the file.
+ * @description Uses a single vectored positional write when the handle is unbuffered. Only
+ *              supports @b FSWritingBehaviourOverwrite.
+ *
+ * @param Handle The file handle.
+ * @param Offset The offset to begin writing to.
+ * @param IOVec The buffers to be written, in order.
+ * @param IOVecCount The number of buffers.
+ * @param Count A pointer to where the amount of data actually written should be stored. May
+ *        be NULL.
+ *
+ * @param Behaviour The behaviour of the operation.
+ * @return FSOperationSuccess if it successfully writes to the file handle. Otherwise the
+ *         type of failure.
+ */
+FSOperation FSHandleWriteVectorFromOffset(FSHandle Handle, size_t Offset, const struct iovec *IOVec, size_t IOVecCount, size_t *Count, FSBehaviour Behaviour);
+
 /*!
  * @brief Get the POSIX file descriptor for the file.
  * @warning This function is only available on POSIX compliant systems. Check @b CC_PLATFORM_POSIX_COMPLIANT
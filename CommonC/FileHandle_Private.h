@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_FileHandle_Private_h
+#define CommonC_FileHandle_Private_h
+
+#include "FileHandle.h"
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+//Implementation of FSHandleTypeUnbuffered handles, shared by the platform specific implementations.
+FSOperation FSHandleDescriptorOpen(FSPath Path, const char *SystemPath, FSHandleType Type, FSHandle *Handle);
+FSOperation FSHandleDescriptorOpenFailure(FSPath Path);
+_Bool FSHandleDescriptorMatchesPath(int Descriptor, FSPath Path);
+FSOperation FSHandleDescriptorClose(FSHandle Handle);
+FSOperation FSHandleDescriptorSync(FSHandle Handle);
+FSOperation FSHandleDescriptorReadFromOffset(FSHandle Handle, size_t Offset, size_t *Count, void *Data, FSBehaviour Behaviour);
+FSOperation FSHandleDescriptorWriteFromOffset(FSHandle Handle, size_t Offset, size_t Count, const void *Data, FSBehaviour Behaviour);
+FSOperation FSHandleDescriptorRemoveFromOffset(FSHandle Handle, size_t Offset, size_t Count, FSBehaviour Behaviour);
+
+//An unbuffered view of a buffered handle's file descriptor, so buffered handles can share the descriptor
+//implementation of insertions and removals. Any buffered writes must be flushed before it is used.
+static inline FSHandleInfo FSHandleDescriptorView(FSHandle Handle)
+{
+    return (FSHandleInfo){
+        .type = FSHandleTypeUpdate | FSHandleTypeUnbuffered,
+        .path = Handle->path,
+        .handle = NULL,
+        .descriptor = FSHandleGetFileDescriptor(Handle),
+        .offset = 0,
+        .alignment = 1
+    };
+}
+#endif
+
+#endif
@@ -0,0 +1,698 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FileIOQueue.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "Logging.h"
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#ifndef CC_FILE_IO_QUEUE_IO_URING
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define CC_FILE_IO_QUEUE_IO_URING 1
+#endif
+#endif
+#endif
+#endif
+
+#if CC_FILE_IO_QUEUE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#endif
+
+#ifndef CC_FILE_IO_QUEUE_WORKERS_PER_PROCESSOR
+#define CC_FILE_IO_QUEUE_WORKERS_PER_PROCESSOR 4
+#endif
+
+#if CC_FILE_IO_QUEUE_IO_URING
+typedef struct {
+    int descriptor;
+    struct {
+        void *ring;
+        size_t size;
+        _Atomic(unsigned) *head, *tail;
+        unsigned *mask, *array;
+        struct io_uring_sqe *entries;
+        size_t entriesSize;
+        unsigned local;
+    } submission;
+    struct {
+        void *ring;
+        size_t size;
+        _Atomic(unsigned) *head, *tail;
+        unsigned *mask;
+        struct io_uring_cqe *entries;
+    } completion;
+    _Atomic(size_t) accepted; //entries the kernel has consumed, as opposed to those reserved but not yet submitted
+    size_t reaped; //guarded by the completion lock
+} FSIOQueueRing;
+#endif
+
+typedef struct {
+    pthread_t *threads;
+    size_t count;
+    FSIORequest **requests;
+    size_t head, pending;
+    pthread_cond_t available;
+    _Bool shutdown;
+} FSIOQueueWorkers;
+
+typedef struct FSIOQueueInfo {
+    CCAllocatorType allocator;
+    FSIOQueueBackend backend;
+    size_t depth;
+    _Atomic(size_t) inflight;
+    pthread_mutex_t submissionLock, completionLock;
+    union {
+        FSIOQueueWorkers workers;
+#if CC_FILE_IO_QUEUE_IO_URING
+        FSIOQueueRing ring;
+#endif
+    };
+    struct {
+        FSIORequest *head, *tail;
+        pthread_cond_t available;
+    } completed;
+} FSIOQueueInfo;
+
+
+static void FSIOQueueFinish(FSIORequest *Request, ssize_t Result)
+{
+    if (Result >= 0)
+    {
+        Request->result = FSOperationSuccess;
+        Request->transferred = Request->type == FSIORequestTypeSync ? 0 : (size_t)Result;
+        Request->error = 0;
+    }
+    
+    else
+    {
+        Request->result = FSOperationFailure;
+        Request->transferred = 0;
+        Request->error = (int)-Result;
+    }
+    
+    if (Request->completion) Request->completion(Request);
+    
+    CCTask Task = Request->task;
+    CCTaskQueue TaskQueue = Request->taskQueue;
+    Request->task = NULL;
+    
+    //The request may be released by another thread as soon as it is marked as finished
+    atomic_store_explicit(&Request->state.finished, TRUE, memory_order_release);
+    
+    if (Task) CCTaskQueuePush(TaskQueue ? TaskQueue : CCTaskQueueDefault(), Task);
+}
+
+static void FSIOQueuePrepare(FSIORequest *Request)
+{
+    CCAssertLog(Request->handle, "Request handle must not be null");
+    CCAssertLog((Request->type == FSIORequestTypeSync) || (Request->buffer) || (!Request->size), "Request buffer must not be null");
+    CCAssertLog(!((Request->offset | Request->size | (uintptr_t)Request->buffer) & (FSHandleGetAlignment(Request->handle) - 1)), "Request must be aligned to the handle's alignment");
+    
+    Request->state.next = NULL;
+    Request->state.vector = (struct iovec){ .iov_base = Request->buffer, .iov_len = Request->size };
+    atomic_store_explicit(&Request->state.finished, FALSE, memory_order_relaxed);
+}
+
+#pragma mark - Thread Pool
+
+static ssize_t FSIOQueuePerform(FSIORequest *Request)
+{
+    const int Descriptor = FSHandleGetFileDescriptor(Request->handle);
+    
+    if (Request->type == FSIORequestTypeSync) return fsync(Descriptor) ? -errno : 0;
+    
+    size_t Total = 0;
+    while (Total < Request->size)
+    {
+        const ssize_t Result = Request->type == FSIORequestTypeRead ? pread(Descriptor, Request->buffer + Total, Request->size - Total, (off_t)(Request->offset + Total)) : pwrite(Descriptor, Request->buffer + Total, Request->size - Total, (off_t)(Request->offset + Total));
+        
+        if (Result > 0) Total += (size_t)Result;
+        else if (Result == 0) break;
+        else if (errno != EINTR) return Total ? (ssize_t)Total : -errno;
+    }
+    
+    return (ssize_t)Total;
+}
+
+static void FSIOQueueComplete(FSIOQueue Queue, FSIORequest *Request, ssize_t Result)
+{
+    //The result is stashed in the transferred field until the request is polled
+    Request->transferred = (size_t)Result;
+    
+    pthread_mutex_lock(&Queue->completionLock);
+    
+    if (Queue->completed.tail) Queue->completed.tail->state.next = Request;
+    else Queue->completed.head = Request;
+    
+    Queue->completed.tail = Request;
+    
+    pthread_cond_broadcast(&Queue->completed.available);
+    pthread_mutex_unlock(&Queue->completionLock);
+}
+
+static void *FSIOQueueWorker(FSIOQueue Queue)
+{
+    for ( ; ; )
+    {
+        pthread_mutex_lock(&Queue->submissionLock);
+        
+        while ((!Queue->workers.pending) && (!Queue->workers.shutdown)) pthread_cond_wait(&Queue->workers.available, &Queue->submissionLock);
+        
+        if (!Queue->workers.pending)
+        {
+            pthread_mutex_unlock(&Queue->submissionLock);
+            break;
+        }
+        
+        FSIORequest *Request = Queue->workers.requests[Queue->workers.head];
+        Queue->workers.head = (Queue->workers.head + 1) % Queue->depth;
+        Queue->workers.pending--;
+        
+        pthread_mutex_unlock(&Queue->submissionLock);
+        
+        FSIOQueueComplete(Queue, Request, FSIOQueuePerform(Request));
+    }
+    
+    return NULL;
+}
+
+static _Bool FSIOQueueWorkersCreate(FSIOQueue Queue, size_t Workers)
+{
+    if (!Workers)
+    {
+        //Workers spend most of their time blocked on the disk, so the processors are oversubscribed
+        const long Processors = sysconf(_SC_NPROCESSORS_ONLN);
+        Workers = (Processors > 0 ? (size_t)Processors : 1) * CC_FILE_IO_QUEUE_WORKERS_PER_PROCESSOR;
+    }
+    
+    if (Workers > Queue->depth) Workers = Queue->depth;
+    
+    Queue->workers = (FSIOQueueWorkers){
+        .threads = CCMalloc(Queue->allocator, sizeof(pthread_t) * Workers, NULL, CC_DEFAULT_ERROR_CALLBACK),
+        .count = 0,
+        .requests = CCMalloc(Queue->allocator, sizeof(FSIORequest*) * Queue->depth, NULL, CC_DEFAULT_ERROR_CALLBACK),
+        .head = 0,
+        .pending = 0,
+        .shutdown = FALSE
+    };
+    
+    if ((!Queue->workers.threads) || (!Queue->workers.requests) || (pthread_cond_init(&Queue->workers.available, NULL)))
+    {
+        if (Queue->workers.threads) CCFree(Queue->workers.threads);
+        if (Queue->workers.requests) CCFree(Queue->workers.requests);
+        
+        return FALSE;
+    }
+    
+    for ( ; Queue->workers.count < Workers; Queue->workers.count++)
+    {
+        if (pthread_create(Queue->workers.threads + Queue->workers.count, NULL, (void*(*)(void*))FSIOQueueWorker, Queue)) break;
+    }
+    
+    if (!Queue->workers.count)
+    {
+        pthread_cond_destroy(&Queue->workers.available);
+        CCFree(Queue->workers.threads);
+        CCFree(Queue->workers.requests);
+        
+        return FALSE;
+    }
+    
+    return TRUE;
+}
+
+static void FSIOQueueWorkersDestroy(FSIOQueue Queue)
+{
+    pthread_mutex_lock(&Queue->submissionLock);
+    Queue->workers.shutdown = TRUE;
+    pthread_cond_broadcast(&Queue->workers.available);
+    pthread_mutex_unlock(&Queue->submissionLock);
+    
+    for (size_t Loop = 0; Loop < Queue->workers.count; Loop++) pthread_join(Queue->workers.threads[Loop], NULL);
+    
+    pthread_cond_destroy(&Queue->workers.available);
+    CCFree(Queue->workers.threads);
+    CCFree(Queue->workers.requests);
+}
+
+static size_t FSIOQueueWorkersSubmit(FSIOQueue Queue, FSIORequest **Requests, size_t Count)
+{
+    pthread_mutex_lock(&Queue->submissionLock);
+    
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        Queue->workers.requests[(Queue->workers.head + Queue->workers.pending++) % Queue->depth] = Requests[Loop];
+    }
+    
+    if (Count == 1) pthread_cond_signal(&Queue->workers.available);
+    else pthread_cond_broadcast(&Queue->workers.available);
+    
+    pthread_mutex_unlock(&Queue->submissionLock);
+    
+    return Count;
+}
+
+static size_t FSIOQueueWorkersPoll(FSIOQueue Queue, size_t Wait)
+{
+    size_t Completed = 0;
+    do {
+        pthread_mutex_lock(&Queue->completionLock);
+        
+        //Stop waiting if the outstanding requests have been claimed by another thread
+        while ((Completed < Wait) && (!Queue->completed.head) && (atomic_load_explicit(&Queue->inflight, memory_order_relaxed))) pthread_cond_wait(&Queue->completed.available, &Queue->completionLock);
+        
+        FSIORequest *Request = Queue->completed.head;
+        Queue->completed.head = NULL;
+        Queue->completed.tail = NULL;
+        
+        size_t Count = 0;
+        for (FSIORequest *Next = Request; Next; Next = Next->state.next) Count++;
+        
+        atomic_fetch_sub_explicit(&Queue->inflight, Count, memory_order_relaxed);
+        
+        pthread_mutex_unlock(&Queue->completionLock);
+        
+        if (!Request) break;
+        
+        while (Request)
+        {
+            FSIORequest *Next = Request->state.next;
+            FSIOQueueFinish(Request, (ssize_t)Request->transferred);
+            Request = Next;
+        }
+        
+        Completed += Count;
+    } while (Completed < Wait);
+    
+    return Completed;
+}
+
+#if CC_FILE_IO_QUEUE_IO_URING
+#pragma mark - io_uring
+
+static _Bool FSIOQueueRingCreate(FSIOQueue Queue)
+{
+    struct io_uring_params Params = { 0 };
+    
+    const int Descriptor = (int)syscall(__NR_io_uring_setup, (unsigned)Queue->depth, &Params);
+    if (Descriptor == -1) return FALSE; //Kernel does not support io_uring or it has been disabled
+    
+    FSIOQueueRing *Ring = &Queue->ring;
+    *Ring = (FSIOQueueRing){ .descriptor = Descriptor, .reaped = 0 };
+    atomic_init(&Ring->accepted, 0);
+    
+    Ring->submission.size = Params.sq_off.array + (Params.sq_entries * sizeof(unsigned));
+    Ring->completion.size = Params.cq_off.cqes + (Params.cq_entries * sizeof(struct io_uring_cqe));
+    
+    if (Params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (Ring->completion.size > Ring->submission.size) Ring->submission.size = Ring->completion.size;
+    }
+    
+    Ring->submission.ring = mmap(NULL, Ring->submission.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Descriptor, IORING_OFF_SQ_RING);
+    if (Ring->submission.ring == MAP_FAILED)
+    {
+        close(Descriptor);
+        return FALSE;
+    }
+    
+    if (Params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        Ring->completion.ring = Ring->submission.ring;
+        Ring->completion.size = 0;
+    }
+    
+    else
+    {
+        Ring->completion.ring = mmap(NULL, Ring->completion.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Descriptor, IORING_OFF_CQ_RING);
+        if (Ring->completion.ring == MAP_FAILED)
+        {
+            munmap(Ring->submission.ring, Ring->submission.size);
+            close(Descriptor);
+            return FALSE;
+        }
+    }
+    
+    Ring->submission.entriesSize = Params.sq_entries * sizeof(struct io_uring_sqe);
+    Ring->submission.entries = mmap(NULL, Ring->submission.entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Descriptor, IORING_OFF_SQES);
+    if (Ring->submission.entries == MAP_FAILED)
+    {
+        if (Ring->completion.size) munmap(Ring->completion.ring, Ring->completion.size);
+        munmap(Ring->submission.ring, Ring->submission.size);
+        close(Descriptor);
+        return FALSE;
+    }
+    
+    Ring->submission.head = Ring->submission.ring + Params.sq_off.head;
+    Ring->submission.tail = Ring->submission.ring + Params.sq_off.tail;
+    Ring->submission.mask = Ring->submission.ring + Params.sq_off.ring_mask;
+    Ring->submission.array = Ring->submission.ring + Params.sq_off.array;
+    Ring->submission.local = atomic_load_explicit(Ring->submission.tail, memory_order_relaxed);
+    
+    Ring->completion.head = Ring->completion.ring + Params.cq_off.head;
+    Ring->completion.tail = Ring->completion.ring + Params.cq_off.tail;
+    Ring->completion.mask = Ring->completion.ring + Params.cq_off.ring_mask;
+    Ring->completion.entries = Ring->completion.ring + Params.cq_off.cqes;
+    
+    //The queue never has more requests in flight than the depth, so the completion ring cannot overflow
+    if (Params.sq_entries < Queue->depth) Queue->depth = Params.sq_entries;
+    
+    return TRUE;
+}
+
+static void FSIOQueueRingDestroy(FSIOQueue Queue)
+{
+    FSIOQueueRing *Ring = &Queue->ring;
+    
+    munmap(Ring->submission.entries, Ring->submission.entriesSize);
+    if (Ring->completion.size) munmap(Ring->completion.ring, Ring->completion.size);
+    munmap(Ring->submission.ring, Ring->submission.size);
+    close(Ring->descriptor);
+}
+
+static size_t FSIOQueueRingSubmit(FSIOQueue Queue, FSIORequest **Requests, size_t Count)
+{
+    FSIOQueueRing *Ring = &Queue->ring;
+    
+    pthread_mutex_lock(&Queue->submissionLock);
+    
+    const unsigned Mask = *Ring->submission.mask, Tail = Ring->submission.local;
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        const unsigned Index = (Tail + (unsigned)Loop) & Mask;
+        FSIORequest *Request = Requests[Loop];
+        
+        struct io_uring_sqe *Entry = &Ring->submission.entries[Index];
+        memset(Entry, 0, sizeof(*Entry));
+        
+        Entry->fd = FSHandleGetFileDescriptor(Request->handle);
+        Entry->user_data = (uintptr_t)Request;
+        
+        switch (Request->type)
+        {
+            case FSIORequestTypeRead:
+            case FSIORequestTypeWrite:
+                Entry->opcode = Request->type == FSIORequestTypeRead ? IORING_OP_READV : IORING_OP_WRITEV;
+                Entry->addr = (uintptr_t)&Request->state.vector;
+                Entry->len = 1;
+                Entry->off = Request->offset;
+                break;
+                
+            case FSIORequestTypeSync:
+                Entry->opcode = IORING_OP_FSYNC;
+                break;
+        }
+        
+        Ring->submission.array[Index] = Index;
+    }
+    
+    atomic_store_explicit(Ring->submission.tail, Tail + (unsigned)Count, memory_order_release);
+    
+    int Submitted;
+    while (((Submitted = (int)syscall(__NR_io_uring_enter, Ring->descriptor, (unsigned)Count, 0, 0, NULL, 0)) == -1) && (errno == EINTR));
+    
+    if (Submitted < 0) Submitted = 0;
+    
+    //Entries the kernel did not consume are withdrawn, so the caller can resubmit them later
+    Ring->submission.local = Tail + (unsigned)Submitted;
+    if ((size_t)Submitted != Count) atomic_store_explicit(Ring->submission.tail, Ring->submission.local, memory_order_release);
+    
+    atomic_fetch_add_explicit(&Ring->accepted, (size_t)Submitted, memory_order_release);
+    
+    pthread_mutex_unlock(&Queue->submissionLock);
+    
+    return (size_t)Submitted;
+}
+
+static size_t FSIOQueueRingPoll(FSIOQueue Queue, size_t Wait)
+{
+    FSIOQueueRing *Ring = &Queue->ring;
+    
+    size_t Completed = 0;
+    
+    pthread_mutex_lock(&Queue->completionLock);
+    
+    for ( ; ; )
+    {
+        unsigned Head = atomic_load_explicit(Ring->completion.head, memory_order_relaxed);
+        const unsigned Tail = atomic_load_explicit(Ring->completion.tail, memory_order_acquire), Mask = *Ring->completion.mask;
+        
+        for ( ; Head != Tail; Head++)
+        {
+            const struct io_uring_cqe *Entry = &Ring->completion.entries[Head & Mask];
+            
+            FSIORequest *Request = (FSIORequest*)(uintptr_t)Entry->user_data;
+            Request->transferred = (size_t)(ssize_t)Entry->res;
+            
+            //Chain the requests to be finished after the completion ring has been released
+            Request->state.next = Queue->completed.head;
+            Queue->completed.head = Request;
+            Completed++;
+            Ring->reaped++;
+            
+            atomic_fetch_sub_explicit(&Queue->inflight, 1, memory_order_relaxed);
+        }
+        
+        atomic_store_explicit(Ring->completion.head, Head, memory_order_release);
+        
+        if (Completed >= Wait) break;
+        
+        /*
+         Only wait on requests the kernel has accepted, as reserved entries may still be withdrawn by a failed
+         submission and would never complete. A request can be reaped before its submitter has counted it as
+         accepted, in which case there is nothing known to be outstanding.
+         */
+        const size_t Accepted = atomic_load_explicit(&Ring->accepted, memory_order_acquire);
+        if ((ptrdiff_t)(Accepted - Ring->reaped) <= 0) break;
+        
+        size_t Outstanding = Accepted - Ring->reaped;
+        if (Outstanding > (Wait - Completed)) Outstanding = Wait - Completed;
+        
+        int Result;
+        while (((Result = (int)syscall(__NR_io_uring_enter, Ring->descriptor, 0, (unsigned)Outstanding, IORING_ENTER_GETEVENTS, NULL, 0)) == -1) && (errno == EINTR));
+        
+        if (Result == -1)
+        {
+            CC_LOG_ERROR("Failed to wait for file I/O completions due to io_uring_enter failing (%d)", errno);
+            break;
+        }
+    }
+    
+    FSIORequest *Request = Queue->completed.head;
+    Queue->completed.head = NULL;
+    
+    pthread_mutex_unlock(&Queue->completionLock);
+    
+    while (Request)
+    {
+        FSIORequest *Next = Request->state.next;
+        FSIOQueueFinish(Request, (ssize_t)Request->transferred);
+        Request = Next;
+    }
+    
+    return Completed;
+}
+#endif
+
+#pragma mark - Queue
+
+static void FSIOQueueDestructor(FSIOQueue Queue)
+{
+    while ((atomic_load_explicit(&Queue->inflight, memory_order_relaxed)) && (FSIOQueuePoll(Queue, 1)));
+    
+    switch (Queue->backend)
+    {
+        case FSIOQueueBackendThreadPool:
+            FSIOQueueWorkersDestroy(Queue);
+            break;
+            
+#if CC_FILE_IO_QUEUE_IO_URING
+        case FSIOQueueBackendIOUring:
+            FSIOQueueRingDestroy(Queue);
+            break;
+#endif
+            
+        default:
+            break;
+    }
+    
+    pthread_cond_destroy(&Queue->completed.available);
+    pthread_mutex_destroy(&Queue->completionLock);
+    pthread_mutex_destroy(&Queue->submissionLock);
+}
+
+FSIOQueue FSIOQueueCreate(CCAllocatorType Allocator, size_t Depth, size_t Workers)
+{
+    CCAssertLog(Depth, "Depth must be at least 1");
+    
+    FSIOQueue Queue = CCMalloc(Allocator, sizeof(FSIOQueueInfo), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    if (Queue)
+    {
+        *Queue = (FSIOQueueInfo){
+            .allocator = Allocator,
+            .backend = FSIOQueueBackendThreadPool,
+            .depth = Depth,
+            .completed = { .head = NULL, .tail = NULL }
+        };
+        
+        atomic_init(&Queue->inflight, 0);
+        
+        pthread_mutex_init(&Queue->submissionLock, NULL);
+        pthread_mutex_init(&Queue->completionLock, NULL);
+        pthread_cond_init(&Queue->completed.available, NULL);
+        
+#if CC_FILE_IO_QUEUE_IO_URING
+        if (FSIOQueueRingCreate(Queue)) Queue->backend = FSIOQueueBackendIOUring;
+        else
+#endif
+        if (!FSIOQueueWorkersCreate(Queue, Workers))
+        {
+            CC_LOG_ERROR("Failed to create file I/O queue due to being unable to start worker threads (%zu)", Workers);
+            
+            pthread_cond_destroy(&Queue->completed.available);
+            pthread_mutex_destroy(&Queue->completionLock);
+            pthread_mutex_destroy(&Queue->submissionLock);
+            CCFree(Queue);
+            
+            return NULL;
+        }
+        
+        CCMemorySetDestructor(Queue, (CCMemoryDestructorCallback)FSIOQueueDestructor);
+    }
+    
+    else CC_LOG_ERROR("Failed to create file I/O queue due to allocation failure. Allocation size (%zu)", sizeof(FSIOQueueInfo));
+    
+    return Queue;
+}
+
+void FSIOQueueDestroy(FSIOQueue Queue)
+{
+    CCAssertLog(Queue, "Queue must not be null");
+    
+    CCFree(Queue);
+}
+
+size_t FSIOQueueSubmit(FSIOQueue Queue, FSIORequest **Requests, size_t Count)
+{
+    CCAssertLog(Queue, "Queue must not be null");
+    CCAssertLog(Requests || !Count, "Requests must not be null");
+    
+    //Reserve the space in the queue
+    size_t Inflight = atomic_load_explicit(&Queue->inflight, memory_order_relaxed), Reserved;
+    do {
+        Reserved = Queue->depth - Inflight;
+        if (Reserved > Count) Reserved = Count;
+        if (!Reserved) return 0;
+    } while (!atomic_compare_exchange_weak_explicit(&Queue->inflight, &Inflight, Inflight + Reserved, memory_order_relaxed, memory_order_relaxed));
+    
+    for (size_t Loop = 0; Loop < Reserved; Loop++) FSIOQueuePrepare(Requests[Loop]);
+    
+    size_t Submitted = 0;
+    switch (Queue->backend)
+    {
+        case FSIOQueueBackendThreadPool:
+            Submitted = FSIOQueueWorkersSubmit(Queue, Requests, Reserved);
+            break;
+            
+#if CC_FILE_IO_QUEUE_IO_URING
+        case FSIOQueueBackendIOUring:
+            Submitted = FSIOQueueRingSubmit(Queue, Requests, Reserved);
+            break;
+#endif
+            
+        default:
+            break;
+    }
+    
+    if (Submitted != Reserved) atomic_fetch_sub_explicit(&Queue->inflight, Reserved - Submitted, memory_order_relaxed);
+    
+    return Submitted;
+}
+
+size_t FSIOQueuePoll(FSIOQueue Queue, size_t Wait)
+{
+    CCAssertLog(Queue, "Queue must not be null");
+    
+    const size_t Inflight = atomic_load_explicit(&Queue->inflight, memory_order_relaxed);
+    if (Wait > Inflight) Wait = Inflight;
+    
+    switch (Queue->backend)
+    {
+        case FSIOQueueBackendThreadPool:
+            return FSIOQueueWorkersPoll(Queue, Wait);
+            
+#if CC_FILE_IO_QUEUE_IO_URING
+        case FSIOQueueBackendIOUring:
+            return FSIOQueueRingPoll(Queue, Wait);
+#endif
+            
+        default:
+            break;
+    }
+    
+    return 0;
+}
+
+void FSIOQueueWait(FSIOQueue Queue, FSIORequest *Request)
+{
+    CCAssertLog(Queue, "Queue must not be null");
+    CCAssertLog(Request, "Request must not be null");
+    
+    while (!FSIORequestIsFinished(Request))
+    {
+        //Another thread may be processing the completion
+        if (!FSIOQueuePoll(Queue, 1)) sched_yield();
+    }
+}
+
+size_t FSIOQueueGetPendingCount(FSIOQueue Queue)
+{
+    CCAssertLog(Queue, "Queue must not be null");
+    
+    return atomic_load_explicit(&Queue->inflight, memory_order_relaxed);
+}
+
+FSIOQueueBackend FSIOQueueGetBackend(FSIOQueue Queue)
+{
+    CCAssertLog(Queue, "Queue must not be null");
+    
+    return Queue->backend;
+}
+
+#endif
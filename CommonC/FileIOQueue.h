@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_FileIOQueue_h
+#define CommonC_FileIOQueue_h
+
+#include <CommonC/Base.h>
+#include <CommonC/Platform.h>
+#include <CommonC/FileHandle.h>
+#include <CommonC/Task.h>
+#include <CommonC/TaskQueue.h>
+#include <stdatomic.h>
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+
+/*!
+ * @brief The operation to be performed by a request.
+ */
+typedef enum {
+    /// Read @b size bytes from @b offset of the file into @b buffer.
+    FSIORequestTypeRead,
+    /// Write @b size bytes from @b buffer to @b offset of the file.
+    FSIORequestTypeWrite,
+    /// Synchronize the file to disk.
+    FSIORequestTypeSync
+} FSIORequestType;
+
+/*!
+ * @brief The backend used to perform the requests.
+ */
+typedef enum {
+    /// Requests are performed by a pool of worker threads using pread/pwrite.
+    FSIOQueueBackendThreadPool,
+    /// Requests are submitted to the kernel using io_uring.
+    FSIOQueueBackendIOUring
+} FSIOQueueBackend;
+
+typedef struct FSIORequest FSIORequest;
+
+/*!
+ * @brief The callback to be invoked when a request has completed.
+ * @description This is called from the thread that is polling the queue.
+ * @param Request The request that has completed.
+ */
+typedef void (*FSIOCompletion)(FSIORequest *Request);
+
+/*!
+ * @brief An asynchronous file operation.
+ * @description The request is owned by the caller and must remain valid (along with its buffer)
+ *              until it has finished. It may be reused once finished.
+ */
+struct FSIORequest {
+    ///The operation to perform.
+    FSIORequestType type;
+    ///The file handle to perform the operation on. Its file descriptor is accessed directly, so
+    ///it should be opened with @b FSHandleTypeUnbuffered. For @b FSHandleTypeDirect handles
+    ///the offset, size and buffer must be aligned to @b FSHandleGetAlignment.
+    FSHandle handle;
+    ///The offset in the file. Requests never use or change the offset of the handle.
+    size_t offset;
+    ///The number of bytes to transfer.
+    size_t size;
+    ///The buffer to transfer to or from.
+    void *buffer;
+    ///An optional callback to be invoked on completion.
+    FSIOCompletion completion;
+    ///A value reserved for the caller.
+    void *context;
+    ///An optional task to be pushed to @b taskQueue (or @b CCTaskQueueDefault if NULL) once the
+    ///request has finished. Ownership of the task is taken by the request.
+    CCTask task;
+    ///The task queue the task is pushed to.
+    CCTaskQueue taskQueue;
+    ///The result of the operation.
+    FSOperation result;
+    ///The number of bytes transferred. This may be less than the requested size if the end of
+    ///the file was reached.
+    size_t transferred;
+    ///The errno of the failed operation, or 0 on success.
+    int error;
+    ///Internal state.
+    struct {
+        FSIORequest *next;
+        struct iovec vector;
+        _Atomic(_Bool) finished;
+    } state;
+};
+
+/*!
+ * @brief A queue of asynchronous file operations.
+ * @description Submission and polling may be performed from any threads.
+ */
+typedef struct FSIOQueueInfo *FSIOQueue;
+
+#pragma mark - Creation / Destruction
+/*!
+ * @brief Create an asynchronous file operation queue.
+ * @description Uses io_uring where available, otherwise falls back to a pool of worker threads.
+ * @param Allocator The allocator to be used for the allocation.
+ * @param Depth The maximum number of requests that may be in flight at once.
+ * @param Workers The number of worker threads to use if falling back to a thread pool, or 0
+ *        to use several per online processor. No more than @p Depth workers are used.
+ *
+ * @return An asynchronous file operation queue, or NULL on failure. Must be destroyed to free
+ *         the memory.
+ */
+CC_NEW FSIOQueue FSIOQueueCreate(CCAllocatorType Allocator, size_t Depth, size_t Workers);
+
+/*!
+ * @brief Destroy an asynchronous file operation queue.
+ * @description Waits for any requests still in flight to complete, invoking their completions.
+ * @param Queue The queue to be destroyed.
+ */
+void FSIOQueueDestroy(FSIOQueue CC_DESTROY(Queue));
+
+#pragma mark - Submission / Completion
+/*!
+ * @brief Submit a batch of requests.
+ * @description The batch is submitted with a single system call when using io_uring.
+ * @param Queue The queue to submit the requests to.
+ * @param Requests The requests to be submitted.
+ * @param Count The number of requests.
+ * @return The number of requests that were submitted. This will be less than @p Count if
+ *         the queue is full, in which case the remaining requests should be submitted again
+ *         after polling.
+ */
+size_t FSIOQueueSubmit(FSIOQueue Queue, FSIORequest **Requests, size_t Count);
+
+/*!
+ * @brief Process completed requests.
+ * @description Sets the results of the completed requests, invokes their completion callbacks
+ *              and pushes their tasks.
+ *
+ * @param Queue The queue to process the completed requests of.
+ * @param Wait The minimum number of requests to wait for, or 0 to not block. This is limited
+ *        to the number of requests in flight.
+ *
+ * @return The number of requests that were completed.
+ */
+size_t FSIOQueuePoll(FSIOQueue Queue, size_t Wait);
+
+/*!
+ * @brief Wait for a request to finish.
+ * @description Completions of other requests may be processed while waiting.
+ * @param Queue The queue the request was submitted to.
+ * @param Request The request to wait for.
+ */
+void FSIOQueueWait(FSIOQueue Queue, FSIORequest *Request);
+
+#pragma mark - Query Info
+/*!
+ * @brief Get the number of requests in flight.
+ * @param Queue The queue.
+ * @return The number of requests that have been submitted but not yet completed.
+ */
+size_t FSIOQueueGetPendingCount(FSIOQueue Queue);
+
+/*!
+ * @brief Get the backend the queue is using.
+ * @param Queue The queue.
+ * @return The backend.
+ */
+FSIOQueueBackend FSIOQueueGetBackend(FSIOQueue Queue);
+
+/*!
+ * @brief Check if the request has finished.
+ * @description This does not block.
+ * @param Request The request.
+ * @return TRUE if the request has completed and its completion has been invoked, otherwise FALSE.
+ */
+static inline _Bool FSIORequestIsFinished(const FSIORequest *Request);
+
+#pragma mark -
+
+static inline _Bool FSIORequestIsFinished(const FSIORequest *Request)
+{
+    return atomic_load_explicit(&((FSIORequest*)Request)->state.finished, memory_order_acquire);
+}
+
+#endif
+
+#endif
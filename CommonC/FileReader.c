@@ -0,0 +1,450 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FileReader.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "Logging.h"
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <pthread.h>
+#include <string.h>
+
+#ifndef CC_FILE_READER_SIZE
+#define CC_FILE_READER_SIZE 65536
+#endif
+
+#ifndef CC_FILE_READER_HEADROOM
+#define CC_FILE_READER_HEADROOM 4096
+#endif
+
+//Buffers are allocated with an extra byte after the capacity, so the data can always be null terminated and the byte
+//following a view is always readable.
+typedef struct {
+    char *data;
+    size_t capacity;
+} FSReaderBuffer;
+
+typedef struct FSReaderInfo {
+    CCAllocatorType allocator;
+    FSHandle handle;
+    size_t size;
+    FSReaderBuffer buffer;
+    size_t start, end, scanned;
+    _Bool retained, exhausted;
+    FSOperation result;
+    struct {
+        _Bool enabled;
+        pthread_t thread;
+        pthread_mutex_t lock;
+        pthread_cond_t changed;
+        //The chunk is read into the buffer after CC_FILE_READER_HEADROOM, so the partial line or record
+        //at the end of the current buffer can be placed in front of it.
+        FSReaderBuffer buffer;
+        size_t count;
+        FSOperation result;
+        _Bool requested, ready, shutdown;
+    } readAhead;
+} FSReaderInfo;
+
+
+static void FSReaderSetFailed(FSReader Reader)
+{
+    Reader->result = FSOperationFailure;
+    Reader->exhausted = TRUE;
+}
+
+static _Bool FSReaderReplaceBuffer(FSReader Reader, size_t Capacity, size_t Offset)
+{
+    const size_t Remaining = Reader->end - Reader->start;
+    
+    char *Data = CCMalloc(Reader->allocator, Capacity + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (!Data)
+    {
+        CC_LOG_ERROR("Failed to grow reader buffer due to allocation failure. Allocation size (%zu)", Capacity + 1);
+        return FALSE;
+    }
+    
+    memcpy(Data + Offset, Reader->buffer.data + Reader->start, Remaining);
+    CCFree(Reader->buffer.data);
+    
+    Reader->buffer = (FSReaderBuffer){ .data = Data, .capacity = Capacity };
+    Reader->retained = FALSE;
+    Reader->start = Offset;
+    Reader->end = Offset + Remaining;
+    
+    return TRUE;
+}
+
+//Move the unconsumed data to the front of a buffer that can fit it plus Count more bytes. The current buffer is only
+//reused if it has not been retained.
+static _Bool FSReaderCompact(FSReader Reader, size_t Count)
+{
+    const size_t Remaining = Reader->end - Reader->start;
+    
+    if ((Reader->retained) || (Reader->buffer.capacity < (Remaining + Count)))
+    {
+        size_t Capacity = Reader->buffer.capacity * 2;
+        if (Capacity < (Remaining + Count)) Capacity = Remaining + Count;
+        
+        return FSReaderReplaceBuffer(Reader, Capacity, 0);
+    }
+    
+    memmove(Reader->buffer.data, Reader->buffer.data + Reader->start, Remaining);
+    Reader->start = 0;
+    Reader->end = Remaining;
+    
+    return TRUE;
+}
+
+#pragma mark - Read Ahead
+
+static void *FSReaderReadAheadWorker(FSReader Reader)
+{
+    pthread_mutex_lock(&Reader->readAhead.lock);
+    
+    for ( ; ; )
+    {
+        while ((!Reader->readAhead.requested) && (!Reader->readAhead.shutdown)) pthread_cond_wait(&Reader->readAhead.changed, &Reader->readAhead.lock);
+        
+        if (Reader->readAhead.shutdown) break;
+        
+        pthread_mutex_unlock(&Reader->readAhead.lock);
+        
+        size_t Count = Reader->size;
+        const FSOperation Result = FSHandleRead(Reader->handle, &Count, Reader->readAhead.buffer.data + CC_FILE_READER_HEADROOM, FSBehaviourUpdateOffset);
+        
+        pthread_mutex_lock(&Reader->readAhead.lock);
+        
+        Reader->readAhead.count = Count;
+        Reader->readAhead.result = Result;
+        Reader->readAhead.requested = FALSE;
+        Reader->readAhead.ready = TRUE;
+        pthread_cond_broadcast(&Reader->readAhead.changed);
+    }
+    
+    pthread_mutex_unlock(&Reader->readAhead.lock);
+    
+    return NULL;
+}
+
+static void FSReaderReadAheadRequest(FSReader Reader)
+{
+    pthread_mutex_lock(&Reader->readAhead.lock);
+    Reader->readAhead.requested = TRUE;
+    pthread_cond_broadcast(&Reader->readAhead.changed);
+    pthread_mutex_unlock(&Reader->readAhead.lock);
+}
+
+static void FSReaderRefillFromReadAhead(FSReader Reader)
+{
+    pthread_mutex_lock(&Reader->readAhead.lock);
+    
+    while (!Reader->readAhead.ready) pthread_cond_wait(&Reader->readAhead.changed, &Reader->readAhead.lock);
+    
+    Reader->readAhead.ready = FALSE;
+    
+    const size_t Count = Reader->readAhead.count;
+    const FSOperation Result = Reader->readAhead.result;
+    
+    pthread_mutex_unlock(&Reader->readAhead.lock);
+    
+    if (Result != FSOperationSuccess)
+    {
+        FSReaderSetFailed(Reader);
+        return;
+    }
+    
+    const size_t Remaining = Reader->end - Reader->start;
+    char *Chunk = Reader->readAhead.buffer.data + CC_FILE_READER_HEADROOM;
+    
+    if (Remaining <= CC_FILE_READER_HEADROOM)
+    {
+        //Swap the buffers, so the chunk is consumed in place and the current buffer receives the next chunk
+        memcpy(Chunk - Remaining, Reader->buffer.data + Reader->start, Remaining);
+        
+        FSReaderBuffer Previous = Reader->buffer;
+        Reader->buffer = Reader->readAhead.buffer;
+        Reader->start = CC_FILE_READER_HEADROOM - Remaining;
+        Reader->end = CC_FILE_READER_HEADROOM + Count;
+        
+        if (Reader->retained)
+        {
+            CCFree(Previous.data);
+            
+            Previous.capacity = CC_FILE_READER_HEADROOM + Reader->size;
+            Previous.data = CCMalloc(Reader->allocator, Previous.capacity + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+            
+            Reader->retained = FALSE;
+        }
+        
+        Reader->readAhead.buffer = Previous;
+        
+        if (!Previous.data)
+        {
+            CC_LOG_ERROR("Failed to create reader buffer due to allocation failure. Allocation size (%zu)", Previous.capacity + 1);
+            FSReaderSetFailed(Reader);
+            return;
+        }
+    }
+    
+    else
+    {
+        //A long line or record spans the buffers, so join them in the current buffer
+        if (!FSReaderCompact(Reader, Count))
+        {
+            FSReaderSetFailed(Reader);
+            return;
+        }
+        
+        memcpy(Reader->buffer.data + Reader->end, Chunk, Count);
+        Reader->end += Count;
+    }
+    
+    if (Count < Reader->size) Reader->exhausted = TRUE;
+    else FSReaderReadAheadRequest(Reader);
+}
+
+#pragma mark - Reader
+
+static void FSReaderRefill(FSReader Reader)
+{
+    if (Reader->readAhead.enabled) FSReaderRefillFromReadAhead(Reader);
+    else if (!FSReaderCompact(Reader, Reader->size)) FSReaderSetFailed(Reader);
+    else
+    {
+        size_t Count = Reader->size;
+        if (FSHandleRead(Reader->handle, &Count, Reader->buffer.data + Reader->end, FSBehaviourUpdateOffset) != FSOperationSuccess) FSReaderSetFailed(Reader);
+        else
+        {
+            Reader->end += Count;
+            
+            if (Count < Reader->size) Reader->exhausted = TRUE;
+        }
+    }
+    
+    Reader->buffer.data[Reader->end] = 0;
+}
+
+static _Bool FSReaderFill(FSReader Reader, size_t Size)
+{
+    while (((Reader->end - Reader->start) < Size) && (!Reader->exhausted)) FSReaderRefill(Reader);
+    
+    return (Reader->end - Reader->start) >= Size;
+}
+
+static void FSReaderDestructor(FSReader Reader)
+{
+    if (Reader->readAhead.enabled)
+    {
+        pthread_mutex_lock(&Reader->readAhead.lock);
+        Reader->readAhead.shutdown = TRUE;
+        pthread_cond_broadcast(&Reader->readAhead.changed);
+        pthread_mutex_unlock(&Reader->readAhead.lock);
+        
+        pthread_join(Reader->readAhead.thread, NULL);
+        
+        pthread_cond_destroy(&Reader->readAhead.changed);
+        pthread_mutex_destroy(&Reader->readAhead.lock);
+        
+        CC_SAFE_Free(Reader->readAhead.buffer.data);
+    }
+    
+    CC_SAFE_Free(Reader->buffer.data);
+}
+
+FSReader FSReaderCreate(CCAllocatorType Allocator, FSHandle Handle, size_t Size, FSReaderHint Hint)
+{
+    CCAssertLog(Handle, "Handle must not be null");
+    
+    if (!Size) Size = CC_FILE_READER_SIZE;
+    
+    FSReader Reader = CCMalloc(Allocator, sizeof(FSReaderInfo), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    if (Reader)
+    {
+        *Reader = (FSReaderInfo){
+            .allocator = Allocator,
+            .handle = Handle,
+            .size = Size,
+            .buffer = { .data = NULL, .capacity = CC_FILE_READER_HEADROOM + Size },
+            .start = 0,
+            .end = 0,
+            .scanned = 0,
+            .retained = FALSE,
+            .exhausted = FALSE,
+            .result = FSOperationSuccess,
+            .readAhead = { .enabled = FALSE, .buffer = { .data = NULL, .capacity = CC_FILE_READER_HEADROOM + Size } }
+        };
+        
+        Reader->buffer.data = CCMalloc(Allocator, Reader->buffer.capacity + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        if (!Reader->buffer.data)
+        {
+            CC_LOG_ERROR("Failed to create reader due to allocation failure. Allocation size (%zu)", Reader->buffer.capacity + 1);
+            CCFree(Reader);
+            
+            return NULL;
+        }
+        
+        Reader->buffer.data[0] = 0;
+        
+        if (Hint & FSReaderHintReadAhead)
+        {
+            Reader->readAhead.buffer.data = CCMalloc(Allocator, Reader->readAhead.buffer.capacity + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+            
+            if (Reader->readAhead.buffer.data)
+            {
+                pthread_mutex_init(&Reader->readAhead.lock, NULL);
+                pthread_cond_init(&Reader->readAhead.changed, NULL);
+                
+                Reader->readAhead.requested = TRUE;
+                
+                if (!pthread_create(&Reader->readAhead.thread, NULL, (void*(*)(void*))FSReaderReadAheadWorker, Reader)) Reader->readAhead.enabled = TRUE;
+                else
+                {
+                    pthread_cond_destroy(&Reader->readAhead.changed);
+                    pthread_mutex_destroy(&Reader->readAhead.lock);
+                    CC_SAFE_Free(Reader->readAhead.buffer.data);
+                }
+            }
+            
+            //Fallback to reading on the calling thread
+            if (!Reader->readAhead.enabled) CC_LOG_ERROR("Failed to start reader read ahead, falling back to synchronous reads");
+        }
+        
+        CCMemorySetDestructor(Reader, (CCMemoryDestructorCallback)FSReaderDestructor);
+    }
+    
+    else CC_LOG_ERROR("Failed to create reader due to allocation failure. Allocation size (%zu)", sizeof(FSReaderInfo));
+    
+    return Reader;
+}
+
+void FSReaderDestroy(FSReader Reader)
+{
+    CCAssertLog(Reader, "Reader must not be null");
+    
+    CCFree(Reader);
+}
+
+_Bool FSReaderReadDelimited(FSReader Reader, char Delimiter, FSReaderView *View)
+{
+    CCAssertLog(Reader, "Reader must not be null");
+    CCAssertLog(View, "View must not be null");
+    
+    for ( ; ; )
+    {
+        const char *Data = Reader->buffer.data + Reader->start;
+        const size_t Available = Reader->end - Reader->start;
+        
+        //Only scan the bytes that have not been scanned by a previous attempt
+        const char *Found = memchr(Data + Reader->scanned, Delimiter, Available - Reader->scanned);
+        if (Found)
+        {
+            *View = (FSReaderView){ .data = Data, .size = Found - Data };
+            Reader->start += View->size + 1;
+            Reader->scanned = 0;
+            
+            return TRUE;
+        }
+        
+        Reader->scanned = Available;
+        
+        if (Reader->exhausted)
+        {
+            if ((!Available) || (Reader->result != FSOperationSuccess)) return FALSE;
+            
+            *View = (FSReaderView){ .data = Data, .size = Available };
+            Reader->start = Reader->end;
+            Reader->scanned = 0;
+            
+            return TRUE;
+        }
+        
+        FSReaderRefill(Reader);
+    }
+}
+
+_Bool FSReaderReadLine(FSReader Reader, FSReaderView *View)
+{
+    if (!FSReaderReadDelimited(Reader, '\n', View)) return FALSE;
+    
+    if ((View->size) && (View->data[View->size - 1] == '\r')) View->size--;
+    
+    return TRUE;
+}
+
+_Bool FSReaderReadRecord(FSReader Reader, FSReaderRecord Format, FSReaderView *View)
+{
+    CCAssertLog(Reader, "Reader must not be null");
+    CCAssertLog(View, "View must not be null");
+    
+    const size_t Prefix = Format & FSReaderRecordLengthMask;
+    CCAssertLog(Prefix && (Prefix <= FSReaderRecordLength64) && ((Prefix & (Prefix - 1)) == 0), "Format must be a valid length prefix");
+    
+    Reader->scanned = 0;
+    
+    if (!FSReaderFill(Reader, Prefix))
+    {
+        if (Reader->end != Reader->start) Reader->result = FSOperationFailure;
+        
+        return FALSE;
+    }
+    
+    const uint8_t *Bytes = (const uint8_t*)Reader->buffer.data + Reader->start;
+    const _Bool BigEndian = Format & FSReaderRecordBigEndian;
+    
+    uint64_t Length = 0;
+    for (size_t Loop = 0; Loop < Prefix; Loop++) Length |= (uint64_t)Bytes[BigEndian ? (Prefix - 1 - Loop) : Loop] << (Loop * 8);
+    
+    if ((Length > (SIZE_MAX - Prefix)) || (!FSReaderFill(Reader, Prefix + (size_t)Length)))
+    {
+        Reader->result = FSOperationFailure;
+        
+        return FALSE;
+    }
+    
+    *View = (FSReaderView){ .data = Reader->buffer.data + Reader->start + Prefix, .size = (size_t)Length };
+    Reader->start += Prefix + (size_t)Length;
+    
+    return TRUE;
+}
+
+FSOperation FSReaderGetResult(FSReader Reader)
+{
+    CCAssertLog(Reader, "Reader must not be null");
+    
+    return Reader->result;
+}
+
+void *FSReaderRetainBuffer(FSReader Reader)
+{
+    CCAssertLog(Reader, "Reader must not be null");
+    
+    Reader->retained = TRUE;
+    
+    return CCRetain(Reader->buffer.data);
+}
+#endif
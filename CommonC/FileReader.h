@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_FileReader_h
+#define CommonC_FileReader_h
+
+#include <CommonC/Base.h>
+#include <CommonC/Platform.h>
+#include <CommonC/Allocator.h>
+#include <CommonC/FileHandle.h>
+#include <CommonC/CCString.h>
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+
+/*!
+ * @brief The options for a reader.
+ */
+typedef enum {
+    FSReaderHintDefault = 0,
+    /// Read the next chunk of the file on a background thread while the current chunk is being
+    /// consumed.
+    FSReaderHintReadAhead = (1 << 0)
+} FSReaderHint;
+
+/*!
+ * @brief The format of the length prefix of a record.
+ */
+typedef enum {
+    /// An 8-bit length.
+    FSReaderRecordLength8 = 1,
+    /// A 16-bit length.
+    FSReaderRecordLength16 = 2,
+    /// A 32-bit length.
+    FSReaderRecordLength32 = 4,
+    /// A 64-bit length.
+    FSReaderRecordLength64 = 8,
+    FSReaderRecordLengthMask = 0xf,
+    
+    /// The length is stored in little endian byte order.
+    FSReaderRecordLittleEndian = (0 << 4),
+    /// The length is stored in big endian byte order.
+    FSReaderRecordBigEndian = (1 << 4)
+} FSReaderRecord;
+
+/*!
+ * @brief A view into the buffer of a reader.
+ * @description The view is only valid until the next read from the reader, unless the buffer
+ *              has been retained with @b FSReaderRetainBuffer.
+ */
+typedef struct {
+    ///The bytes of the view. This is not null terminated.
+    const char *data;
+    ///The number of bytes in the view.
+    size_t size;
+} FSReaderView;
+
+/*!
+ * @brief A buffered reader of lines and records from a file.
+ * @description Lines and records are returned as views into the reader's buffer, so no copies
+ *              are made unless a line or record crosses the end of the buffer. A reader should
+ *              only be used by one thread at a time.
+ */
+typedef struct FSReaderInfo *FSReader;
+
+#pragma mark - Creation / Destruction
+/*!
+ * @brief Create a reader.
+ * @param Allocator The allocator to be used for the allocations.
+ * @param Handle The file handle to read from. Reading starts at the current offset of the
+ *        handle. The handle must not be used while the reader exists, and must outlive it.
+ *
+ * @param Size The number of bytes to read from the file at a time, or 0 to use a default size.
+ *        Lines or records larger than this will cause the buffer to grow.
+ *
+ * @param Hint The options for the reader.
+ * @return The reader, or NULL on failure. Must be destroyed to free the memory.
+ */
+CC_NEW FSReader FSReaderCreate(CCAllocatorType Allocator, FSHandle Handle, size_t Size, FSReaderHint Hint);
+
+/*!
+ * @brief Destroy a reader.
+ * @description Any retained buffers remain valid until they are freed.
+ * @param Reader The reader to be destroyed.
+ */
+void FSReaderDestroy(FSReader CC_DESTROY(Reader));
+
+#pragma mark - Reading
+/*!
+ * @brief Read up to the next occurrence of a delimiter.
+ * @param Reader The reader.
+ * @param Delimiter The delimiter to read up to. The delimiter is consumed but not included in
+ *        the view.
+ *
+ * @param View A pointer to where the view should be stored.
+ * @return TRUE if a view was read, or FALSE if the end of the file was reached or the read
+ *         failed. The last view in the file may not be followed by a delimiter.
+ */
+_Bool FSReaderReadDelimited(FSReader Reader, char Delimiter, FSReaderView *View);
+
+/*!
+ * @brief Read the next line.
+ * @description Lines may be terminated by either "\n" or "\r\n".
+ * @param Reader The reader.
+ * @param View A pointer to where the view of the line (excluding the line terminator) should
+ *        be stored.
+ *
+ * @return TRUE if a line was read, or FALSE if the end of the file was reached or the read
+ *         failed.
+ */
+_Bool FSReaderReadLine(FSReader Reader, FSReaderView *View);
+
+/*!
+ * @brief Read the next length prefixed record.
+ * @param Reader The reader.
+ * @param Format The format of the length prefix.
+ * @param View A pointer to where the view of the record (excluding the length prefix) should
+ *        be stored.
+ *
+ * @return TRUE if a record was read, or FALSE if the end of the file was reached or the read
+ *         failed. A record that is truncated by the end of the file is a failure.
+ */
+_Bool FSReaderReadRecord(FSReader Reader, FSReaderRecord Format, FSReaderView *View);
+
+/*!
+ * @brief Get the result of the reads.
+ * @param Reader The reader.
+ * @return FSOperationSuccess if all the reads have succeeded, otherwise the type of failure.
+ */
+FSOperation FSReaderGetResult(FSReader Reader);
+
+#pragma mark - Buffer Retention
+/*!
+ * @brief Retain the buffer the current views are in.
+ * @description The reader will stop reusing the buffer, so the views (and any strings created
+ *              from them) remain valid after further reads.
+ *
+ * @param Reader The reader.
+ * @return The retained buffer. This must be freed with @b CCFree once its views are no longer
+ *         being used.
+ */
+CC_NEW void *FSReaderRetainBuffer(FSReader Reader);
+
+/*!
+ * @brief Create a string from a view.
+ * @description The string references the bytes of the view without copying them, so must not
+ *              be used past the lifetime of the view (or the retained buffer it is in).
+ *
+ * @param View The view.
+ * @param Encoding The encoding of the view.
+ * @return The string, or NULL on failure. Must be destroyed to free the memory.
+ */
+static inline CC_NEW CCString FSReaderViewCreateString(FSReaderView View, CCStringEncoding Encoding);
+
+#pragma mark -
+
+static inline CCString FSReaderViewCreateString(FSReaderView View, CCStringEncoding Encoding)
+{
+    return CCStringCreateWithSize(CC_STD_ALLOCATOR, (CCStringHint)Encoding, View.data, View.size);
+}
+
+#endif
+
+#endif
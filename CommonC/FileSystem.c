@@ -25,7 +25,11 @@
 
 #define _XOPEN_SOURCE 500
 #define _BSD_SOURCE
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE //copy_file_range
+#endif
 #include "FileSystem.h"
+#include "FileSystem_Private.h"
 #include "Platform.h"
 #include "OrderedCollection.h"
 #include "CollectionEnumerator.h"
@@ -33,6 +37,19 @@
 #include "TypeCallbacks.h"
 #include "MemoryAllocation.h"
 #include "Logging.h"
+#include "Hash.h"
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#endif
 
 #if CC_PLATFORM_OS_X || CC_PLATFORM_IOS
 //SystemPath.m
@@ -44,6 +61,17 @@
 #include <dirent.h>
 #include <ftw.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <stdint.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
 #elif CC_PLATFORM_WINDOWS
 #error Add support for windows
 #else
@@ -94,6 +122,306 @@ FSOperation FSManagerRename(FSPath Path, const char *Name)
     return Success;
 }
 
+#pragma mark - Info
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+
+#ifndef CC_FILE_SYSTEM_INFO_CACHE_SIZE
+#define CC_FILE_SYSTEM_INFO_CACHE_SIZE 256
+#endif
+
+#if !defined(CC_FILE_SYSTEM_INFO_CACHE_INOTIFY) && defined(__linux__)
+#define CC_FILE_SYSTEM_INFO_CACHE_INOTIFY 1
+#endif
+
+typedef struct {
+    char *path;
+    uint32_t hash;
+    int watch;
+    uint64_t expires;
+    FSOperation result;
+    FSFileInfo info;
+} FSManagerInfoCacheEntry;
+
+typedef struct {
+    int watch;
+    size_t count;
+} FSManagerInfoCacheWatchReference;
+
+static struct {
+    pthread_mutex_t lock;
+    _Atomic(uint64_t) ttl;
+    int notify;
+    uint64_t generation;
+    FSManagerInfoCacheEntry entries[CC_FILE_SYSTEM_INFO_CACHE_SIZE];
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+    FSManagerInfoCacheWatchReference watches[CC_FILE_SYSTEM_INFO_CACHE_SIZE];
+#endif
+} FSManagerInfoCache = { .lock = PTHREAD_MUTEX_INITIALIZER, .notify = -1 };
+
+static uint64_t FSManagerInfoCacheTime(void)
+{
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    
+    return ((uint64_t)Time.tv_sec * 1000000000) + (uint64_t)Time.tv_nsec;
+}
+
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+/*
+ Watches are shared by every cached path in the same directory (inotify returns the existing watch descriptor), so
+ they're reference counted and removed once no cached path uses them. These must be called with the lock held.
+ */
+static _Bool FSManagerInfoCacheRetainWatch(int Watch)
+{
+    FSManagerInfoCacheWatchReference *Free = NULL;
+    for (size_t Loop = 0; Loop < CC_FILE_SYSTEM_INFO_CACHE_SIZE; Loop++)
+    {
+        FSManagerInfoCacheWatchReference *Reference = &FSManagerInfoCache.watches[Loop];
+        if (!Reference->count)
+        {
+            if (!Free) Free = Reference;
+        }
+        
+        else if (Reference->watch == Watch)
+        {
+            Reference->count++;
+            return TRUE;
+        }
+    }
+    
+    if (!Free) return FALSE;
+    
+    *Free = (FSManagerInfoCacheWatchReference){ .watch = Watch, .count = 1 };
+    
+    return TRUE;
+}
+
+static void FSManagerInfoCacheReleaseWatch(int Watch)
+{
+    if (Watch == -1) return;
+    
+    for (size_t Loop = 0; Loop < CC_FILE_SYSTEM_INFO_CACHE_SIZE; Loop++)
+    {
+        FSManagerInfoCacheWatchReference *Reference = &FSManagerInfoCache.watches[Loop];
+        if ((Reference->count) && (Reference->watch == Watch))
+        {
+            //the watch may already have been removed by the kernel (e.g. if the directory was deleted)
+            if ((!--Reference->count) && (FSManagerInfoCache.notify != -1)) inotify_rm_watch(FSManagerInfoCache.notify, Watch);
+            
+            return;
+        }
+    }
+}
+#else
+#define FSManagerInfoCacheReleaseWatch(Watch) (void)(Watch)
+#endif
+
+static void FSManagerInfoCacheClear(int Watch)
+{
+    for (size_t Loop = 0; Loop < CC_FILE_SYSTEM_INFO_CACHE_SIZE; Loop++)
+    {
+        FSManagerInfoCacheEntry *Entry = &FSManagerInfoCache.entries[Loop];
+        if ((Entry->path) && ((Watch == -1) || (Entry->watch == Watch)))
+        {
+            CC_SAFE_Free(Entry->path);
+            FSManagerInfoCacheReleaseWatch(Entry->watch);
+            Entry->watch = -1;
+        }
+    }
+}
+
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+static void FSManagerInfoCacheProcessNotifications(void)
+{
+    _Alignas(struct inotify_event) char Buffer[4096];
+    for (ssize_t Size; (Size = read(FSManagerInfoCache.notify, Buffer, sizeof(Buffer))) > 0; )
+    {
+        FSManagerInfoCache.generation++;
+        
+        for (const char *Event = Buffer; Event < (Buffer + Size); Event += sizeof(struct inotify_event) + ((const struct inotify_event*)Event)->len)
+        {
+            const struct inotify_event *Notification = (const struct inotify_event*)Event;
+            FSManagerInfoCacheClear(Notification->mask & IN_Q_OVERFLOW ? -1 : Notification->wd);
+        }
+    }
+}
+
+static int FSManagerInfoCacheWatch(FSPath Path)
+{
+    if (FSManagerInfoCache.notify == -1) return -1;
+    
+    const char *SystemPath = FSPathGetPathString(Path);
+    size_t Length = strlen(SystemPath);
+    
+    //Watch the parent directory, so changes to the entry itself are reported
+    if ((Length) && (SystemPath[Length - 1] == '/')) Length--;
+    while ((Length) && (SystemPath[Length - 1] != '/')) Length--;
+    
+    char Directory[PATH_MAX];
+    if (Length >= sizeof(Directory)) return -1;
+    
+    if (Length) memcpy(Directory, SystemPath, Length);
+    else Directory[Length++] = '.';
+    Directory[Length] = 0;
+    
+    const int Watch = inotify_add_watch(FSManagerInfoCache.notify, Directory, IN_ATTRIB | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+    if ((Watch != -1) && (!FSManagerInfoCacheRetainWatch(Watch)))
+    {
+        //too many directories are being watched, so this path is only refreshed when its attributes expire
+        inotify_rm_watch(FSManagerInfoCache.notify, Watch);
+        return -1;
+    }
+    
+    return Watch;
+}
+#endif
+
+void FSManagerSetInfoCacheTTL(uint64_t TTL)
+{
+    pthread_mutex_lock(&FSManagerInfoCache.lock);
+    
+    atomic_store_explicit(&FSManagerInfoCache.ttl, TTL, memory_order_relaxed);
+    FSManagerInfoCache.generation++;
+    FSManagerInfoCacheClear(-1);
+    
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+    if ((TTL) && (FSManagerInfoCache.notify == -1)) FSManagerInfoCache.notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    else if ((!TTL) && (FSManagerInfoCache.notify != -1))
+    {
+        close(FSManagerInfoCache.notify);
+        FSManagerInfoCache.notify = -1;
+        
+        //closing removes any watches still held by lookups in progress, and a new instance reuses their descriptors
+        memset(FSManagerInfoCache.watches, 0, sizeof(FSManagerInfoCache.watches));
+    }
+#endif
+    
+    pthread_mutex_unlock(&FSManagerInfoCache.lock);
+}
+
+void FSManagerInvalidateInfoCache(void)
+{
+    if (!atomic_load_explicit(&FSManagerInfoCache.ttl, memory_order_relaxed)) return;
+    
+    pthread_mutex_lock(&FSManagerInfoCache.lock);
+    FSManagerInfoCache.generation++;
+    FSManagerInfoCacheClear(-1);
+    pthread_mutex_unlock(&FSManagerInfoCache.lock);
+}
+
+FSOperation FSManagerGetInfo(FSPath Path, FSFileInfo *Info)
+{
+    CCAssertLog(Path, "Path must not be null");
+    CCAssertLog(Info, "Info must not be null");
+    
+    const uint64_t TTL = atomic_load_explicit(&FSManagerInfoCache.ttl, memory_order_relaxed);
+    if (!TTL) return FSManagerGetSystemInfo(Path, Info);
+    
+    /*
+     Results are only cached if no changes were reported while the info was being retrieved. As the watch is added
+     before retrieving the info, any later changes will be reported.
+     */
+    
+    const char *Key = FSPathGetFullPathString(Path);
+    const size_t Length = strlen(Key);
+    const uint32_t Hash = CCHashMurmur32Buffer(Key, Length, 0);
+    FSManagerInfoCacheEntry *Entry = &FSManagerInfoCache.entries[Hash % CC_FILE_SYSTEM_INFO_CACHE_SIZE];
+    
+    pthread_mutex_lock(&FSManagerInfoCache.lock);
+    
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+    if (FSManagerInfoCache.notify != -1) FSManagerInfoCacheProcessNotifications();
+#endif
+    
+    const uint64_t Time = FSManagerInfoCacheTime();
+    if ((Entry->path) && (Entry->hash == Hash) && (Entry->expires > Time) && (!strcmp(Entry->path, Key)))
+    {
+        const FSOperation Result = Entry->result;
+        *Info = Entry->info;
+        
+        pthread_mutex_unlock(&FSManagerInfoCache.lock);
+        
+        return Result;
+    }
+    
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+    const int Watch = FSManagerInfoCacheWatch(Path);
+#else
+    const int Watch = -1;
+#endif
+    
+    const uint64_t Generation = FSManagerInfoCache.generation;
+    
+    pthread_mutex_unlock(&FSManagerInfoCache.lock);
+    
+    const FSOperation Result = FSManagerGetSystemInfo(Path, Info);
+    
+    char *CachedKey;
+    CC_SAFE_Malloc(CachedKey, Length + 1,
+                   pthread_mutex_lock(&FSManagerInfoCache.lock);
+                   FSManagerInfoCacheReleaseWatch(Watch);
+                   pthread_mutex_unlock(&FSManagerInfoCache.lock);
+                   return Result;
+                   );
+    
+    memcpy(CachedKey, Key, Length + 1);
+    
+    pthread_mutex_lock(&FSManagerInfoCache.lock);
+    
+#if CC_FILE_SYSTEM_INFO_CACHE_INOTIFY
+    if (FSManagerInfoCache.notify != -1) FSManagerInfoCacheProcessNotifications();
+#endif
+    
+    if (FSManagerInfoCache.generation == Generation)
+    {
+        if (Entry->path)
+        {
+            CC_SAFE_Free(Entry->path);
+            FSManagerInfoCacheReleaseWatch(Entry->watch);
+        }
+        
+        *Entry = (FSManagerInfoCacheEntry){
+            .path = CachedKey,
+            .hash = Hash,
+            .watch = Watch,
+            .expires = Time + TTL,
+            .result = Result,
+            .info = *Info
+        };
+        
+        CachedKey = NULL;
+    }
+    
+    else FSManagerInfoCacheReleaseWatch(Watch);
+    
+    pthread_mutex_unlock(&FSManagerInfoCache.lock);
+    
+    if (CachedKey) CC_SAFE_Free(CachedKey);
+    
+    return Result;
+}
+
+#else
+
+void FSManagerSetInfoCacheTTL(uint64_t TTL)
+{
+}
+
+void FSManagerInvalidateInfoCache(void)
+{
+}
+
+FSOperation FSManagerGetInfo(FSPath Path, FSFileInfo *Info)
+{
+    CCAssertLog(Path, "Path must not be null");
+    CCAssertLog(Info, "Info must not be null");
+    
+    return FSManagerGetSystemInfo(Path, Info);
+}
+
+#endif
+
 #if CC_PLATFORM_UNIX
 
 #pragma mark Path
@@ -143,123 +471,475 @@ static const char *FSPathSystemInternalRepresentation(FSPath Path)
     return FSPathGetPathString(Path); //TODO: Need to handle resolving of volumes
 }
 
+FSOperation FSManagerGetSystemInfo(FSPath Path, FSFileInfo *Info)
+{
+    struct stat Stat;
+    if (stat(FSPathSystemInternalRepresentation(Path), &Stat))
+    {
+        *Info = (FSFileInfo){ .directory = FALSE };
+        
+        return errno == ENOENT ? FSOperationPathNotExist : FSOperationFailure;
+    }
+    
+    *Info = (FSFileInfo){
+        .directory = S_ISDIR(Stat.st_mode),
+        .access = ((_Bool)(Stat.st_mode & S_IRUSR) * FSAccessReadable)
+                | ((_Bool)(Stat.st_mode & S_IWUSR) * FSAccessWritable)
+                | ((_Bool)(Stat.st_mode & S_IXUSR) * FSAccessExecutable)
+                | ((_Bool)(Stat.st_mode & S_IWUSR) * FSAccessDeletable), //TODO: detect proper file/directory mutability (FSAccessDeletable)
+        .size = Stat.st_size,
+        .blockSize = Stat.st_blksize,
+        .modified = ((uint64_t)Stat.st_mtim.tv_sec * 1000000000) + (uint64_t)Stat.st_mtim.tv_nsec
+    };
+    
+    return FSOperationSuccess;
+}
+
 _Bool FSManagerExists(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
     
-    struct stat Info;
-    int Status = stat(FSPathSystemInternalRepresentation(Path), &Info);
-    
-    return (!Status) && ((_Bool)S_ISDIR(Info.st_mode) == FSPathIsDirectory(Path));
+    FSFileInfo Info;
+    return (FSManagerGetInfo(Path, &Info) == FSOperationSuccess) && (Info.directory == FSPathIsDirectory(Path));
 }
 
 FSAccess FSManagerGetAccessRights(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
     
-    struct stat Info;
-    int Status = stat(FSPathSystemInternalRepresentation(Path), &Info);
-    
-    return Status ? 0 : ((_Bool)(Info.st_mode & S_IRUSR) * FSAccessReadable)
-    | ((_Bool)(Info.st_mode & S_IWUSR) * FSAccessWritable)
-    | ((_Bool)(Info.st_mode & S_IXUSR) * FSAccessExecutable)
-    | ((_Bool)(Info.st_mode & S_IWUSR) * FSAccessDeletable); //TODO: detect proper file/directory mutability (FSAccessDeletable)
+    FSFileInfo Info;
+    return FSManagerGetInfo(Path, &Info) == FSOperationSuccess ? Info.access : 0;
 }
 
 size_t FSManagerGetSize(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
     
-    struct stat Info;
-    int Status = stat(FSPathSystemInternalRepresentation(Path), &Info);
-    
-    return !Status ? Info.st_size : 0;
+    FSFileInfo Info;
+    return FSManagerGetInfo(Path, &Info) == FSOperationSuccess ? Info.size : 0;
 }
 
 size_t FSManagerGetPreferredIOBlockSize(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
     
-    struct stat Info;
-    int Status = stat(FSPathSystemInternalRepresentation(Path), &Info);
+    FSFileInfo Info;
+    return FSManagerGetInfo(Path, &Info) == FSOperationSuccess ? Info.blockSize : 0;
+}
+
+#if !defined(CC_FILE_SYSTEM_SCAN_GETDENTS) && defined(__linux__) && defined(SYS_getdents64)
+#define CC_FILE_SYSTEM_SCAN_GETDENTS 1
+#endif
+
+#ifndef CC_FILE_SYSTEM_SCAN_BUFFER_SIZE
+#define CC_FILE_SYSTEM_SCAN_BUFFER_SIZE 32768
+#endif
+
+#ifndef CC_FILE_SYSTEM_SCAN_WORKERS_PER_PROCESSOR
+#define CC_FILE_SYSTEM_SCAN_WORKERS_PER_PROCESSOR 2
+#endif
+
+#ifndef CC_FILE_SYSTEM_SCAN_QUEUE_SIZE
+#define CC_FILE_SYSTEM_SCAN_QUEUE_SIZE 256
+#endif
+
+#if CC_FILE_SYSTEM_SCAN_GETDENTS
+typedef struct {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+} FSManagerDirectoryRecord;
+#endif
+
+typedef struct {
+#if CC_FILE_SYSTEM_SCAN_GETDENTS
+    int fd;
+    size_t offset, size;
+    uint64_t buffer[CC_FILE_SYSTEM_SCAN_BUFFER_SIZE / sizeof(uint64_t)];
+#else
+    DIR *dir;
+#endif
+} FSManagerDirectoryReader;
+
+static _Bool FSManagerDirectoryReaderOpen(FSManagerDirectoryReader *Reader, int Directory)
+{
+#if CC_FILE_SYSTEM_SCAN_GETDENTS
+    Reader->fd = Directory;
+    Reader->offset = 0;
+    Reader->size = 0;
+#else
+    if (!(Reader->dir = fdopendir(Directory)))
+    {
+        close(Directory);
+        return FALSE;
+    }
+#endif
     
-    return !Status ? Info.st_blksize : 0;
+    return TRUE;
+}
+
+static void FSManagerDirectoryReaderClose(FSManagerDirectoryReader *Reader)
+{
+#if CC_FILE_SYSTEM_SCAN_GETDENTS
+    close(Reader->fd);
+#else
+    closedir(Reader->dir);
+#endif
 }
 
-static void FSManagerAddContentsInPath(FSPath SystemPath, CCOrderedCollection *List, CCCollection NamingMatches, FSMatch MatchOptions)
+static int FSManagerDirectoryReaderGetDescriptor(FSManagerDirectoryReader *Reader)
 {
-    DIR *Info = opendir(FSPathSystemInternalRepresentation(SystemPath));
-    if (Info)
+#if CC_FILE_SYSTEM_SCAN_GETDENTS
+    return Reader->fd;
+#else
+    return dirfd(Reader->dir);
+#endif
+}
+
+static const char *FSManagerDirectoryReaderNext(FSManagerDirectoryReader *Reader, unsigned char *Type)
+{
+#if CC_FILE_SYSTEM_SCAN_GETDENTS
+    if (Reader->offset == Reader->size)
     {
-        for (struct dirent *Entry; (Entry = readdir(Info)); )
-        {
-            const char *Item = Entry->d_name;
-            if ((Item[0] == '.') && ((MatchOptions & FSMatchSkipHidden) || (Item[1] == 0) || ((Item[1] == '.') && (Item[2] == 0)))) continue;
-            
-            const _Bool IsDir = Entry->d_type == DT_DIR;
-            _Bool Match = TRUE;
-            
-#ifdef _DIRENT_HAVE_D_NAMLEN
-            const size_t EntryLength = Entry->d_namlen;
+        const long Size = syscall(SYS_getdents64, Reader->fd, Reader->buffer, sizeof(Reader->buffer));
+        if (Size <= 0) return NULL;
+        
+        Reader->offset = 0;
+        Reader->size = Size;
+    }
+    
+    const FSManagerDirectoryRecord *Record = (const FSManagerDirectoryRecord*)((const char*)Reader->buffer + Reader->offset);
+    Reader->offset += Record->d_reclen;
+    
+    *Type = Record->d_type;
+    
+    return Record->d_name;
 #else
-            const size_t EntryLength = strlen(Entry->d_name);
+    const struct dirent *Entry = readdir(Reader->dir);
+    if (!Entry) return NULL;
+    
+    *Type = Entry->d_type;
+    
+    return Entry->d_name;
 #endif
+}
+
+/*
+ Path is only set if the entry's FSPath was needed for name matching, the callback may take ownership of it by
+ setting it to NULL.
+ */
+typedef _Bool (*FSManagerScanCallback)(const FSManagerEntry *Entry, FSPath *Path, void *Context);
+
+typedef struct FSManagerScanJob {
+    struct FSManagerScanJob *next;
+    int fd;
+    size_t length, depth;
+    char path[];
+} FSManagerScanJob;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+    FSManagerScanJob *jobs;
+    size_t count, pending, workers;
+    _Atomic(_Bool) stopped;
+    CCCollection namingMatches;
+    FSMatch options;
+    FSManagerScanCallback callback;
+    void *context;
+} FSManagerScanner;
+
+static _Bool FSManagerScanPush(FSManagerScanner *Scanner, int Directory, const char *Path, size_t Length, size_t Depth)
+{
+    if (!Scanner->workers) return FALSE;
+    
+    FSManagerScanJob *Job;
+    CC_SAFE_Malloc(Job, sizeof(FSManagerScanJob) + Length + 1,
+                   return FALSE;
+                   );
+    
+    Job->fd = Directory;
+    Job->length = Length;
+    Job->depth = Depth;
+    memcpy(Job->path, Path, Length + 1);
+    
+    pthread_mutex_lock(&Scanner->lock);
+    
+    if (Scanner->count == CC_FILE_SYSTEM_SCAN_QUEUE_SIZE)
+    {
+        pthread_mutex_unlock(&Scanner->lock);
+        CC_SAFE_Free(Job);
+        
+        return FALSE;
+    }
+    
+    Job->next = Scanner->jobs;
+    Scanner->jobs = Job;
+    Scanner->count++;
+    Scanner->pending++;
+    
+    pthread_cond_signal(&Scanner->available);
+    pthread_mutex_unlock(&Scanner->lock);
+    
+    return TRUE;
+}
+
+/*
+ Path is a buffer of PATH_MAX holding the directory's path (with a trailing separator) of the given length, which is
+ extended with each entry's name. Subdirectories are handed to the other workers while there is room in the queue,
+ otherwise they are scanned immediately.
+ */
+static void FSManagerScanDirectory(FSManagerScanner *Scanner, int Directory, char *Path, size_t Length, size_t Depth)
+{
+    FSManagerDirectoryReader *Reader;
+    CC_SAFE_Malloc(Reader, sizeof(FSManagerDirectoryReader),
+                   CC_LOG_ERROR("Failed to scan directory: \"%s\" due to allocation failure (%zu)", Path, sizeof(FSManagerDirectoryReader));
+                   close(Directory);
+                   return;
+                   );
+    
+    if (!FSManagerDirectoryReaderOpen(Reader, Directory))
+    {
+        CC_SAFE_Free(Reader);
+        return;
+    }
+    
+    const FSMatch Options = Scanner->options;
+    unsigned char Type;
+    for (const char *Name; (!atomic_load_explicit(&Scanner->stopped, memory_order_relaxed)) && ((Name = FSManagerDirectoryReaderNext(Reader, &Type))); )
+    {
+        if ((Name[0] == '.') && ((Options & FSMatchSkipHidden) || (!Name[1]) || ((Name[1] == '.') && (!Name[2])))) continue;
+        
+        const size_t NameLength = strlen(Name);
+        if ((Length + NameLength + 2) > PATH_MAX) continue;
+        
+        if (Type == DT_UNKNOWN)
+        {
+            struct stat Info;
+            Type = (!fstatat(FSManagerDirectoryReaderGetDescriptor(Reader), Name, &Info, AT_SYMLINK_NOFOLLOW)) && (S_ISDIR(Info.st_mode)) ? DT_DIR : DT_REG;
+        }
+        
+        const _Bool IsDir = Type == DT_DIR;
+        
+        size_t EntryLength = Length + NameLength;
+        memcpy(Path + Length, Name, NameLength);
+        if (IsDir) Path[EntryLength++] = '/';
+        Path[EntryLength] = 0;
+        
+        _Bool Match = TRUE;
+        FSPath EntryPath = NULL;
+        if (Scanner->namingMatches)
+        {
+            EntryPath = FSPathCreateFromSystemPath(Path);
             
-            const size_t SystemPathLength = strlen(FSPathGetPathString(SystemPath));
-            char *ItemPath;
-            CC_SAFE_Malloc(ItemPath, SystemPathLength + EntryLength + 1,
-                           CC_LOG_ERROR("Failed to add path item: \"%s/%s\" due to allocation failure (%zu)", FSPathGetPathString(SystemPath), Item, SystemPathLength + EntryLength + 1);
-                           continue;
-                           );
-            
-            strcpy(ItemPath, FSPathGetPathString(SystemPath));
-            strcpy(ItemPath + SystemPathLength, Item);
-            
-            FSPath Path = FSPathCreateFromSystemPath(ItemPath);
-            CC_SAFE_Free(ItemPath);
-            
-            if (NamingMatches)
-            {
-                CC_COLLECTION_FOREACH(FSPath, PathMatch, NamingMatches)
-                {
-                    Match = FSPathMatch(Path, PathMatch, MatchOptions);
-                    
-                    if (Match) break;
-                }
-            }
-            
-            _Bool PreservePath = FALSE;
-            if ((PreservePath = ((MatchOptions & FSMatchNameBlacklist) ? !Match : Match)))
+            CC_COLLECTION_FOREACH(FSPath, PathMatch, Scanner->namingMatches)
             {
-                if (!(IsDir * (MatchOptions & FSMatchSkipDirectory)) && !(!IsDir * (MatchOptions & FSMatchSkipFile)))
-                {
-                    if (!*List) *List = CCCollectionCreate(CC_STD_ALLOCATOR, CCCollectionHintOrdered | CCCollectionHintHeavyEnumerating, sizeof(FSPath), FSPathDestructorForCollection);
-                    CCOrderedCollectionAppendElement(*List, &Path);
-                }
+                Match = FSPathMatch(EntryPath, PathMatch, Options);
+                
+                if (Match) break;
             }
+        }
+        
+        if (((Options & FSMatchNameBlacklist) ? !Match : Match) && !(IsDir ? (Options & FSMatchSkipDirectory) : (Options & FSMatchSkipFile)))
+        {
+            const FSManagerEntry Entry = {
+                .path = Path,
+                .name = Path + Length,
+                .length = EntryLength,
+                .depth = Depth,
+                .directory = IsDir
+            };
             
-            if ((MatchOptions & FSMatchSearchRecursively))
+            if (!Scanner->callback(&Entry, &EntryPath, Scanner->context)) atomic_store_explicit(&Scanner->stopped, TRUE, memory_order_relaxed);
+        }
+        
+        if (EntryPath) FSPathDestroy(EntryPath);
+        
+        if ((IsDir) && (Options & FSMatchSearchRecursively) && (!atomic_load_explicit(&Scanner->stopped, memory_order_relaxed)))
+        {
+            const int Subdirectory = openat(FSManagerDirectoryReaderGetDescriptor(Reader), Name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if ((Subdirectory != -1) && (!FSManagerScanPush(Scanner, Subdirectory, Path, EntryLength, Depth + 1)))
             {
-                if (IsDir) FSManagerAddContentsInPath(Path, List, NamingMatches, MatchOptions);
+                FSManagerScanDirectory(Scanner, Subdirectory, Path, EntryLength, Depth + 1);
             }
-            
-            if (!PreservePath) FSPathDestroy(Path);
+        }
+    }
+    
+    FSManagerDirectoryReaderClose(Reader);
+    CC_SAFE_Free(Reader);
+    
+    Path[Length] = 0;
+}
+
+static void FSManagerScanWork(FSManagerScanner *Scanner, char *Path)
+{
+    for ( ; ; )
+    {
+        pthread_mutex_lock(&Scanner->lock);
+        
+        while ((!Scanner->jobs) && (Scanner->pending)) pthread_cond_wait(&Scanner->available, &Scanner->lock);
+        
+        FSManagerScanJob *Job = Scanner->jobs;
+        if (Job)
+        {
+            Scanner->jobs = Job->next;
+            Scanner->count--;
+        }
+        
+        pthread_mutex_unlock(&Scanner->lock);
+        
+        if (!Job) break;
+        
+        if (!atomic_load_explicit(&Scanner->stopped, memory_order_relaxed))
+        {
+            memcpy(Path, Job->path, Job->length + 1);
+            FSManagerScanDirectory(Scanner, Job->fd, Path, Job->length, Job->depth);
         }
         
-        closedir(Info);
+        else close(Job->fd);
+        
+        CC_SAFE_Free(Job);
+        
+        pthread_mutex_lock(&Scanner->lock);
+        if (!--Scanner->pending) pthread_cond_broadcast(&Scanner->available);
+        pthread_mutex_unlock(&Scanner->lock);
     }
 }
 
+static void *FSManagerScanWorker(FSManagerScanner *Scanner)
+{
+    char *Path;
+    CC_SAFE_Malloc(Path, PATH_MAX,
+                   return NULL;
+                   );
+    
+    FSManagerScanWork(Scanner, Path);
+    
+    CC_SAFE_Free(Path);
+    
+    return NULL;
+}
+
+static FSOperation FSManagerScan(FSPath Path, CCCollection NamingMatches, FSMatch MatchOptions, FSManagerScanCallback Callback, void *Context)
+{
+    const char *SystemPath = FSPathSystemInternalRepresentation(Path);
+    size_t Length = strlen(SystemPath);
+    if ((Length + 2) > PATH_MAX) return FSOperationFailure;
+    
+    const int Directory = open(Length ? SystemPath : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (Directory == -1) return errno == ENOENT ? FSOperationPathNotExist : FSOperationFailure;
+    
+    size_t WorkerCount = 0;
+    if (MatchOptions & FSMatchSearchRecursively)
+    {
+        const long Processors = sysconf(_SC_NPROCESSORS_ONLN);
+        WorkerCount = ((Processors > 0 ? (size_t)Processors : 1) * CC_FILE_SYSTEM_SCAN_WORKERS_PER_PROCESSOR) - 1;
+    }
+    
+    FSManagerScanner *Scanner;
+    pthread_t *Workers;
+    CC_SAFE_Malloc(Scanner, sizeof(FSManagerScanner) + (sizeof(pthread_t) * WorkerCount) + PATH_MAX,
+                   close(Directory);
+                   return FSOperationFailure;
+                   );
+    
+    Workers = (pthread_t*)(Scanner + 1);
+    char *Buffer = (char*)(Workers + WorkerCount);
+    
+    memcpy(Buffer, SystemPath, Length + 1);
+    if ((Length) && (Buffer[Length - 1] != '/'))
+    {
+        Buffer[Length++] = '/';
+        Buffer[Length] = 0;
+    }
+    
+    Scanner->jobs = NULL;
+    Scanner->count = 0;
+    Scanner->pending = 1; //the initial directory
+    atomic_init(&Scanner->stopped, FALSE);
+    Scanner->namingMatches = NamingMatches;
+    Scanner->options = MatchOptions;
+    Scanner->callback = Callback;
+    Scanner->context = Context;
+    pthread_mutex_init(&Scanner->lock, NULL);
+    pthread_cond_init(&Scanner->available, NULL);
+    
+    Scanner->workers = 0;
+    for ( ; Scanner->workers < WorkerCount; Scanner->workers++)
+    {
+        if (pthread_create(Workers + Scanner->workers, NULL, (void*(*)(void*))FSManagerScanWorker, Scanner)) break;
+    }
+    
+    FSManagerScanDirectory(Scanner, Directory, Buffer, Length, 0);
+    
+    pthread_mutex_lock(&Scanner->lock);
+    if (!--Scanner->pending) pthread_cond_broadcast(&Scanner->available);
+    pthread_mutex_unlock(&Scanner->lock);
+    
+    FSManagerScanWork(Scanner, Buffer);
+    
+    for (size_t Loop = 0; Loop < Scanner->workers; Loop++) pthread_join(Workers[Loop], NULL);
+    
+    pthread_cond_destroy(&Scanner->available);
+    pthread_mutex_destroy(&Scanner->lock);
+    CC_SAFE_Free(Scanner);
+    
+    return FSOperationSuccess;
+}
+
+typedef struct {
+    FSManagerEnumerator callback;
+    void *context;
+} FSManagerEnumeration;
+
+static _Bool FSManagerEnumerateEntry(const FSManagerEntry *Entry, FSPath *Path, FSManagerEnumeration *Enumeration)
+{
+    return Enumeration->callback(Entry, Enumeration->context);
+}
+
+FSOperation FSManagerEnumerateContentsAtPath(FSPath Path, CCCollection NamingMatches, FSMatch MatchOptions, FSManagerEnumerator Callback, void *Context)
+{
+    CCAssertLog(Path, "Path must not be null");
+    CCAssertLog(Callback, "Callback must not be null");
+    
+    return FSManagerScan(Path, NamingMatches, MatchOptions, (FSManagerScanCallback)FSManagerEnumerateEntry, &(FSManagerEnumeration){ .callback = Callback, .context = Context });
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    CCOrderedCollection list;
+} FSManagerContents;
+
+static _Bool FSManagerAddContent(const FSManagerEntry *Entry, FSPath *Path, FSManagerContents *Contents)
+{
+    FSPath Content = *Path ? *Path : FSPathCreateFromSystemPath(Entry->path);
+    *Path = NULL;
+    
+    pthread_mutex_lock(&Contents->lock);
+    
+    if (!Contents->list) Contents->list = CCCollectionCreate(CC_STD_ALLOCATOR, CCCollectionHintOrdered | CCCollectionHintHeavyEnumerating, sizeof(FSPath), FSPathDestructorForCollection);
+    CCOrderedCollectionAppendElement(Contents->list, &Content);
+    
+    pthread_mutex_unlock(&Contents->lock);
+    
+    return TRUE;
+}
+
 CCOrderedCollection FSManagerGetContentsAtPath(FSPath Path, CCCollection NamingMatches, FSMatch MatchOptions)
 {
     CCAssertLog(Path, "Path must not be null");
     CCAssertLog(NamingMatches, "NamingMatches must not be null");
     
-    CCOrderedCollection List = NULL;
+    FSManagerContents Contents = { .list = NULL };
+    pthread_mutex_init(&Contents.lock, NULL);
+    
+    FSManagerScan(Path, NamingMatches, MatchOptions, (FSManagerScanCallback)FSManagerAddContent, &Contents);
     
-    FSManagerAddContentsInPath(Path, &List, NamingMatches, MatchOptions);
+    pthread_mutex_destroy(&Contents.lock);
     
-    return List;
+    return Contents.list;
 }
 
 static _Bool FSManagerCreateDirectory(FSPath Path, _Bool IntermediateDirectories)
@@ -308,6 +988,8 @@ FSOperation FSManagerCreate(FSPath Path, _Bool IntermediateDirectories)
             Success = FSManagerCreateDirectory(Path, IntermediateDirectories);
         }
         
+        FSManagerInvalidateInfoCache();
+        
         return Success ? FSOperationSuccess : FSOperationFailure;
     }
     
@@ -336,6 +1018,8 @@ FSOperation FSManagerRemove(FSPath Path)
         if (FSPathIsFile(Path)) Success = !remove(FSPathSystemInternalRepresentation(Path));
         else Success = !nftw(FSPathSystemInternalRepresentation(Path), FSManagerRemover, FSManagerMaxFileDescriptors(), FTW_DEPTH);
         
+        FSManagerInvalidateInfoCache();
+        
         return Success ? FSOperationSuccess : FSOperationFailure;
     }
     
@@ -351,90 +1035,340 @@ FSOperation FSManagerMove(FSPath Path, FSPath Destination)
     {
         _Bool Success = !rename(FSPathSystemInternalRepresentation(Path), FSPathSystemInternalRepresentation(Destination));
         
+        FSManagerInvalidateInfoCache();
+        
         return Success ? FSOperationSuccess : FSOperationFailure;
     }
     
     return FSOperationPathNotExist;
 }
 
-static _Thread_local size_t ChunkSize = 0;
-static _Thread_local void *Chunk = NULL;
-static FSOperation FSManagerCopyItem(FSPath Path, FSPath Destination)
+#if !defined(CC_FILE_SYSTEM_COPY_FILE_RANGE) && (defined(__linux__) || defined(__FreeBSD__))
+#define CC_FILE_SYSTEM_COPY_FILE_RANGE 1
+#endif
+
+#ifndef CC_FILE_SYSTEM_COPY_CHUNK_SIZE
+#define CC_FILE_SYSTEM_COPY_CHUNK_SIZE (1024 * 1024)
+#endif
+
+#ifndef CC_FILE_SYSTEM_COPY_WORKERS_PER_PROCESSOR
+#define CC_FILE_SYSTEM_COPY_WORKERS_PER_PROCESSOR 4
+#endif
+
+#ifndef CC_FILE_SYSTEM_COPY_QUEUE_SIZE
+#define CC_FILE_SYSTEM_COPY_QUEUE_SIZE 1024
+#endif
+
+static _Bool FSManagerCopyContents(int Source, int Destination)
+{
+#ifdef FICLONE
+    //Share the extents where the file system supports it (btrfs, xfs), so no data is copied
+    if (!ioctl(Destination, FICLONE, Source)) return TRUE;
+#endif
+    
+    off_t Offset = 0;
+    
+#if CC_FILE_SYSTEM_COPY_FILE_RANGE
+    //Copy within the kernel (or offloaded to the file system/device)
+    for ( ; ; )
+    {
+        const ssize_t Copied = copy_file_range(Source, NULL, Destination, NULL, CC_FILE_SYSTEM_COPY_CHUNK_SIZE * 64, 0);
+        
+        if (Copied > 0) Offset += Copied;
+        else if (Copied == 0) return TRUE;
+        else if (errno != EINTR) break;
+    }
+#endif
+    
+#if defined(__linux__)
+    for ( ; ; )
+    {
+        const ssize_t Copied = sendfile(Destination, Source, NULL, CC_FILE_SYSTEM_COPY_CHUNK_SIZE * 64);
+        
+        if (Copied > 0) Offset += Copied;
+        else if (Copied == 0) return TRUE;
+        else if (errno != EINTR) break;
+    }
+#endif
+    
+    //Neither is supported for the files, so copy the remainder through a buffer
+    if ((lseek(Source, Offset, SEEK_SET) == -1) || (lseek(Destination, Offset, SEEK_SET) == -1)) return FALSE;
+    
+    void *Chunk;
+    CC_SAFE_Malloc(Chunk, CC_FILE_SYSTEM_COPY_CHUNK_SIZE,
+                   return FALSE;
+                   );
+    
+    _Bool Success = TRUE;
+    for (ssize_t Count; (Success) && ((Count = read(Source, Chunk, CC_FILE_SYSTEM_COPY_CHUNK_SIZE))); )
+    {
+        if (Count == -1)
+        {
+            Success = errno == EINTR;
+            continue;
+        }
+        
+        for (ssize_t Written = 0, Result; (Success) && (Written < Count); )
+        {
+            if ((Result = write(Destination, Chunk + Written, Count - Written)) > 0) Written += Result;
+            else Success = (Result == -1) && (errno == EINTR);
+        }
+    }
+    
+    CC_SAFE_Free(Chunk);
+    
+    return Success;
+}
+
+static _Bool FSManagerCopyFile(const char *Path, const char *Destination)
 {
-    FSOperation Success;
-    if ((Success = FSManagerCreate(Destination, FALSE)) == FSOperationSuccess)
+    const int Source = open(Path, O_RDONLY);
+    if (Source == -1) return FALSE;
+    
+    const int Copy = open(Destination, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (Copy == -1)
     {
-        if ((FSPathIsFile(Path)))
+        close(Source);
+        return FALSE;
+    }
+    
+    _Bool Success = FSManagerCopyContents(Source, Copy);
+    
+    Success &= !close(Copy);
+    close(Source);
+    
+    return Success;
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t available, space;
+    char *jobs[CC_FILE_SYSTEM_COPY_QUEUE_SIZE];
+    size_t head, count, workers;
+    _Bool finished;
+    _Atomic(_Bool) failed;
+} FSManagerCopyQueue;
+
+static void *FSManagerCopyWorker(FSManagerCopyQueue *Queue)
+{
+    for ( ; ; )
+    {
+        pthread_mutex_lock(&Queue->lock);
+        
+        while ((!Queue->count) && (!Queue->finished)) pthread_cond_wait(&Queue->available, &Queue->lock);
+        
+        if (!Queue->count)
         {
-            FSHandle Reader, Writer;
-            if ((Success = FSHandleOpen(Path, FSHandleTypeRead, &Reader)) == FSOperationSuccess)
+            pthread_mutex_unlock(&Queue->lock);
+            break;
+        }
+        
+        char *Job = Queue->jobs[Queue->head];
+        Queue->head = (Queue->head + 1) % CC_FILE_SYSTEM_COPY_QUEUE_SIZE;
+        Queue->count--;
+        
+        pthread_cond_signal(&Queue->space);
+        pthread_mutex_unlock(&Queue->lock);
+        
+        //Job is the source and destination paths stored consecutively
+        if ((!atomic_load_explicit(&Queue->failed, memory_order_relaxed)) && (!FSManagerCopyFile(Job, Job + strlen(Job) + 1)))
+        {
+            atomic_store_explicit(&Queue->failed, TRUE, memory_order_relaxed);
+        }
+        
+        CC_SAFE_Free(Job);
+    }
+    
+    return NULL;
+}
+
+static _Bool FSManagerCopyQueuePush(FSManagerCopyQueue *Queue, const char *Path, size_t PathLength, const char *Destination, size_t DestinationLength)
+{
+    char *Job;
+    CC_SAFE_Malloc(Job, PathLength + DestinationLength + 2,
+                   return FALSE;
+                   );
+    
+    memcpy(Job, Path, PathLength + 1);
+    memcpy(Job + PathLength + 1, Destination, DestinationLength + 1);
+    
+    pthread_mutex_lock(&Queue->lock);
+    
+    while (Queue->count == CC_FILE_SYSTEM_COPY_QUEUE_SIZE) pthread_cond_wait(&Queue->space, &Queue->lock);
+    
+    Queue->jobs[(Queue->head + Queue->count++) % CC_FILE_SYSTEM_COPY_QUEUE_SIZE] = Job;
+    
+    pthread_cond_signal(&Queue->available);
+    pthread_mutex_unlock(&Queue->lock);
+    
+    return TRUE;
+}
+
+typedef struct FSManagerCopyAncestor {
+    const struct FSManagerCopyAncestor *parent;
+    dev_t device;
+    ino_t node;
+} FSManagerCopyAncestor;
+
+static _Bool FSManagerCopyIsAncestor(const FSManagerCopyAncestor *Ancestor, const struct stat *Info)
+{
+    for ( ; Ancestor; Ancestor = Ancestor->parent)
+    {
+        if ((Ancestor->device == Info->st_dev) && (Ancestor->node == Info->st_ino)) return TRUE;
+    }
+    
+    return FALSE;
+}
+
+static _Bool FSManagerCopyLink(const char *Path, const char *Destination)
+{
+    char Target[PATH_MAX];
+    const ssize_t Length = readlink(Path, Target, sizeof(Target) - 1);
+    if (Length < 0) return FALSE;
+    
+    Target[Length] = 0;
+    
+    return !symlink(Target, Destination);
+}
+
+/*
+ Path and Destination are buffers of PATH_MAX holding paths of the given lengths (without trailing separators), which
+ are extended with each entry's name. Directories are created as they are walked, while files are copied by the
+ workers (or immediately if there are none). Parent is the chain of directories currently being walked, so a link
+ back into one of them is recreated as a link rather than followed forever.
+ */
+static _Bool FSManagerCopyDirectory(FSManagerCopyQueue *Queue, char *Path, size_t PathLength, char *Destination, size_t DestinationLength, const FSManagerCopyAncestor *Parent)
+{
+    struct stat DirectoryInfo;
+    if (stat(Path, &DirectoryInfo)) return FALSE;
+    
+    const FSManagerCopyAncestor Ancestor = { .parent = Parent, .device = DirectoryInfo.st_dev, .node = DirectoryInfo.st_ino };
+    
+    if ((mkdir(Destination, S_IRWXU | S_IRGRP | S_IROTH)) && (errno != EEXIST)) return FALSE;
+    
+    DIR *Dir = opendir(Path);
+    if (!Dir) return FALSE;
+    
+    _Bool Success = TRUE;
+    for (struct dirent *Entry; (Success) && (!atomic_load_explicit(&Queue->failed, memory_order_relaxed)) && ((Entry = readdir(Dir))); )
+    {
+        if ((Entry->d_name[0] == '.') && ((!Entry->d_name[1]) || ((Entry->d_name[1] == '.') && (!Entry->d_name[2])))) continue;
+        
+        const size_t Length = strlen(Entry->d_name);
+        if (((PathLength + Length + 2) > PATH_MAX) || ((DestinationLength + Length + 2) > PATH_MAX))
+        {
+            Success = FALSE;
+            break;
+        }
+        
+        Path[PathLength] = '/';
+        memcpy(Path + PathLength + 1, Entry->d_name, Length + 1);
+        Destination[DestinationLength] = '/';
+        memcpy(Destination + DestinationLength + 1, Entry->d_name, Length + 1);
+        
+        //Symbolic links are followed, unless they lead back into a directory being copied
+        _Bool IsDirectory = Entry->d_type == DT_DIR, IsCycle = FALSE;
+        if ((Entry->d_type == DT_UNKNOWN) || (Entry->d_type == DT_LNK))
+        {
+            struct stat Info;
+            if (stat(Path, &Info))
             {
-                if ((Success = FSHandleOpen(Destination, FSHandleTypeWrite, &Writer)) == FSOperationSuccess)
-                {
-                    const size_t BlockSize = FSManagerGetPreferredIOBlockSize(Path);
-                    if (ChunkSize < BlockSize)
-                    {
-                        CC_SAFE_Realloc(Chunk, BlockSize,
-                                        FSHandleClose(Writer);
-                                        FSHandleClose(Reader);
-                                        
-                                        return FSOperationFailure;
-                                        );
-                        
-                        ChunkSize = BlockSize;
-                    }
-                    
-                    for (size_t Count = BlockSize; Count; )
-                    {
-                        Count = BlockSize;
-                        if (FSHandleRead(Reader, &Count, Chunk, FSBehaviourUpdateOffset) != FSOperationSuccess)
-                        {
-                            FSHandleClose(Writer);
-                            FSHandleClose(Reader);
-                            
-                            return FSOperationFailure;
-                        }
-                        
-                        if (FSHandleWrite(Writer, Count, Chunk, FSBehaviourUpdateOffset) != FSOperationSuccess)
-                        {
-                            FSHandleClose(Writer);
-                            FSHandleClose(Reader);
-                            
-                            return FSOperationFailure;
-                        }
-                    }
-                    
-                    FSHandleClose(Writer);
-                }
-                
-                FSHandleClose(Reader);
+                Success = FALSE;
+                break;
             }
+            
+            IsDirectory = S_ISDIR(Info.st_mode);
+            IsCycle = (IsDirectory) && (FSManagerCopyIsAncestor(&Ancestor, &Info));
         }
+        
+        if (IsCycle) Success = FSManagerCopyLink(Path, Destination);
+        else if (IsDirectory) Success = FSManagerCopyDirectory(Queue, Path, PathLength + Length + 1, Destination, DestinationLength + Length + 1, &Ancestor);
+        else if (!Queue->workers) Success = FSManagerCopyFile(Path, Destination);
+        else Success = FSManagerCopyQueuePush(Queue, Path, PathLength + Length + 1, Destination, DestinationLength + Length + 1);
     }
     
+    closedir(Dir);
+    
+    Path[PathLength] = 0;
+    Destination[DestinationLength] = 0;
+    
     return Success;
 }
 
-static _Thread_local FSPath CopyDestination;
-static _Thread_local size_t BaseComponentCount;
-static int FSManagerCopier(const char *Path, const struct stat *Info, int Flags, struct FTW *Ref)
+static size_t FSManagerCopyPath(char *Buffer, const char *Path)
+{
+    size_t Length = strlen(Path);
+    if (Length >= PATH_MAX) return 0;
+    
+    memcpy(Buffer, Path, Length + 1);
+    while ((Length > 1) && (Buffer[Length - 1] == '/')) Buffer[--Length] = 0;
+    
+    return Length;
+}
+
+static FSOperation FSManagerCopyTree(FSPath Path, FSPath Destination)
 {
-    FSPath Destination = FSPathCopy(CopyDestination);
-    CCOrderedCollection Components = FSPathConvertSystemPathToComponents(Path, TRUE);
-    for (size_t Loop = BaseComponentCount, Count = CCCollectionGetCount(Components); Loop < Count; Loop++)
+    char *SourcePath, *DestinationPath;
+    CC_SAFE_Malloc(SourcePath, PATH_MAX * 2,
+                   return FSOperationFailure;
+                   );
+    
+    DestinationPath = SourcePath + PATH_MAX;
+    
+    const size_t SourceLength = FSManagerCopyPath(SourcePath, FSPathSystemInternalRepresentation(Path));
+    const size_t DestinationLength = FSManagerCopyPath(DestinationPath, FSPathSystemInternalRepresentation(Destination));
+    
+    if ((!SourceLength) || (!DestinationLength))
     {
-        FSPathAppendComponent(Destination, FSPathComponentCopy(*(FSPathComponent*)CCOrderedCollectionGetElementAtIndex(Components, Loop)));
+        CC_SAFE_Free(SourcePath);
+        return FSOperationFailure;
     }
     
-    CCCollectionDestroy(Components);
+    const long Processors = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t WorkerCount = (Processors > 0 ? (size_t)Processors : 1) * CC_FILE_SYSTEM_COPY_WORKERS_PER_PROCESSOR;
+    
+    FSManagerCopyQueue *Queue;
+    pthread_t *Workers;
+    CC_SAFE_Malloc(Queue, sizeof(FSManagerCopyQueue) + (sizeof(pthread_t) * WorkerCount),
+                   CC_SAFE_Free(SourcePath);
+                   return FSOperationFailure;
+                   );
     
-    FSPath Original = FSPathCreateFromSystemPath(Path);
-    FSOperation Success = FSManagerCopyItem(Original, Destination);
+    Workers = (pthread_t*)(Queue + 1);
     
-    FSPathDestroy(Original);
-    FSPathDestroy(Destination);
+    Queue->head = 0;
+    Queue->count = 0;
+    Queue->finished = FALSE;
+    atomic_init(&Queue->failed, FALSE);
+    pthread_mutex_init(&Queue->lock, NULL);
+    pthread_cond_init(&Queue->available, NULL);
+    pthread_cond_init(&Queue->space, NULL);
     
-    return Success == FSOperationSuccess ? 0 : -1;
+    Queue->workers = 0;
+    for ( ; Queue->workers < WorkerCount; Queue->workers++)
+    {
+        if (pthread_create(Workers + Queue->workers, NULL, (void*(*)(void*))FSManagerCopyWorker, Queue)) break;
+    }
+    
+    //Without any workers the files are copied while walking
+    _Bool Success = FSManagerCopyDirectory(Queue, SourcePath, SourceLength, DestinationPath, DestinationLength, NULL);
+    
+    pthread_mutex_lock(&Queue->lock);
+    Queue->finished = TRUE;
+    pthread_cond_broadcast(&Queue->available);
+    pthread_mutex_unlock(&Queue->lock);
+    
+    for (size_t Loop = 0; Loop < Queue->workers; Loop++) pthread_join(Workers[Loop], NULL);
+    
+    Success &= !atomic_load_explicit(&Queue->failed, memory_order_relaxed);
+    
+    pthread_cond_destroy(&Queue->space);
+    pthread_cond_destroy(&Queue->available);
+    pthread_mutex_destroy(&Queue->lock);
+    CC_SAFE_Free(Queue);
+    CC_SAFE_Free(SourcePath);
+    
+    return Success ? FSOperationSuccess : FSOperationFailure;
 }
 
 FSOperation FSManagerCopy(FSPath Path, FSPath Destination)
@@ -445,19 +1379,10 @@ FSOperation FSManagerCopy(FSPath Path, FSPath Destination)
     if (FSManagerExists(Path))
     {
         FSOperation Result;
-        if (FSPathIsFile(Path)) Result = FSManagerCopyItem(Path, Destination);
-        else
-        {
-            CopyDestination = Destination;
-            BaseComponentCount = FSPathGetComponentCount(Path);
-            
-            _Bool Success = !nftw(FSPathSystemInternalRepresentation(Path), FSManagerCopier, FSManagerMaxFileDescriptors(), 0);
-            
-            Result = Success ? FSOperationSuccess : FSOperationFailure;
-        }
+        if (FSPathIsFile(Path)) Result = FSManagerCopyFile(FSPathSystemInternalRepresentation(Path), FSPathSystemInternalRepresentation(Destination)) ? FSOperationSuccess : FSOperationFailure;
+        else Result = FSManagerCopyTree(Path, Destination);
         
-        CC_SAFE_Free(Chunk);
-        ChunkSize = 0;
+        FSManagerInvalidateInfoCache();
         
         return Result;
     }
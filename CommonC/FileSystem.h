@@ -42,6 +42,46 @@ typedef enum {
     FSOperationPathNotExist
 } FSOperation;
 
+/*!
+ * @brief The attributes of a path.
+ */
+typedef struct {
+    /// Whether the path is a directory.
+    _Bool directory;
+    /// The access rights of the path.
+    FSAccess access;
+    /// The size of the path.
+    size_t size;
+    /// The preferred block size for IO operations on the path.
+    size_t blockSize;
+    /// The time the contents were last modified, in nanoseconds since the epoch.
+    uint64_t modified;
+} FSFileInfo;
+
+/*!
+ * @brief An entry found when enumerating the contents of a path.
+ */
+typedef struct {
+    /// The system path of the entry. Directories include a trailing separator.
+    const char *path;
+    /// The name of the entry (including the trailing separator of directories), this points into the path.
+    const char *name;
+    /// The length of the path.
+    size_t length;
+    /// The depth of the entry below the enumerated path, where immediate contents are 0.
+    size_t depth;
+    /// Whether the entry is a directory.
+    _Bool directory;
+} FSManagerEntry;
+
+/*!
+ * @brief Callback to receive an entry of an enumeration.
+ * @param Entry The entry. This is only valid for the duration of the callback.
+ * @param Context The context passed to the enumeration.
+ * @return TRUE if the enumeration should continue, otherwise FALSE to stop it.
+ */
+typedef _Bool (*FSManagerEnumerator)(const FSManagerEntry *Entry, void *Context);
+
 
 /*!
  * @brief Check whether the path exists.
@@ -71,6 +111,40 @@ size_t FSManagerGetSize(FSPath Path);
  */
 size_t FSManagerGetPreferredIOBlockSize(FSPath Path);
 
+/*!
+ * @brief Get all the attributes of a path.
+ * @description Retrieves all of the attributes in a single query, so should be preferred over
+ *              querying them individually when more than one is needed.
+ *
+ * @param Path The path.
+ * @param Info The attributes of the path.
+ * @return FSOperationSuccess if the attributes were retrieved, FSOperationPathNotExist if the path
+ *         does not exist. Otherwise the type of failure.
+ */
+FSOperation FSManagerGetInfo(FSPath Path, FSFileInfo *Info);
+
+/*!
+ * @brief Set how long the attributes of paths are cached for.
+ * @description By default attributes are not cached. When enabled, the attributes retrieved by
+ *              @b FSManagerGetInfo (and the individual attribute queries) are reused until they
+ *              expire. Changes made by the FSManager functions invalidate the cache, and on Linux
+ *              any changes to the cached paths are observed through inotify. Otherwise changes
+ *              made elsewhere may not be observed until the attributes expire.
+ *
+ *              Only the directory containing each cached path is watched, so renaming or replacing
+ *              one of its ancestor directories is not observed until the attributes expire.
+ *
+ * @param TTL The time in nanoseconds attributes are cached for, or 0 to disable the cache.
+ */
+void FSManagerSetInfoCacheTTL(uint64_t TTL);
+
+/*!
+ * @brief Invalidate any cached attributes.
+ * @description This should be used after making changes to paths outside of the FSManager
+ *              functions, when those changes need to be observed immediately.
+ */
+void FSManagerInvalidateInfoCache(void);
+
 /*!
  * @brief Get a list of all content paths in the specified path.
  * @description Contents are filtered based on matching inputs. The named matching rules are as
@@ -89,6 +163,27 @@ size_t FSManagerGetPreferredIOBlockSize(FSPath Path);
  */
 CC_NEW CCOrderedCollection FSManagerGetContentsAtPath(FSPath Path, CCCollection NamingMatches, FSMatch MatchOptions);
 
+/*!
+ * @brief Enumerate the contents of the specified path.
+ * @description Contents are filtered the same way as @b FSManagerGetContentsAtPath, however rather
+ *              than collecting them into a list, each matching entry is passed to the callback as
+ *              soon as it is read. So memory use does not grow with the number of entries.
+ *
+ *              When searching recursively, subdirectories are scanned by multiple threads. So the
+ *              callback may be called concurrently and entries are not passed in any particular
+ *              order.
+ *
+ * @param Path The path.
+ * @param NamingMatches An array of FSPath's to apply named matching rules on the entries, or NULL
+ *        for no named matches.
+ * @param MatchOptions The options specifying the matching behaviour.
+ * @param Callback The callback to receive each entry.
+ * @param Context The context to be passed to the callback.
+ * @return FSOperationSuccess if the path was enumerated, or stopped by the callback. Otherwise the
+ *         type of failure.
+ */
+FSOperation FSManagerEnumerateContentsAtPath(FSPath Path, CCCollection NamingMatches, FSMatch MatchOptions, FSManagerEnumerator Callback, void *Context);
+
 /*!
  * @brief Create a path and optionally any required intermediate directories.
  * @param Path The path.
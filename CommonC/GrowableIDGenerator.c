@@ -0,0 +1,357 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "GrowableIDGenerator.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "BitTricks.h"
+#include "Platform.h"
+#include <stdatomic.h>
+
+#if defined(__has_include)
+
+#if __has_include(<threads.h>)
+#define CC_ID_GENERATOR_USING_STDTHREADS 1
+#include <threads.h>
+#elif CC_PLATFORM_POSIX_COMPLIANT
+#define CC_ID_GENERATOR_USING_PTHREADS 1
+#include <pthread.h>
+#else
+#error No thread support
+#endif
+
+#elif CC_PLATFORM_POSIX_COMPLIANT
+#define CC_ID_GENERATOR_USING_PTHREADS 1
+#include <pthread.h>
+#else
+#define CC_ID_GENERATOR_USING_STDTHREADS 1
+#include <threads.h>
+#endif
+
+/*
+ Recycled IDs are kept in a shared lock-free stack, where the link for each ID is stored in segments that grow
+ alongside the ID space. Segment n holds (chunk size * 2^n) links, so existing links never need to be relocated.
+ 
+ Each thread caches up to CC_GROWABLE_ID_GENERATOR_CACHE_SIZE IDs, and moves CC_GROWABLE_ID_GENERATOR_BATCH_SIZE
+ IDs at a time between its cache and the shared state.
+ */
+#define CC_GROWABLE_ID_GENERATOR_SEGMENT_MAX (sizeof(uintptr_t) * 8)
+#define CC_GROWABLE_ID_GENERATOR_CACHE_SIZE 32
+#define CC_GROWABLE_ID_GENERATOR_BATCH_SIZE (CC_GROWABLE_ID_GENERATOR_CACHE_SIZE / 2)
+
+typedef struct {
+    uintptr_t id; //ID + 1, or 0 if empty
+    uintptr_t tag;
+} CCGrowableIDGeneratorStack;
+
+typedef struct CCGrowableIDGeneratorCache {
+    struct CCGrowableIDGeneratorCache *next;
+    struct CCGrowableIDGeneratorInternal *generator;
+    _Atomic(_Bool) owned;
+    size_t count;
+    uintptr_t ids[CC_GROWABLE_ID_GENERATOR_CACHE_SIZE];
+} CCGrowableIDGeneratorCache;
+
+typedef struct CCGrowableIDGeneratorInternal {
+    CCAllocatorType allocator;
+    size_t chunkSize;
+    _Atomic(uintptr_t) next;
+    _Atomic(CCGrowableIDGeneratorStack) recycled;
+    _Atomic(CCGrowableIDGeneratorCache*) caches;
+    _Atomic(_Atomic(uintptr_t)*) segments[CC_GROWABLE_ID_GENERATOR_SEGMENT_MAX];
+#if CC_ID_GENERATOR_USING_PTHREADS
+    pthread_key_t key;
+#elif CC_ID_GENERATOR_USING_STDTHREADS
+    tss_t key;
+#endif
+} CCGrowableIDGeneratorInternal;
+
+
+static void *CCGrowableIDGeneratorConstructor(CCAllocatorType Allocator, size_t Count);
+static void CCGrowableIDGeneratorDestructor(CCGrowableIDGeneratorInternal *Internal);
+static _Bool CCGrowableIDGeneratorTryAssign(CCGrowableIDGeneratorInternal *Internal, uintptr_t *ID);
+static void CCGrowableIDGeneratorRecycle(CCGrowableIDGeneratorInternal *Internal, uintptr_t ID);
+static uintptr_t CCGrowableIDGeneratorGetMaxID(CCGrowableIDGeneratorInternal *Internal);
+static uintptr_t CCGrowableIDGeneratorAssign(CCGrowableIDGeneratorInternal *Internal);
+
+const CCConcurrentIDGeneratorInterface CCGrowableIDGeneratorInterface = {
+    .create = CCGrowableIDGeneratorConstructor,
+    .destroy = (CCConcurrentIDGeneratorDestructorCallback)CCGrowableIDGeneratorDestructor,
+    .try = (CCConcurrentIDGeneratorTryAssignCallback)CCGrowableIDGeneratorTryAssign,
+    .recycle = (CCConcurrentIDGeneratorRecycleCallback)CCGrowableIDGeneratorRecycle,
+    .max = (CCConcurrentIDGeneratorGetMaxIDCallback)CCGrowableIDGeneratorGetMaxID,
+    .optional = {
+        .assign = (CCConcurrentIDGeneratorAssignCallback)CCGrowableIDGeneratorAssign
+    }
+};
+
+
+const CCConcurrentIDGeneratorInterface * const CCGrowableIDGenerator = &CCGrowableIDGeneratorInterface;
+
+static inline size_t CCGrowableIDGeneratorGetSegment(CCGrowableIDGeneratorInternal *Generator, uintptr_t ID)
+{
+    return CCBitCountSet(CCBitHighestSet((ID / Generator->chunkSize) + 1) - 1);
+}
+
+static inline uintptr_t CCGrowableIDGeneratorGetSegmentStart(CCGrowableIDGeneratorInternal *Generator, size_t Segment)
+{
+    return Generator->chunkSize * (((uintptr_t)1 << Segment) - 1);
+}
+
+static inline _Atomic(uintptr_t) *CCGrowableIDGeneratorGetLink(CCGrowableIDGeneratorInternal *Generator, uintptr_t ID)
+{
+    const size_t Segment = CCGrowableIDGeneratorGetSegment(Generator, ID);
+    
+    return atomic_load_explicit(&Generator->segments[Segment], memory_order_acquire) + (ID - CCGrowableIDGeneratorGetSegmentStart(Generator, Segment));
+}
+
+/*
+ Ensures the links for all IDs below Count have been allocated.
+ */
+static _Bool CCGrowableIDGeneratorReserveLinks(CCGrowableIDGeneratorInternal *Generator, uintptr_t Count)
+{
+    for (size_t Segment = 0, Last = CCGrowableIDGeneratorGetSegment(Generator, Count - 1); Segment <= Last; Segment++)
+    {
+        if (atomic_load_explicit(&Generator->segments[Segment], memory_order_acquire)) continue;
+        
+        _Atomic(uintptr_t) *Links = CCMalloc(Generator->allocator, sizeof(_Atomic(uintptr_t)) * (Generator->chunkSize << Segment), NULL, CC_DEFAULT_ERROR_CALLBACK);
+        if (!Links) return FALSE;
+        
+        _Atomic(uintptr_t) *Expected = NULL;
+        if (!atomic_compare_exchange_strong_explicit(&Generator->segments[Segment], &Expected, Links, memory_order_release, memory_order_acquire)) CCFree(Links);
+    }
+    
+    return TRUE;
+}
+
+/*
+ Pushes a chain of IDs (linked in the order they appear in the array) onto the recycled stack.
+ */
+static void CCGrowableIDGeneratorPush(CCGrowableIDGeneratorInternal *Generator, const uintptr_t *IDs, size_t Count)
+{
+    for (size_t Loop = 1; Loop < Count; Loop++) atomic_store_explicit(CCGrowableIDGeneratorGetLink(Generator, IDs[Loop - 1]), IDs[Loop] + 1, memory_order_relaxed);
+    
+    _Atomic(uintptr_t) *Last = CCGrowableIDGeneratorGetLink(Generator, IDs[Count - 1]);
+    
+    CCGrowableIDGeneratorStack Head = atomic_load_explicit(&Generator->recycled, memory_order_relaxed);
+    do {
+        atomic_store_explicit(Last, Head.id, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&Generator->recycled, &Head, ((CCGrowableIDGeneratorStack){ .id = IDs[0] + 1, .tag = Head.tag + 1 }), memory_order_release, memory_order_relaxed));
+}
+
+static size_t CCGrowableIDGeneratorPop(CCGrowableIDGeneratorInternal *Generator, uintptr_t *IDs, size_t Count)
+{
+    size_t Popped = 0;
+    for (CCGrowableIDGeneratorStack Head = atomic_load_explicit(&Generator->recycled, memory_order_acquire); (Head.id) && (Popped < Count); )
+    {
+        const uintptr_t Next = atomic_load_explicit(CCGrowableIDGeneratorGetLink(Generator, Head.id - 1), memory_order_relaxed);
+        
+        if (atomic_compare_exchange_weak_explicit(&Generator->recycled, &Head, ((CCGrowableIDGeneratorStack){ .id = Next, .tag = Head.tag + 1 }), memory_order_acquire, memory_order_acquire))
+        {
+            IDs[Popped++] = Head.id - 1;
+            Head = (CCGrowableIDGeneratorStack){ .id = Next, .tag = Head.tag + 1 };
+        }
+    }
+    
+    return Popped;
+}
+
+/*
+ Reserves a range of new IDs from the end of the ID space.
+ */
+static size_t CCGrowableIDGeneratorReserve(CCGrowableIDGeneratorInternal *Generator, uintptr_t *IDs, size_t Count)
+{
+    uintptr_t Next = atomic_load_explicit(&Generator->next, memory_order_relaxed);
+    do {
+        if (Next > (UINTPTR_MAX - Count)) return 0;
+        if (!CCGrowableIDGeneratorReserveLinks(Generator, Next + Count)) return 0;
+    } while (!atomic_compare_exchange_weak_explicit(&Generator->next, &Next, Next + Count, memory_order_relaxed, memory_order_relaxed));
+    
+    for (size_t Loop = 0; Loop < Count; Loop++) IDs[Loop] = Next + (Count - 1) - Loop;
+    
+    return Count;
+}
+
+static void CCGrowableIDGeneratorReleaseCache(CCGrowableIDGeneratorCache *Cache)
+{
+    if (Cache->count)
+    {
+        CCGrowableIDGeneratorPush(Cache->generator, Cache->ids, Cache->count);
+        Cache->count = 0;
+    }
+    
+    atomic_store_explicit(&Cache->owned, FALSE, memory_order_release);
+}
+
+static CCGrowableIDGeneratorCache *CCGrowableIDGeneratorGetCache(CCGrowableIDGeneratorInternal *Generator)
+{
+#if CC_ID_GENERATOR_USING_PTHREADS
+    CCGrowableIDGeneratorCache *Cache = pthread_getspecific(Generator->key);
+#elif CC_ID_GENERATOR_USING_STDTHREADS
+    CCGrowableIDGeneratorCache *Cache = tss_get(Generator->key);
+#endif
+    
+    if (CC_LIKELY(Cache)) return Cache;
+    
+    /*
+     Caches are never freed until the generator is destroyed, instead caches released by exited threads are reused.
+     */
+    for (Cache = atomic_load_explicit(&Generator->caches, memory_order_acquire); Cache; Cache = Cache->next)
+    {
+        _Bool Owned = FALSE;
+        if (atomic_compare_exchange_strong_explicit(&Cache->owned, &Owned, TRUE, memory_order_acquire, memory_order_relaxed)) break;
+    }
+    
+    if (!Cache)
+    {
+        Cache = CCMalloc(Generator->allocator, sizeof(CCGrowableIDGeneratorCache), NULL, CC_DEFAULT_ERROR_CALLBACK);
+        if (!Cache) return NULL;
+        
+        Cache->generator = Generator;
+        Cache->count = 0;
+        atomic_init(&Cache->owned, TRUE);
+        
+        Cache->next = atomic_load_explicit(&Generator->caches, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&Generator->caches, &Cache->next, Cache, memory_order_release, memory_order_relaxed));
+    }
+    
+#if CC_ID_GENERATOR_USING_PTHREADS
+    pthread_setspecific(Generator->key, Cache);
+#elif CC_ID_GENERATOR_USING_STDTHREADS
+    tss_set(Generator->key, Cache);
+#endif
+    
+    return Cache;
+}
+
+void *CCGrowableIDGeneratorConstructor(CCAllocatorType Allocator, size_t Count)
+{
+    CCGrowableIDGeneratorInternal *Generator = CCMalloc(Allocator, sizeof(CCGrowableIDGeneratorInternal), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    if (Generator)
+    {
+#if CC_ID_GENERATOR_USING_PTHREADS
+        if (pthread_key_create(&Generator->key, (void(*)(void*))CCGrowableIDGeneratorReleaseCache))
+#elif CC_ID_GENERATOR_USING_STDTHREADS
+        if (tss_create(&Generator->key, (tss_dtor_t)CCGrowableIDGeneratorReleaseCache) != thrd_success)
+#endif
+        {
+            CCFree(Generator);
+            return NULL;
+        }
+        
+        Generator->allocator = Allocator;
+        Generator->chunkSize = Count;
+        atomic_init(&Generator->next, 0);
+        atomic_init(&Generator->recycled, ((CCGrowableIDGeneratorStack){ .id = 0, .tag = 0 }));
+        atomic_init(&Generator->caches, NULL);
+        for (size_t Loop = 0; Loop < CC_GROWABLE_ID_GENERATOR_SEGMENT_MAX; Loop++) atomic_init(&Generator->segments[Loop], NULL);
+        
+        if (!CCGrowableIDGeneratorReserveLinks(Generator, Count))
+        {
+            CCGrowableIDGeneratorDestructor(Generator);
+            return NULL;
+        }
+    }
+    
+    return Generator;
+}
+
+void CCGrowableIDGeneratorDestructor(CCGrowableIDGeneratorInternal *Generator)
+{
+#if CC_ID_GENERATOR_USING_PTHREADS
+    pthread_key_delete(Generator->key);
+#elif CC_ID_GENERATOR_USING_STDTHREADS
+    tss_delete(Generator->key);
+#endif
+    
+    for (CCGrowableIDGeneratorCache *Cache = atomic_load_explicit(&Generator->caches, memory_order_relaxed); Cache; )
+    {
+        CCGrowableIDGeneratorCache *Next = Cache->next;
+        CCFree(Cache);
+        Cache = Next;
+    }
+    
+    for (size_t Loop = 0; Loop < CC_GROWABLE_ID_GENERATOR_SEGMENT_MAX; Loop++)
+    {
+        _Atomic(uintptr_t) *Links = atomic_load_explicit(&Generator->segments[Loop], memory_order_relaxed);
+        if (Links) CCFree(Links);
+    }
+    
+    CCFree(Generator);
+}
+
+_Bool CCGrowableIDGeneratorTryAssign(CCGrowableIDGeneratorInternal *Generator, uintptr_t *ID)
+{
+    CCGrowableIDGeneratorCache *Cache = CCGrowableIDGeneratorGetCache(Generator);
+    if (!Cache) return CCGrowableIDGeneratorPop(Generator, ID, 1) || CCGrowableIDGeneratorReserve(Generator, ID, 1);
+    
+    if (!Cache->count)
+    {
+        Cache->count = CCGrowableIDGeneratorPop(Generator, Cache->ids, CC_GROWABLE_ID_GENERATOR_BATCH_SIZE);
+        if (!Cache->count) Cache->count = CCGrowableIDGeneratorReserve(Generator, Cache->ids, CC_GROWABLE_ID_GENERATOR_BATCH_SIZE);
+        if (!Cache->count) return FALSE;
+    }
+    
+    *ID = Cache->ids[--Cache->count];
+    
+    return TRUE;
+}
+
+uintptr_t CCGrowableIDGeneratorAssign(CCGrowableIDGeneratorInternal *Generator)
+{
+    uintptr_t ID;
+    while (!CCGrowableIDGeneratorTryAssign(Generator, &ID)) CC_SPIN_WAIT();
+    
+    return ID;
+}
+
+void CCGrowableIDGeneratorRecycle(CCGrowableIDGeneratorInternal *Generator, uintptr_t ID)
+{
+    CCAssertLog(ID < atomic_load_explicit(&Generator->next, memory_order_relaxed), "ID must have been assigned from this pool");
+    
+    CCGrowableIDGeneratorCache *Cache = CCGrowableIDGeneratorGetCache(Generator);
+    if (!Cache)
+    {
+        CCGrowableIDGeneratorPush(Generator, &ID, 1);
+        return;
+    }
+    
+    if (Cache->count == CC_GROWABLE_ID_GENERATOR_CACHE_SIZE)
+    {
+        Cache->count -= CC_GROWABLE_ID_GENERATOR_BATCH_SIZE;
+        CCGrowableIDGeneratorPush(Generator, Cache->ids, CC_GROWABLE_ID_GENERATOR_BATCH_SIZE);
+        
+        for (size_t Loop = 0; Loop < Cache->count; Loop++) Cache->ids[Loop] = Cache->ids[Loop + CC_GROWABLE_ID_GENERATOR_BATCH_SIZE];
+    }
+    
+    Cache->ids[Cache->count++] = ID;
+}
+
+uintptr_t CCGrowableIDGeneratorGetMaxID(CCGrowableIDGeneratorInternal *Generator)
+{
+    const uintptr_t Count = atomic_load_explicit(&Generator->next, memory_order_relaxed);
+    
+    return Count > Generator->chunkSize ? Count : Generator->chunkSize;
+}
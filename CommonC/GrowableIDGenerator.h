@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * @header CCGrowableIDGenerator
+ * CCGrowableIDGenerator is an interface for an ID generator whose ID space grows on demand.
+ * The count the generator is created with is only the initial reservation, once all IDs are
+ * assigned new ones will continue to be assigned from the end of the ID space. So IDs start
+ * at 0 and remain mostly consecutive, though gaps may temporarily exist as IDs are reserved
+ * in batches.
+ *
+ * Each thread keeps a small cache of reserved and recycled IDs, so most assignments and
+ * recycles do not touch any shared state. IDs cached by a thread are returned to the
+ * generator when the thread exits.
+ *
+ * Allows for many producer-consumer access.
+ */
+#ifndef CommonC_GrowableIDGenerator_h
+#define CommonC_GrowableIDGenerator_h
+
+#include <CommonC/ConcurrentIDGeneratorInterface.h>
+
+/*!
+ * @brief A lockfree growable ID generator.
+ * @description The base ID will start at 0 and grow as more IDs are required. The max ID
+ *              reflects the current size of the ID space and so may increase over time.
+ *
+ * @performance Assigning and recycling are wait-free O(1) operations when they can be served
+ *              by the thread's cache, otherwise they are lock-free operations on the shared
+ *              pool. Growing the ID space never relocates existing state.
+ */
+extern const CCConcurrentIDGeneratorInterface * const CCGrowableIDGenerator;
+
+#endif
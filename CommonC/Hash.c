@@ -26,6 +26,7 @@
 #include "Hash.h"
 #include "Extensions.h"
 #include <stdint.h>
+#include <string.h>
 
 uint32_t CCHashJenkins32(CCData Data)
 {
@@ -185,3 +186,56 @@ Finalizer:
     
     return Hash;
 }
+
+uint32_t CCHashMurmur32Buffer(const void *Buffer, size_t Size, uint32_t Seed)
+{
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    const uint32_t r1 = 15;
+    const uint32_t r2 = 13;
+    const uint32_t m = 5;
+    const uint32_t n = 0xe6546b64;
+    
+    uint32_t Hash = Seed;
+    
+    const size_t BlockCount = Size / sizeof(uint32_t);
+    for (size_t Index = 0; Index < BlockCount; Index++)
+    {
+        uint32_t k;
+        memcpy(&k, Buffer + (Index * sizeof(uint32_t)), sizeof(k));
+        k *= c1;
+        k = CCHashROL32(k, r1);
+        k *= c2;
+        
+        Hash ^= k;
+        Hash = CCHashROL32(Hash, r2) * m + n;
+    }
+    
+    const uint8_t *Tail = Buffer + (BlockCount * sizeof(uint32_t));
+    uint32_t k = 0;
+    switch (Size - (BlockCount * sizeof(uint32_t)))
+    {
+        case 3:
+            k ^= Tail[2] << 16;
+        case 2:
+            k ^= Tail[1] << 8;
+        case 1:
+            k ^= Tail[0];
+            
+            k *= c1;
+            k = CCHashROL32(k, r1);
+            k *= c2;
+            
+            Hash ^= k;
+            break;
+    }
+    
+    Hash ^= Size;
+    Hash ^= (Hash >> 16);
+    Hash *= 0x85ebca6b;
+    Hash ^= (Hash >> 13);
+    Hash *= 0xc2b2ae35;
+    Hash ^= (Hash >> 16);
+    
+    return Hash;
+}
@@ -45,4 +45,17 @@ uint32_t CCHashJenkins32(CCData Data);
  */
 uint32_t CCHashMurmur32(CCData Data);
 
+/*!
+ * @brief An implementation of Murmur3 hash for a contiguous buffer.
+ * @description Matches @b CCHashMurmur32 of a data container holding the same bytes in a single
+ *              map, when using a seed of 0.
+ *
+ * @see https://en.wikipedia.org/wiki/MurmurHash#Algorithm
+ * @param Buffer The buffer to obtain the hash for.
+ * @param Size The size of the buffer.
+ * @param Seed The seed to start the hash from.
+ * @return The hash.
+ */
+uint32_t CCHashMurmur32Buffer(const void *Buffer, size_t Size, uint32_t Seed);
+
 #endif
@@ -28,6 +28,7 @@
 #include "Assertion.h"
 #include "Logging.h"
 #include "Platform.h"
+#include "Trace.h"
 #include <stdatomic.h>
 #include <string.h>
 
@@ -147,7 +148,7 @@ static void *CCLazyGarbageCollectorConstructor(CCAllocatorType Allocator)
             return NULL;
         }
         
-        atomic_init(&GC->managed, (CCLazyGarbageCollectorManagedList){ .list = NULL, .refCount = 0 });
+        atomic_init(&GC->managed, ((CCLazyGarbageCollectorManagedList){ .list = NULL, .refCount = 0 }));
     }
     
     return GC;
@@ -155,13 +156,16 @@ static void *CCLazyGarbageCollectorConstructor(CCAllocatorType Allocator)
 
 void CCLazyGarbageCollectorDestructor(CCLazyGarbageCollectorInternal *GC)
 {
+    //key deletion won't call the destructor, so the destroying thread's state has to be freed here
 #if CC_GC_USING_PTHREADS
+    CCFree(pthread_getspecific(GC->key));
     pthread_key_delete(GC->key);
 #elif CC_GC_USING_STDTHREADS
+    CCFree(tss_get(GC->key));
     tss_delete(GC->key);
 #endif
     
-    CCLazyGarbageCollectorManagedList Managed = atomic_load_explicit(&GC->managed, memory_order_relaxed);
+    CCLazyGarbageCollectorManagedList Managed = atomic_load_explicit(&GC->managed, memory_order_acquire);
     CCLazyGarbageCollectorDrain(GC, Managed.list);
     
     CCFree(GC);
@@ -199,6 +203,8 @@ void CCLazyGarbageCollectorBegin(CCLazyGarbageCollectorInternal *GC, CCAllocator
 
 static void CCLazyGarbageCollectorDrain(CCLazyGarbageCollectorInternal *GC, CCLazyGarbageCollectorNode *Node)
 {
+    CC_TRACE_SCOPE("CCLazyGarbageCollectorDrain");
+    
     while (Node)
     {
         ((CCLazyGarbageCollectorEntry*)CCLazyGarbageCollectorGetNodeData(Node))->reclaimer(((CCLazyGarbageCollectorEntry*)CCLazyGarbageCollectorGetNodeData(Node))->item);
@@ -217,13 +223,14 @@ void CCLazyGarbageCollectorEnd(CCLazyGarbageCollectorInternal *GC, CCAllocatorTy
     CCLazyGarbageCollectorThread *Local = tss_get(GC->key);
 #endif
     
+    //leaving releases this thread's accesses, and the last thread out acquires everyone else's before draining
     CCLazyGarbageCollectorManagedList Managed;
     if (Local->head)
     {
         do {
             Managed = atomic_load_explicit(&GC->managed, memory_order_relaxed);
             Local->tail->next = Managed.list;
-        } while (!atomic_compare_exchange_weak_explicit(&GC->managed, &Managed, ((CCLazyGarbageCollectorManagedList){ .list = Managed.refCount == 1 ? NULL : Local->head, .refCount = Managed.refCount - 1 }), memory_order_release, memory_order_relaxed));
+        } while (!atomic_compare_exchange_weak_explicit(&GC->managed, &Managed, ((CCLazyGarbageCollectorManagedList){ .list = Managed.refCount == 1 ? NULL : Local->head, .refCount = Managed.refCount - 1 }), memory_order_acq_rel, memory_order_relaxed));
         
         if (Managed.refCount == 1) CCLazyGarbageCollectorDrain(GC, Local->head);
     }
@@ -232,7 +239,7 @@ void CCLazyGarbageCollectorEnd(CCLazyGarbageCollectorInternal *GC, CCAllocatorTy
     {
         do {
             Managed = atomic_load_explicit(&GC->managed, memory_order_relaxed);
-        } while (!atomic_compare_exchange_weak_explicit(&GC->managed, &Managed, ((CCLazyGarbageCollectorManagedList){ .list = Managed.refCount == 1 ? NULL : Managed.list, .refCount = Managed.refCount - 1 }), memory_order_relaxed, memory_order_relaxed));
+        } while (!atomic_compare_exchange_weak_explicit(&GC->managed, &Managed, ((CCLazyGarbageCollectorManagedList){ .list = Managed.refCount == 1 ? NULL : Managed.list, .refCount = Managed.refCount - 1 }), memory_order_acq_rel, memory_order_relaxed));
         
         if ((Managed.refCount == 1) && (Managed.list)) CCLazyGarbageCollectorDrain(GC, Managed.list);
     }    
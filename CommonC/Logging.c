@@ -23,6 +23,10 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE //SCHED_IDLE
+#endif
+
 #define CC_DEFAULT_ERROR_CALLBACK NULL
 
 #include <string.h>
@@ -39,11 +43,21 @@
 #include "OrderedCollection.h"
 #include "TypeCallbacks.h"
 #include "CollectionEnumerator.h"
+#include "CCString.h"
+#include "ConcurrentGarbageCollector.h"
+#include "EpochGarbageCollector.h"
+#include "ThreadSlot_Private.h"
 
 // Specify which system specific loggers to build with
 //#define CC_EXCLUDE_ASL_LOGGER
 //#define CC_EXCLUDE_OSL_LOGGER
 //#define CC_EXCLUDE_SYSLOG_LOGGER
+//#define CC_EXCLUDE_ASYNC_LOGGER
+
+// Specify whether rotated log files can be compressed (requires zlib)
+#ifndef CC_LOG_COMPRESSION
+#define CC_LOG_COMPRESSION 0
+#endif
 
 #if CC_PLATFORM_APPLE
 
@@ -74,7 +88,30 @@
 #if CC_PLATFORM_POSIX_COMPLIANT
 #include <glob.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include <time.h>
+
+#if CC_LOG_COMPRESSION
+#include <zlib.h>
+#endif
+
+#if CC_PLATFORM_APPLE
+#include <pthread/qos.h>
+#endif
+
+#if !defined(CC_EXCLUDE_ASYNC_LOGGER)
+#define CC_ASYNC_LOGGER 1
+#include <stdatomic.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#endif
 #endif
 
 #if CC_PLATFORM_IOS
@@ -101,6 +138,8 @@ const char * const CCTagNotice = "NOTICE";
 const char * const CCTagInfo = "INFO";
 const char * const CCTagDebug = "DEBUG";
 
+_Atomic(CCLogLevel) CCLogLevelCurrent = ATOMIC_VAR_INIT(CCLogLevelDebug);
+
 
 
 #define CC_IDENTIFIER_ "io.scrimpycat.common"
@@ -110,7 +149,121 @@ const char * const CCTagDebug = "DEBUG";
 /// Set whether the default framework log file should be a new file (1) or if it should append onto the current (0)
 #define CC_NEW_FRAMEWORK_LOG_FILE 1
 
-static CCOrderedCollection FileList = NULL;
+/// Set how the default framework log file is rotated
+#define CC_FRAMEWORK_LOG_ROTATION (CCLogRotation){ .size = 16 * 1024 * 1024, .interval = 0, .retain = 4, .compress = TRUE }
+
+#pragma mark - Snapshots
+/*
+ The filters and files are published as immutable snapshots. Readers iterate the current snapshot inside a garbage
+ collection section, while writers publish a copy with the change and retire the old snapshot to the garbage collector.
+ */
+typedef struct {
+    size_t count;
+    _Alignas(void*) char elements[];
+} CCLogSnapshot;
+
+static _Atomic(CCConcurrentGarbageCollector) LogGC = ATOMIC_VAR_INIT(NULL);
+
+/// The collector the thread's outermost section was started with, and how deeply the sections are nested.
+static _Thread_local struct {
+    CCConcurrentGarbageCollector gc;
+    size_t depth;
+} LogSection = { .gc = NULL, .depth = 0 };
+
+static CCConcurrentGarbageCollector LogGarbageCollector(void)
+{
+    CCConcurrentGarbageCollector GC = atomic_load_explicit(&LogGC, memory_order_acquire);
+    if (CC_UNLIKELY(!GC))
+    {
+        CCConcurrentGarbageCollector NewGC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, CCEpochGarbageCollector);
+        if (!NewGC) return NULL;
+        
+        if (atomic_compare_exchange_strong_explicit(&LogGC, &GC, NewGC, memory_order_acq_rel, memory_order_acquire)) GC = NewGC;
+        else CCConcurrentGarbageCollectorDestroy(NewGC);
+    }
+    
+    return GC;
+}
+
+/*!
+ * @brief Start reading the snapshots.
+ * @description Sections may be nested, as logging can be re-entered by filters.
+ */
+static void LogSectionBegin(void)
+{
+    if (LogSection.depth++ == 0)
+    {
+        if ((LogSection.gc = LogGarbageCollector())) CCConcurrentGarbageCollectorBegin(LogSection.gc);
+    }
+}
+
+static void LogSectionEnd(void)
+{
+    if ((--LogSection.depth == 0) && (LogSection.gc))
+    {
+        CCConcurrentGarbageCollectorEnd(LogSection.gc);
+        LogSection.gc = NULL;
+    }
+}
+
+/*!
+ * @brief Publish a new snapshot with the element added.
+ * @param Snapshot The snapshot to be replaced.
+ * @param Size The size of the element.
+ * @param Element The element to be added.
+ * @param Prepend Whether the element should be added to the start of the snapshot, otherwise it is added to the end.
+ * @return Whether the element was added.
+ */
+static _Bool LogSnapshotAdd(_Atomic(CCLogSnapshot*) *Snapshot, size_t Size, const void *Element, _Bool Prepend)
+{
+    LogSectionBegin();
+    
+    for (CCLogSnapshot *Current = atomic_load_explicit(Snapshot, memory_order_acquire); ; )
+    {
+        const size_t Count = Current ? Current->count : 0;
+        
+        CCLogSnapshot *New;
+        CC_SAFE_Malloc(New, sizeof(CCLogSnapshot) + (Size * (Count + 1)),
+                       LogSectionEnd();
+                       return FALSE;
+                       );
+        
+        New->count = Count + 1;
+        memcpy(New->elements + (Prepend ? 0 : Size * Count), Element, Size);
+        if (Count) memcpy(New->elements + (Prepend ? Size : 0), Current->elements, Size * Count);
+        
+        if (atomic_compare_exchange_strong_explicit(Snapshot, &Current, New, memory_order_acq_rel, memory_order_acquire))
+        {
+            //Without a collector the old snapshot can't be safely reclaimed, so it is leaked
+            if ((Current) && (LogSection.gc)) CCConcurrentGarbageCollectorManage(LogSection.gc, Current, CCFree);
+            
+            break;
+        }
+        
+        CCFree(New);
+    }
+    
+    LogSectionEnd();
+    
+    return TRUE;
+}
+
+static inline const void *LogSnapshotGet(_Atomic(CCLogSnapshot*) *Snapshot, size_t *Count)
+{
+    CCLogSnapshot *Current = atomic_load_explicit(Snapshot, memory_order_acquire);
+    
+    *Count = Current ? Current->count : 0;
+    
+    return Current ? Current->elements : NULL;
+}
+
+/// The FSHandle snapshot.
+static _Atomic(CCLogSnapshot*) FileList = ATOMIC_VAR_INIT(NULL);
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+/// Set while the thread is writing to the log files, so any messages logged by the write don't recurse.
+static _Thread_local _Bool WritingFiles = FALSE;
+#endif
 
 #if CC_USE_GCD
 static dispatch_queue_t LogQueue;
@@ -142,11 +295,7 @@ static void LogMessageOSL(CCOSLogContext *Ctx)
     os_log_with_type(Ctx->log, Ctx->type, "%s", Ctx->msg);
     os_release(Ctx->log);
     
-    if (Ctx->destroy)
-    {
-        CCFree((char*)Ctx->msg);
-        CCFree(Ctx);
-    }
+    if (Ctx->destroy) CCFree(Ctx);
 }
 #endif
 
@@ -181,19 +330,10 @@ static void Setup(void)
                 
                 FSPath LogPath = FSPathCreateFromSystemPath(Path);
                 
-                if (FSManagerCreate(LogPath, FALSE) == FSOperationSuccess)
-                {
-                    FSHandle Handle;
-                    if (FSHandleOpen(LogPath, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
-                    {
 #if CC_NEW_FRAMEWORK_LOG_FILE
-                        FSHandleRemove(Handle, FSManagerGetSize(Handle->path), FSBehaviourPreserveOffset);
-#else
-                        FSHandleSetOffset(Handle, FSManagerGetSize(Handle->path));
+                FSManagerRemove(LogPath);
 #endif
-                        CCLogAddFile(Handle);
-                    }
-                }
+                CCLogAddRotatingFile(LogPath, CC_FRAMEWORK_LOG_ROTATION);
                 
                 FSPathDestroy(LogPath);
             }
@@ -209,206 +349,1628 @@ static void Setup(void)
         return;
     }
     
-    CFURLRef PathURL = CFURLCreateCopyAppendingPathComponent(kCFAllocatorDefault, HomeDir, CFSTR("Documents/common.log"), FALSE);
-    CFRelease(HomeDir);
-    if (!PathURL)
-    {
-        CC_LOG_ERROR("Failed to create path. Won't be able to record logs locally to app.");
-        return;
-    }
+    CFURLRef PathURL = CFURLCreateCopyAppendingPathComponent(kCFAllocatorDefault, HomeDir, CFSTR("Documents/common.log"), FALSE);
+    CFRelease(HomeDir);
+    if (!PathURL)
+    {
+        CC_LOG_ERROR("Failed to create path. Won't be able to record logs locally to app.");
+        return;
+    }
+    
+    CFStringRef Path = CFURLCopyFileSystemPath(PathURL, kCFURLPOSIXPathStyle);
+    CFRelease(PathURL);
+    if (!Path)
+    {
+        CC_LOG_ERROR("Failed to create path. Won't be able to record logs locally to app.");
+        return;
+    }
+    
+    size_t Size = CFStringGetLength(Path) + 1;
+    char *PathStr = NULL;
+    CC_TEMP_Malloc(PathStr, sizeof(char) * Size,
+                   CC_LOG_ERROR("Failed to create path. Won't be able to record logs locally to app.");
+                   CFRelease(Path);
+                   return;
+                   );
+    
+    if (CFStringGetCString(Path, PathStr, Size, kCFStringEncodingASCII))
+    {
+        FSPath LogPath = FSPathCreateFromSystemPath(PathStr);
+        
+        if (FSManagerCreate(LogPath, FALSE) == FSOperationSuccess)
+        {
+            FSHandle Handle;
+            if (FSHandleOpen(LogPath, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+            {
+#if CC_NEW_FRAMEWORK_LOG_FILE
+                FSHandleRemove(Handle, FSManagerGetSize(Handle->path), FSBehaviourPreserveOffset);
+#else
+                FSHandleSetOffset(Handle, FSManagerGetSize(Handle->path));
+#endif
+                CCLogAddFile(Handle);
+            }
+        }
+        
+        FSPathDestroy(LogPath);
+    }
+    
+    CFRelease(Path);
+    CC_TEMP_Free(PathStr);
+#endif
+}
+
+#if CC_ASL_LOGGER
+static void ASLSetup(void)
+{
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    Client = asl_open(NULL, NULL, 0);
+#pragma clang diagnostic pop
+}
+#endif
+
+#pragma mark - Filters
+typedef struct {
+    void *filter;
+    _Bool isBlock;
+} CCFilter;
+
+/// The CCFilter snapshots, the most recently added filter is first.
+static _Atomic(CCLogSnapshot*) InputFilters = ATOMIC_VAR_INIT(NULL), SpecifierFilters = ATOMIC_VAR_INIT(NULL), MessageFilters = ATOMIC_VAR_INIT(NULL);
+
+#undef CCLogAddFilter
+void CCLogAddFilter(CCLogFilterType Type, CCLogFilter Filter)
+{
+    const CCFilter NewFilter = { .filter = Filter, .isBlock = FALSE };
+    
+    if (Type & CCLogFilterInput) LogSnapshotAdd(&InputFilters, sizeof(CCFilter), &NewFilter, TRUE);
+    if (Type & CCLogFilterSpecifier) LogSnapshotAdd(&SpecifierFilters, sizeof(CCFilter), &NewFilter, TRUE);
+    if (Type & CCLogFilterMessage) LogSnapshotAdd(&MessageFilters, sizeof(CCFilter), &NewFilter, TRUE);
+}
+
+#if __BLOCKS__
+void CCLogAddFilterBlock(CCLogFilterType Type, CCLogFilterBlock Filter)
+{
+    if (Type & CCLogFilterInput) LogSnapshotAdd(&InputFilters, sizeof(CCFilter), &(CCFilter){ .filter = Block_copy(Filter), .isBlock = TRUE }, TRUE);
+    if (Type & CCLogFilterSpecifier) LogSnapshotAdd(&SpecifierFilters, sizeof(CCFilter), &(CCFilter){ .filter = Block_copy(Filter), .isBlock = TRUE }, TRUE);
+    if (Type & CCLogFilterMessage) LogSnapshotAdd(&MessageFilters, sizeof(CCFilter), &(CCFilter){ .filter = Block_copy(Filter), .isBlock = TRUE }, TRUE);
+}
+#endif
+
+#pragma mark - CCLogMessage functions
+#define CC_MESSAGE_BATCH_SIZE 64
+
+typedef struct CCLogMessageBuffer {
+    char **message;
+    size_t *length;
+    int (*write)(const struct CCLogMessage *Msg, const char *String, size_t Length);
+    int (*remove)(const struct CCLogMessage *Msg, size_t Length);
+    size_t *bufferSize;
+} CCLogMessageBuffer;
+
+static int MessageBufferWrite(CCLogMessageBuffer *Msg, const char *String, size_t Length)
+{
+    if (*Msg->bufferSize - *Msg->length < Length)
+    {
+        *Msg->bufferSize += CC_MESSAGE_BATCH_SIZE + ((Length / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
+        CC_SAFE_Realloc(*Msg->message, sizeof(char) * (*Msg->bufferSize + 1),
+                        return -1;
+                        );
+    }
+    
+    strncpy(*Msg->message + *Msg->length, String, Length);
+    (*Msg->message)[(*Msg->length += Length)] = 0;
+    
+    return 0;
+}
+
+static int MessageBufferRemove(CCLogMessageBuffer *Msg, size_t Length)
+{
+    if (Length > *Msg->length) Length = *Msg->length;
+    
+    (*Msg->message)[(*Msg->length -= Length)] = 0;
+    
+    return 0;
+}
+
+#pragma mark - File Output
+#if CC_PLATFORM_POSIX_COMPLIANT
+/*!
+ * @brief Write the lines to the descriptor with a single system call, unless the write is interrupted or short.
+ */
+static void LogWriteDescriptor(int Descriptor, const struct iovec *IOVec, size_t Count)
+{
+    ssize_t Written;
+    while (((Written = writev(Descriptor, IOVec, (int)Count)) == -1) && (errno == EINTR));
+    
+    for (size_t Loop = 0; (Written >= 0) && (Loop < Count); Loop++)
+    {
+        if ((size_t)Written >= IOVec[Loop].iov_len)
+        {
+            Written -= IOVec[Loop].iov_len;
+            continue;
+        }
+        
+        for (size_t Offset = Written; Offset < IOVec[Loop].iov_len; )
+        {
+            const ssize_t Partial = write(Descriptor, (const char*)IOVec[Loop].iov_base + Offset, IOVec[Loop].iov_len - Offset);
+            if (Partial > 0) Offset += Partial;
+            else if ((Partial == -1) && (errno != EINTR)) return;
+        }
+        
+        Written = 0;
+    }
+}
+
+#pragma mark - Rotation
+#ifndef CC_LOG_ROTATION_POLL_INTERVAL
+/// The maximum number of milliseconds before a rotated file is closed and processed when nothing is being logged.
+#define CC_LOG_ROTATION_POLL_INTERVAL 1000
+#endif
+
+/*
+ Rotating files are renamed to "<path>.<segment>" once they reach their size or interval, and a new file is opened in
+ their place. The old descriptor is swapped out and retired to the garbage collector, so loggers never wait on a
+ rotation and lines still being written to the old descriptor end up in the segment. Once the descriptor is reclaimed
+ the segment is handed to a background thread to be compressed and to apply the retention limit.
+ */
+typedef struct CCLogRotatingFile CCLogRotatingFile;
+
+typedef struct {
+    /// The rotating file the descriptor belongs to.
+    CCLogRotatingFile *file;
+    /// The segment the file was rotated to, or 0 if it was not rotated.
+    uint64_t segment;
+    /// The file descriptor.
+    int fd;
+} CCLogRotatingDescriptor;
+
+struct CCLogRotatingFile {
+    /// The rotation settings.
+    CCLogRotation rotation;
+    /// The descriptor currently being written to.
+    _Atomic(CCLogRotatingDescriptor*) descriptor;
+    /// The number of bytes written to the current file.
+    _Atomic(size_t) size;
+    /// The time the current file should be rotated at.
+    _Atomic(time_t) deadline;
+    /// Set while the file is being rotated.
+    atomic_flag rotating;
+    /// The most recent segment, this is only accessed while rotating.
+    uint64_t segment;
+    /// The length of the path.
+    size_t length;
+    /// The system path of the file.
+    char path[];
+};
+
+typedef struct CCLogRotationJob {
+    struct CCLogRotationJob *next;
+    CCLogRotatingFile *file;
+    uint64_t segment;
+} CCLogRotationJob;
+
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    CCLogRotationJob *jobs, **tail;
+    _Bool running;
+} LogRotation = {
+    .once = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+    .jobs = NULL,
+    .tail = &LogRotation.jobs,
+    .running = FALSE
+};
+
+/// The CCLogRotatingFile snapshot.
+static _Atomic(CCLogSnapshot*) RotatingFileList = ATOMIC_VAR_INIT(NULL);
+
+static time_t LogRotationDeadline(const CCLogRotatingFile *File, time_t Now)
+{
+    //Align to the interval, so an hourly or daily rotation happens on the hour or at midnight (UTC)
+    return File->rotation.interval ? ((Now / File->rotation.interval) + 1) * File->rotation.interval : 0;
+}
+
+static _Bool LogRotationDue(CCLogRotatingFile *File, size_t Size, time_t Now)
+{
+    if ((File->rotation.size) && (Size >= File->rotation.size)) return TRUE;
+    
+    return (File->rotation.interval) && (Now >= atomic_load_explicit(&File->deadline, memory_order_relaxed));
+}
+
+/*!
+ * @brief Find the segments of a rotating file, removing the older segments.
+ * @param File The rotating file.
+ * @param Remove The segments up to and including this segment are removed, or 0 to not remove any.
+ * @return The most recent segment, or 0 if there are none.
+ */
+static uint64_t LogRotationScan(const CCLogRotatingFile *File, uint64_t Remove)
+{
+    const char *Separator = strrchr(File->path, '/');
+    const size_t DirectoryLength = Separator ? (size_t)(Separator - File->path) + 1 : 2;
+    const char *Name = Separator ? Separator + 1 : File->path;
+    const size_t NameLength = strlen(Name);
+    
+    char Directory[DirectoryLength + 1];
+    memcpy(Directory, Separator ? File->path : "./", DirectoryLength);
+    Directory[DirectoryLength] = 0;
+    
+    DIR *Dir = opendir(Directory);
+    if (!Dir) return 0;
+    
+    uint64_t Latest = 0;
+    for (struct dirent *Entry; (Entry = readdir(Dir)); )
+    {
+        if ((strncmp(Entry->d_name, Name, NameLength)) || (Entry->d_name[NameLength] != '.') || (!isdigit((unsigned char)Entry->d_name[NameLength + 1]))) continue;
+        
+        char *End;
+        const uint64_t Segment = strtoull(Entry->d_name + NameLength + 1, &End, 10);
+        if ((*End) && (strcmp(End, ".gz"))) continue;
+        
+        //Segments are numbered from 1, so a segment 0 belongs to something else and is never removed
+        if ((Segment) && (Segment <= Remove))
+        {
+            char Path[DirectoryLength + strlen(Entry->d_name) + 1];
+            snprintf(Path, sizeof(Path), "%s%s", Directory, Entry->d_name);
+            unlink(Path);
+        }
+        
+        else if (Segment > Latest) Latest = Segment;
+    }
+    
+    closedir(Dir);
+    
+    return Latest;
+}
+
+#if CC_LOG_COMPRESSION
+/*!
+ * @brief Compress the segment to "<segment>.gz", removing the segment if successful.
+ */
+static void LogRotationCompress(const char *Segment)
+{
+    const int Input = open(Segment, O_RDONLY | O_CLOEXEC);
+    if (Input == -1) return;
+    
+    const size_t Length = strlen(Segment);
+    char Path[Length + sizeof(".gz")];
+    memcpy(Path, Segment, Length);
+    memcpy(Path + Length, ".gz", sizeof(".gz"));
+    
+    gzFile Output = gzopen(Path, "wb");
+    _Bool Success = Output != NULL;
+    
+    char Buffer[16384];
+    for (ssize_t Read; (Success) && ((Read = read(Input, Buffer, sizeof(Buffer))) != 0); )
+    {
+        if (Read == -1) Success = errno == EINTR;
+        else Success = gzwrite(Output, Buffer, (unsigned int)Read) == Read;
+    }
+    
+    if ((Output) && (gzclose(Output) != Z_OK)) Success = FALSE;
+    
+    close(Input);
+    
+    unlink(Success ? Segment : Path);
+}
+#endif
+
+static void LogRotationProcess(CCLogRotatingFile *File, uint64_t Segment)
+{
+#if CC_LOG_COMPRESSION
+    if (File->rotation.compress)
+    {
+        char Path[File->length + 22];
+        snprintf(Path, sizeof(Path), "%s.%" PRIu64, File->path, Segment);
+        LogRotationCompress(Path);
+    }
+#endif
+    
+    if ((File->rotation.retain) && (Segment > File->rotation.retain)) LogRotationScan(File, Segment - File->rotation.retain);
+}
+
+static void *LogRotationWorker(void *Arg)
+{
+#if defined(SCHED_IDLE)
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &(struct sched_param){ .sched_priority = 0 });
+#elif CC_PLATFORM_APPLE
+    pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#endif
+    
+    pthread_mutex_lock(&LogRotation.lock);
+    
+    for ( ; ; )
+    {
+        if (!LogRotation.jobs)
+        {
+            struct timespec Time;
+            clock_gettime(CLOCK_REALTIME, &Time);
+            
+            Time.tv_nsec += CC_LOG_ROTATION_POLL_INTERVAL * 1000000;
+            Time.tv_sec += Time.tv_nsec / 1000000000;
+            Time.tv_nsec %= 1000000000;
+            
+            pthread_cond_timedwait(&LogRotation.changed, &LogRotation.lock, &Time);
+        }
+        
+        CCLogRotationJob *Jobs = LogRotation.jobs;
+        LogRotation.jobs = NULL;
+        LogRotation.tail = &LogRotation.jobs;
+        
+        pthread_mutex_unlock(&LogRotation.lock);
+        
+        //Advance the garbage collector, so retired descriptors are reclaimed even when nothing is being logged
+        LogSectionBegin();
+        LogSectionEnd();
+        
+        while (Jobs)
+        {
+            LogRotationProcess(Jobs->file, Jobs->segment);
+            
+            CCLogRotationJob *Job = Jobs;
+            Jobs = Jobs->next;
+            CCFree(Job);
+        }
+        
+        pthread_mutex_lock(&LogRotation.lock);
+    }
+    
+    return NULL;
+}
+
+static void LogRotationSetup(void)
+{
+    pthread_t Thread;
+    if (pthread_create(&Thread, NULL, LogRotationWorker, NULL)) return;
+    
+    pthread_detach(Thread);
+    
+    LogRotation.running = TRUE;
+}
+
+static void LogRotatingDescriptorReclaim(CCLogRotatingDescriptor *Descriptor)
+{
+    close(Descriptor->fd);
+    
+    if ((Descriptor->segment) && (LogRotation.running))
+    {
+        CCLogRotationJob *Job;
+        CC_SAFE_Malloc(Job, sizeof(CCLogRotationJob),
+                       CCFree(Descriptor);
+                       return;
+                       );
+        
+        *Job = (CCLogRotationJob){ .next = NULL, .file = Descriptor->file, .segment = Descriptor->segment };
+        
+        pthread_mutex_lock(&LogRotation.lock);
+        *LogRotation.tail = Job;
+        LogRotation.tail = &Job->next;
+        pthread_cond_signal(&LogRotation.changed);
+        pthread_mutex_unlock(&LogRotation.lock);
+    }
+    
+    CCFree(Descriptor);
+}
+
+/*!
+ * @brief Rotate the file if it is still due, this must be called inside a snapshot section.
+ */
+static void LogRotate(CCLogRotatingFile *File, time_t Now)
+{
+    if ((!LogSection.gc) || (atomic_flag_test_and_set_explicit(&File->rotating, memory_order_acquire))) return;
+    
+    //Another thread may have rotated the file since the write
+    if (LogRotationDue(File, atomic_load_explicit(&File->size, memory_order_relaxed), Now))
+    {
+        //Whether or not the rotation succeeds, don't retry until the next size or interval
+        atomic_store_explicit(&File->size, 0, memory_order_relaxed);
+        atomic_store_explicit(&File->deadline, LogRotationDeadline(File, Now), memory_order_relaxed);
+        
+        CCLogRotatingDescriptor *Descriptor;
+        CC_SAFE_Malloc(Descriptor, sizeof(CCLogRotatingDescriptor),
+                       atomic_flag_clear_explicit(&File->rotating, memory_order_release);
+                       return;
+                       );
+        
+        char Segment[File->length + 22];
+        snprintf(Segment, sizeof(Segment), "%s.%" PRIu64, File->path, File->segment + 1);
+        
+        //The file may have been removed, in which case there's no segment
+        const _Bool Renamed = !rename(File->path, Segment);
+        if ((Renamed) || (errno == ENOENT))
+        {
+            *Descriptor = (CCLogRotatingDescriptor){ .file = File, .segment = 0, .fd = open(File->path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) };
+            
+            if (Descriptor->fd != -1)
+            {
+                if (Renamed) File->segment++;
+                
+                CCLogRotatingDescriptor *Retired = atomic_exchange_explicit(&File->descriptor, Descriptor, memory_order_acq_rel);
+                Retired->segment = Renamed ? File->segment : 0;
+                
+                CCConcurrentGarbageCollectorManage(LogSection.gc, Retired, (CCConcurrentGarbageCollectorReclaimer)LogRotatingDescriptorReclaim);
+                
+                Descriptor = NULL;
+            }
+            
+            else if (Renamed) rename(Segment, File->path);
+        }
+        
+        CC_SAFE_Free(Descriptor);
+    }
+    
+    atomic_flag_clear_explicit(&File->rotating, memory_order_release);
+}
+
+static void LogWriteRotatingFiles(const struct iovec *IOVec, size_t Count, _Bool Crashing)
+{
+    size_t FileCount;
+    CCLogRotatingFile * const *Files = LogSnapshotGet(&RotatingFileList, &FileCount);
+    if (!FileCount) return;
+    
+    size_t Length = 0;
+    for (size_t Loop = 0; Loop < Count; Loop++) Length += IOVec[Loop].iov_len;
+    
+    time_t Now = 0;
+    for (size_t Loop = 0; Loop < FileCount; Loop++)
+    {
+        CCLogRotatingFile *File = Files[Loop];
+        
+        LogWriteDescriptor(atomic_load_explicit(&File->descriptor, memory_order_acquire)->fd, IOVec, Count);
+        
+        const size_t Size = atomic_fetch_add_explicit(&File->size, Length, memory_order_relaxed) + Length;
+        if ((File->rotation.interval) && (!Now)) Now = time(NULL);
+        
+        if ((!Crashing) && (LogRotationDue(File, Size, Now))) LogRotate(File, Now);
+    }
+}
+
+static void LogWriteFiles(const struct iovec *IOVec, size_t Count, _Bool Crashing)
+{
+    //A crash may have interrupted the garbage collector, so read the snapshots unprotected (files are never removed, and
+    //rotating files aren't rotated while crashing)
+    if (!Crashing) LogSectionBegin();
+    
+    WritingFiles = TRUE;
+    
+    size_t FileCount;
+    const FSHandle *Files = LogSnapshotGet(&FileList, &FileCount);
+    for (size_t Loop = 0; Loop < FileCount; Loop++)
+    {
+        LogWriteDescriptor(FSHandleGetFileDescriptor(Files[Loop]), IOVec, Count);
+    }
+    
+    LogWriteRotatingFiles(IOVec, Count, Crashing);
+    
+    WritingFiles = FALSE;
+    
+    if (!Crashing) LogSectionEnd();
+}
+#endif
+
+static int LogMessage(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, time_t Time, const char *FormatString, va_list Args);
+
+#if CC_ASYNC_LOGGER
+#ifndef CC_LOG_ASYNC_BUFFER_SIZE
+/// The size of the per-thread buffer messages are queued in. Must be a power of 2.
+#define CC_LOG_ASYNC_BUFFER_SIZE 65536
+#endif
+
+#ifndef CC_LOG_ASYNC_FLUSH_INTERVAL
+/// The maximum number of milliseconds queued messages wait before being written.
+#define CC_LOG_ASYNC_FLUSH_INTERVAL 10
+#endif
+
+#ifndef CC_LOG_BINARY_BUFFER_SIZE
+/// The size of the per-thread buffer binary messages are queued in. Must be a power of 2.
+#define CC_LOG_BINARY_BUFFER_SIZE 65536
+#endif
+
+#ifndef CC_LOG_BINARY_RECORD_MAX
+/// The maximum size of a binary message, larger messages are formatted immediately.
+#define CC_LOG_BINARY_RECORD_MAX 1024
+#endif
+
+#define CC_LOG_ASYNC_BATCH_SIZE 32
+#define CC_LOG_ASYNC_CRASH_ATTEMPTS 1000
+
+_Static_assert((CC_LOG_ASYNC_BUFFER_SIZE & (CC_LOG_ASYNC_BUFFER_SIZE - 1)) == 0, "CC_LOG_ASYNC_BUFFER_SIZE must be a power of 2");
+_Static_assert((CC_LOG_BINARY_BUFFER_SIZE & (CC_LOG_BINARY_BUFFER_SIZE - 1)) == 0, "CC_LOG_BINARY_BUFFER_SIZE must be a power of 2");
+_Static_assert(CC_LOG_BINARY_RECORD_MAX <= (CC_LOG_BINARY_BUFFER_SIZE / 2), "CC_LOG_BINARY_RECORD_MAX must fit in the binary buffer");
+
+/*
+ A single producer (the owning thread) single consumer (the drainer) ring of complete lines. The head and
+ tail are free running, so the ring is drained by writing out the bytes between them.
+ 
+ Binary messages are queued in a separate ring of 8 byte aligned records, which are formatted by the drainer.
+ A record that would cross the end of the ring is preceded by padding. Each record notes the head of the line
+ ring when it was queued, so the drainer writes out the lines queued before it first and keeps the thread's
+ messages in order.
+ */
+typedef struct {
+    CCThreadSlot slot;
+    _Atomic(size_t) head, tail;
+    //The head of the line ring captured by the drainer before formatting binary messages (only used by the drainer)
+    size_t drain;
+    char data[CC_LOG_ASYNC_BUFFER_SIZE];
+    struct {
+        _Atomic(size_t) head, tail;
+        _Alignas(8) char data[CC_LOG_BINARY_BUFFER_SIZE];
+    } binary;
+} CCLogAsyncBuffer;
+
+typedef enum {
+    CCLogBinaryArgumentInt,
+    CCLogBinaryArgumentLong,
+    CCLogBinaryArgumentLongLong,
+    CCLogBinaryArgumentIntMax,
+    CCLogBinaryArgumentSize,
+    CCLogBinaryArgumentPtrDiff,
+    CCLogBinaryArgumentDouble,
+    CCLogBinaryArgumentLongDouble,
+    CCLogBinaryArgumentPointer,
+    //Null terminated string prefixed by its 32-bit size
+    CCLogBinaryArgumentString,
+    //Characters prefixed by their 32-bit size, or UINT32_MAX if null
+    CCLogBinaryArgumentCCString
+} CCLogBinaryArgument;
+
+typedef struct {
+    const char *text;
+    size_t length;
+    //The number of '*' width and precision arguments before the value, or -1 if the segment is literal text
+    int stars;
+    //The precision of the specifier, -1 if there is none, or -2 if it's the last '*' argument
+    int precision;
+    CCLogBinaryArgument type;
+} CCLogBinarySegment;
+
+struct CCLogBinaryFormat {
+    const char *tag, *identifier;
+    const char *filename, *functionName;
+    unsigned int line;
+    //The format uses specifiers whose arguments can't be recorded, so is formatted immediately
+    _Bool immediate;
+    size_t count;
+    CCLogBinarySegment segments[];
+};
+
+typedef struct {
+    //The size of the record (including the header and any alignment)
+    uint32_t size;
+    CCLoggingOption option;
+    //The format of the message, or NULL if the record is padding
+    const CCLogBinaryFormat *format;
+    //The time of the message in nanoseconds since the epoch
+    uint64_t time;
+    //The head of the line ring when the message was queued
+    size_t text;
+} CCLogBinaryHeader;
+
+static struct {
+    pthread_once_t once;
+    pthread_key_t key;
+    pthread_mutex_t lock;
+    pthread_cond_t changed, drained;
+    _Bool wake;
+    _Atomic(_Bool) running;
+    _Atomic(CCThreadSlot*) buffers;
+    atomic_flag draining;
+    _Atomic(CCLogAsyncOverflow) overflow;
+    _Atomic(size_t) dropped;
+} LogAsync = {
+    .once = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .changed = PTHREAD_COND_INITIALIZER,
+    .drained = PTHREAD_COND_INITIALIZER,
+    .draining = ATOMIC_FLAG_INIT
+};
+
+/// Set while the thread is draining, so any messages logged by the drain are written synchronously.
+static _Thread_local _Bool Draining = FALSE;
+
+#pragma mark Binary Output
+
+static CCLogBinaryFormat *LogBinaryFormatCreate(const char *Tag, const char *Identifier, const char *Filename, const char *FunctionName, unsigned int Line, const char *FormatString)
+{
+    size_t Max = 1;
+    for (const char *Specifier = FormatString; (Specifier = strchr(Specifier, '%')); Specifier++) Max += 2;
+    
+    CCLogBinaryFormat *Format;
+    CC_SAFE_Malloc(Format, sizeof(CCLogBinaryFormat) + (sizeof(CCLogBinarySegment) * Max),
+                   return NULL;
+                   );
+    
+    *Format = (CCLogBinaryFormat){
+        .tag = Tag,
+        .identifier = Identifier,
+        .filename = Filename,
+        .functionName = FunctionName,
+        .line = Line,
+        .immediate = FALSE,
+        .count = 0
+    };
+    
+    const char *Literal = FormatString;
+    for (const char *Specifier = FormatString; (Specifier = strchr(Specifier, '%')); )
+    {
+        const size_t LiteralLength = (Specifier - Literal) + (Specifier[1] == '%');
+        if (LiteralLength) Format->segments[Format->count++] = (CCLogBinarySegment){ .text = Literal, .length = LiteralLength, .stars = -1 };
+        
+        if (Specifier[1] == '%')
+        {
+            Literal = Specifier += 2;
+            continue;
+        }
+        
+        CCFormatSpecifierInfo Info;
+        const size_t Conversion = CCGetFormatSpecifierInfo(Specifier, &Info);
+        
+        CCLogBinarySegment Segment = {
+            .text = Specifier,
+            .length = Conversion + 1,
+            .stars = (Info.options.width && Info.width.valueInArgs) + (Info.options.precision && Info.precision.valueInArgs),
+            .precision = Info.options.precision ? (Info.precision.valueInArgs ? -2 : Info.precision.value) : -1,
+            .type = CCLogBinaryArgumentInt
+        };
+        
+        switch (Specifier[Conversion])
+        {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'B':
+                switch (Info.length)
+                {
+                    case 'l':
+                        Segment.type = CCLogBinaryArgumentLong;
+                        break;
+                        
+                    case 'll':
+                        Segment.type = CCLogBinaryArgumentLongLong;
+                        break;
+                        
+                    case 'j':
+                        Segment.type = CCLogBinaryArgumentIntMax;
+                        break;
+                        
+                    case 'z':
+                        Segment.type = CCLogBinaryArgumentSize;
+                        break;
+                        
+                    case 't':
+                        Segment.type = CCLogBinaryArgumentPtrDiff;
+                        break;
+                }
+                break;
+                
+            case 'c':
+            case 'C':
+                break;
+                
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                Segment.type = Info.length == 'L' ? CCLogBinaryArgumentLongDouble : CCLogBinaryArgumentDouble;
+                break;
+                
+            case 's':
+                Segment.type = CCLogBinaryArgumentString;
+                Format->immediate |= Info.length == 'l';
+                break;
+                
+            case 'S':
+                Segment.type = CCLogBinaryArgumentCCString;
+                break;
+                
+            case 'p':
+                Segment.type = CCLogBinaryArgumentPointer;
+                break;
+                
+            default:
+                //%n, custom specifiers that take other arguments (%[], %DEL), or unknown specifiers
+                Format->immediate = TRUE;
+                break;
+        }
+        
+        if ((Format->immediate) || (!Specifier[Conversion])) break;
+        
+        Format->segments[Format->count++] = Segment;
+        Literal = Specifier += Segment.length;
+    }
+    
+    if (*Literal) Format->segments[Format->count++] = (CCLogBinarySegment){ .text = Literal, .length = strlen(Literal), .stars = -1 };
+    
+    return Format;
+}
+
+static void LogBinaryFormatSpecifier(const CCLogData *LogData, CCLogMessageBuffer *Message, const CCLogBinarySegment *Segment, ...)
+{
+    va_list Args;
+    va_start(Args, Segment);
+    
+    CCLogSpecifierData SpecData = {
+        .msg = (CCLogMessage*)Message,
+        .specifier = Segment->text,
+        .args = &Args
+    };
+    
+    size_t Consumed = 0, FilterCount;
+    const CCFilter *Filters = LogSnapshotGet(&SpecifierFilters, &FilterCount);
+    for (const CCFilter *CurrentFilter = Filters; (CurrentFilter != Filters + FilterCount) && (!Consumed); CurrentFilter++)
+    {
+#if __BLOCKS__
+        if (CurrentFilter->isBlock) Consumed = ((CCLogSpecifierFilterBlock)CurrentFilter->filter)(LogData, &SpecData);
+        else
+#endif
+            Consumed = ((CCLogSpecifierFilter)CurrentFilter->filter)(LogData, &SpecData);
+    }
+    
+    if (!Consumed)
+    {
+        char Specifier[Segment->length + 1];
+        memcpy(Specifier, Segment->text, Segment->length);
+        Specifier[Segment->length] = 0;
+        
+        va_list ArgsCopy;
+        va_copy(ArgsCopy, Args);
+        const int Length = vsnprintf(NULL, 0, Specifier, ArgsCopy);
+        va_end(ArgsCopy);
+        
+        if (Length > 0)
+        {
+            char Formatted[Length + 1];
+            vsnprintf(Formatted, sizeof(Formatted), Specifier, Args);
+            MessageBufferWrite(Message, Formatted, Length);
+        }
+    }
+    
+    else if (Consumed < Segment->length) MessageBufferWrite(Message, Segment->text + Consumed, Segment->length - Consumed);
+    
+    va_end(Args);
+}
+
+static int LogMessageWithTime(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, time_t Time, const char *FormatString, ...)
+{
+    va_list Args;
+    va_start(Args, FormatString);
+    const int Length = LogMessage(Option, Tag, Identifier, Filename, FunctionName, Line, Time, FormatString, Args);
+    va_end(Args);
+    
+    return Length;
+}
+
+static void LogBinaryPrint(const CCLogBinaryHeader *Header, const char *Arguments)
+{
+    const CCLogBinaryFormat *Format = Header->format;
+    
+    size_t Length = 0, Size = CC_MESSAGE_BATCH_SIZE;
+    char *Message;
+    CC_SAFE_Malloc(Message, sizeof(char) * (Size + 1),
+                   return;
+                   );
+    
+    *Message = 0;
+    
+    CCLogMessageBuffer MessageBuffer = {
+        .message = &Message,
+        .length = &Length,
+        .write = (int(*)(const CCLogMessage*,const char*,size_t))MessageBufferWrite,
+        .remove = (int(*)(const CCLogMessage*,size_t))MessageBufferRemove,
+        .bufferSize = &Size
+    };
+    
+    CCLoggingOption Option = Header->option;
+    const CCLogData LogData = {
+        .filter = CCLogFilterSpecifier,
+        .option = &Option,
+        .tag = Format->tag,
+        .identifier = Format->identifier,
+        .filename = Format->filename,
+        .functionName = Format->functionName,
+        .line = Format->line
+    };
+    
+#define CC_LOG_BINARY_FORMAT_SPECIFIER(type) \
+{ \
+    type Value; \
+    memcpy(&Value, Arguments, sizeof(type)); \
+    Arguments += sizeof(type); \
+    \
+    if (Segment->stars == 0) LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Value); \
+    else if (Segment->stars == 1) LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Stars[0], Value); \
+    else LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Stars[0], Stars[1], Value); \
+}
+    
+    for (size_t Loop = 0; Loop < Format->count; Loop++)
+    {
+        const CCLogBinarySegment *Segment = &Format->segments[Loop];
+        
+        if (Segment->stars < 0)
+        {
+            MessageBufferWrite(&MessageBuffer, Segment->text, Segment->length);
+            continue;
+        }
+        
+        int Stars[2];
+        memcpy(Stars, Arguments, sizeof(int) * Segment->stars);
+        Arguments += sizeof(int) * Segment->stars;
+        
+        switch (Segment->type)
+        {
+            case CCLogBinaryArgumentInt:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(int);
+                break;
+                
+            case CCLogBinaryArgumentLong:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(long);
+                break;
+                
+            case CCLogBinaryArgumentLongLong:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(long long);
+                break;
+                
+            case CCLogBinaryArgumentIntMax:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(intmax_t);
+                break;
+                
+            case CCLogBinaryArgumentSize:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(size_t);
+                break;
+                
+            case CCLogBinaryArgumentPtrDiff:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(ptrdiff_t);
+                break;
+                
+            case CCLogBinaryArgumentDouble:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(double);
+                break;
+                
+            case CCLogBinaryArgumentLongDouble:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(long double);
+                break;
+                
+            case CCLogBinaryArgumentPointer:
+                CC_LOG_BINARY_FORMAT_SPECIFIER(void*);
+                break;
+                
+            case CCLogBinaryArgumentString:
+            {
+                uint32_t StringSize;
+                memcpy(&StringSize, Arguments, sizeof(StringSize));
+                Arguments += sizeof(StringSize);
+                
+                const char *Value = Arguments;
+                Arguments += StringSize + 1;
+                
+                if (Segment->stars == 0) LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Value);
+                else if (Segment->stars == 1) LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Stars[0], Value);
+                else LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Stars[0], Stars[1], Value);
+                break;
+            }
+                
+            case CCLogBinaryArgumentCCString:
+            {
+                uint32_t StringSize;
+                memcpy(&StringSize, Arguments, sizeof(StringSize));
+                Arguments += sizeof(StringSize);
+                
+                CCString Value = 0;
+                if (StringSize != UINT32_MAX)
+                {
+                    Value = CCStringCreateWithSize(CC_STD_ALLOCATOR, CCStringHintCopy | CCStringEncodingUTF8, Arguments, StringSize);
+                    Arguments += StringSize;
+                }
+                
+                if (Segment->stars == 0) LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Value);
+                else if (Segment->stars == 1) LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Stars[0], Value);
+                else LogBinaryFormatSpecifier(&LogData, &MessageBuffer, Segment, Stars[0], Stars[1], Value);
+                
+                if (Value) CCStringDestroy(Value);
+                break;
+            }
+        }
+    }
+    
+#undef CC_LOG_BINARY_FORMAT_SPECIFIER
+    
+    LogMessageWithTime(Option & ~CCLogOptionAsync, Format->tag, Format->identifier, Format->filename, Format->functionName, Format->line, (time_t)(Header->time / 1000000000), "%s", Message);
+    
+    CC_SAFE_Free(Message);
+}
+
+static void LogAsyncDrainLines(CCLogAsyncBuffer *Buffer, size_t Head)
+{
+    const size_t Tail = atomic_load_explicit(&Buffer->tail, memory_order_relaxed);
+    if ((ptrdiff_t)(Head - Tail) <= 0) return;
+    
+    const size_t Start = Tail & (CC_LOG_ASYNC_BUFFER_SIZE - 1), Size = Head - Tail;
+    const size_t Contiguous = CC_LOG_ASYNC_BUFFER_SIZE - Start < Size ? CC_LOG_ASYNC_BUFFER_SIZE - Start : Size;
+    
+    const struct iovec IOVec[2] = {
+        { .iov_base = Buffer->data + Start, .iov_len = Contiguous },
+        { .iov_base = Buffer->data, .iov_len = Size - Contiguous }
+    };
+    
+    LogWriteFiles(IOVec, Contiguous < Size ? 2 : 1, FALSE);
+    
+    atomic_store_explicit(&Buffer->tail, Head, memory_order_release);
+}
+
+static void LogBinaryDrain(CCLogAsyncBuffer *Buffer)
+{
+    /*
+     The line ring's head is captured before the binary ring's, so any record queued before those lines is drained
+     here, while any record that isn't drained was queued after them.
+     */
+    Buffer->drain = atomic_load_explicit(&Buffer->head, memory_order_acquire);
+    const size_t Head = atomic_load_explicit(&Buffer->binary.head, memory_order_acquire);
+    
+    LogSectionBegin();
+    
+    for (size_t Tail = atomic_load_explicit(&Buffer->binary.tail, memory_order_relaxed); Tail != Head; )
+    {
+        const size_t Start = Tail & (CC_LOG_BINARY_BUFFER_SIZE - 1);
+        
+        if ((CC_LOG_BINARY_BUFFER_SIZE - Start) < sizeof(CCLogBinaryHeader)) Tail += CC_LOG_BINARY_BUFFER_SIZE - Start;
+        else
+        {
+            CCLogBinaryHeader Header;
+            memcpy(&Header, Buffer->binary.data + Start, sizeof(Header));
+            
+            if (Header.format)
+            {
+                LogAsyncDrainLines(Buffer, Header.text);
+                LogBinaryPrint(&Header, Buffer->binary.data + Start + sizeof(Header));
+            }
+            
+            Tail += Header.size;
+        }
+        
+        atomic_store_explicit(&Buffer->binary.tail, Tail, memory_order_release);
+    }
+    
+    LogSectionEnd();
+}
+
+#pragma mark Asynchronous Output
+
+static void LogAsyncDrain(_Bool Crashing)
+{
+    for (size_t Attempt = 0; atomic_flag_test_and_set_explicit(&LogAsync.draining, memory_order_acquire); Attempt++)
+    {
+        //The crash may have interrupted the drain, in which case give up waiting on it
+        if ((Crashing) && (Attempt >= CC_LOG_ASYNC_CRASH_ATTEMPTS)) break;
+        
+        sched_yield();
+    }
+    
+    Draining = TRUE;
+    
+    //Formatting binary messages is not safe while crashing
+    if (!Crashing)
+    {
+        for (CCThreadSlot *Slot = atomic_load_explicit(&LogAsync.buffers, memory_order_acquire); Slot; Slot = Slot->next) LogBinaryDrain((CCLogAsyncBuffer*)Slot);
+    }
+    
+    struct iovec IOVec[(CC_LOG_ASYNC_BATCH_SIZE * 2) + 1];
+    size_t Count = 0;
+    
+    char Dropped[64];
+    const size_t DroppedCount = atomic_exchange_explicit(&LogAsync.dropped, 0, memory_order_relaxed);
+    if (DroppedCount)
+    {
+        const int Length = snprintf(Dropped, sizeof(Dropped), "%s: Dropped %zu log messages\n", CCTagWarning, DroppedCount);
+        IOVec[Count++] = (struct iovec){ .iov_base = Dropped, .iov_len = (size_t)Length };
+    }
+    
+    CCThreadSlot *Slot = atomic_load_explicit(&LogAsync.buffers, memory_order_acquire);
+    while ((Slot) || (Count))
+    {
+        struct {
+            CCLogAsyncBuffer *buffer;
+            size_t head;
+        } Drained[CC_LOG_ASYNC_BATCH_SIZE];
+        size_t DrainedCount = 0;
+        
+        for ( ; (Slot) && (DrainedCount < CC_LOG_ASYNC_BATCH_SIZE); Slot = Slot->next)
+        {
+            CCLogAsyncBuffer *Buffer = (CCLogAsyncBuffer*)Slot;
+            
+            //Lines queued after a binary message that hasn't been drained yet must wait for it
+            const size_t Head = Crashing ? atomic_load_explicit(&Buffer->head, memory_order_acquire) : Buffer->drain;
+            const size_t Tail = atomic_load_explicit(&Buffer->tail, memory_order_relaxed);
+            
+            if ((ptrdiff_t)(Head - Tail) <= 0) continue;
+            
+            const size_t Start = Tail & (CC_LOG_ASYNC_BUFFER_SIZE - 1), Size = Head - Tail;
+            const size_t Contiguous = CC_LOG_ASYNC_BUFFER_SIZE - Start < Size ? CC_LOG_ASYNC_BUFFER_SIZE - Start : Size;
+            
+            IOVec[Count++] = (struct iovec){ .iov_base = Buffer->data + Start, .iov_len = Contiguous };
+            if (Contiguous < Size) IOVec[Count++] = (struct iovec){ .iov_base = Buffer->data, .iov_len = Size - Contiguous };
+            
+            Drained[DrainedCount].buffer = Buffer;
+            Drained[DrainedCount++].head = Head;
+        }
+        
+        if (Count) LogWriteFiles(IOVec, Count, Crashing);
+        
+        for (size_t Loop = 0; Loop < DrainedCount; Loop++) atomic_store_explicit(&Drained[Loop].buffer->tail, Drained[Loop].head, memory_order_release);
+        
+        Count = 0;
+    }
+    
+    Draining = FALSE;
+    
+    atomic_flag_clear_explicit(&LogAsync.draining, memory_order_release);
+}
+
+static void *LogAsyncFlusher(void *Arg)
+{
+    pthread_mutex_lock(&LogAsync.lock);
+    
+    for ( ; ; )
+    {
+        if (!LogAsync.wake)
+        {
+            struct timespec Time;
+            clock_gettime(CLOCK_REALTIME, &Time);
+            
+            Time.tv_nsec += CC_LOG_ASYNC_FLUSH_INTERVAL * 1000000;
+            Time.tv_sec += Time.tv_nsec / 1000000000;
+            Time.tv_nsec %= 1000000000;
+            
+            pthread_cond_timedwait(&LogAsync.changed, &LogAsync.lock, &Time);
+        }
+        
+        LogAsync.wake = FALSE;
+        
+        pthread_mutex_unlock(&LogAsync.lock);
+        LogAsyncDrain(FALSE);
+        pthread_mutex_lock(&LogAsync.lock);
+        
+        pthread_cond_broadcast(&LogAsync.drained);
+    }
+    
+    return NULL;
+}
+
+static void LogAsyncSetup(void)
+{
+    if (pthread_key_create(&LogAsync.key, (void(*)(void*))CCThreadSlotDetach)) return;
+    
+    pthread_t Thread;
+    if (pthread_create(&Thread, NULL, LogAsyncFlusher, NULL))
+    {
+        pthread_key_delete(LogAsync.key);
+        return;
+    }
+    
+    pthread_detach(Thread);
+    atexit(CCLogFlush);
+    
+    atomic_store_explicit(&LogAsync.running, TRUE, memory_order_release);
+}
+
+static void LogAsyncInit(CCLogAsyncBuffer *Buffer)
+{
+    atomic_init(&Buffer->head, 0);
+    atomic_init(&Buffer->tail, 0);
+    Buffer->drain = 0;
+    atomic_init(&Buffer->binary.head, 0);
+    atomic_init(&Buffer->binary.tail, 0);
+}
+
+static CCLogAsyncBuffer *LogAsyncGetBuffer(void)
+{
+    CCLogAsyncBuffer *Buffer = pthread_getspecific(LogAsync.key);
+    if (Buffer) return Buffer;
+    
+    Buffer = (CCLogAsyncBuffer*)CCThreadSlotClaim(&LogAsync.buffers, sizeof(CCLogAsyncBuffer), (CCThreadSlotInitializer)LogAsyncInit);
+    if (!Buffer) return NULL;
+    
+    pthread_setspecific(LogAsync.key, Buffer);
+    
+    return Buffer;
+}
+
+static CCLogAsyncBuffer *LogAsyncGetWritableBuffer(void)
+{
+    if (Draining) return NULL;
+    
+    pthread_once(&LogAsync.once, LogAsyncSetup);
+    if (!atomic_load_explicit(&LogAsync.running, memory_order_acquire)) return NULL;
+    
+    return LogAsyncGetBuffer();
+}
+
+/*!
+ * @brief Wait for space in a ring according to the overflow policy.
+ * @return The tail of the ring once there is space, or SIZE_MAX if the message should be dropped.
+ */
+static size_t LogAsyncReserve(_Atomic(size_t) *RingTail, size_t Head, size_t Capacity, size_t Size)
+{
+    size_t Tail;
+    while ((Capacity - (Head - (Tail = atomic_load_explicit(RingTail, memory_order_acquire)))) < Size)
+    {
+        switch (atomic_load_explicit(&LogAsync.overflow, memory_order_relaxed))
+        {
+            case CCLogAsyncOverflowBlock:
+                pthread_mutex_lock(&LogAsync.lock);
+                LogAsync.wake = TRUE;
+                pthread_cond_signal(&LogAsync.changed);
+                pthread_cond_wait(&LogAsync.drained, &LogAsync.lock);
+                pthread_mutex_unlock(&LogAsync.lock);
+                break;
+                
+            case CCLogAsyncOverflowCount:
+                atomic_fetch_add_explicit(&LogAsync.dropped, 1, memory_order_relaxed);
+                return SIZE_MAX;
+                
+            case CCLogAsyncOverflowDrop:
+                return SIZE_MAX;
+        }
+    }
+    
+    return Tail;
+}
+
+/*!
+ * @brief Queue a line to be written to the log files.
+ * @return TRUE if the line was handled (queued or dropped), or FALSE if it must be written synchronously.
+ */
+static _Bool LogAsyncWrite(const struct iovec *IOVec, size_t Count)
+{
+    size_t Length = 0;
+    for (size_t Loop = 0; Loop < Count; Loop++) Length += IOVec[Loop].iov_len;
+    
+    if (Length > CC_LOG_ASYNC_BUFFER_SIZE) return FALSE;
+    
+    CCLogAsyncBuffer *Buffer = LogAsyncGetWritableBuffer();
+    if (!Buffer) return FALSE;
+    
+    const size_t Head = atomic_load_explicit(&Buffer->head, memory_order_relaxed);
+    const size_t Tail = LogAsyncReserve(&Buffer->tail, Head, CC_LOG_ASYNC_BUFFER_SIZE, Length);
+    if (Tail == SIZE_MAX) return TRUE;
+    
+    for (size_t Loop = 0, Offset = Head; Loop < Count; Offset += IOVec[Loop++].iov_len)
+    {
+        const size_t Start = Offset & (CC_LOG_ASYNC_BUFFER_SIZE - 1), Size = IOVec[Loop].iov_len;
+        const size_t Contiguous = CC_LOG_ASYNC_BUFFER_SIZE - Start < Size ? CC_LOG_ASYNC_BUFFER_SIZE - Start : Size;
+        
+        memcpy(Buffer->data + Start, IOVec[Loop].iov_base, Contiguous);
+        memcpy(Buffer->data, (const char*)IOVec[Loop].iov_base + Contiguous, Size - Contiguous);
+    }
+    
+    atomic_store_explicit(&Buffer->head, Head + Length, memory_order_release);
+    
+    //Flush early once the buffer is half full, rather than waiting for the interval
+    if ((Head + Length - Tail) > (CC_LOG_ASYNC_BUFFER_SIZE / 2)) pthread_cond_signal(&LogAsync.changed);
+    
+    return TRUE;
+}
+
+/*!
+ * @brief Record a binary message.
+ * @return TRUE if the message was handled (queued or dropped), or FALSE if it must be formatted immediately.
+ */
+static _Bool LogBinaryWrite(const CCLogBinaryFormat *Format, CCLoggingOption Option, va_list Args)
+{
+    if (Format->immediate) return FALSE;
+    
+    CCLogAsyncBuffer *Buffer = LogAsyncGetWritableBuffer();
+    if (!Buffer) return FALSE;
+    
+    _Alignas(8) char Record[CC_LOG_BINARY_RECORD_MAX];
+    size_t Size = sizeof(CCLogBinaryHeader);
+    
+#define CC_LOG_BINARY_RECORD(type, promoted) \
+{ \
+    if ((Size + sizeof(type)) > sizeof(Record)) return FALSE; \
+    \
+    const type Value = (type)va_arg(Args, promoted); \
+    memcpy(Record + Size, &Value, sizeof(type)); \
+    Size += sizeof(type); \
+}
+    
+    for (size_t Loop = 0; Loop < Format->count; Loop++)
+    {
+        const CCLogBinarySegment *Segment = &Format->segments[Loop];
+        
+        if (Segment->stars < 0) continue;
+        
+        int Star = 0;
+        for (int Loop = 0; Loop < Segment->stars; Loop++)
+        {
+            if ((Size + sizeof(int)) > sizeof(Record)) return FALSE;
+            
+            Star = va_arg(Args, int);
+            memcpy(Record + Size, &Star, sizeof(int));
+            Size += sizeof(int);
+        }
+        
+        switch (Segment->type)
+        {
+            case CCLogBinaryArgumentInt:
+                CC_LOG_BINARY_RECORD(int, int);
+                break;
+                
+            case CCLogBinaryArgumentLong:
+                CC_LOG_BINARY_RECORD(long, long);
+                break;
+                
+            case CCLogBinaryArgumentLongLong:
+                CC_LOG_BINARY_RECORD(long long, long long);
+                break;
+                
+            case CCLogBinaryArgumentIntMax:
+                CC_LOG_BINARY_RECORD(intmax_t, intmax_t);
+                break;
+                
+            case CCLogBinaryArgumentSize:
+                CC_LOG_BINARY_RECORD(size_t, size_t);
+                break;
+                
+            case CCLogBinaryArgumentPtrDiff:
+                CC_LOG_BINARY_RECORD(ptrdiff_t, ptrdiff_t);
+                break;
+                
+            case CCLogBinaryArgumentDouble:
+                CC_LOG_BINARY_RECORD(double, double);
+                break;
+                
+            case CCLogBinaryArgumentLongDouble:
+                CC_LOG_BINARY_RECORD(long double, long double);
+                break;
+                
+            case CCLogBinaryArgumentPointer:
+                CC_LOG_BINARY_RECORD(void*, void*);
+                break;
+                
+            case CCLogBinaryArgumentString:
+            {
+                const char *String = va_arg(Args, const char*);
+                if (!String) String = "(null)";
+                
+                //A precision limits how much of the string is read, so it may not be null terminated
+                const int Precision = Segment->precision == -2 ? Star : Segment->precision;
+                const size_t Length = Precision >= 0 ? strnlen(String, Precision) : strlen(String);
+                if ((Size + sizeof(uint32_t) + Length + 1) > sizeof(Record)) return FALSE;
+                
+                memcpy(Record + Size, &(uint32_t){ (uint32_t)Length }, sizeof(uint32_t));
+                memcpy(Record + Size + sizeof(uint32_t), String, Length);
+                Record[Size + sizeof(uint32_t) + Length] = 0;
+                Size += sizeof(uint32_t) + Length + 1;
+                break;
+            }
+                
+            case CCLogBinaryArgumentCCString:
+            {
+                CCString String = va_arg(Args, CCString);
+                const size_t Length = String ? CCStringGetSize(String) : 0;
+                
+                if ((Size + sizeof(uint32_t) + Length) > sizeof(Record)) return FALSE;
+                
+                memcpy(Record + Size, &(uint32_t){ String ? (uint32_t)Length : UINT32_MAX }, sizeof(uint32_t));
+                Size += sizeof(uint32_t);
+                
+                if (String)
+                {
+                    const char *Characters = CCStringGetBuffer(String);
+                    if (Characters) memcpy(Record + Size, Characters, Length);
+                    else CCStringCopyCharacters(String, 0, CCStringGetLength(String), Record + Size);
+                    
+                    Size += Length;
+                }
+                break;
+            }
+        }
+    }
+    
+#undef CC_LOG_BINARY_RECORD
     
-    CFStringRef Path = CFURLCopyFileSystemPath(PathURL, kCFURLPOSIXPathStyle);
-    CFRelease(PathURL);
-    if (!Path)
+    Size = (Size + 7) & ~(size_t)7;
+    
+    struct timespec Time;
+    clock_gettime(CLOCK_REALTIME, &Time);
+    
+    const CCLogBinaryHeader Header = {
+        .size = (uint32_t)Size,
+        .option = Option,
+        .format = Format,
+        .time = ((uint64_t)Time.tv_sec * 1000000000) + (uint64_t)Time.tv_nsec,
+        .text = atomic_load_explicit(&Buffer->head, memory_order_relaxed)
+    };
+    memcpy(Record, &Header, sizeof(Header));
+    
+    const size_t Head = atomic_load_explicit(&Buffer->binary.head, memory_order_relaxed);
+    const size_t Start = Head & (CC_LOG_BINARY_BUFFER_SIZE - 1);
+    const size_t Padding = (CC_LOG_BINARY_BUFFER_SIZE - Start) < Size ? CC_LOG_BINARY_BUFFER_SIZE - Start : 0;
+    
+    if (LogAsyncReserve(&Buffer->binary.tail, Head, CC_LOG_BINARY_BUFFER_SIZE, Padding + Size) == SIZE_MAX) return TRUE;
+    
+    if (Padding >= sizeof(CCLogBinaryHeader)) memcpy(Buffer->binary.data + Start, &(CCLogBinaryHeader){ .size = (uint32_t)Padding, .format = NULL }, sizeof(CCLogBinaryHeader));
+    
+    memcpy(Buffer->binary.data + ((Head + Padding) & (CC_LOG_BINARY_BUFFER_SIZE - 1)), Record, Size);
+    atomic_store_explicit(&Buffer->binary.head, Head + Padding + Size, memory_order_release);
+    
+    return TRUE;
+}
+
+static const int CrashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+static struct sigaction CrashActions[sizeof(CrashSignals) / sizeof(typeof(*CrashSignals))];
+
+static void LogCrashHandler(int Signal)
+{
+    if (atomic_load_explicit(&LogAsync.running, memory_order_acquire)) LogAsyncDrain(TRUE);
+    
+    for (size_t Loop = 0; Loop < sizeof(CrashSignals) / sizeof(typeof(*CrashSignals)); Loop++)
     {
-        CC_LOG_ERROR("Failed to create path. Won't be able to record logs locally to app.");
-        return;
+        if (CrashSignals[Loop] == Signal) sigaction(Signal, &CrashActions[Loop], NULL);
     }
     
-    size_t Size = CFStringGetLength(Path) + 1;
-    char *PathStr = NULL;
-    CC_TEMP_Malloc(PathStr, sizeof(char) * Size,
-                   CC_LOG_ERROR("Failed to create path. Won't be able to record logs locally to app.");
-                   CFRelease(Path);
-                   return;
-                   );
+    raise(Signal);
+}
+#endif
+
+int CCLogBinary(CCLogBinarySite *Site, CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, ...)
+{
+    va_list Args;
+    va_start(Args, FormatString);
     
-    if (CFStringGetCString(Path, PathStr, Size, kCFStringEncodingASCII))
+#if CC_ASYNC_LOGGER
+    //Only asynchronous messages are recorded, anything else must be written before returning
+    CCLogBinaryFormat *Format = NULL;
+    if ((Option & CCLogOptionAsync) && (!(Format = atomic_load_explicit(&Site->format, memory_order_acquire))))
     {
-        FSPath LogPath = FSPathCreateFromSystemPath(PathStr);
-        
-        if (FSManagerCreate(LogPath, FALSE) == FSOperationSuccess)
+        CCLogBinaryFormat *Expected = NULL;
+        if ((Format = LogBinaryFormatCreate(Tag, Identifier, Filename, FunctionName, Line, FormatString)))
         {
-            FSHandle Handle;
-            if (FSHandleOpen(LogPath, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+            if (!atomic_compare_exchange_strong_explicit(&Site->format, &Expected, Format, memory_order_acq_rel, memory_order_acquire))
             {
-#if CC_NEW_FRAMEWORK_LOG_FILE
-                FSHandleRemove(Handle, FSManagerGetSize(Handle->path), FSBehaviourPreserveOffset);
-#else
-                FSHandleSetOffset(Handle, FSManagerGetSize(Handle->path));
-#endif
-                CCLogAddFile(Handle);
+                CCFree(Format);
+                Format = Expected;
             }
         }
+    }
+    
+    if (Format)
+    {
+        va_list ArgsCopy;
+        va_copy(ArgsCopy, Args);
+        const _Bool Recorded = LogBinaryWrite(Format, Option, ArgsCopy);
+        va_end(ArgsCopy);
         
-        FSPathDestroy(LogPath);
+        if (Recorded)
+        {
+            va_end(Args);
+            return 0;
+        }
     }
+#endif
     
-    CFRelease(Path);
-    CC_TEMP_Free(PathStr);
+    const int Length = CCLogv(Option, Tag, Identifier, Filename, FunctionName, Line, FormatString, Args);
+    va_end(Args);
+    
+    return Length;
+}
+
+void CCLogFlush(void)
+{
+#if CC_ASYNC_LOGGER
+    if (atomic_load_explicit(&LogAsync.running, memory_order_acquire)) LogAsyncDrain(FALSE);
 #endif
 }
 
-#if CC_ASL_LOGGER
-static void ASLSetup(void)
+void CCLogFlushOnCrash(void)
 {
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-    Client = asl_open(NULL, NULL, 0);
-#pragma clang diagnostic pop
+#if CC_ASYNC_LOGGER
+    struct sigaction Action = { .sa_handler = LogCrashHandler };
+    sigemptyset(&Action.sa_mask);
+    
+    for (size_t Loop = 0; Loop < sizeof(CrashSignals) / sizeof(typeof(*CrashSignals)); Loop++) sigaction(CrashSignals[Loop], &Action, &CrashActions[Loop]);
+#endif
 }
+
+void CCLogSetAsyncOverflow(CCLogAsyncOverflow Overflow)
+{
+#if CC_ASYNC_LOGGER
+    atomic_store_explicit(&LogAsync.overflow, Overflow, memory_order_relaxed);
 #endif
+}
 
-#pragma mark - Filters
-typedef struct CCFilter {
-    void *filter;
-    _Bool isBlock;
-    struct CCFilter *next;
-} CCFilter;
+#pragma mark - Levels
+void CCLogSetLevel(CCLogLevel Level)
+{
+    atomic_store_explicit(&CCLogLevelCurrent, Level, memory_order_relaxed);
+}
 
-static CCFilter *InputFilters = NULL, *SpecifierFilters = NULL, *MessageFilters = NULL;
+CCLogLevel CCLogGetLevel(void)
+{
+    return atomic_load_explicit(&CCLogLevelCurrent, memory_order_relaxed);
+}
 
-#undef CCLogAddFilter
-void CCLogAddFilter(CCLogFilterType Type, CCLogFilter Filter)
+#pragma mark - Rate Limiting
+/*
+ The site's state is the second of the current window in the upper 32 bits, and the number of messages logged in that
+ window in the lower 32 bits.
+ */
+_Bool CCLogLimit(CCLogLimitSite *Site, uint32_t Rate, CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line)
 {
-    if (Type & CCLogFilterInput)
-    {
-        CCFilter *NewFilter;
-        CC_SAFE_Malloc(NewFilter, sizeof(CCFilter),
-                       //Add error callback?
-                       return;
-                       );
-        
-        NewFilter->filter = Filter;
-        NewFilter->isBlock = FALSE;
-        NewFilter->next = InputFilters;
-        InputFilters = NewFilter;
-    }
+    CCAssertLog(Site, "Site must not be null");
     
-    if (Type & CCLogFilterSpecifier)
-    {
-        CCFilter *NewFilter;
-        CC_SAFE_Malloc(NewFilter, sizeof(CCFilter),
-                       //Add error callback?
-                       return;
-                       );
-        
-        NewFilter->filter = Filter;
-        NewFilter->isBlock = FALSE;
-        NewFilter->next = SpecifierFilters;
-        SpecifierFilters = NewFilter;
-    }
+    const uint64_t Window = (uint32_t)time(NULL);
     
-    if (Type & CCLogFilterMessage)
+    for (uint64_t State = atomic_load_explicit(&Site->state, memory_order_relaxed); ; )
     {
-        CCFilter *NewFilter;
-        CC_SAFE_Malloc(NewFilter, sizeof(CCFilter),
-                       //Add error callback?
-                       return;
-                       );
+        const _Bool NewWindow = (State >> 32) != Window;
+        if ((!NewWindow) && ((uint32_t)State >= Rate))
+        {
+            atomic_fetch_add_explicit(&Site->suppressed, 1, memory_order_relaxed);
+            return FALSE;
+        }
         
-        NewFilter->filter = Filter;
-        NewFilter->isBlock = FALSE;
-        NewFilter->next = MessageFilters;
-        MessageFilters = NewFilter;
+        if (atomic_compare_exchange_weak_explicit(&Site->state, &State, NewWindow ? (Window << 32) | 1 : State + 1, memory_order_relaxed, memory_order_relaxed))
+        {
+            if (NewWindow)
+            {
+                const uint32_t Suppressed = atomic_exchange_explicit(&Site->suppressed, 0, memory_order_relaxed);
+                if (Suppressed) CCLog(Option, Tag, Identifier, Filename, FunctionName, Line, "Suppressed %" PRIu32 " messages", Suppressed);
+            }
+            
+            return TRUE;
+        }
     }
 }
 
-#if __BLOCKS__
-void CCLogAddFilterBlock(CCLogFilterType Type, CCLogFilterBlock Filter)
+#pragma mark - Line Assembly
+/*
+ Messages are assembled in a buffer that is reused by the thread, unless the thread is already logging (a filter logged
+ a message, or logging failed to allocate), in which case the message uses its own buffer.
+ */
+typedef struct {
+    char *message, *specifier;
+    size_t messageSize, specifierSize;
+    _Bool inUse;
+} CCLogScratch;
+
+static _Thread_local CCLogScratch LogThreadScratch = { .message = NULL, .specifier = NULL, .messageSize = 0, .specifierSize = 0, .inUse = FALSE };
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+static pthread_key_t LogScratchKey;
+
+static void LogScratchDestroy(CCLogScratch *Scratch)
 {
-    if (Type & CCLogFilterInput)
+    CC_SAFE_Free(Scratch->message);
+    CC_SAFE_Free(Scratch->specifier);
+}
+
+static void LogScratchSetup(void)
+{
+    pthread_key_create(&LogScratchKey, (void(*)(void*))LogScratchDestroy);
+}
+#endif
+
+static CCLogScratch *LogScratchAcquire(void)
+{
+#if CC_PLATFORM_POSIX_COMPLIANT
+    if (LogThreadScratch.inUse) return NULL;
+    
+    if ((!LogThreadScratch.message) && (!LogThreadScratch.specifier))
     {
-        CCFilter *NewFilter;
-        CC_SAFE_Malloc(NewFilter, sizeof(CCFilter),
-                       //Add error callback?
-                       return;
-                       );
-        
-        NewFilter->filter = Block_copy(Filter);
-        NewFilter->isBlock = TRUE;
-        NewFilter->next = InputFilters;
-        InputFilters = NewFilter;
+        static pthread_once_t Once = PTHREAD_ONCE_INIT;
+        pthread_once(&Once, LogScratchSetup);
+        pthread_setspecific(LogScratchKey, &LogThreadScratch);
     }
     
-    if (Type & CCLogFilterSpecifier)
+    LogThreadScratch.inUse = TRUE;
+    
+    return &LogThreadScratch;
+#else
+    return NULL;
+#endif
+}
+
+static void LogScratchRelease(CCLogScratch *Scratch, char *Message, size_t MessageSize, char *Specifier, size_t SpecifierSize)
+{
+    if (Scratch == &LogThreadScratch)
     {
-        CCFilter *NewFilter;
-        CC_SAFE_Malloc(NewFilter, sizeof(CCFilter),
-                       //Add error callback?
-                       return;
-                       );
-        
-        NewFilter->filter = Block_copy(Filter);
-        NewFilter->isBlock = TRUE;
-        NewFilter->next = SpecifierFilters;
-        SpecifierFilters = NewFilter;
+        *Scratch = (CCLogScratch){
+            .message = Message,
+            .specifier = Specifier,
+            .messageSize = MessageSize,
+            .specifierSize = SpecifierSize,
+            .inUse = FALSE
+        };
     }
     
-    if (Type & CCLogFilterMessage)
+    else
     {
-        CCFilter *NewFilter;
-        CC_SAFE_Malloc(NewFilter, sizeof(CCFilter),
-                       //Add error callback?
-                       return;
-                       );
-        
-        NewFilter->filter = Block_copy(Filter);
-        NewFilter->isBlock = TRUE;
-        NewFilter->next = MessageFilters;
-        MessageFilters = NewFilter;
+        CC_SAFE_Free(Message);
+        CC_SAFE_Free(Specifier);
     }
 }
-#endif
 
-#pragma mark - CCLogMessage functions
-#define CC_MESSAGE_BATCH_SIZE 64
+#define CC_LOG_PROCESS_PREFIX_MAX 512
 
-typedef struct CCLogMessageBuffer {
-    char **message;
-    size_t *length;
-    int (*write)(const struct CCLogMessage *Msg, const char *String, size_t Length);
-    int (*remove)(const struct CCLogMessage *Msg, size_t Length);
-    size_t *bufferSize;
-} CCLogMessageBuffer;
+/// The "host process[pid]: " part of the line prefix.
+static struct {
+    char text[CC_LOG_PROCESS_PREFIX_MAX];
+    size_t length;
+} LogProcessPrefix = { .length = 0 };
 
-static int MessageBufferWrite(CCLogMessageBuffer *Msg, const char *String, size_t Length)
+static void LogProcessPrefixFormat(void)
 {
-    if (*Msg->bufferSize - *Msg->length < Length)
-    {
-        *Msg->bufferSize += CC_MESSAGE_BATCH_SIZE + ((Length / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
-        CC_SAFE_Realloc(*Msg->message, sizeof(char) * (*Msg->bufferSize + 1),
-                        return -1;
-                        );
-    }
+    const int Length = snprintf(LogProcessPrefix.text, sizeof(LogProcessPrefix.text), "%s %s[%" PRIuPTR "]: ", CCHostCurrentName(), CCProcessCurrentStrippedName(), CCProcessCurrent());
+    LogProcessPrefix.length = Length < 0 ? 0 : (Length < (int)sizeof(LogProcessPrefix.text) ? (size_t)Length : sizeof(LogProcessPrefix.text) - 1);
+}
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+static void LogProcessPrefixSetup(void)
+{
+    LogProcessPrefixFormat();
     
-    strncpy(*Msg->message + *Msg->length, String, Length);
-    (*Msg->message)[(*Msg->length += Length)] = 0;
+    //The child has a new pid
+    pthread_atfork(NULL, NULL, LogProcessPrefixFormat);
+}
+#endif
+
+static const char *LogProcessPrefixGet(size_t *Length)
+{
+#if CC_PLATFORM_POSIX_COMPLIANT
+    static pthread_once_t Once = PTHREAD_ONCE_INIT;
+    pthread_once(&Once, LogProcessPrefixSetup);
+#else
+    LogProcessPrefixFormat();
+#endif
     
-    return 0;
+    *Length = LogProcessPrefix.length;
+    
+    return LogProcessPrefix.text;
 }
 
-static int MessageBufferRemove(CCLogMessageBuffer *Msg, size_t Length)
+/// The timestamp part of the line prefix, which is only reformatted when the second changes.
+static _Thread_local struct {
+    time_t time;
+    char text[32];
+    size_t length;
+} LogTimestamp = { .time = (time_t)-1, .length = 0 };
+
+static const char *LogTimestampGet(time_t Time, size_t *Length)
 {
-    if (Length > *Msg->length) Length = *Msg->length;
+    if (LogTimestamp.time != Time)
+    {
+        struct tm Local;
+#if CC_PLATFORM_POSIX_COMPLIANT
+        localtime_r(&Time, &Local);
+#else
+        Local = *localtime(&Time);
+#endif
+        
+        const size_t TimestampLength = strftime(LogTimestamp.text, sizeof(LogTimestamp.text) - 1, "%b %d %T", &Local);
+        LogTimestamp.text[TimestampLength] = ' ';
+        LogTimestamp.length = TimestampLength + 1;
+        LogTimestamp.time = Time;
+    }
     
-    (*Msg->message)[(*Msg->length -= Length)] = 0;
+    *Length = LogTimestamp.length;
     
-    return 0;
+    return LogTimestamp.text;
 }
 
 #pragma mark - Logger
-int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, va_list Args)
+static int LogMessage(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, time_t Time, const char *FormatString, va_list Args)
 {
     CCLogData LogData = {
         .filter = CCLogFilterInput,
@@ -428,7 +1990,9 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
         .args = (va_list*)&Args
 #endif
     };
-    for (CCFilter *CurrentFilter = InputFilters; CurrentFilter; CurrentFilter = CurrentFilter->next)
+    size_t FilterCount;
+    const CCFilter *Filters = LogSnapshotGet(&InputFilters, &FilterCount);
+    for (const CCFilter *CurrentFilter = Filters; CurrentFilter != Filters + FilterCount; CurrentFilter++)
     {
 #if __BLOCKS__
         if (CurrentFilter->isBlock) ((CCLogInputFilterBlock)CurrentFilter->filter)(&LogData, &InputData);
@@ -442,11 +2006,15 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
     
     if (!Tag) Tag = CCTagInfo;
     
-    size_t MessageSize = 0, Length = strlen(Tag) + 1 //"%s:"
+    CCLogScratch LocalScratch = { .message = NULL, .specifier = NULL, .messageSize = 0, .specifierSize = 0, .inUse = FALSE };
+    CCLogScratch *Scratch = LogScratchAcquire();
+    if (!Scratch) Scratch = &LocalScratch;
+    
+    size_t MessageSize = Scratch->messageSize, BufferSize = Scratch->specifierSize, Length = strlen(Tag) + 1 //"%s:"
     + (Filename? 1 + strlen(Filename) + 1 + 11 + 2 : 0) //"[%s:%d]:" Approx max number of digits for unsigned int: 10 + 1 (sign) TODO: add a CCNumberOfDigits() function in bit tricks
     + (FunctionName? strlen(FunctionName) + 1 : 0) //"%s:"
     + 2; //" " and null terminator
-    char *Message = NULL;
+    char *Message = Scratch->message, *Buffer = Scratch->specifier;
     
     CCLogMessageBuffer MessageBuffer = {
         .message = &Message,
@@ -456,12 +2024,19 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
         .bufferSize = &MessageSize
     };
     
-    if (SpecifierFilters)
+    size_t SpecifierFilterCount;
+    const CCFilter *SpecifierFilter = LogSnapshotGet(&SpecifierFilters, &SpecifierFilterCount);
+    if (SpecifierFilterCount)
     {
-        MessageSize = CC_MESSAGE_BATCH_SIZE + ((Length / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
-        CC_SAFE_Malloc(Message, sizeof(char) * (MessageSize + 1),
-                       return -1;
-                       );
+        const size_t PrefixSize = CC_MESSAGE_BATCH_SIZE + ((Length / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
+        if (MessageSize < PrefixSize)
+        {
+            CC_SAFE_Realloc(Message, sizeof(char) * (PrefixSize + 1),
+                            LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
+                            return -1;
+                            );
+            MessageSize = PrefixSize;
+        }
         
         
         if ((Filename) && (FunctionName)) Length = snprintf(Message, Length, "%s:[%s:%d]:%s: ", Tag, Filename, Line, FunctionName);
@@ -470,8 +2045,6 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
         else  Length = snprintf(Message, Length, "%s: ", Tag);
         
         
-        size_t BufferSize = 0;
-        char *Buffer = NULL;
         const char *Specifier = FormatString;
         
         Specifier = strchr(Specifier, '%');
@@ -481,11 +2054,12 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
         {
             if (MessageSize - Length < NextSpecLength)
             {
-                MessageSize += CC_MESSAGE_BATCH_SIZE + ((NextSpecLength / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
-                CC_SAFE_Realloc(Message, sizeof(char) * (MessageSize + 1),
-                                CC_SAFE_Free(Message);
+                const size_t Size = MessageSize + CC_MESSAGE_BATCH_SIZE + ((NextSpecLength / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
+                CC_SAFE_Realloc(Message, sizeof(char) * (Size + 1),
+                                LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
                                 return -1;
                                 );
+                MessageSize = Size;
             }
             
             strncpy(&Message[Length], FormatString, NextSpecLength);
@@ -504,7 +2078,7 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
                 .args = (va_list*)&Args
 #endif
             };
-            for (CCFilter *CurrentFilter = SpecifierFilters; CurrentFilter && (FormatString == Specifier); CurrentFilter = CurrentFilter->next)
+            for (const CCFilter *CurrentFilter = SpecifierFilter; (CurrentFilter != SpecifierFilter + SpecifierFilterCount) && (FormatString == Specifier); CurrentFilter++)
             {
 #if __BLOCKS__
                 if (CurrentFilter->isBlock) Specifier += ((CCLogSpecifierFilterBlock)CurrentFilter->filter)(&LogData, &SpecData);
@@ -521,8 +2095,7 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
                 if (BufferSize < NextSpecLength)
                 {
                     CC_SAFE_Realloc(Buffer, sizeof(char) * (NextSpecLength + 1),
-                                    CC_SAFE_Free(Buffer);
-                                    CC_SAFE_Free(Message);
+                                    LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
                                     return -1;
                                     );
                     BufferSize = NextSpecLength;
@@ -538,12 +2111,12 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
                 
                 if (MessageSize - Length < Len)
                 {
-                    MessageSize += CC_MESSAGE_BATCH_SIZE + ((Len / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
-                    CC_SAFE_Realloc(Message, sizeof(char) * (MessageSize + 1),
-                                    CC_SAFE_Free(Buffer);
-                                    CC_SAFE_Free(Message);
+                    const size_t Size = MessageSize + CC_MESSAGE_BATCH_SIZE + ((Len / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
+                    CC_SAFE_Realloc(Message, sizeof(char) * (Size + 1),
+                                    LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
                                     return -1;
                                     );
+                    MessageSize = Size;
                 }
                 
                 va_copy(ArgsCopy, Args);
@@ -645,12 +2218,12 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
                 {
                     if (MessageSize - Length < NextSpecLength)
                     {
-                        MessageSize += CC_MESSAGE_BATCH_SIZE + ((NextSpecLength / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
-                        CC_SAFE_Realloc(Message, sizeof(char) * (MessageSize + 1),
-                                        CC_SAFE_Free(Buffer);
-                                        CC_SAFE_Free(Message);
+                        const size_t Size = MessageSize + CC_MESSAGE_BATCH_SIZE + ((NextSpecLength / CC_MESSAGE_BATCH_SIZE) * CC_MESSAGE_BATCH_SIZE);
+                        CC_SAFE_Realloc(Message, sizeof(char) * (Size + 1),
+                                        LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
                                         return -1;
                                         );
+                        MessageSize = Size;
                     }
                     
                     strncpy(&Message[Length], FormatString, NextSpecLength);
@@ -659,7 +2232,6 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
             }
         }
         
-        CC_SAFE_Free(Buffer);
         Message[Length] = 0;
     }
     
@@ -671,9 +2243,14 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
         va_end(ArgsCopy);
         
         
-        CC_SAFE_Malloc(Message, sizeof(char) * (Length + FormatLength),
-                       return -1;
-                       );
+        if (MessageSize < (Length + FormatLength))
+        {
+            CC_SAFE_Realloc(Message, sizeof(char) * (Length + FormatLength + 1),
+                            LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
+                            return -1;
+                            );
+            MessageSize = Length + FormatLength;
+        }
         
         if ((Filename) && (FunctionName)) Length = snprintf(Message, Length, "%s:[%s:%d]:%s: ", Tag, Filename, Line, FunctionName);
         else if (Filename) Length = snprintf(Message, Length, "%s:[%s:%d]: ", Tag, Filename, Line);
@@ -685,7 +2262,8 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
     
     
     LogData.filter = CCLogFilterMessage;
-    for (CCFilter *CurrentFilter = MessageFilters; CurrentFilter; CurrentFilter = CurrentFilter->next)
+    Filters = LogSnapshotGet(&MessageFilters, &FilterCount);
+    for (const CCFilter *CurrentFilter = Filters; CurrentFilter != Filters + FilterCount; CurrentFilter++)
     {
 #if __BLOCKS__
         if (CurrentFilter->isBlock) ((CCLogMessageFilterBlock)CurrentFilter->filter)(&LogData, (CCLogMessage*)&MessageBuffer);
@@ -751,13 +2329,17 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
             {
                 if (LogQueue)
                 {
+                    //The message buffer is reused, so the queued message is copied after the context
                     CCOSLogContext *Context;
-                    if ((Context = CCMalloc(CC_DEFAULT_ALLOCATOR, sizeof(CCOSLogContext), NULL, CC_DEFAULT_ERROR_CALLBACK)))
+                    if ((Context = CCMalloc(CC_DEFAULT_ALLOCATOR, sizeof(CCOSLogContext) + (sizeof(char) * (Length + 1)), NULL, CC_DEFAULT_ERROR_CALLBACK)))
                     {
-                        *Context = (CCOSLogContext){ .log = Log, .type = LogType, .msg = CCRetain(Message), .destroy = TRUE };
+                        memcpy(Context + 1, Message, sizeof(char) * (Length + 1));
+                        *Context = (CCOSLogContext){ .log = Log, .type = LogType, .msg = (const char*)(Context + 1), .destroy = TRUE };
+                        
+                        dispatch_async_f(LogQueue, Context, (dispatch_function_t)LogMessageOSL);
                     }
                     
-                    dispatch_async_f(LogQueue, Context, (dispatch_function_t)LogMessageOSL);
+                    else os_release(Log);
                 }
             }
             
@@ -818,38 +2400,60 @@ int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, cons
         if (FreeIdentifier) CCFree((char*)Identifier);
 #endif
         
-        if ((FileList) && (Logged != CCSystemLoggerASL))
+#if CC_PLATFORM_POSIX_COMPLIANT
+        if (((atomic_load_explicit(&FileList, memory_order_relaxed)) || (atomic_load_explicit(&RotatingFileList, memory_order_relaxed))) && (Logged != CCSystemLoggerASL) && (!WritingFiles))
+#else
+        if ((atomic_load_explicit(&FileList, memory_order_relaxed)) && (Logged != CCSystemLoggerASL))
+#endif
         {
-            char Timestamp[16];
-            strftime(Timestamp, sizeof(Timestamp), "%b %d %T", localtime(&(time_t){ time(NULL) }));
-            
-            const char *Hostname = CCHostCurrentName(), *ProcName = CCProcessCurrentStrippedName();
-            const CCPid Pid = CCProcessCurrent();
+            size_t TimestampLength, PrefixLength;
+            const char *Timestamp = LogTimestampGet(Time, &TimestampLength), *Prefix = LogProcessPrefixGet(&PrefixLength);
             
-            const size_t FormattedLength = snprintf(NULL, 0, "%s %s %s[%" PRIuPTR "]: ", Timestamp, Hostname, ProcName, Pid) + Length + 2;
+#if CC_PLATFORM_POSIX_COMPLIANT
+            const struct iovec Line[] = {
+                { .iov_base = (char*)Timestamp, .iov_len = TimestampLength },
+                { .iov_base = (char*)Prefix, .iov_len = PrefixLength },
+                { .iov_base = Message, .iov_len = Length },
+                { .iov_base = "\n", .iov_len = 1 }
+            };
             
-            char *FormattedMessage = CCMalloc(CC_DEFAULT_ALLOCATOR, FormattedLength, NULL, CC_DEFAULT_ERROR_CALLBACK);
-            if (FormattedMessage)
+#if CC_ASYNC_LOGGER
+            if (!(Option & CCLogOptionAsync) || !LogAsyncWrite(Line, sizeof(Line) / sizeof(*Line)))
+#endif
             {
-                snprintf(FormattedMessage, FormattedLength, "%s %s %s[%" PRIuPTR "]: %s\n", Timestamp, Hostname, ProcName, Pid, Message);
-                
-                CC_COLLECTION_FOREACH(FSHandle, Handle, FileList)
-                {
-                    FSHandleWrite(Handle, FormattedLength - 1, FormattedMessage, FSBehaviourUpdateOffset);
-                }
-                
-                CC_SAFE_Free(FormattedMessage);
+                LogWriteFiles(Line, sizeof(Line) / sizeof(*Line), FALSE);
+            }
+#else
+            size_t FileCount;
+            const FSHandle *Files = LogSnapshotGet(&FileList, &FileCount);
+            for (size_t Loop = 0; Loop < FileCount; Loop++)
+            {
+                FSHandle Handle = Files[Loop];
+                FSHandleWrite(Handle, TimestampLength, Timestamp, FSBehaviourUpdateOffset);
+                FSHandleWrite(Handle, PrefixLength, Prefix, FSBehaviourUpdateOffset);
+                FSHandleWrite(Handle, Length, Message, FSBehaviourUpdateOffset);
+                FSHandleWrite(Handle, 1, "\n", FSBehaviourUpdateOffset);
             }
+#endif
         }
     }
     
     if ((Option & CCLogOptionOutputPrint) && !(Logged & CCSystemLoggerPrinted)) fprintf(stderr, "%s\n", Message);
     
-    CC_SAFE_Free(Message);
+    LogScratchRelease(Scratch, Message, MessageSize, Buffer, BufferSize);
     
     return (int)Length;
 }
 
+int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, va_list Args)
+{
+    LogSectionBegin();
+    const int Length = LogMessage(Option, Tag, Identifier, Filename, FunctionName, Line, time(NULL), FormatString, Args);
+    LogSectionEnd();
+    
+    return Length;
+}
+
 int CCLog(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char * const FormatString, ...)
 {
     va_list Args;
@@ -906,9 +2510,14 @@ extern int asl_add_output(aslclient asl, int fd, const char *msg_fmt, const char
 
 void CCLogAddFile(FSHandle File)
 {
-    if (!FileList) FileList = CCCollectionCreate(CC_STD_ALLOCATOR, CCCollectionHintOrdered | CCCollectionHintSizeSmall | CCCollectionHintHeavyEnumerating | CCCollectionHintConstantLength | CCCollectionHintConstantElements, sizeof(FSHandle), FSHandleDestructorForCollection);
+#if CC_PLATFORM_POSIX_COMPLIANT
+    //Lines are written directly to the descriptor, so move it to the handle's offset (this also flushes anything the stream buffered)
+    const size_t Offset = FSHandleGetOffset(File);
+    FSHandleSetOffset(File, Offset);
+    lseek(FSHandleGetFileDescriptor(File), (off_t)Offset, SEEK_SET);
+#endif
     
-    CCOrderedCollectionAppendElement(FileList, &File);
+    LogSnapshotAdd(&FileList, sizeof(FSHandle), &File, FALSE);
     
 #if CC_PLATFORM_POSIX_COMPLIANT
     
@@ -931,6 +2540,71 @@ void CCLogAddFile(FSHandle File)
 #endif
 }
 
+_Bool CCLogAddRotatingFile(FSPath Path, CCLogRotation Rotation)
+{
+    CCAssertLog(Path, "Path must not be null");
+    
+    if (FSManagerCreate(Path, TRUE) != FSOperationSuccess) return FALSE;
+    
+#if CC_PLATFORM_POSIX_COMPLIANT
+    const char *SystemPath = FSPathGetPathString(Path); //TODO: Need to handle resolving of volumes
+    const size_t Length = strlen(SystemPath);
+    
+    CCLogRotatingFile *File;
+    CC_SAFE_Malloc(File, sizeof(CCLogRotatingFile) + (sizeof(char) * (Length + 1)),
+                   return FALSE;
+                   );
+    
+    CCLogRotatingDescriptor *Descriptor;
+    CC_SAFE_Malloc(Descriptor, sizeof(CCLogRotatingDescriptor),
+                   CC_SAFE_Free(File);
+                   return FALSE;
+                   );
+    
+    *Descriptor = (CCLogRotatingDescriptor){ .file = File, .segment = 0, .fd = open(SystemPath, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) };
+    
+    struct stat Info;
+    if ((Descriptor->fd == -1) || (fstat(Descriptor->fd, &Info)))
+    {
+        if (Descriptor->fd != -1) close(Descriptor->fd);
+        CC_SAFE_Free(Descriptor);
+        CC_SAFE_Free(File);
+        return FALSE;
+    }
+    
+    File->rotation = Rotation;
+    File->length = Length;
+    memcpy(File->path, SystemPath, sizeof(char) * (Length + 1));
+    
+    atomic_init(&File->descriptor, Descriptor);
+    atomic_init(&File->size, (size_t)Info.st_size);
+    atomic_init(&File->deadline, LogRotationDeadline(File, time(NULL)));
+    atomic_flag_clear(&File->rotating);
+    
+    File->segment = LogRotationScan(File, 0);
+    
+    pthread_once(&LogRotation.once, LogRotationSetup);
+    
+    if (!LogSnapshotAdd(&RotatingFileList, sizeof(CCLogRotatingFile*), &File, FALSE))
+    {
+        close(Descriptor->fd);
+        CC_SAFE_Free(Descriptor);
+        CC_SAFE_Free(File);
+        return FALSE;
+    }
+    
+    return TRUE;
+#else
+    FSHandle Handle;
+    if (FSHandleOpen(Path, FSHandleTypeWrite, &Handle) != FSOperationSuccess) return FALSE;
+    
+    FSHandleSetOffset(Handle, FSManagerGetSize(Path));
+    CCLogAddFile(Handle);
+    
+    return TRUE;
+#endif
+}
+
 size_t CCGetFormatSpecifierInfo(const char *Format, CCFormatSpecifierInfo *Info)
 {
     memset(Info, 0, sizeof(CCFormatSpecifierInfo));
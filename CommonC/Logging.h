@@ -30,6 +30,7 @@
  CC_NO_LOG: Disable all logging from macros. Virtually turns them all into a no-op.
  CC_NO_LOG_##tag: Disables logging of a particular tag through its macro usage (turned into no-op).
  { CC_NO_LOG_EMERGENCY, CC_NO_LOG_ALERT, CC_NO_LOG_CRITICAL, CC_NO_LOG_ERROR, CC_NO_LOG_WARNING, CC_NO_LOG_NOTICE, CC_NO_LOG_INFO, CC_NO_LOG_DEBUG }
+ CC_LOG_LEVEL: Disables logging of the tags less severe than the level (0 = emergency ... 7 = debug) through their macro usage.
  
  Options (either pre-include or undef and redefine):
  CC_LOG_OPTION: Specify the logging options for all logging macros.
@@ -38,6 +39,11 @@
  CC_LOG_##tag##_IDENTIFIER: Specify the identifier for that particular tag through its macro usage. Will override CC_LOG_IDENTIFIER when set.
  CC_LOG_FROM_FILE: Specify the file (typically __FILE__) or NULL to avoid adding the file name to the logging message.
  CC_LOG_FROM_FUNCTION: Specify the function (typically __func__) or NULL to avoid adding the function name to the logging message.
+ CC_LOG_##tag##_BINARY: Log using CCLogBinary, the format string must be a string literal.
+ CC_LOG_##tag##_LIMIT(rate, ...): Log at most rate messages per second from that call site, the number of suppressed messages is logged once
+                                   the site logs again.
+ CC_LOG_##tag##_SAMPLE(n, ...): Log 1 in every n messages from that call site.
+ The CC_LOG_##tag macros check the runtime level (see CCLogSetLevel) first, and don't evaluate their arguments if the tag is disabled.
  
  Types:
  enum CCLoggingOption - A bit mask indicating what type of logging options should be used.
@@ -45,7 +51,21 @@
     CCLogOptionOutputPrint - The logger will print the log message to stderr.
     CCLogOptionOutputFile - The logger will write the log message to the appropriate files.
     CCLogOptionOutputAll - A convenience option, specifies all options to be used.
-    CCLogOptionAsync - Writes to file asynchronously.
+    CCLogOptionAsync - Writes to file asynchronously. On POSIX platforms messages are queued in a per-thread buffer and written out in batches by a background thread.
+ 
+ enum CCLogLevel - The severity of the tags, matching the syslog levels.
+ 
+ struct CCLogRotation - How a file added with CCLogAddRotatingFile is rotated.
+    size - Rotate the file once it reaches this many bytes, or 0 to not rotate by size.
+    interval - Rotate the file every interval seconds, aligned to multiples of the interval (UTC) so 3600 rotates on the hour. 0 to not rotate by time.
+    retain - The number of rotated segments to keep, or 0 to keep all of them.
+    compress - Whether the rotated segments should be gzip compressed. Only available when built with CC_LOG_COMPRESSION (requires zlib), otherwise
+               the segments are left uncompressed.
+ 
+ enum CCLogAsyncOverflow - What to do when a thread's asynchronous buffer is full.
+    CCLogAsyncOverflowBlock - Wait for the buffer to be written out. This is the default.
+    CCLogAsyncOverflowDrop - Drop the message.
+    CCLogAsyncOverflowCount - Drop the message, and log how many were dropped once the buffers are written out.
  
  enum CCLogFilterType - The filter type of the function.
     CCLogFilterInput - Data field is CCLogInputData, return value is ignored. This filter is called at the beginning of CCLogv. The main usage is for having filters that apply to one of the prefixed fields (e.g. shortening the filename). This filter can only affect the current option, otherwise to do more it's suggested to call CCLog again with the modified inputs.
@@ -70,14 +90,47 @@
     unsigned int Line - The line number in that source.
     const char *FormatString - The main message/format specifier string. It follows printf style format string conversions.
     ... - The arguments referenced through the FormatString.
+ CCLogBinary() - Logs the message like CCLog, but when CCLogOptionAsync is set the arguments are recorded and the message is formatted later by the
+                 asynchronous writer. Supports the standard conversions and the %B, %C, %S custom specifiers, other formats are logged immediately.
+                 A thread's binary and asynchronous messages are written in the order they were logged.
+    Arguments:
+    CCLogBinarySite *Site - The static storage for the call site, the format string is parsed the first time it is used. The format string, tag,
+                            identifier, filename and function name must remain valid for the lifetime of the program.
+    The remaining arguments are the same as CCLog.
  CCLogAddFile() - Add a file to log messages to.
     Arguments:
     const char *File - A path and name of the file to be used. If no such file exists it will try create one. If the path does not exist it try will 
                        make one.
+ CCLogAddRotatingFile() - Add a file to log messages to, which is rotated to "<file>.<segment>" (numbered from 1, continuing from any existing
+                          segments) when it reaches its size or interval. Lines are never split or lost by a rotation, loggers don't wait
+                          on it, and compression and removing the old segments is done by a low priority background thread. Rotation
+                          is only available on POSIX platforms, otherwise the file is simply appended to.
+    Return:
+    _Bool - Whether the file could be opened.
+    Arguments:
+    FSPath Path - The path of the file. If no such file exists it will be created, along with any missing directories.
+    CCLogRotation Rotation - How the file should be rotated.
  CCLogAddFilter() - Add a filter to be applied to calls made using CCLog/CCLogv. Filters can be used to restructure log messages, add custom format specifiers, pass messages to other systems or other loggers, etc.
     Arguments:
     CCLogFilterType Type - The type of this filter (may be multiple).
     CCLogFilter Filter - The filter (either function or if supported block). See CCLogFilterType definition for filter guidlines.
+ CCLogFlush() - Write out any messages that are queued for asynchronous output. This is also performed on exit.
+ CCLogFlushOnCrash() - Install signal handlers (SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT) that write out any messages queued for asynchronous output, before passing the signal to the previously installed handler.
+                      Binary messages still queued when crashing are lost, as formatting them is not safe in a signal handler.
+ CCLogSetAsyncOverflow() - Set what to do when a thread's asynchronous buffer is full.
+    Arguments:
+    CCLogAsyncOverflow Overflow - The overflow policy.
+ CCLogSetLevel() - Set the least severe level the CC_LOG_##tag macros log. By default all levels are logged.
+    Arguments:
+    CCLogLevel Level - The level.
+ CCLogGetLevel() - Get the least severe level the CC_LOG_##tag macros log.
+ CCLogLevelIsEnabled() - Check whether a level is logged. This is a relaxed atomic load.
+ CCLogLimit() - Check whether a call site is under its rate limit, logging how many messages were suppressed when a new second starts.
+    Arguments:
+    CCLogLimitSite *Site - The static storage for the call site.
+    uint32_t Rate - The maximum number of messages per second.
+    The remaining arguments are the same as CCLog, and are used to log the suppressed count.
+ CCLogSample() - Check whether a message should be logged from a call site, allowing 1 in every N messages.
  
  
  
@@ -103,6 +156,7 @@
 #include <CommonC/Hacks.h>
 #include <CommonC/FileHandle.h>
 #include <CommonC/Ownership.h>
+#include <stdatomic.h>
 
 
 #pragma mark - Constants
@@ -125,9 +179,48 @@ typedef enum {
     CCLogOptionOutputAll = CCLogOptionOutputPrint | CCLogOptionOutputFile,
     
     //Asynchronous file output
-    CCLogOptionAsync = (1 << 8) //Only available when GCD is supported
+    CCLogOptionAsync = (1 << 8) //Only available when GCD is supported or on POSIX platforms
 } CCLoggingOption;
 
+typedef enum {
+    CCLogLevelEmergency,
+    CCLogLevelAlert,
+    CCLogLevelCritical,
+    CCLogLevelError,
+    CCLogLevelWarning,
+    CCLogLevelNotice,
+    CCLogLevelInfo,
+    CCLogLevelDebug
+} CCLogLevel;
+
+typedef struct {
+    _Atomic(uint64_t) state;
+    _Atomic(uint32_t) suppressed;
+} CCLogLimitSite;
+
+typedef enum {
+    CCLogAsyncOverflowBlock,
+    CCLogAsyncOverflowDrop,
+    CCLogAsyncOverflowCount
+} CCLogAsyncOverflow;
+
+typedef struct {
+    /// Rotate the file once it reaches this many bytes, or 0 to not rotate by size.
+    size_t size;
+    /// Rotate the file every interval seconds (aligned to multiples of the interval, UTC), or 0 to not rotate by time.
+    uint32_t interval;
+    /// The number of rotated segments to keep, or 0 to keep all of them.
+    size_t retain;
+    /// Whether the rotated segments should be compressed.
+    _Bool compress;
+} CCLogRotation;
+
+typedef struct CCLogBinaryFormat CCLogBinaryFormat;
+
+typedef struct {
+    _Atomic(CCLogBinaryFormat*) format;
+} CCLogBinarySite;
+
 typedef enum {
     CCLogFilterInput = (1 << 0),
     CCLogFilterSpecifier = (1 << 1),
@@ -205,10 +298,20 @@ typedef struct {
 
 #pragma mark - Functions
 void CCLogAddFile(FSHandle CC_OWN(File));
+_Bool CCLogAddRotatingFile(FSPath Path, CCLogRotation Rotation);
 int CCLogCustom(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, ...);
 int CCLog(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, ...) CC_FORMAT_PRINTF(7, 8);
 int CCLogv(CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, va_list Args) CC_FORMAT_PRINTF(7, 0);
+int CCLogBinary(CCLogBinarySite *Site, CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line, const char *FormatString, ...);
 void CCLogAddFilter(CCLogFilterType Type, CCLogFilter Filter);
+void CCLogFlush(void);
+void CCLogFlushOnCrash(void);
+void CCLogSetAsyncOverflow(CCLogAsyncOverflow Overflow);
+void CCLogSetLevel(CCLogLevel Level);
+CCLogLevel CCLogGetLevel(void);
+static inline _Bool CCLogLevelIsEnabled(CCLogLevel Level);
+_Bool CCLogLimit(CCLogLimitSite *Site, uint32_t Rate, CCLoggingOption Option, const char *Tag, const char *Identifier, const char * const Filename, const char * const FunctionName, unsigned int Line);
+static inline _Bool CCLogSample(CCLogLimitSite *Site, uint32_t N);
 
 #if __BLOCKS__
 void CCLogAddFilterBlock(CCLogFilterType Type, CCLogFilterBlock Filter);
@@ -227,14 +330,37 @@ void *: CCLogAddFilter)(type, (void*)filter)
 
 
 
+#pragma mark -
+extern _Atomic(CCLogLevel) CCLogLevelCurrent;
+
+static inline _Bool CCLogLevelIsEnabled(CCLogLevel Level)
+{
+    return Level <= atomic_load_explicit(&CCLogLevelCurrent, memory_order_relaxed);
+}
+
+static inline _Bool CCLogSample(CCLogLimitSite *Site, uint32_t N)
+{
+    return (N <= 1) || ((atomic_fetch_add_explicit(&Site->state, 1, memory_order_relaxed) % N) == 0);
+}
+
+
+
 #if CC_NO_LOG
 #define CC_LOG_(option, tag, identifier, ...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_CUSTOM_(option, tag, identifier, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_BINARY_(option, tag, identifier, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_LIMIT_(rate, option, tag, identifier, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_SAMPLE_(n, option, tag, identifier, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
 #define CC_LOG_(option, tag, identifier, ...) CCLog(option, tag, identifier, CC_LOG_FROM_FILE, CC_LOG_FROM_FUNCTION, __LINE__, __VA_ARGS__)
 #define CC_LOG_CUSTOM_(option, tag, identifier, ...) CCLogCustom(option, tag, identifier, CC_LOG_FROM_FILE, CC_LOG_FROM_FUNCTION, __LINE__, __VA_ARGS__)
+#define CC_LOG_BINARY_(option, tag, identifier, ...) ({ static CCLogBinarySite CC_LOG_BINARY_SITE_; CCLogBinary(&CC_LOG_BINARY_SITE_, option, tag, identifier, CC_LOG_FROM_FILE, CC_LOG_FROM_FUNCTION, __LINE__, __VA_ARGS__); })
+#define CC_LOG_LIMIT_(rate, option, tag, identifier, ...) ({ static CCLogLimitSite CC_LOG_LIMIT_SITE_; CCLogLimit(&CC_LOG_LIMIT_SITE_, rate, option, tag, identifier, CC_LOG_FROM_FILE, CC_LOG_FROM_FUNCTION, __LINE__) ? CC_LOG_(option, tag, identifier, __VA_ARGS__) : 0; })
+#define CC_LOG_SAMPLE_(n, option, tag, identifier, ...) ({ static CCLogLimitSite CC_LOG_LIMIT_SITE_; CCLogSample(&CC_LOG_LIMIT_SITE_, n) ? CC_LOG_(option, tag, identifier, __VA_ARGS__) : 0; })
 #endif
 
+#define CC_LOG_LEVEL_(level, log) (CCLogLevelIsEnabled(level) ? (log) : 0)
+
 
 #pragma mark - Formatting Helper Function
 size_t CCGetFormatSpecifierInfo(const char *Format, CCFormatSpecifierInfo *Info);
@@ -243,69 +369,142 @@ size_t CCGetFormatSpecifierInfo(const char *Format, CCFormatSpecifierInfo *Info)
 #pragma mark - Loggers
 #define CC_LOG(tag, ...) CC_LOG_(CC_LOG_OPTION, tag, CC_LOG_IDENTIFIER, __VA_ARGS__)
 #define CC_LOG_CUSTOM(tag, ...) CC_LOG_CUSTOM_(CC_LOG_OPTION, tag, CC_LOG_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_BINARY(tag, ...) CC_LOG_BINARY_(CC_LOG_OPTION, tag, CC_LOG_IDENTIFIER, __VA_ARGS__)
+
+#ifdef CC_LOG_LEVEL
+#if (CC_LOG_LEVEL < 1) && !defined(CC_NO_LOG_ALERT)
+#define CC_NO_LOG_ALERT 1
+#endif
+#if (CC_LOG_LEVEL < 2) && !defined(CC_NO_LOG_CRITICAL)
+#define CC_NO_LOG_CRITICAL 1
+#endif
+#if (CC_LOG_LEVEL < 3) && !defined(CC_NO_LOG_ERROR)
+#define CC_NO_LOG_ERROR 1
+#endif
+#if (CC_LOG_LEVEL < 4) && !defined(CC_NO_LOG_WARNING)
+#define CC_NO_LOG_WARNING 1
+#endif
+#if (CC_LOG_LEVEL < 5) && !defined(CC_NO_LOG_NOTICE)
+#define CC_NO_LOG_NOTICE 1
+#endif
+#if (CC_LOG_LEVEL < 6) && !defined(CC_NO_LOG_INFO)
+#define CC_NO_LOG_INFO 1
+#endif
+#if (CC_LOG_LEVEL < 7) && !defined(CC_NO_LOG_DEBUG)
+#define CC_NO_LOG_DEBUG 1
+#endif
+#endif
 
 #if CC_NO_LOG_EMERGENCY
 #define CC_LOG_EMERGENCY(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_EMERGENCY_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_EMERGENCY_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_EMERGENCY_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_EMERGENCY_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_EMERGENCY(...) CC_LOG_(CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_EMERGENCY_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_EMERGENCY(...) CC_LOG_LEVEL_(CCLogLevelEmergency, CC_LOG_(CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_EMERGENCY_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelEmergency, CC_LOG_CUSTOM_(CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_EMERGENCY_BINARY(...) CC_LOG_LEVEL_(CCLogLevelEmergency, CC_LOG_BINARY_(CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_EMERGENCY_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelEmergency, CC_LOG_LIMIT_(rate, CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_EMERGENCY_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelEmergency, CC_LOG_SAMPLE_(n, CC_LOG_EMERGENCY_OPTION & CC_LOG_OPTION, CCTagEmergency, CC_LOG_EMERGENCY_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_ALERT
 #define CC_LOG_ALERT(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_ALERT_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_ALERT_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_ALERT_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_ALERT_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_ALERT(...) CC_LOG_(CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_ALERT_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_ALERT(...) CC_LOG_LEVEL_(CCLogLevelAlert, CC_LOG_(CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ALERT_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelAlert, CC_LOG_CUSTOM_(CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ALERT_BINARY(...) CC_LOG_LEVEL_(CCLogLevelAlert, CC_LOG_BINARY_(CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ALERT_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelAlert, CC_LOG_LIMIT_(rate, CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ALERT_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelAlert, CC_LOG_SAMPLE_(n, CC_LOG_ALERT_OPTION & CC_LOG_OPTION, CCTagAlert, CC_LOG_ALERT_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_CRITICAL
 #define CC_LOG_CRITICAL(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_CRITICAL_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_CRITICAL_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_CRITICAL_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_CRITICAL_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_CRITICAL(...) CC_LOG_(CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_CRITICAL_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_CRITICAL(...) CC_LOG_LEVEL_(CCLogLevelCritical, CC_LOG_(CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_CRITICAL_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelCritical, CC_LOG_CUSTOM_(CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_CRITICAL_BINARY(...) CC_LOG_LEVEL_(CCLogLevelCritical, CC_LOG_BINARY_(CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_CRITICAL_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelCritical, CC_LOG_LIMIT_(rate, CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_CRITICAL_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelCritical, CC_LOG_SAMPLE_(n, CC_LOG_CRITICAL_OPTION & CC_LOG_OPTION, CCTagCritical, CC_LOG_CRITICAL_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_ERROR
 #define CC_LOG_ERROR(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_ERROR_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_ERROR_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_ERROR_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_ERROR_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_ERROR(...) CC_LOG_(CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_ERROR_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_ERROR(...) CC_LOG_LEVEL_(CCLogLevelError, CC_LOG_(CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ERROR_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelError, CC_LOG_CUSTOM_(CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ERROR_BINARY(...) CC_LOG_LEVEL_(CCLogLevelError, CC_LOG_BINARY_(CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ERROR_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelError, CC_LOG_LIMIT_(rate, CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_ERROR_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelError, CC_LOG_SAMPLE_(n, CC_LOG_ERROR_OPTION & CC_LOG_OPTION, CCTagError, CC_LOG_ERROR_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_WARNING
 #define CC_LOG_WARNING(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_WARNING_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_WARNING_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_WARNING_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_WARNING_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_WARNING(...) CC_LOG_(CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_WARNING_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_WARNING(...) CC_LOG_LEVEL_(CCLogLevelWarning, CC_LOG_(CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_WARNING_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelWarning, CC_LOG_CUSTOM_(CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_WARNING_BINARY(...) CC_LOG_LEVEL_(CCLogLevelWarning, CC_LOG_BINARY_(CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_WARNING_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelWarning, CC_LOG_LIMIT_(rate, CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_WARNING_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelWarning, CC_LOG_SAMPLE_(n, CC_LOG_WARNING_OPTION & CC_LOG_OPTION, CCTagWarning, CC_LOG_WARNING_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_NOTICE
 #define CC_LOG_NOTICE(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_NOTICE_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_NOTICE_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_NOTICE_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_NOTICE_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_NOTICE(...) CC_LOG_(CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_NOTICE_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_NOTICE(...) CC_LOG_LEVEL_(CCLogLevelNotice, CC_LOG_(CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_NOTICE_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelNotice, CC_LOG_CUSTOM_(CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_NOTICE_BINARY(...) CC_LOG_LEVEL_(CCLogLevelNotice, CC_LOG_BINARY_(CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_NOTICE_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelNotice, CC_LOG_LIMIT_(rate, CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_NOTICE_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelNotice, CC_LOG_SAMPLE_(n, CC_LOG_NOTICE_OPTION & CC_LOG_OPTION, CCTagNotice, CC_LOG_NOTICE_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_INFO
 #define CC_LOG_INFO(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_INFO_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_INFO_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_INFO_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_INFO_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_INFO(...) CC_LOG_(CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_INFO_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_INFO(...) CC_LOG_LEVEL_(CCLogLevelInfo, CC_LOG_(CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_INFO_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelInfo, CC_LOG_CUSTOM_(CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_INFO_BINARY(...) CC_LOG_LEVEL_(CCLogLevelInfo, CC_LOG_BINARY_(CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_INFO_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelInfo, CC_LOG_LIMIT_(rate, CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_INFO_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelInfo, CC_LOG_SAMPLE_(n, CC_LOG_INFO_OPTION & CC_LOG_OPTION, CCTagInfo, CC_LOG_INFO_IDENTIFIER, __VA_ARGS__))
 #endif
 
 #if CC_NO_LOG_DEBUG
 #define CC_LOG_DEBUG(...) CC_SILENCE_UNUSED_WARNING(0)
 #define CC_LOG_DEBUG_CUSTOM(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_DEBUG_BINARY(...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_DEBUG_LIMIT(rate, ...) CC_SILENCE_UNUSED_WARNING(0)
+#define CC_LOG_DEBUG_SAMPLE(n, ...) CC_SILENCE_UNUSED_WARNING(0)
 #else
-#define CC_LOG_DEBUG(...) CC_LOG_(CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__)
-#define CC_LOG_DEBUG_CUSTOM(...) CC_LOG_CUSTOM_(CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__)
+#define CC_LOG_DEBUG(...) CC_LOG_LEVEL_(CCLogLevelDebug, CC_LOG_(CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_DEBUG_CUSTOM(...) CC_LOG_LEVEL_(CCLogLevelDebug, CC_LOG_CUSTOM_(CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_DEBUG_BINARY(...) CC_LOG_LEVEL_(CCLogLevelDebug, CC_LOG_BINARY_(CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_DEBUG_LIMIT(rate, ...) CC_LOG_LEVEL_(CCLogLevelDebug, CC_LOG_LIMIT_(rate, CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__))
+#define CC_LOG_DEBUG_SAMPLE(n, ...) CC_LOG_LEVEL_(CCLogLevelDebug, CC_LOG_SAMPLE_(n, CC_LOG_DEBUG_OPTION & CC_LOG_OPTION, CCTagDebug, CC_LOG_DEBUG_IDENTIFIER, __VA_ARGS__))
 #endif
 
 
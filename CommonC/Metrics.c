@@ -0,0 +1,468 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Metrics.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "BitTricks.h"
+#include "Extensions.h"
+#include "Platform.h"
+#include "ThreadSlot_Private.h"
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <pthread.h>
+#endif
+
+struct CCMetricInfo {
+    const char *name;
+    CCMetricType type;
+    size_t index;
+};
+
+typedef struct {
+    _Atomic(uint64_t) count;
+    _Atomic(uint64_t) sum;
+    _Atomic(uint64_t) min;
+    _Atomic(uint64_t) max;
+    _Atomic(uint64_t) buckets[CC_METRICS_HISTOGRAM_BUCKET_COUNT];
+} CCMetricsHistogramShard;
+
+/*
+ Each thread owns a shard, so updates are a plain load and store (the atomics are only so the values can be read while
+ they're being updated). A detached shard keeps its values, so they remain part of the totals.
+ */
+typedef struct {
+    CCThreadSlot slot;
+    _Atomic(uint64_t) values[CC_METRICS_MAX];
+    _Atomic(CCMetricsHistogramShard*) histograms[CC_METRICS_MAX];
+} CCMetricsShard;
+
+typedef struct CCMetricsSnapshotInfo {
+    size_t count;
+    CCMetricsValue values[];
+} CCMetricsSnapshotInfo;
+
+static struct {
+    atomic_flag lock;
+    _Atomic(size_t) count;
+    struct CCMetricInfo metrics[CC_METRICS_MAX];
+    _Atomic(CCThreadSlot*) shards;
+#if CC_PLATFORM_POSIX_COMPLIANT
+    pthread_once_t once;
+    pthread_key_t key;
+#endif
+} Metrics = {
+    .lock = ATOMIC_FLAG_INIT,
+#if CC_PLATFORM_POSIX_COMPLIANT
+    .once = PTHREAD_ONCE_INIT
+#endif
+};
+
+static _Thread_local CCMetricsShard *CurrentShard = NULL;
+static _Thread_local _Bool CreatingShard = FALSE;
+
+#pragma mark - Registration
+
+CCMetric CCMetricsRegister(const char *Name, CCMetricType Type)
+{
+    CCAssertLog(Name, "Name must not be null");
+    
+    CCMetric Metric = NULL;
+    
+    while (atomic_flag_test_and_set_explicit(&Metrics.lock, memory_order_acquire)) CC_SPIN_WAIT();
+    
+    const size_t Count = atomic_load_explicit(&Metrics.count, memory_order_relaxed);
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        if (!strcmp(Metrics.metrics[Loop].name, Name))
+        {
+            if (Metrics.metrics[Loop].type == Type) Metric = &Metrics.metrics[Loop];
+            
+            atomic_flag_clear_explicit(&Metrics.lock, memory_order_release);
+            
+            return Metric;
+        }
+    }
+    
+    if (Count < CC_METRICS_MAX)
+    {
+        Metrics.metrics[Count] = (struct CCMetricInfo){ .name = Name, .type = Type, .index = Count };
+        Metric = &Metrics.metrics[Count];
+        
+        atomic_store_explicit(&Metrics.count, Count + 1, memory_order_release);
+    }
+    
+    atomic_flag_clear_explicit(&Metrics.lock, memory_order_release);
+    
+    return Metric;
+}
+
+CCMetric CCMetricsSiteRegister(_Atomic(CCMetric) *Site, const char *Name, CCMetricType Type)
+{
+    CCAssertLog(Site, "Site must not be null");
+    
+    CCMetric Metric = CCMetricsRegister(Name, Type);
+    if (Metric) atomic_store_explicit(Site, Metric, memory_order_release);
+    
+    return Metric;
+}
+
+#pragma mark - Shards
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+static void CCMetricsShardDetach(CCMetricsShard *Shard)
+{
+    CurrentShard = NULL;
+    CCThreadSlotDetach(&Shard->slot);
+}
+
+static void CCMetricsSetup(void)
+{
+    if (pthread_key_create(&Metrics.key, (void(*)(void*))CCMetricsShardDetach)) CCAssertLog(0, "Failed to create metrics thread key");
+}
+#endif
+
+static void CCMetricsShardInit(CCMetricsShard *Shard)
+{
+    for (size_t Loop = 0; Loop < CC_METRICS_MAX; Loop++)
+    {
+        atomic_init(&Shard->values[Loop], 0);
+        atomic_init(&Shard->histograms[Loop], NULL);
+    }
+}
+
+/*!
+ * @brief Get the shard of the current thread.
+ * @description Creating the shard may allocate, which is itself instrumented. Any updates made while the shard is
+ *              being created are dropped.
+ *
+ * @return The shard or NULL if one could not be created.
+ */
+static CC_FORCE_INLINE CCMetricsShard *CCMetricsGetShard(void)
+{
+    if (CC_LIKELY(CurrentShard)) return CurrentShard;
+    if (CreatingShard) return NULL;
+    
+    CreatingShard = TRUE;
+    
+#if CC_PLATFORM_POSIX_COMPLIANT
+    pthread_once(&Metrics.once, CCMetricsSetup);
+#endif
+    
+    CCMetricsShard *Shard = (CCMetricsShard*)CCThreadSlotClaim(&Metrics.shards, sizeof(CCMetricsShard), (CCThreadSlotInitializer)CCMetricsShardInit);
+    
+#if CC_PLATFORM_POSIX_COMPLIANT
+    if (Shard) pthread_setspecific(Metrics.key, Shard);
+#endif
+    
+    CurrentShard = Shard;
+    CreatingShard = FALSE;
+    
+    return Shard;
+}
+
+static CCMetricsHistogramShard *CCMetricsGetHistogramShard(CCMetricsShard *Shard, size_t Index)
+{
+    CCMetricsHistogramShard *Histogram = atomic_load_explicit(&Shard->histograms[Index], memory_order_relaxed);
+    if (CC_LIKELY(Histogram)) return Histogram;
+    
+    if (CreatingShard) return NULL;
+    
+    CreatingShard = TRUE;
+    Histogram = CCMalloc(CC_DEFAULT_ALLOCATOR, sizeof(CCMetricsHistogramShard), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    CreatingShard = FALSE;
+    
+    if (Histogram)
+    {
+        atomic_init(&Histogram->count, 0);
+        atomic_init(&Histogram->sum, 0);
+        atomic_init(&Histogram->min, UINT64_MAX);
+        atomic_init(&Histogram->max, 0);
+        for (size_t Loop = 0; Loop < CC_METRICS_HISTOGRAM_BUCKET_COUNT; Loop++) atomic_init(&Histogram->buckets[Loop], 0);
+        
+        atomic_store_explicit(&Shard->histograms[Index], Histogram, memory_order_release);
+    }
+    
+    return Histogram;
+}
+
+#pragma mark - Updating
+
+static CC_FORCE_INLINE void CCMetricsShardAdd(_Atomic(uint64_t) *Value, uint64_t Amount)
+{
+    atomic_store_explicit(Value, atomic_load_explicit(Value, memory_order_relaxed) + Amount, memory_order_relaxed);
+}
+
+void CCMetricsCounterAdd(CCMetric Metric, uint64_t Value)
+{
+    if (!Metric) return;
+    
+    CCAssertLog(Metric->type == CCMetricTypeCounter, "Metric must be a counter");
+    
+    CCMetricsShard *Shard = CCMetricsGetShard();
+    if (Shard) CCMetricsShardAdd(&Shard->values[Metric->index], Value);
+}
+
+void CCMetricsGaugeAdd(CCMetric Metric, int64_t Value)
+{
+    if (!Metric) return;
+    
+    CCAssertLog(Metric->type == CCMetricTypeGauge, "Metric must be a gauge");
+    
+    CCMetricsShard *Shard = CCMetricsGetShard();
+    if (Shard) CCMetricsShardAdd(&Shard->values[Metric->index], (uint64_t)Value);
+}
+
+static CC_FORCE_INLINE size_t CCMetricsHistogramBucket(uint64_t Value)
+{
+    if (Value < (1 << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS)) return (size_t)Value;
+    
+    const size_t Exponent = (size_t)CCBitCountTrailingZeros(CCBitHighestSet(Value));
+    
+    return ((Exponent - (CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS - 1)) << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS) + (size_t)((Value >> (Exponent - CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS)) & ((1 << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS) - 1));
+}
+
+static uint64_t CCMetricsHistogramBucketLowerBound(size_t Bucket)
+{
+    if (Bucket < (1 << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS)) return Bucket;
+    
+    const size_t Exponent = (Bucket >> CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS) + (CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS - 1);
+    const uint64_t Mantissa = (1 << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS) + (Bucket & ((1 << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS) - 1));
+    
+    return Mantissa << (Exponent - CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS);
+}
+
+static uint64_t CCMetricsHistogramBucketUpperBound(size_t Bucket)
+{
+    return Bucket + 1 < CC_METRICS_HISTOGRAM_BUCKET_COUNT ? CCMetricsHistogramBucketLowerBound(Bucket + 1) - 1 : UINT64_MAX;
+}
+
+void CCMetricsHistogramRecord(CCMetric Metric, uint64_t Value)
+{
+    if (!Metric) return;
+    
+    CCAssertLog(Metric->type == CCMetricTypeHistogram, "Metric must be a histogram");
+    
+    CCMetricsShard *Shard = CCMetricsGetShard();
+    if (!Shard) return;
+    
+    CCMetricsHistogramShard *Histogram = CCMetricsGetHistogramShard(Shard, Metric->index);
+    if (!Histogram) return;
+    
+    CCMetricsShardAdd(&Histogram->buckets[CCMetricsHistogramBucket(Value)], 1);
+    CCMetricsShardAdd(&Histogram->count, 1);
+    CCMetricsShardAdd(&Histogram->sum, Value);
+    
+    if (Value < atomic_load_explicit(&Histogram->min, memory_order_relaxed)) atomic_store_explicit(&Histogram->min, Value, memory_order_relaxed);
+    if (Value > atomic_load_explicit(&Histogram->max, memory_order_relaxed)) atomic_store_explicit(&Histogram->max, Value, memory_order_relaxed);
+}
+
+uint64_t CCMetricsTimestamp(void)
+{
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    
+    return ((uint64_t)Time.tv_sec * 1000000000) + (uint64_t)Time.tv_nsec;
+}
+
+#pragma mark - Snapshots
+
+CCMetricsSnapshot CCMetricsSnapshotCreate(CCAllocatorType Allocator)
+{
+    const size_t Count = atomic_load_explicit(&Metrics.count, memory_order_acquire);
+    
+    size_t HistogramCount = 0;
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        if (Metrics.metrics[Loop].type == CCMetricTypeHistogram) HistogramCount++;
+    }
+    
+    const size_t Size = sizeof(CCMetricsSnapshotInfo) + (sizeof(CCMetricsValue) * Count);
+    CCMetricsSnapshot Snapshot = CCMalloc(Allocator, Size + (sizeof(CCMetricsHistogram) * HistogramCount), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    if (Snapshot)
+    {
+        Snapshot->count = Count;
+        
+        CCMetricsHistogram *Histograms = (CCMetricsHistogram*)((uint8_t*)Snapshot + Size);
+        for (size_t Loop = 0; Loop < Count; Loop++)
+        {
+            CCMetricsValue *Value = &Snapshot->values[Loop];
+            Value->name = Metrics.metrics[Loop].name;
+            Value->type = Metrics.metrics[Loop].type;
+            
+            if (Value->type == CCMetricTypeHistogram)
+            {
+                memset(Histograms, 0, sizeof(CCMetricsHistogram));
+                Histograms->min = UINT64_MAX;
+                Value->histogram = Histograms++;
+            }
+            
+            else Value->counter = 0;
+        }
+        
+        for (CCThreadSlot *Slot = atomic_load_explicit(&Metrics.shards, memory_order_acquire); Slot; Slot = Slot->next)
+        {
+            CCMetricsShard *Shard = (CCMetricsShard*)Slot;
+            
+            for (size_t Loop = 0; Loop < Count; Loop++)
+            {
+                CCMetricsValue *Value = &Snapshot->values[Loop];
+                
+                if (Value->type == CCMetricTypeHistogram)
+                {
+                    CCMetricsHistogramShard *Shared = atomic_load_explicit(&Shard->histograms[Loop], memory_order_acquire);
+                    if (!Shared) continue;
+                    
+                    CCMetricsHistogram *Histogram = (CCMetricsHistogram*)Value->histogram;
+                    Histogram->count += atomic_load_explicit(&Shared->count, memory_order_relaxed);
+                    Histogram->sum += atomic_load_explicit(&Shared->sum, memory_order_relaxed);
+                    
+                    const uint64_t Min = atomic_load_explicit(&Shared->min, memory_order_relaxed), Max = atomic_load_explicit(&Shared->max, memory_order_relaxed);
+                    if (Min < Histogram->min) Histogram->min = Min;
+                    if (Max > Histogram->max) Histogram->max = Max;
+                    
+                    for (size_t Bucket = 0; Bucket < CC_METRICS_HISTOGRAM_BUCKET_COUNT; Bucket++) Histogram->buckets[Bucket] += atomic_load_explicit(&Shared->buckets[Bucket], memory_order_relaxed);
+                }
+                
+                else Value->counter += atomic_load_explicit(&Shard->values[Loop], memory_order_relaxed);
+            }
+        }
+    }
+    
+    return Snapshot;
+}
+
+void CCMetricsSnapshotDestroy(CCMetricsSnapshot Snapshot)
+{
+    CCAssertLog(Snapshot, "Snapshot must not be null");
+    
+    CCFree(Snapshot);
+}
+
+size_t CCMetricsSnapshotGetCount(CCMetricsSnapshot Snapshot)
+{
+    CCAssertLog(Snapshot, "Snapshot must not be null");
+    
+    return Snapshot->count;
+}
+
+const CCMetricsValue *CCMetricsSnapshotGetValue(CCMetricsSnapshot Snapshot, size_t Index)
+{
+    CCAssertLog(Snapshot, "Snapshot must not be null");
+    CCAssertLog(Index < Snapshot->count, "Index must not be out of bounds");
+    
+    return &Snapshot->values[Index];
+}
+
+const CCMetricsValue *CCMetricsSnapshotGetValueNamed(CCMetricsSnapshot Snapshot, const char *Name)
+{
+    CCAssertLog(Snapshot, "Snapshot must not be null");
+    CCAssertLog(Name, "Name must not be null");
+    
+    for (size_t Loop = 0; Loop < Snapshot->count; Loop++)
+    {
+        if (!strcmp(Snapshot->values[Loop].name, Name)) return &Snapshot->values[Loop];
+    }
+    
+    return NULL;
+}
+
+size_t CCMetricsSnapshotFormat(CCMetricsSnapshot Snapshot, char *Buffer, size_t Size)
+{
+    CCAssertLog(Snapshot, "Snapshot must not be null");
+    CCAssertLog(Buffer || !Size, "Buffer must not be null if size is not 0");
+    
+    if (Size) *Buffer = 0;
+    
+    size_t Length = 0;
+    for (size_t Loop = 0; Loop < Snapshot->count; Loop++)
+    {
+        const CCMetricsValue *Value = &Snapshot->values[Loop];
+        char * const Line = Length < Size ? Buffer + Length : NULL;
+        const size_t Available = Length < Size ? Size - Length : 0;
+        
+        int Written = 0;
+        switch (Value->type)
+        {
+            case CCMetricTypeCounter:
+                Written = snprintf(Line, Available, "counter %s %" PRIu64 "\n", Value->name, Value->counter);
+                break;
+                
+            case CCMetricTypeGauge:
+                Written = snprintf(Line, Available, "gauge %s %" PRId64 "\n", Value->name, Value->gauge);
+                break;
+                
+            case CCMetricTypeHistogram:
+            {
+                const CCMetricsHistogram *Histogram = Value->histogram;
+                Written = snprintf(Line, Available, "histogram %s count=%" PRIu64 " min=%" PRIu64 " mean=%" PRIu64 " p50=%" PRIu64 " p90=%" PRIu64 " p99=%" PRIu64 " max=%" PRIu64 "\n",
+                                   Value->name,
+                                   Histogram->count,
+                                   Histogram->count ? Histogram->min : 0,
+                                   Histogram->count ? Histogram->sum / Histogram->count : 0,
+                                   CCMetricsHistogramGetQuantile(Histogram, 0.5),
+                                   CCMetricsHistogramGetQuantile(Histogram, 0.9),
+                                   CCMetricsHistogramGetQuantile(Histogram, 0.99),
+                                   Histogram->max);
+                break;
+            }
+        }
+        
+        if (Written > 0) Length += (size_t)Written;
+    }
+    
+    return Length;
+}
+
+uint64_t CCMetricsHistogramGetQuantile(const CCMetricsHistogram *Histogram, double Quantile)
+{
+    CCAssertLog(Histogram, "Histogram must not be null");
+    CCAssertLog((Quantile >= 0.0) && (Quantile <= 1.0), "Quantile must be between 0.0 and 1.0");
+    
+    if (!Histogram->count) return 0;
+    
+    uint64_t Rank = (uint64_t)(Quantile * (double)Histogram->count + 0.5);
+    if (Rank < 1) Rank = 1;
+    if (Rank > Histogram->count) Rank = Histogram->count;
+    
+    uint64_t Total = 0;
+    for (size_t Loop = 0; Loop < CC_METRICS_HISTOGRAM_BUCKET_COUNT; Loop++)
+    {
+        Total += Histogram->buckets[Loop];
+        
+        if (Total >= Rank)
+        {
+            const uint64_t Value = CCMetricsHistogramBucketUpperBound(Loop);
+            
+            return Value < Histogram->min ? Histogram->min : (Value > Histogram->max ? Histogram->max : Value);
+        }
+    }
+    
+    return Histogram->max;
+}
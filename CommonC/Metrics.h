@@ -0,0 +1,262 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_Metrics_h
+#define CommonC_Metrics_h
+
+#include <CommonC/Base.h>
+#include <CommonC/Allocator.h>
+#include <CommonC/Ownership.h>
+#include <stdatomic.h>
+
+#ifndef CC_METRICS
+/// Set whether the framework should be instrumented with metrics (1), or if the instrumentation should be compiled out (0).
+#define CC_METRICS 0
+#endif
+
+#ifndef CC_METRICS_MAX
+/// The maximum number of metrics that can be registered.
+#define CC_METRICS_MAX 256
+#endif
+
+/// The number of sub-buckets each power of 2 of a histogram is divided into, as a power of 2.
+#define CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS 4
+
+/// The number of buckets in a histogram.
+#define CC_METRICS_HISTOGRAM_BUCKET_COUNT (((64 - CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS) + 1) << CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS)
+
+/*!
+ * @brief The type of a metric.
+ */
+typedef enum {
+    /// A monotonically increasing count.
+    CCMetricTypeCounter,
+    /// A value that can be increased or decreased.
+    CCMetricTypeGauge,
+    /// A distribution of values (such as latencies), recorded in log-linear buckets.
+    CCMetricTypeHistogram
+} CCMetricType;
+
+/*!
+ * @brief A registered metric.
+ * @description Metrics are updated through per-thread shards, so updating a metric doesn't use
+ *              any atomic read-modify-write operations, and the shards are only aggregated when
+ *              a snapshot is taken. Metrics exist for the lifetime of the program.
+ */
+typedef const struct CCMetricInfo *CCMetric;
+
+/*!
+ * @brief The aggregated values of a histogram.
+ * @description The values recorded are placed in log-linear buckets, where each power of 2 is
+ *              divided into 2^CC_METRICS_HISTOGRAM_SUB_BUCKET_BITS buckets. So the values within
+ *              a bucket are within 1/16th (6.25%) of each other.
+ */
+typedef struct {
+    /// The number of values recorded.
+    uint64_t count;
+    /// The sum of the values recorded.
+    uint64_t sum;
+    /// The minimum value recorded, or UINT64_MAX if none were recorded.
+    uint64_t min;
+    /// The maximum value recorded.
+    uint64_t max;
+    /// The number of values recorded in each bucket.
+    uint64_t buckets[CC_METRICS_HISTOGRAM_BUCKET_COUNT];
+} CCMetricsHistogram;
+
+/*!
+ * @brief The aggregated value of a metric.
+ */
+typedef struct {
+    /// The name of the metric.
+    const char *name;
+    /// The type of the metric.
+    CCMetricType type;
+    union {
+        /// The value of a counter.
+        uint64_t counter;
+        /// The value of a gauge.
+        int64_t gauge;
+        /// The values of a histogram.
+        const CCMetricsHistogram *histogram;
+    };
+} CCMetricsValue;
+
+/*!
+ * @brief A snapshot of the values of all the registered metrics.
+ */
+typedef struct CCMetricsSnapshotInfo *CCMetricsSnapshot;
+
+
+#pragma mark - Registration
+/*!
+ * @brief Register a metric.
+ * @description Registering a name that is already registered returns the existing metric.
+ * @param Name The name of the metric. This must remain valid for the lifetime of the program.
+ * @param Type The type of the metric.
+ * @return The metric, or NULL if there are already CC_METRICS_MAX metrics or the name is
+ *         registered with a different type.
+ */
+CCMetric CCMetricsRegister(const char *Name, CCMetricType Type);
+
+/*!
+ * @brief Register the metric for a call site.
+ * @description This should not be called directly, use @b CCMetricsSiteGet instead.
+ * @param Site The static storage for the call site.
+ * @param Name The name of the metric. This must remain valid for the lifetime of the program.
+ * @param Type The type of the metric.
+ * @return The metric, or NULL if it could not be registered.
+ */
+CCMetric CCMetricsSiteRegister(_Atomic(CCMetric) *Site, const char *Name, CCMetricType Type);
+
+/*!
+ * @brief Get the metric for a call site, registering it the first time it's used.
+ * @param Site The static storage for the call site.
+ * @param Name The name of the metric. This must remain valid for the lifetime of the program.
+ * @param Type The type of the metric.
+ * @return The metric, or NULL if it could not be registered.
+ */
+static inline CCMetric CCMetricsSiteGet(_Atomic(CCMetric) *Site, const char *Name, CCMetricType Type);
+
+#pragma mark - Updating
+/*!
+ * @brief Add to a counter.
+ * @param Metric The counter metric, or NULL to do nothing.
+ * @param Value The amount to add.
+ */
+void CCMetricsCounterAdd(CCMetric Metric, uint64_t Value);
+
+/*!
+ * @brief Add to a gauge.
+ * @param Metric The gauge metric, or NULL to do nothing.
+ * @param Value The amount to add (or subtract if negative).
+ */
+void CCMetricsGaugeAdd(CCMetric Metric, int64_t Value);
+
+/*!
+ * @brief Record a value in a histogram.
+ * @param Metric The histogram metric, or NULL to do nothing.
+ * @param Value The value to record.
+ */
+void CCMetricsHistogramRecord(CCMetric Metric, uint64_t Value);
+
+/*!
+ * @brief Get a monotonic timestamp for measuring latencies.
+ * @return The timestamp in nanoseconds.
+ */
+uint64_t CCMetricsTimestamp(void);
+
+#pragma mark - Snapshots
+/*!
+ * @brief Take a snapshot of the registered metrics.
+ * @description The shards of every thread are aggregated, updates being made while the
+ *              snapshot is taken may or may not be included.
+ *
+ * @param Allocator The allocator to be used for the allocation.
+ * @return The snapshot, or NULL on failure. Must be destroyed to free the memory.
+ */
+CC_NEW CCMetricsSnapshot CCMetricsSnapshotCreate(CCAllocatorType Allocator);
+
+/*!
+ * @brief Destroy a snapshot.
+ * @param Snapshot The snapshot to be destroyed.
+ */
+void CCMetricsSnapshotDestroy(CCMetricsSnapshot CC_DESTROY(Snapshot));
+
+/*!
+ * @brief Get the number of metrics in a snapshot.
+ * @param Snapshot The snapshot.
+ * @return The number of metrics.
+ */
+size_t CCMetricsSnapshotGetCount(CCMetricsSnapshot Snapshot);
+
+/*!
+ * @brief Get the value of a metric in a snapshot.
+ * @param Snapshot The snapshot.
+ * @param Index The index of the metric, metrics are in the order they were registered.
+ * @return The value. This is only valid for the lifetime of the snapshot.
+ */
+const CCMetricsValue *CCMetricsSnapshotGetValue(CCMetricsSnapshot Snapshot, size_t Index);
+
+/*!
+ * @brief Find the value of a metric in a snapshot.
+ * @param Snapshot The snapshot.
+ * @param Name The name of the metric.
+ * @return The value, or NULL if there is no metric with that name. This is only valid for the
+ *         lifetime of the snapshot.
+ */
+const CCMetricsValue *CCMetricsSnapshotGetValueNamed(CCMetricsSnapshot Snapshot, const char *Name);
+
+/*!
+ * @brief Format the snapshot as text.
+ * @description Each metric is written on its own line as "<type> <name> <value>", where the
+ *              value of a histogram is its count, min, mean, p50, p90, p99 and max.
+ *
+ * @param Snapshot The snapshot.
+ * @param Buffer The buffer to write the text to, this is always null terminated when the size
+ *        is not 0. May be NULL if the size is 0.
+ *
+ * @param Size The size of the buffer.
+ * @return The length of the text (excluding the null terminator), which may be larger than the
+ *         buffer if it was truncated.
+ */
+size_t CCMetricsSnapshotFormat(CCMetricsSnapshot Snapshot, char *Buffer, size_t Size);
+
+/*!
+ * @brief Get the value at a quantile of a histogram.
+ * @param Histogram The histogram.
+ * @param Quantile The quantile (0.0 - 1.0).
+ * @return The highest value of the bucket the quantile falls in (bounded by the min and max), or
+ *         0 if the histogram is empty.
+ */
+uint64_t CCMetricsHistogramGetQuantile(const CCMetricsHistogram *Histogram, double Quantile);
+
+
+#pragma mark - Instrumentation
+/*
+ Instrument code with metrics that are compiled out unless CC_METRICS is set. The name must be a string literal, and is
+ registered the first time the call site is reached.
+ */
+#if CC_METRICS
+#define CC_METRICS_SITE_(name, type) ({ static _Atomic(CCMetric) CC_METRICS_SITE_; CCMetricsSiteGet(&CC_METRICS_SITE_, name, type); })
+#define CC_METRICS_COUNTER_ADD(name, value) CCMetricsCounterAdd(CC_METRICS_SITE_(name, CCMetricTypeCounter), value)
+#define CC_METRICS_GAUGE_ADD(name, value) CCMetricsGaugeAdd(CC_METRICS_SITE_(name, CCMetricTypeGauge), value)
+#define CC_METRICS_HISTOGRAM_RECORD(name, value) CCMetricsHistogramRecord(CC_METRICS_SITE_(name, CCMetricTypeHistogram), value)
+#else
+#define CC_METRICS_COUNTER_ADD(name, value) ((void)0)
+#define CC_METRICS_GAUGE_ADD(name, value) ((void)0)
+#define CC_METRICS_HISTOGRAM_RECORD(name, value) ((void)0)
+#endif
+
+
+#pragma mark -
+static inline CCMetric CCMetricsSiteGet(_Atomic(CCMetric) *Site, const char *Name, CCMetricType Type)
+{
+    CCMetric Metric = atomic_load_explicit(Site, memory_order_acquire);
+    
+    return Metric ? Metric : CCMetricsSiteRegister(Site, Name, Type);
+}
+
+#endif
@@ -34,6 +34,13 @@
 #include <string.h>
 #include <ctype.h>
 
+#if CC_PLATFORM_UNIX
+#include <stdlib.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#endif
+
 
 static void FSPathClearPathStringCache(FSPath Path);
 
@@ -223,7 +230,71 @@ CCOrderedCollection FSPathConvertPathToComponents(const char *Path, _Bool Comple
 #if CC_PLATFORM_OS_X || CC_PLATFORM_IOS
 //SystemPath.m
 #elif CC_PLATFORM_UNIX
-#error Add support for unix
+CCOrderedCollection FSPathConvertSystemPathToComponents(const char *Path, _Bool CompletePath)
+{
+    CCAssertLog(Path, "Path must not be null");
+    
+    const char *Home = NULL;
+    if ((Path[0] == '~') && ((!Path[1]) || (Path[1] == '/')))
+    {
+        Home = getenv("HOME");
+        if (Home) Path++;
+    }
+    
+    const size_t HomeLength = Home ? strlen(Home) : 0, Length = HomeLength + strlen(Path);
+    
+    char *SystemPath;
+    CC_SAFE_Malloc(SystemPath, Length + 2,
+                   CC_LOG_ERROR("Failed to convert system path due to allocation failure. Allocation size (%zu)", Length + 2);
+                   return NULL;
+                   );
+    
+    if (Home) memcpy(SystemPath, Home, HomeLength);
+    strcpy(SystemPath + HomeLength, Path);
+    
+    //The path format treats a path without a trailing slash as a file, so existing directories are marked as such
+    struct stat Info;
+    if ((Length) && (SystemPath[Length - 1] != '/') && (!stat(SystemPath, &Info)) && (S_ISDIR(Info.st_mode))) strcpy(SystemPath + Length, "/");
+    
+    CCOrderedCollection Components = FSPathConvertPathToComponents(SystemPath, CompletePath);
+    CC_SAFE_Free(SystemPath);
+    
+    return Components;
+}
+
+FSPath FSPathCurrent(void)
+{
+    static FSPathInfo FSCurrentPath;
+    if (!FSCurrentPath.components)
+    {
+        char CurrentPath[PATH_MAX + 1];
+        if (getcwd(CurrentPath, PATH_MAX))
+        {
+            const size_t Length = strlen(CurrentPath);
+            if (CurrentPath[Length - 1] != '/') strcpy(CurrentPath + Length, "/");
+            
+            FSCurrentPath.components = FSPathConvertPathToComponents(CurrentPath, FALSE);
+        }
+        
+        else
+        {
+            CC_LOG_ERROR("Failed to get the current directory");
+            FSCurrentPath.components = FSPathConvertPathToComponents("/", FALSE);
+        }
+    }
+    
+    return &FSCurrentPath;
+}
+
+FSPath FSPathCreateAppData(const char *AppName)
+{
+    const char *DataPath = getenv("XDG_DATA_HOME");
+    CCOrderedCollection Components = DataPath && *DataPath ? FSPathConvertSystemPathToComponents(DataPath, TRUE) : FSPathConvertSystemPathToComponents("~/.local/share/", TRUE);
+    
+    CCOrderedCollectionAppendElement(Components, &(FSPathComponent){ FSPathComponentCreate(FSPathComponentTypeDirectory, AppName) });
+    
+    return FSPathCreateFromComponents(Components);
+}
 #elif CC_PLATFORM_WINDOWS
 #error Add support for windows
 #else
@@ -407,8 +478,8 @@ static void FSPathCreatePathStringCache(FSPath Path)
         const char *Volume = NULL;
         if (RequiresVolume)
         {
-            Volume = FSPathComponentGetString(FSPathGetVolume(Path));
-            Length += 2 + strlen(Volume);
+            Volume = FSPathComponentGetString(FSPathGetVolume(Path)); //platforms without volumes (unix) won't have one
+            if (Volume) Length += 2 + strlen(Volume);
         }
         
         CC_SAFE_Malloc(Path->completeRep, sizeof(char) * (Length + 1),
@@ -210,7 +210,7 @@
 
 #if __clang__
 #define CC_COMPILER_CLANG 1
-#elif __GCC__
+#elif __GNUC__
 #define CC_COMPILER_GCC 1
 #elif __MINGW32__ || __MINGW64__
 #define CC_COMPILER_MINGW 1
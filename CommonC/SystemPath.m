@@ -33,7 +33,9 @@
 #import "Assertion.h"
 #import "Path.h"
 #import "FileHandle.h"
+#import "FileHandle_Private.h"
 #import "FileSystem.h"
+#import "FileSystem_Private.h"
 #import "TypeCallbacks.h"
 
 
@@ -203,18 +205,42 @@ static NSURL *FSPathSystemInternalRepresentation(FSPath Path)
     return SystemPath;
 }
 
-_Bool FSManagerExists(FSPath Path)
+FSOperation FSManagerGetSystemInfo(FSPath Path, FSFileInfo *Info)
 {
-    CCAssertLog(Path, "Path must not be null");
-    
     @autoreleasepool {
-        BOOL IsDir;
-        _Bool Exists = [[NSFileManager defaultManager] fileExistsAtPath: FSPathSystemInternalRepresentation(Path).path isDirectory: &IsDir];
+        NSURL *SystemPath = FSPathSystemInternalRepresentation(Path);
+        NSDictionary *Values = [SystemPath resourceValuesForKeys: @[NSURLIsDirectoryKey, NSURLIsReadableKey, NSURLIsWritableKey, NSURLIsExecutableKey, NSURLFileSizeKey, NSURLPreferredIOBlockSizeKey, NSURLContentModificationDateKey] error: NULL];
+        
+        if (!Values)
+        {
+            *Info = (FSFileInfo){ .directory = FALSE };
+            
+            return [SystemPath checkResourceIsReachableAndReturnError: NULL] ? FSOperationFailure : FSOperationPathNotExist;
+        }
         
-        return (Exists) && (IsDir == FSPathIsDirectory(Path));
+        *Info = (FSFileInfo){
+            .directory = [Values[NSURLIsDirectoryKey] boolValue],
+            .access = ((_Bool)[Values[NSURLIsReadableKey] boolValue] * FSAccessReadable)
+                    | ((_Bool)[Values[NSURLIsWritableKey] boolValue] * FSAccessWritable)
+                    | ((_Bool)[Values[NSURLIsExecutableKey] boolValue] * FSAccessExecutable)
+                    | ((_Bool)[[NSFileManager defaultManager] isDeletableFileAtPath: SystemPath.path] * FSAccessDeletable),
+            .size = (size_t)[Values[NSURLFileSizeKey] unsignedLongLongValue],
+            .blockSize = (size_t)[Values[NSURLPreferredIOBlockSizeKey] unsignedLongLongValue],
+            .modified = (uint64_t)([Values[NSURLContentModificationDateKey] timeIntervalSince1970] * 1000000000.0)
+        };
+        
+        return FSOperationSuccess;
     }
 }
 
+_Bool FSManagerExists(FSPath Path)
+{
+    CCAssertLog(Path, "Path must not be null");
+    
+    FSFileInfo Info;
+    return (FSManagerGetInfo(Path, &Info) == FSOperationSuccess) && (Info.directory == FSPathIsDirectory(Path));
+}
+
 FSAccess FSManagerGetAccessRights(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
@@ -234,24 +260,16 @@ size_t FSManagerGetSize(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
     
-    @autoreleasepool {
-        NSNumber *Size;
-        [FSPathSystemInternalRepresentation(Path) getResourceValue: &Size forKey: NSURLFileSizeKey error: NULL];
-        
-        return (size_t)Size.unsignedLongLongValue;
-    }
+    FSFileInfo Info;
+    return FSManagerGetInfo(Path, &Info) == FSOperationSuccess ? Info.size : 0;
 }
 
 size_t FSManagerGetPreferredIOBlockSize(FSPath Path)
 {
     CCAssertLog(Path, "Path must not be null");
     
-    @autoreleasepool {
-        NSNumber *Size;
-        [FSPathSystemInternalRepresentation(Path) getResourceValue: &Size forKey: NSURLPreferredIOBlockSizeKey error: NULL];
-        
-        return (size_t)Size.unsignedLongLongValue;
-    }
+    FSFileInfo Info;
+    return FSManagerGetInfo(Path, &Info) == FSOperationSuccess ? Info.blockSize : 0;
 }
 
 static void FSManagerAddContentsInPath(NSURL *SystemPath, CCOrderedCollection *List, CCCollection NamingMatches, FSMatch MatchOptions)
@@ -323,6 +341,78 @@ CCOrderedCollection FSManagerGetContentsAtPath(FSPath Path, CCCollection NamingM
     return List;
 }
 
+FSOperation FSManagerEnumerateContentsAtPath(FSPath Path, CCCollection NamingMatches, FSMatch MatchOptions, FSManagerEnumerator Callback, void *Context)
+{
+    CCAssertLog(Path, "Path must not be null");
+    CCAssertLog(Callback, "Callback must not be null");
+    
+    @autoreleasepool {
+        NSURL *SystemPath = FSPathSystemInternalRepresentation(Path);
+        if (![SystemPath checkResourceIsReachableAndReturnError: NULL]) return FSOperationPathNotExist;
+        
+        NSDirectoryEnumerationOptions Options = (MatchOptions & FSMatchSkipHidden) ? NSDirectoryEnumerationSkipsHiddenFiles : 0;
+        if (!(MatchOptions & FSMatchSearchRecursively)) Options |= NSDirectoryEnumerationSkipsSubdirectoryDescendants;
+        
+        NSDirectoryEnumerator *Enumerator = [[NSFileManager defaultManager] enumeratorAtURL: SystemPath
+                                                                 includingPropertiesForKeys: @[NSURLIsDirectoryKey]
+                                                                                    options: Options
+                                                                               errorHandler: nil];
+        
+        char ItemPath[PATH_MAX];
+        _Bool Enumerating = TRUE;
+        for (NSURL *Item in Enumerator)
+        {
+            @autoreleasepool {
+                NSNumber *Dir;
+                [Item getResourceValue: &Dir forKey: NSURLIsDirectoryKey error: NULL];
+                const _Bool IsDir = Dir ? Dir.boolValue : FALSE;
+                
+                size_t Length = strlen(Item.fileSystemRepresentation);
+                if ((Length + 2) > sizeof(ItemPath)) continue;
+                
+                memcpy(ItemPath, Item.fileSystemRepresentation, Length);
+                if ((IsDir) && (Length) && (ItemPath[Length - 1] != '/')) ItemPath[Length++] = '/';
+                ItemPath[Length] = 0;
+                
+                _Bool Match = TRUE;
+                if (NamingMatches)
+                {
+                    FSPath EntryPath = FSPathCreateFromSystemPath(ItemPath);
+                    
+                    CC_COLLECTION_FOREACH(FSPath, PathMatch, NamingMatches)
+                    {
+                        Match = FSPathMatch(EntryPath, PathMatch, MatchOptions);
+                        
+                        if (Match) break;
+                    }
+                    
+                    FSPathDestroy(EntryPath);
+                }
+                
+                if (((MatchOptions & FSMatchNameBlacklist) ? !Match : Match) && !(IsDir ? (MatchOptions & FSMatchSkipDirectory) : (MatchOptions & FSMatchSkipFile)))
+                {
+                    const char *Name = ItemPath + Length - IsDir;
+                    while ((Name != ItemPath) && (Name[-1] != '/')) Name--;
+                    
+                    const FSManagerEntry Entry = {
+                        .path = ItemPath,
+                        .name = Name,
+                        .length = Length,
+                        .depth = Enumerator.level - 1,
+                        .directory = IsDir
+                    };
+                    
+                    Enumerating = Callback(&Entry, Context);
+                }
+            }
+            
+            if (!Enumerating) break;
+        }
+    }
+    
+    return FSOperationSuccess;
+}
+
 FSOperation FSManagerCreate(FSPath Path, _Bool IntermediateDirectories)
 {
     CCAssertLog(Path, "Path must not be null");
@@ -362,6 +452,8 @@ FSOperation FSManagerCreate(FSPath Path, _Bool IntermediateDirectories)
                                                                          error: NULL];
             }
             
+            FSManagerInvalidateInfoCache();
+            
             return Success ? FSOperationSuccess : FSOperationFailure;
         }
     }
@@ -378,6 +470,8 @@ FSOperation FSManagerRemove(FSPath Path)
         @autoreleasepool {
             _Bool Success = [[NSFileManager defaultManager] removeItemAtURL: FSPathSystemInternalRepresentation(Path) error: NULL];
             
+            FSManagerInvalidateInfoCache();
+            
             return Success ? FSOperationSuccess : FSOperationFailure;
         }
     }
@@ -397,6 +491,8 @@ FSOperation FSManagerMove(FSPath Path, FSPath Destination)
                                                                     toURL: FSPathSystemInternalRepresentation(Destination)
                                                                     error: NULL];
             
+            FSManagerInvalidateInfoCache();
+            
             return Success ? FSOperationSuccess : FSOperationFailure;
         }
     }
@@ -416,6 +512,8 @@ FSOperation FSManagerCopy(FSPath Path, FSPath Destination)
                                                                     toURL: FSPathSystemInternalRepresentation(Destination)
                                                                     error: NULL];
             
+            FSManagerInvalidateInfoCache();
+            
             return Success ? FSOperationSuccess : FSOperationFailure;
         }
     }
@@ -434,6 +532,8 @@ FSOperation FSHandleOpen(FSPath Path, FSHandleType Type, FSHandle *Handle)
     {
         @autoreleasepool {
             NSURL *SystemPath = FSPathSystemInternalRepresentation(Path);
+            if (Type & FSHandleTypeUnbuffered) return FSHandleDescriptorOpen(Path, SystemPath.fileSystemRepresentation, Type, Handle);
+            
             NSFileHandle *File = nil;
             
             if (Type == FSHandleTypeRead) File = [NSFileHandle fileHandleForReadingFromURL: SystemPath error: NULL];
@@ -448,7 +548,8 @@ FSOperation FSHandleOpen(FSPath Path, FSHandleType Type, FSHandle *Handle)
             **Handle = (FSHandleInfo){
                 .type = Type,
                 .path = FSPathCopy(Path),
-                .handle = [File retain]
+                .handle = [File retain],
+                .descriptor = -1
             };
             
             return FSOperationSuccess;
@@ -462,6 +563,8 @@ FSOperation FSHandleClose(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorClose(Handle);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     FSPathDestroy(Handle->path);
@@ -480,6 +583,8 @@ FSOperation FSHandleSync(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorSync(Handle);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     @autoreleasepool {
@@ -495,6 +600,8 @@ FSOperation FSHandleRead(FSHandle Handle, size_t *Count, void *Data, FSBehaviour
     CCAssertLog(Count, "Count must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorReadFromOffset(Handle, Handle->offset, Count, Data, Behaviour);
+    
     if ((!Handle->handle) || (Handle->type == FSHandleTypeWrite))
     {
         *Count = 0;
@@ -522,6 +629,8 @@ FSOperation FSHandleReadFromOffset(FSHandle Handle, size_t Offset, size_t *Count
     CCAssertLog(Count, "Count must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorReadFromOffset(Handle, Offset, Count, Data, Behaviour);
+    
     if (!Handle->handle)
     {
         *Count = 0;
@@ -543,6 +652,8 @@ FSOperation FSHandleWrite(FSHandle Handle, size_t Count, const void *Data, FSBeh
     CCAssertLog(Handle, "Handle must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorWriteFromOffset(Handle, Handle->offset, Count, Data, Behaviour);
+    
     if ((!Handle->handle) || (Handle->type == FSHandleTypeRead)) return FSOperationFailure;
     
     const size_t Offset = FSHandleGetOffset(Handle);
@@ -558,40 +669,8 @@ FSOperation FSHandleWrite(FSHandle Handle, size_t Count, const void *Data, FSBeh
         {
             if (Handle->type != FSHandleTypeUpdate) return FSOperationFailure;
             
-#if CC_PLATFORM_OS_X
-            size_t ChunkSize = FSManagerGetPreferredIOBlockSize(Handle->path);
-#elif CC_PLATFORM_IOS
-            size_t ChunkSize = 4096;
-#endif
-            if (Count > ChunkSize) ChunkSize = Count;
-            
-            const size_t Size = FSManagerGetSize(Handle->path) - Offset;
-            NSData *Chunk = [[(NSFileHandle*)Handle->handle readDataOfLength: ChunkSize] retain];
-            
-            [(NSFileHandle*)Handle->handle seekToFileOffset: Offset];
-            [(NSFileHandle*)Handle->handle writeData: WriteData];
-            
-            for (size_t Shifted = 0; Shifted < Size; )
-            {
-                @autoreleasepool {
-                    NSData *NextChunk = nil;
-                    if (Shifted + Chunk.length < Size)
-                    {
-                        [(NSFileHandle*)Handle->handle seekToFileOffset: Offset + Shifted + Count];
-                        NextChunk = [(NSFileHandle*)Handle->handle readDataOfLength: ChunkSize];
-                    }
-                    
-                    [(NSFileHandle*)Handle->handle seekToFileOffset: Offset + Shifted + Count];
-                    [(NSFileHandle*)Handle->handle writeData: Chunk];
-                    
-                    Shifted += Chunk.length;
-                    
-                    [Chunk release];
-                    Chunk = [NextChunk retain];
-                }
-            }
-            
-            [Chunk release];
+            FSHandleInfo View = FSHandleDescriptorView(Handle);
+            if (FSHandleDescriptorWriteFromOffset(&View, Offset, Count, Data, FSWritingBehaviourInsert) != FSOperationSuccess) return FSOperationFailure;
         }
     }
     
@@ -606,6 +685,8 @@ FSOperation FSHandleWriteFromOffset(FSHandle Handle, size_t Offset, size_t Count
     CCAssertLog(Handle, "Handle must not be null");
     CCAssertLog(Data, "Data must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorWriteFromOffset(Handle, Offset, Count, Data, Behaviour);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     const size_t OldOffset = FSHandleGetOffset(Handle);
@@ -622,45 +703,14 @@ FSOperation FSHandleRemove(FSHandle Handle, size_t Count, FSBehaviour Behaviour)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorRemoveFromOffset(Handle, Handle->offset, Count, Behaviour);
+    
     if ((!Handle->handle) || (Handle->type != FSHandleTypeUpdate)) return FSOperationFailure;
     
     const size_t Offset = FSHandleGetOffset(Handle);
-    size_t Size = FSManagerGetSize(Handle->path);
     
-    if (Offset > Size) return FSOperationSuccess;
-    Size -= Offset;
-    
-    @autoreleasepool {
-        if (Count >= Size)
-        {
-            [(NSFileHandle*)Handle->handle truncateFileAtOffset: Offset];
-        }
-        
-        else
-        {
-#if CC_PLATFORM_OS_X
-            size_t ChunkSize = FSManagerGetPreferredIOBlockSize(Handle->path);
-#elif CC_PLATFORM_IOS
-            size_t ChunkSize = 4096;
-#endif
-            
-            for (size_t Shifted = 0; Shifted < (Size - Count); )
-            {
-                @autoreleasepool {
-                    [(NSFileHandle*)Handle->handle seekToFileOffset: Offset + Shifted + Count];
-                    NSData *Chunk = [(NSFileHandle*)Handle->handle readDataOfLength: ChunkSize];
-                    
-                    [(NSFileHandle*)Handle->handle seekToFileOffset: Offset + Shifted];
-                    [(NSFileHandle*)Handle->handle writeData: Chunk];
-                    
-                    Shifted += Chunk.length;
-                }
-            }
-            
-            [(NSFileHandle*)Handle->handle truncateFileAtOffset: Offset + Size - Count];
-        }
-        
-    }
+    FSHandleInfo View = FSHandleDescriptorView(Handle);
+    if (FSHandleDescriptorRemoveFromOffset(&View, Offset, Count, FSBehaviourDefault) != FSOperationSuccess) return FSOperationFailure;
     
     if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourPreserveOffset) return FSHandleSetOffset(Handle, Offset);
     else if ((Behaviour & FSBehaviourOffsettingMask) == FSBehaviourUpdateOffset) return FSHandleSetOffset(Handle, Offset + Count);
@@ -672,6 +722,8 @@ FSOperation FSHandleRemoveFromOffset(FSHandle Handle, size_t Offset, size_t Coun
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return FSHandleDescriptorRemoveFromOffset(Handle, Offset, Count, Behaviour);
+    
     if (!Handle->handle) return FSOperationFailure;
     
     const size_t OldOffset = FSHandleGetOffset(Handle);
@@ -688,6 +740,8 @@ size_t FSHandleGetOffset(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return Handle->offset;
+    
     if (Handle->handle)
     {
         @autoreleasepool {
@@ -702,6 +756,12 @@ FSOperation FSHandleSetOffset(FSHandle Handle, size_t Offset)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered)
+    {
+        Handle->offset = Offset;
+        return FSOperationSuccess;
+    }
+    
     if (!Handle->handle) return FSOperationFailure;
     
     @autoreleasepool {
@@ -716,6 +776,8 @@ int FSHandleGetFileDescriptor(FSHandle Handle)
 {
     CCAssertLog(Handle, "Handle must not be null");
     
+    if (Handle->type & FSHandleTypeUnbuffered) return Handle->descriptor;
+    
     if (Handle->handle)
     {
         @autoreleasepool {
@@ -28,6 +28,7 @@
 #include "Assertion.h"
 #include "Logging.h"
 #include "Platform.h"
+#include "Trace.h"
 #include <stdatomic.h>
 #include <string.h>
 
@@ -79,7 +80,7 @@ CCTask CCTaskCreate(CCAllocatorType Allocator, CCTaskFunction Function, size_t O
     if (Task)
     {
         *Task = (CCTaskInfo){ .input = NULL, .output = NULL, .function = Function };
-        atomic_init(&Task->state, (CCTaskState){ .executions = 0, .completed = FALSE });
+        atomic_init(&Task->state, ((CCTaskState){ .executions = 0, .completed = FALSE }));
         
         CCMemorySetDestructor(Task, (CCMemoryDestructorCallback)CCTaskDestructor);
         
@@ -130,6 +131,8 @@ void CCTaskRun(CCTask Task)
 {
     CCAssertLog(Task, "Task must not be null");
     
+    CC_TRACE_SCOPE("CCTaskRun");
+    
     CCTaskState State;
     do {
         State = atomic_load_explicit(&Task->state, memory_order_relaxed);
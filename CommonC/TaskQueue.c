@@ -29,6 +29,8 @@
 #include "Logging.h"
 #include "ConcurrentQueue.h"
 #include "EpochGarbageCollector.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <stdatomic.h>
 
 typedef struct CCTaskQueueInfo {
@@ -100,9 +102,16 @@ void CCTaskQueueDestroy(CCTaskQueue Queue)
     CCFree(Queue);
 }
 
+typedef struct {
+    CCTask task;
+#if CC_METRICS
+    uint64_t timestamp;
+#endif
+} CCTaskQueueEntry;
+
 static void CCTaskQueueNodeDestructor(CCConcurrentQueueNode *Node)
 {
-    CCTask Task = *(CCTask*)CCConcurrentQueueGetNodeData(Node);
+    CCTask Task = ((CCTaskQueueEntry*)CCConcurrentQueueGetNodeData(Node))->task;
     if (Task) CCTaskDestroy(Task);
 }
 
@@ -111,17 +120,27 @@ void CCTaskQueuePush(CCTaskQueue Queue, CCTask Task)
     CCAssertLog(Queue, "Queue must not be null");
     CCAssertLog(Task, "Task must not be null");
     
-    CCConcurrentQueueNode *Node = CCConcurrentQueueCreateNode(Queue->allocator, sizeof(CCTask), &Task);
+    CCConcurrentQueueNode *Node = CCConcurrentQueueCreateNode(Queue->allocator, sizeof(CCTaskQueueEntry), &(CCTaskQueueEntry){
+        .task = Task,
+#if CC_METRICS
+        .timestamp = CCMetricsTimestamp()
+#endif
+    });
     CCMemorySetDestructor(Node, (CCMemoryDestructorCallback)CCTaskQueueNodeDestructor);
     
     CCConcurrentQueuePush(Queue->tasks, Node);
     atomic_fetch_add_explicit(&Queue->count, 1, memory_order_relaxed);
+    
+    CC_METRICS_COUNTER_ADD("task-queue.push", 1);
+    CC_METRICS_GAUGE_ADD("task-queue.depth", 1);
 }
 
 CCTask CCTaskQueuePop(CCTaskQueue Queue)
 {
     CCAssertLog(Queue, "Queue must not be null");
     
+    CC_TRACE_SCOPE("CCTaskQueuePop");
+    
     if (Queue->type == CCTaskQueueExecuteSerially)
     {
         if (atomic_flag_test_and_set_explicit(&Queue->lock, memory_order_acquire)) return NULL;
@@ -142,8 +161,14 @@ CCTask CCTaskQueuePop(CCTaskQueue Queue)
     CCConcurrentQueueNode *Node = CCConcurrentQueuePop(Queue->tasks);
     if (!Node) return NULL;
     
-    CCTask Task = *(CCTask*)CCConcurrentQueueGetNodeData(Node);
-    *(CCTask*)CCConcurrentQueueGetNodeData(Node) = NULL;
+    CCTaskQueueEntry *Entry = CCConcurrentQueueGetNodeData(Node);
+    CCTask Task = Entry->task;
+    Entry->task = NULL;
+    
+    CC_METRICS_COUNTER_ADD("task-queue.pop", 1);
+    CC_METRICS_GAUGE_ADD("task-queue.depth", -1);
+    CC_METRICS_HISTOGRAM_RECORD("task-queue.wait", CCMetricsTimestamp() - Entry->timestamp);
+    
     CCConcurrentQueueDestroyNode(Node);
     
     if (Queue->type == CCTaskQueueExecuteSerially)
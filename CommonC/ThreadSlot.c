@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ThreadSlot_Private.h"
+#include "MemoryAllocation.h"
+
+CCThreadSlot *CCThreadSlotClaim(_Atomic(CCThreadSlot*) *List, size_t Size, CCThreadSlotInitializer Initializer)
+{
+    CCThreadSlot *Slot = NULL;
+    for (Slot = atomic_load_explicit(List, memory_order_acquire); Slot; Slot = Slot->next)
+    {
+        _Bool Detached = TRUE;
+        if (atomic_compare_exchange_strong(&Slot->detached, &Detached, FALSE)) return Slot;
+    }
+    
+    CC_SAFE_Malloc(Slot, Size,
+                   return NULL;
+                   );
+    
+    atomic_init(&Slot->detached, FALSE);
+    Initializer(Slot);
+    
+    Slot->next = atomic_load_explicit(List, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(List, &Slot->next, Slot, memory_order_release, memory_order_relaxed));
+    
+    return Slot;
+}
+
+void CCThreadSlotDetach(CCThreadSlot *Slot)
+{
+    atomic_store_explicit(&Slot->detached, TRUE, memory_order_release);
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_ThreadSlot_Private_h
+#define CommonC_ThreadSlot_Private_h
+
+#include "Base.h"
+#include <stdatomic.h>
+
+/*
+ Per-thread slots are kept in a list that is only ever pushed onto, so the list can be walked by other threads while
+ threads are claiming slots. Slots are never freed, when a thread exits its slot is detached and will be claimed (along
+ with whatever state it holds) by the next thread that needs one.
+ */
+typedef struct CCThreadSlot {
+    /// The next slot in the list.
+    struct CCThreadSlot *next;
+    /// Whether the slot is free to be claimed by another thread.
+    _Atomic(_Bool) detached;
+} CCThreadSlot;
+
+/*!
+ * @brief A callback to initialize a newly created slot.
+ * @param Slot The slot to be initialized.
+ */
+typedef void (*CCThreadSlotInitializer)(CCThreadSlot *Slot);
+
+/*!
+ * @brief Claim a detached slot from the list, or create a new slot if there are none.
+ * @description The slot must be the first member of the structure it is part of.
+ * @param List The list of slots.
+ * @param Size The size of the structure the slot is part of.
+ * @param Initializer The callback to initialize a newly created slot before it is added to the list.
+ * @return The slot or NULL if one could not be created.
+ */
+CCThreadSlot *CCThreadSlotClaim(_Atomic(CCThreadSlot*) *List, size_t Size, CCThreadSlotInitializer Initializer);
+
+/*!
+ * @brief Detach a slot so it can be claimed by another thread.
+ * @description This should be called when the thread that owns the slot exits.
+ * @param Slot The slot to be detached.
+ */
+void CCThreadSlotDetach(CCThreadSlot *Slot);
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Trace.h"
+#include "MemoryAllocation.h"
+#include "Assertion.h"
+#include "FileSystem.h"
+#include "FileHandle.h"
+#include "Platform.h"
+#include "ThreadSlot_Private.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+_Static_assert((CC_TRACE_BUFFER_SIZE & (CC_TRACE_BUFFER_SIZE - 1)) == 0, "CC_TRACE_BUFFER_SIZE must be a power of 2");
+
+typedef struct {
+    _Atomic(const char*) name;
+    _Atomic(uint64_t) start;
+    _Atomic(uint64_t) duration;
+} CCTraceEvent;
+
+/*
+ Each thread owns a ring of spans. Only the owner writes to it so the head is advanced with a plain store, the exporter
+ discards any spans that may have been overwritten while it was reading them.
+ */
+typedef struct {
+    CCThreadSlot slot;
+    _Atomic(size_t) head;
+    size_t id;
+    CCTraceEvent events[CC_TRACE_BUFFER_SIZE];
+} CCTraceBuffer;
+
+_Atomic(_Bool) CCTraceActive = FALSE;
+
+static struct {
+    _Atomic(CCThreadSlot*) buffers;
+    _Atomic(size_t) count;
+#if CC_PLATFORM_POSIX_COMPLIANT
+    pthread_once_t once;
+    pthread_key_t key;
+#endif
+} Trace = {
+#if CC_PLATFORM_POSIX_COMPLIANT
+    .once = PTHREAD_ONCE_INIT
+#endif
+};
+
+static _Thread_local CCTraceBuffer *CurrentBuffer = NULL;
+
+#pragma mark - Control
+
+void CCTraceSetEnabled(_Bool Enabled)
+{
+    atomic_store_explicit(&CCTraceActive, Enabled, memory_order_relaxed);
+}
+
+#pragma mark - Spans
+
+#if CC_PLATFORM_POSIX_COMPLIANT
+static void CCTraceBufferDetach(CCTraceBuffer *Buffer)
+{
+    CurrentBuffer = NULL;
+    CCThreadSlotDetach(&Buffer->slot);
+}
+
+static void CCTraceSetup(void)
+{
+    if (pthread_key_create(&Trace.key, (void(*)(void*))CCTraceBufferDetach)) CCAssertLog(0, "Failed to create trace thread key");
+}
+#endif
+
+static void CCTraceBufferInit(CCTraceBuffer *Buffer)
+{
+    atomic_init(&Buffer->head, 0);
+    Buffer->id = atomic_fetch_add_explicit(&Trace.count, 1, memory_order_relaxed) + 1;
+}
+
+static CCTraceBuffer *CCTraceGetBuffer(void)
+{
+    if (CC_LIKELY(CurrentBuffer)) return CurrentBuffer;
+    
+#if CC_PLATFORM_POSIX_COMPLIANT
+    pthread_once(&Trace.once, CCTraceSetup);
+#endif
+    
+    CCTraceBuffer *Buffer = (CCTraceBuffer*)CCThreadSlotClaim(&Trace.buffers, sizeof(CCTraceBuffer), (CCThreadSlotInitializer)CCTraceBufferInit);
+    if (!Buffer) return NULL;
+    
+#if CC_PLATFORM_POSIX_COMPLIANT
+    pthread_setspecific(Trace.key, Buffer);
+#endif
+    
+    CurrentBuffer = Buffer;
+    
+    return Buffer;
+}
+
+void CCTraceSpanRecord(const CCTraceSpan *Span)
+{
+    CCAssertLog(Span, "Span must not be null");
+    
+    const uint64_t End = CCMetricsTimestamp();
+    
+    CCTraceBuffer *Buffer = CCTraceGetBuffer();
+    if (!Buffer) return;
+    
+    const size_t Head = atomic_load_explicit(&Buffer->head, memory_order_relaxed);
+    CCTraceEvent *Event = &Buffer->events[Head & (CC_TRACE_BUFFER_SIZE - 1)];
+    
+    //order the head that released this slot before its reuse, so an exporter that reads any of the new values also sees that head
+    if (Head >= CC_TRACE_BUFFER_SIZE) atomic_thread_fence(memory_order_release);
+    
+    atomic_store_explicit(&Event->name, Span->name, memory_order_relaxed);
+    atomic_store_explicit(&Event->start, Span->start, memory_order_relaxed);
+    atomic_store_explicit(&Event->duration, End - Span->start, memory_order_relaxed);
+    atomic_store_explicit(&Buffer->head, Head + 1, memory_order_release);
+}
+
+#pragma mark - Exporting
+
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t length;
+} CCTraceWriter;
+
+static CC_FORMAT_PRINTF(2, 3) void CCTraceWriterAppend(CCTraceWriter *Writer, const char *Format, ...)
+{
+    va_list Args;
+    va_start(Args, Format);
+    
+    const int Written = vsnprintf(Writer->length < Writer->size ? Writer->buffer + Writer->length : NULL, Writer->length < Writer->size ? Writer->size - Writer->length : 0, Format, Args);
+    if (Written > 0) Writer->length += (size_t)Written;
+    
+    va_end(Args);
+}
+
+static void CCTraceWriterAppendString(CCTraceWriter *Writer, const char *String)
+{
+    const char *Start = String;
+    for ( ; *String; String++)
+    {
+        if ((*String == '"') || (*String == '\\') || ((unsigned char)*String < 0x20))
+        {
+            CCTraceWriterAppend(Writer, "%.*s\\u%04x", (int)(String - Start), Start, (unsigned char)*String);
+            Start = String + 1;
+        }
+    }
+    
+    CCTraceWriterAppend(Writer, "%s", Start);
+}
+
+size_t CCTraceFormat(char *Buffer, size_t Size)
+{
+    CCAssertLog(Buffer || !Size, "Buffer must not be null if size is not 0");
+    
+    if (Size) *Buffer = 0;
+    
+#if CC_PLATFORM_POSIX_COMPLIANT
+    const unsigned long Process = (unsigned long)getpid();
+#else
+    const unsigned long Process = 1;
+#endif
+    
+    CCTraceWriter Writer = { .buffer = Buffer, .size = Size, .length = 0 };
+    CCTraceWriterAppend(&Writer, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    
+    _Bool First = TRUE;
+    for (CCThreadSlot *Slot = atomic_load_explicit(&Trace.buffers, memory_order_acquire); Slot; Slot = Slot->next)
+    {
+        CCTraceBuffer *Ring = (CCTraceBuffer*)Slot;
+        
+        const size_t Head = atomic_load_explicit(&Ring->head, memory_order_acquire);
+        const size_t Tail = Head > CC_TRACE_BUFFER_SIZE ? Head - CC_TRACE_BUFFER_SIZE : 0;
+        
+        for (size_t Loop = Tail; Loop < Head; Loop++)
+        {
+            const CCTraceEvent *Event = &Ring->events[Loop & (CC_TRACE_BUFFER_SIZE - 1)];
+            const char *Name = atomic_load_explicit(&Event->name, memory_order_relaxed);
+            const uint64_t Start = atomic_load_explicit(&Event->start, memory_order_relaxed), Duration = atomic_load_explicit(&Event->duration, memory_order_relaxed);
+            
+            atomic_thread_fence(memory_order_acquire);
+            
+            //the owning thread may have wrapped around and be overwriting this span, if any value read above is from the overwrite
+            //the fence in CCTraceSpanRecord guarantees this load sees the head that reused the slot
+            if (atomic_load_explicit(&Ring->head, memory_order_relaxed) - Loop > CC_TRACE_BUFFER_SIZE - 1) continue;
+            
+            CCTraceWriterAppend(&Writer, "%s{\"name\":\"", First ? "" : ",");
+            CCTraceWriterAppendString(&Writer, Name);
+            CCTraceWriterAppend(&Writer, "\",\"ph\":\"X\",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64 ".%03" PRIu64 ",\"pid\":%lu,\"tid\":%zu}", Start / 1000, Start % 1000, Duration / 1000, Duration % 1000, Process, Ring->id);
+            
+            First = FALSE;
+        }
+    }
+    
+    CCTraceWriterAppend(&Writer, "]}\n");
+    
+    return Writer.length;
+}
+
+_Bool CCTraceWrite(FSPath Path)
+{
+    CCAssertLog(Path, "Path must not be null");
+    
+    char *Text = NULL;
+    size_t Length = 0;
+    for (size_t Size = CCTraceFormat(NULL, 0) + 1; ; Size = Length + 1)
+    {
+        CC_SAFE_Realloc(Text, Size,
+                        CC_SAFE_Free(Text);
+                        return FALSE;
+                        );
+        
+        Length = CCTraceFormat(Text, Size);
+        if (Length < Size) break;
+    }
+    
+    if (FSManagerExists(Path)) FSManagerRemove(Path);
+    FSManagerCreate(Path, FALSE);
+    
+    _Bool Written = FALSE;
+    FSHandle Handle;
+    if (FSHandleOpen(Path, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+    {
+        Written = FSHandleWrite(Handle, Length, Text, FSBehaviourDefault) == FSOperationSuccess;
+        FSHandleClose(Handle);
+    }
+    
+    CC_SAFE_Free(Text);
+    
+    return Written;
+}
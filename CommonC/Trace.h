@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_Trace_h
+#define CommonC_Trace_h
+
+#include <CommonC/Base.h>
+#include <CommonC/Path.h>
+#include <CommonC/Metrics.h>
+#include <stdatomic.h>
+
+#ifndef CC_TRACE
+/// Set whether the framework should be instrumented with trace spans (1), or if the instrumentation should be compiled out (0).
+#define CC_TRACE 0
+#endif
+
+#ifndef CC_TRACE_BUFFER_SIZE
+/// The number of spans each thread keeps, once full the oldest spans are overwritten. Must be a power of 2.
+#define CC_TRACE_BUFFER_SIZE 4096
+#endif
+
+/*!
+ * @brief A span that has been started.
+ * @description Spans are recorded when they end, so only the start needs to be kept.
+ */
+typedef struct {
+    /// The name of the span.
+    const char *name;
+    /// The timestamp of the start of the span, or 0 if tracing was disabled.
+    uint64_t start;
+} CCTraceSpan;
+
+/*!
+ * @brief Whether tracing is enabled.
+ * @description Use @b CCTraceIsEnabled and @b CCTraceSetEnabled to access.
+ */
+extern _Atomic(_Bool) CCTraceActive;
+
+/*!
+ * @brief Record a span that was started while tracing was enabled.
+ * @description Use @b CCTraceSpanEnd to end spans.
+ */
+void CCTraceSpanRecord(const CCTraceSpan *Span);
+
+
+#pragma mark - Control
+/*!
+ * @brief Enable or disable the recording of spans.
+ * @description Tracing is disabled by default. While disabled starting a span is only the cost
+ *              of reading this flag.
+ *
+ * @param Enabled Whether spans should be recorded.
+ */
+void CCTraceSetEnabled(_Bool Enabled);
+
+/*!
+ * @brief Check whether spans are being recorded.
+ * @return TRUE if tracing is enabled, otherwise FALSE.
+ */
+static inline _Bool CCTraceIsEnabled(void);
+
+#pragma mark - Spans
+/*!
+ * @brief Start a span.
+ * @param Name The name of the span. This must remain valid for the lifetime of the program.
+ * @return The span. This must be ended by the same thread.
+ */
+static inline CCTraceSpan CCTraceSpanBegin(const char *Name);
+
+/*!
+ * @brief End a span, recording it in the current thread's buffer.
+ * @param Span The span to be ended. If it was started while tracing was disabled, nothing is
+ *        recorded.
+ */
+static inline void CCTraceSpanEnd(const CCTraceSpan *Span);
+
+#pragma mark - Exporting
+/*!
+ * @brief Format the recorded spans as Chrome trace event JSON.
+ * @description The output can be loaded by chrome://tracing or Perfetto. Each span is a complete
+ *              ("X") event, with the buffer it was recorded in as its thread ID. Spans that are
+ *              being recorded while formatting may or may not be included.
+ *
+ * @param Buffer The buffer to write the text to, this is always null terminated when the size
+ *        is not 0. May be NULL if the size is 0.
+ *
+ * @param Size The size of the buffer.
+ * @return The length of the text (excluding the null terminator), which may be larger than the
+ *         buffer if it was truncated.
+ */
+size_t CCTraceFormat(char *Buffer, size_t Size);
+
+/*!
+ * @brief Write the recorded spans to a file as Chrome trace event JSON.
+ * @param Path The path of the file. If it exists it will be replaced.
+ * @return TRUE if the file was written, otherwise FALSE.
+ */
+_Bool CCTraceWrite(FSPath Path);
+
+
+#pragma mark - Instrumentation
+/*
+ Instrument code with spans that are compiled out unless CC_TRACE is set. The name must be a string literal.
+ 
+ CC_TRACE_BEGIN and CC_TRACE_END open and close a block, the span ends when the block is left (including by returning
+ from within it). CC_TRACE_SCOPE spans the remainder of the enclosing scope.
+ 
+ e.g.
+ CC_TRACE_BEGIN("load");
+ ...
+ CC_TRACE_END();
+ */
+#if CC_TRACE
+#define CC_TRACE_SCOPE(name) const CCTraceSpan CC_TRACE_SPAN_ __attribute__((cleanup(CCTraceSpanEnd))) = CCTraceSpanBegin(name)
+#define CC_TRACE_BEGIN(name) { CC_TRACE_SCOPE(name)
+#define CC_TRACE_END() }
+#else
+#define CC_TRACE_SCOPE(name) ((void)0)
+#define CC_TRACE_BEGIN(name) {
+#define CC_TRACE_END() }
+#endif
+
+
+#pragma mark -
+static inline _Bool CCTraceIsEnabled(void)
+{
+    return atomic_load_explicit(&CCTraceActive, memory_order_relaxed);
+}
+
+static inline CCTraceSpan CCTraceSpanBegin(const char *Name)
+{
+    return (CCTraceSpan){ .name = Name, .start = CCTraceIsEnabled() ? CCMetricsTimestamp() : 0 };
+}
+
+static inline void CCTraceSpanEnd(const CCTraceSpan *Span)
+{
+    if (Span->start) CCTraceSpanRecord(Span);
+}
+
+#endif
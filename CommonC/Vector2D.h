@@ -762,7 +762,7 @@ static CC_FORCE_INLINE CCVector CCVectorize2CompareEqualUlps(const CCVector a, c
     CCVector2D Sign = CCVectorizeGetVector2D(_mm_xor_ps(a, b));
     if ((signbit(Sign.x)) && (signbit(Sign.y))) return CCVectorize2CompareEqual(a, b);
     
-    return _mm_and_ps(_mm_cmpeq_epi32(_mm_max_ps(_mm_sub_epi32(_mm_max_ps(a, b), _mm_min_ps(a, b)), MaxUlps), MaxUlps), _mm_set1_ps(1.0f));
+    return _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(_mm_sub_epi32(_mm_castps_si128(_mm_max_ps(a, b)), _mm_castps_si128(_mm_min_ps(a, b)))), MaxUlps)), _mm_castps_si128(MaxUlps))), _mm_set1_ps(1.0f));
 #else
     return CCVectorizeVector2DWithZero(CCVector2CompareEqualUlps(CCVectorizeGetVector2D(a), CCVectorizeGetVector2D(b), CCVectorizeGetVector2Di(MaxUlps)));
 #endif
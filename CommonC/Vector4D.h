@@ -550,7 +550,7 @@ static CC_FORCE_INLINE CCVector CCVectorize4CompareEqualUlps(const CCVector a, c
     CCVector4D Sign = CCVectorizeGetVector4D(_mm_xor_ps(a, b));
     if ((signbit(Sign.x)) && (signbit(Sign.y)) && (signbit(Sign.z)) && (signbit(Sign.w))) return CCVectorize4CompareEqual(a, b);
     
-    return _mm_and_ps(_mm_cmpeq_epi32(_mm_max_ps(_mm_sub_epi32(_mm_max_ps(a, b), _mm_min_ps(a, b)), MaxUlps), MaxUlps), _mm_set1_ps(1.0f));
+    return _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_castps_si128(_mm_max_ps(_mm_castsi128_ps(_mm_sub_epi32(_mm_castps_si128(_mm_max_ps(a, b)), _mm_castps_si128(_mm_min_ps(a, b)))), MaxUlps)), _mm_castps_si128(MaxUlps))), _mm_set1_ps(1.0f));
 #else
     return CCVectorizeVector4D(CCVector4CompareEqualUlps(CCVectorizeGetVector4D(a), CCVectorizeGetVector4D(b), CCVectorizeGetVector4Di(MaxUlps)));
 #endif
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/Array.h>
+
+#define ARRAY_COUNT 4096
+
+static void *ArraySetup(const void *Arg)
+{
+    CCArray Array = CCArrayCreate(CC_STD_ALLOCATOR, sizeof(size_t), 16);
+    for (size_t Loop = 0; Loop < ARRAY_COUNT; Loop++) CCArrayAppendElement(Array, &Loop);
+    
+    return Array;
+}
+
+static void ArrayTeardown(void *Array)
+{
+    CCArrayDestroy(Array);
+}
+
+static void ArrayAppend(void *Context, size_t Iterations)
+{
+    CCArray Array = CCArrayCreate(CC_STD_ALLOCATOR, sizeof(size_t), (size_t)Context);
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCArrayAppendElement(Array, &Loop);
+    
+    CCArrayDestroy(Array);
+}
+
+static void ArrayGet(CCArray Array, size_t Iterations)
+{
+    size_t Sum = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Sum += *(size_t*)CCArrayGetElementAtIndex(Array, Loop & (ARRAY_COUNT - 1));
+    
+    CCBenchmarkKeep(&Sum);
+}
+
+static void ArrayReplace(CCArray Array, size_t Iterations)
+{
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCArrayReplaceElementAtIndex(Array, Loop & (ARRAY_COUNT - 1), &Loop);
+}
+
+static void ArrayInsertRemoveFront(CCArray Array, size_t Iterations)
+{
+    for (size_t Loop = 0; Loop < Iterations; Loop++)
+    {
+        CCArrayInsertElementAtIndex(Array, 0, &Loop);
+        CCArrayRemoveElementAtIndex(Array, 0);
+    }
+}
+
+static const CCBenchmark Benchmarks[] = {
+    { .name = "CCArray/append (chunk 16)", .run = ArrayAppend, .arg = (void*)(size_t)16 },
+    { .name = "CCArray/append (chunk 4096)", .run = ArrayAppend, .arg = (void*)(size_t)4096 },
+    { .name = "CCArray/get", .run = (CCBenchmarkRun)ArrayGet, .setup = ArraySetup, .teardown = ArrayTeardown },
+    { .name = "CCArray/replace", .run = (CCBenchmarkRun)ArrayReplace, .setup = ArraySetup, .teardown = ArrayTeardown },
+    { .name = "CCArray/insert+remove front (4096 elements)", .run = (CCBenchmarkRun)ArrayInsertRemoveFront, .setup = ArraySetup, .teardown = ArrayTeardown }
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
@@ -0,0 +1,344 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "Benchmark.h"
+#include <CommonC/Metrics.h>
+#include <CommonC/Platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#define CC_BENCHMARK_PERF 1
+#endif
+
+#define CC_BENCHMARK_COUNTER_MAX 3
+
+typedef struct {
+    double ns;
+    double counters[CC_BENCHMARK_COUNTER_MAX];
+} CCBenchmarkSample;
+
+static struct {
+    const char *filter;
+    size_t warmup;
+    size_t repetitions;
+    uint64_t time;
+    size_t iterations;
+    size_t threads;
+    _Bool perf;
+} Options = {
+    .filter = NULL,
+    .warmup = 2,
+    .repetitions = 10,
+    .time = 20000000,
+    .iterations = 0,
+    .threads = 0,
+    .perf = FALSE
+};
+
+#pragma mark - Hardware Counters
+
+static const struct {
+    const char *name;
+#if CC_BENCHMARK_PERF
+    uint64_t config;
+#endif
+} Counters[CC_BENCHMARK_COUNTER_MAX] = {
+#if CC_BENCHMARK_PERF
+    { "cycles", PERF_COUNT_HW_CPU_CYCLES },
+    { "cache-misses", PERF_COUNT_HW_CACHE_MISSES },
+    { "branch-misses", PERF_COUNT_HW_BRANCH_MISSES }
+#else
+    { "cycles" },
+    { "cache-misses" },
+    { "branch-misses" }
+#endif
+};
+
+static int CounterDescriptors[CC_BENCHMARK_COUNTER_MAX] = { -1, -1, -1 };
+
+static _Bool CCBenchmarkCountersOpen(void)
+{
+#if CC_BENCHMARK_PERF
+    for (size_t Loop = 0; Loop < CC_BENCHMARK_COUNTER_MAX; Loop++)
+    {
+        struct perf_event_attr Attributes = {
+            .type = PERF_TYPE_HARDWARE,
+            .size = sizeof(struct perf_event_attr),
+            .config = Counters[Loop].config,
+            .disabled = 1,
+            .inherit = 1, //include threads created by multi-threaded benchmarks
+            .exclude_kernel = 1,
+            .exclude_hv = 1
+        };
+        
+        CounterDescriptors[Loop] = (int)syscall(__NR_perf_event_open, &Attributes, 0, -1, -1, 0);
+        if (CounterDescriptors[Loop] == -1)
+        {
+            fprintf(stderr, "Hardware counter (%s) is unavailable, continuing without counters\n", Counters[Loop].name);
+            
+            for (size_t Index = 0; Index < Loop; Index++) close(CounterDescriptors[Index]);
+            
+            return FALSE;
+        }
+    }
+    
+    return TRUE;
+#else
+    fprintf(stderr, "Hardware counters are unsupported on this platform, continuing without counters\n");
+    
+    return FALSE;
+#endif
+}
+
+static void CCBenchmarkCountersStart(void)
+{
+#if CC_BENCHMARK_PERF
+    for (size_t Loop = 0; Loop < CC_BENCHMARK_COUNTER_MAX; Loop++)
+    {
+        ioctl(CounterDescriptors[Loop], PERF_EVENT_IOC_RESET, 0);
+        ioctl(CounterDescriptors[Loop], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+static void CCBenchmarkCountersStop(double *Values)
+{
+#if CC_BENCHMARK_PERF
+    for (size_t Loop = 0; Loop < CC_BENCHMARK_COUNTER_MAX; Loop++) ioctl(CounterDescriptors[Loop], PERF_EVENT_IOC_DISABLE, 0);
+    
+    for (size_t Loop = 0; Loop < CC_BENCHMARK_COUNTER_MAX; Loop++)
+    {
+        uint64_t Value = 0;
+        Values[Loop] = read(CounterDescriptors[Loop], &Value, sizeof(Value)) == sizeof(Value) ? (double)Value : 0.0;
+    }
+#endif
+}
+
+#pragma mark - Measuring
+
+static uint64_t CCBenchmarkMeasure(const CCBenchmark *Benchmark, void *Context, size_t Iterations, CCBenchmarkSample *Sample)
+{
+    if (Options.perf) CCBenchmarkCountersStart();
+    
+    const uint64_t Start = CCMetricsTimestamp();
+    Benchmark->run(Context, Iterations);
+    const uint64_t Elapsed = CCMetricsTimestamp() - Start;
+    
+    if (Sample)
+    {
+        Sample->ns = (double)Elapsed / (double)Iterations;
+        
+        if (Options.perf)
+        {
+            CCBenchmarkCountersStop(Sample->counters);
+            for (size_t Loop = 0; Loop < CC_BENCHMARK_COUNTER_MAX; Loop++) Sample->counters[Loop] /= (double)Iterations;
+        }
+    }
+    
+    else if (Options.perf) CCBenchmarkCountersStop((double[CC_BENCHMARK_COUNTER_MAX]){ 0 });
+    
+    return Elapsed;
+}
+
+/*!
+ * @brief Find the number of iterations that takes roughly the target time.
+ */
+static size_t CCBenchmarkCalibrate(const CCBenchmark *Benchmark, void *Context)
+{
+    if (Options.iterations) return Options.iterations;
+    
+    for (size_t Iterations = 1; ; Iterations *= 2)
+    {
+        const uint64_t Elapsed = CCBenchmarkMeasure(Benchmark, Context, Iterations, NULL);
+        
+        if (Elapsed >= Options.time / 4)
+        {
+            const double Scaled = (double)Iterations * ((double)Options.time / (double)(Elapsed ? Elapsed : 1));
+            
+            return Scaled < 1.0 ? 1 : (size_t)Scaled;
+        }
+        
+        if (Iterations >= (SIZE_MAX / 4)) return Iterations;
+    }
+}
+
+static int CCBenchmarkSampleCompare(const void *a, const void *b)
+{
+    const double Left = *(const double*)a, Right = *(const double*)b;
+    
+    return (Left > Right) - (Left < Right);
+}
+
+static double CCBenchmarkPercentile(const double *Sorted, size_t Count, double Percentile)
+{
+    size_t Rank = (size_t)((Percentile * (double)Count) + 0.5);
+    
+    return Sorted[Rank ? (Rank > Count ? Count : Rank) - 1 : 0];
+}
+
+static void CCBenchmarkExecute(const CCBenchmark *Benchmark, CCBenchmarkSample *Samples)
+{
+    void *Context = Benchmark->setup ? Benchmark->setup(Benchmark->arg) : (void*)Benchmark->arg;
+    
+    const size_t Iterations = CCBenchmarkCalibrate(Benchmark, Context);
+    
+    for (size_t Loop = 0; Loop < Options.warmup; Loop++) CCBenchmarkMeasure(Benchmark, Context, Iterations, NULL);
+    for (size_t Loop = 0; Loop < Options.repetitions; Loop++) CCBenchmarkMeasure(Benchmark, Context, Iterations, &Samples[Loop]);
+    
+    if (Benchmark->teardown) Benchmark->teardown(Context);
+    
+    double Values[Options.repetitions];
+    for (size_t Loop = 0; Loop < Options.repetitions; Loop++) Values[Loop] = Samples[Loop].ns;
+    
+    qsort(Values, Options.repetitions, sizeof(double), CCBenchmarkSampleCompare);
+    
+    double Mean = 0.0;
+    for (size_t Loop = 0; Loop < Options.repetitions; Loop++) Mean += Values[Loop];
+    Mean /= (double)Options.repetitions;
+    
+    printf("%-56s %12zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f", Benchmark->name, Iterations, Mean, Values[0], CCBenchmarkPercentile(Values, Options.repetitions, 0.5), CCBenchmarkPercentile(Values, Options.repetitions, 0.9), CCBenchmarkPercentile(Values, Options.repetitions, 0.99), Values[Options.repetitions - 1]);
+    
+    if (Options.perf)
+    {
+        for (size_t Counter = 0; Counter < CC_BENCHMARK_COUNTER_MAX; Counter++)
+        {
+            double Total = 0.0;
+            for (size_t Loop = 0; Loop < Options.repetitions; Loop++) Total += Samples[Loop].counters[Counter];
+            
+            printf(" %14.2f", Total / (double)Options.repetitions);
+        }
+    }
+    
+    printf("\n");
+    fflush(stdout);
+}
+
+#pragma mark - Running
+
+size_t CCBenchmarkGetThreadCount(void)
+{
+    if (Options.threads) return Options.threads;
+    
+    const long CPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    return CPUs > 0 ? (size_t)CPUs : 1;
+}
+
+typedef struct {
+    void (*function)(void *Context, size_t Index);
+    void *context;
+    size_t index;
+} CCBenchmarkThread;
+
+static void *CCBenchmarkThreadEntry(CCBenchmarkThread *Thread)
+{
+    Thread->function(Thread->context, Thread->index);
+    
+    return NULL;
+}
+
+void CCBenchmarkRunThreads(size_t Threads, void (*Function)(void *Context, size_t Index), void *Context)
+{
+    pthread_t Handles[Threads];
+    CCBenchmarkThread Entries[Threads];
+    
+    for (size_t Loop = 1; Loop < Threads; Loop++)
+    {
+        Entries[Loop] = (CCBenchmarkThread){ .function = Function, .context = Context, .index = Loop };
+        pthread_create(&Handles[Loop], NULL, (void*(*)(void*))CCBenchmarkThreadEntry, &Entries[Loop]);
+    }
+    
+    Function(Context, 0);
+    
+    for (size_t Loop = 1; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+}
+
+static size_t CCBenchmarkParseCount(const char *Option, const char *Value)
+{
+    char *End;
+    const unsigned long long Count = strtoull(Value, &End, 10);
+    
+    if ((End == Value) || (*End))
+    {
+        fprintf(stderr, "Invalid value for %s: %s\n", Option, Value);
+        exit(EXIT_FAILURE);
+    }
+    
+    return (size_t)Count;
+}
+
+int CCBenchmarkMain(int argc, char *argv[], const CCBenchmark *Benchmarks, size_t Count)
+{
+    for (int Loop = 1; Loop < argc; Loop++)
+    {
+        const char *Arg = argv[Loop];
+        
+        if (!strncmp(Arg, "--filter=", 9)) Options.filter = Arg + 9;
+        else if (!strncmp(Arg, "--warmup=", 9)) Options.warmup = CCBenchmarkParseCount("--warmup", Arg + 9);
+        else if (!strncmp(Arg, "--repetitions=", 14)) Options.repetitions = CCBenchmarkParseCount("--repetitions", Arg + 14);
+        else if (!strncmp(Arg, "--time=", 7)) Options.time = CCBenchmarkParseCount("--time", Arg + 7) * 1000000;
+        else if (!strncmp(Arg, "--iterations=", 13)) Options.iterations = CCBenchmarkParseCount("--iterations", Arg + 13);
+        else if (!strncmp(Arg, "--threads=", 10)) Options.threads = CCBenchmarkParseCount("--threads", Arg + 10);
+        else if (!strcmp(Arg, "--perf")) Options.perf = TRUE;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--filter=<text>] [--warmup=<count>] [--repetitions=<count>] [--time=<ms>] [--iterations=<count>] [--threads=<count>] [--perf]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    if (!Options.repetitions) Options.repetitions = 1;
+    if (Options.perf) Options.perf = CCBenchmarkCountersOpen();
+    
+    printf("%-56s %12s %10s %10s %10s %10s %10s %10s", "benchmark (ns/op)", "iterations", "mean", "min", "p50", "p90", "p99", "max");
+    if (Options.perf)
+    {
+        for (size_t Loop = 0; Loop < CC_BENCHMARK_COUNTER_MAX; Loop++) printf(" %14s", Counters[Loop].name);
+    }
+    printf("\n");
+    
+    CCBenchmarkSample *Samples = calloc(Options.repetitions, sizeof(CCBenchmarkSample));
+    if (!Samples) return EXIT_FAILURE;
+    
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        if ((!Options.filter) || (strstr(Benchmarks[Loop].name, Options.filter))) CCBenchmarkExecute(&Benchmarks[Loop], Samples);
+    }
+    
+    free(Samples);
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_Benchmark_h
+#define CommonC_Benchmark_h
+
+#include <CommonC/Base.h>
+
+/*!
+ * @brief Create the state used by a benchmark.
+ * @param Arg The argument of the benchmark.
+ * @return The context to be passed to the run and teardown callbacks.
+ */
+typedef void *(*CCBenchmarkSetup)(const void *Arg);
+
+/*!
+ * @brief Run a benchmark.
+ * @param Context The context created by the setup callback (or the argument if there is none).
+ * @param Iterations The number of operations to perform.
+ */
+typedef void (*CCBenchmarkRun)(void *Context, size_t Iterations);
+
+/*!
+ * @brief Destroy the state used by a benchmark.
+ * @param Context The context created by the setup callback.
+ */
+typedef void (*CCBenchmarkTeardown)(void *Context);
+
+/*!
+ * @brief A benchmark.
+ * @description The benchmark is set up once, and then run in repetitions of a calibrated number
+ *              of iterations. The time (and optionally hardware counters) of each repetition is
+ *              divided by the iterations to get the cost per operation.
+ */
+typedef struct {
+    /// The name of the benchmark.
+    const char *name;
+    /// The callback to run the benchmark.
+    CCBenchmarkRun run;
+    /// The optional callback to setup the benchmark.
+    CCBenchmarkSetup setup;
+    /// The optional callback to teardown the benchmark.
+    CCBenchmarkTeardown teardown;
+    /// The argument passed to the setup callback.
+    const void *arg;
+} CCBenchmark;
+
+
+/*!
+ * @brief Run the benchmarks according to the command line options.
+ * @description The options are:
+ *
+ *              --filter=<text>: Only run benchmarks whose name contains the text.
+ *              --warmup=<count>: The number of repetitions to discard (default 2).
+ *              --repetitions=<count>: The number of repetitions to measure (default 10).
+ *              --time=<ms>: The target duration of a repetition (default 20).
+ *              --iterations=<count>: Use a fixed number of iterations instead of calibrating.
+ *              --threads=<count>: The maximum number of threads multi-threaded benchmarks use.
+ *              --perf: Measure cycles, cache misses and branch misses (Linux only).
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param Benchmarks The benchmarks.
+ * @param Count The number of benchmarks.
+ * @return The exit status.
+ */
+int CCBenchmarkMain(int argc, char *argv[], const CCBenchmark *Benchmarks, size_t Count);
+
+/*!
+ * @brief Get the maximum number of threads multi-threaded benchmarks should use.
+ * @return The value of --threads, or the number of CPUs.
+ */
+size_t CCBenchmarkGetThreadCount(void);
+
+/*!
+ * @brief Prevent the compiler from optimising away the computation of a value.
+ * @param Value A pointer to the value.
+ */
+static inline void CCBenchmarkKeep(const void *Value);
+
+/*!
+ * @brief Run a function on a number of threads, waiting for them to finish.
+ * @param Threads The number of threads.
+ * @param Function The function each thread runs, it is passed the context and the index of the thread.
+ * @param Context The context to pass to the function.
+ */
+void CCBenchmarkRunThreads(size_t Threads, void (*Function)(void *Context, size_t Index), void *Context);
+
+
+#pragma mark -
+static inline void CCBenchmarkKeep(const void *Value)
+{
+    __asm__ volatile("" : : "r"(Value) : "memory");
+}
+
+#endif
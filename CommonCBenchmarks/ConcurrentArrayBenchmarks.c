@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/ConcurrentArray.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+
+#define ARRAY_REPLACE_COUNT 1024
+
+typedef struct {
+    const CCConcurrentGarbageCollectorInterface * const *gc;
+    size_t threads;
+} ArrayArg;
+
+typedef struct {
+    CCConcurrentArray array;
+    size_t threads;
+    size_t iterations;
+} ArrayContext;
+
+static void *ArraySetup(const ArrayArg *Arg)
+{
+    ArrayContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(ArrayContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    Context->array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(size_t), 64, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Arg->gc));
+    Context->threads = Arg->threads ? Arg->threads : CCBenchmarkGetThreadCount();
+    
+    for (size_t Loop = 0; Loop < ARRAY_REPLACE_COUNT; Loop++) CCConcurrentArrayAppendElement(Context->array, &Loop);
+    
+    return Context;
+}
+
+static void ArrayTeardown(ArrayContext *Context)
+{
+    CCConcurrentArrayDestroy(Context->array);
+    CCFree(Context);
+}
+
+static void ArrayAppendThread(ArrayContext *Context, size_t Index)
+{
+    const size_t Iterations = (Context->iterations / Context->threads) + (Index < (Context->iterations % Context->threads));
+    
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCConcurrentArrayAppendElement(Context->array, &Loop);
+}
+
+static void ArrayAppend(ArrayContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))ArrayAppendThread, Context);
+}
+
+static void ArrayReplaceThread(ArrayContext *Context, size_t Index)
+{
+    const size_t Iterations = (Context->iterations / Context->threads) + (Index < (Context->iterations % Context->threads));
+    
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCConcurrentArrayReplaceElementAtIndex(Context->array, (Loop * 7) % ARRAY_REPLACE_COUNT, &Loop, NULL);
+}
+
+static void ArrayReplace(ArrayContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))ArrayReplaceThread, Context);
+}
+
+static void ArrayGetThread(ArrayContext *Context, size_t Index)
+{
+    const size_t Iterations = (Context->iterations / Context->threads) + (Index < (Context->iterations % Context->threads));
+    
+    for (size_t Loop = 0; Loop < Iterations; Loop++)
+    {
+        size_t Value;
+        CCConcurrentArrayGetElementAtIndex(Context->array, (Loop * 7) % ARRAY_REPLACE_COUNT, &Value);
+        CCBenchmarkKeep(&Value);
+    }
+}
+
+static void ArrayGet(ArrayContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))ArrayGetThread, Context);
+}
+
+#define ARRAY_ARG(collector, count) &(const ArrayArg){ .gc = &collector, .threads = count }
+
+#define ARRAY_BENCHMARKS(collector, label, count) \
+{ .name = "CCConcurrentArray/" label "/append/threads:" #count, .run = (CCBenchmarkRun)ArrayAppend, .setup = (CCBenchmarkSetup)ArraySetup, .teardown = (CCBenchmarkTeardown)ArrayTeardown, .arg = ARRAY_ARG(collector, count) }, \
+{ .name = "CCConcurrentArray/" label "/replace/threads:" #count, .run = (CCBenchmarkRun)ArrayReplace, .setup = (CCBenchmarkSetup)ArraySetup, .teardown = (CCBenchmarkTeardown)ArrayTeardown, .arg = ARRAY_ARG(collector, count) }, \
+{ .name = "CCConcurrentArray/" label "/get/threads:" #count, .run = (CCBenchmarkRun)ArrayGet, .setup = (CCBenchmarkSetup)ArraySetup, .teardown = (CCBenchmarkTeardown)ArrayTeardown, .arg = ARRAY_ARG(collector, count) }
+
+//threads:0 uses the --threads option or the number of CPUs
+static const CCBenchmark Benchmarks[] = {
+    ARRAY_BENCHMARKS(CCEpochGarbageCollector, "epoch", 1),
+    ARRAY_BENCHMARKS(CCEpochGarbageCollector, "epoch", 2),
+    ARRAY_BENCHMARKS(CCEpochGarbageCollector, "epoch", 4),
+    ARRAY_BENCHMARKS(CCEpochGarbageCollector, "epoch", 0),
+    ARRAY_BENCHMARKS(CCLazyGarbageCollector, "lazy", 1),
+    ARRAY_BENCHMARKS(CCLazyGarbageCollector, "lazy", 2),
+    ARRAY_BENCHMARKS(CCLazyGarbageCollector, "lazy", 4),
+    ARRAY_BENCHMARKS(CCLazyGarbageCollector, "lazy", 0)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
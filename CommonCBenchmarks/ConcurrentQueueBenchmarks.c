@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/ConcurrentQueue.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+
+typedef struct {
+    const CCConcurrentGarbageCollectorInterface * const *gc;
+    size_t threads;
+} QueueArg;
+
+typedef struct {
+    CCConcurrentQueue queue;
+    size_t threads;
+    size_t iterations;
+} QueueContext;
+
+static void *QueueSetup(const QueueArg *Arg)
+{
+    QueueContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(QueueContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    Context->queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Arg->gc));
+    Context->threads = Arg->threads ? Arg->threads : CCBenchmarkGetThreadCount();
+    
+    return Context;
+}
+
+static void QueueTeardown(QueueContext *Context)
+{
+    for (CCConcurrentQueueNode *Node; (Node = CCConcurrentQueuePop(Context->queue)); ) CCConcurrentQueueDestroyNode(Node);
+    
+    CCConcurrentQueueDestroy(Context->queue);
+    CCFree(Context);
+}
+
+static void QueuePushPopThread(QueueContext *Context, size_t Index)
+{
+    const size_t Iterations = (Context->iterations / Context->threads) + (Index < (Context->iterations % Context->threads));
+    
+    for (size_t Loop = 0; Loop < Iterations; Loop++)
+    {
+        CCConcurrentQueuePush(Context->queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(size_t), &Loop));
+        
+        CCConcurrentQueueNode *Node = CCConcurrentQueuePop(Context->queue);
+        if (Node) CCConcurrentQueueDestroyNode(Node);
+    }
+}
+
+static void QueuePushPop(QueueContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))QueuePushPopThread, Context);
+}
+
+static void QueueBurstThread(QueueContext *Context, size_t Index)
+{
+    const size_t Iterations = (Context->iterations / Context->threads) + (Index < (Context->iterations % Context->threads));
+    
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCConcurrentQueuePush(Context->queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(size_t), &Loop));
+    
+    for (size_t Loop = 0; Loop < Iterations; Loop++)
+    {
+        CCConcurrentQueueNode *Node = CCConcurrentQueuePop(Context->queue);
+        if (Node) CCConcurrentQueueDestroyNode(Node);
+    }
+}
+
+static void QueueBurst(QueueContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))QueueBurstThread, Context);
+}
+
+#define QUEUE_ARG(collector, count) &(const QueueArg){ .gc = &collector, .threads = count }
+
+#define QUEUE_BENCHMARKS(collector, label, count) \
+{ .name = "CCConcurrentQueue/" label "/push+pop/threads:" #count, .run = (CCBenchmarkRun)QueuePushPop, .setup = (CCBenchmarkSetup)QueueSetup, .teardown = (CCBenchmarkTeardown)QueueTeardown, .arg = QUEUE_ARG(collector, count) }, \
+{ .name = "CCConcurrentQueue/" label "/push all, pop all/threads:" #count, .run = (CCBenchmarkRun)QueueBurst, .setup = (CCBenchmarkSetup)QueueSetup, .teardown = (CCBenchmarkTeardown)QueueTeardown, .arg = QUEUE_ARG(collector, count) }
+
+//threads:0 uses the --threads option or the number of CPUs
+static const CCBenchmark Benchmarks[] = {
+    QUEUE_BENCHMARKS(CCEpochGarbageCollector, "epoch", 1),
+    QUEUE_BENCHMARKS(CCEpochGarbageCollector, "epoch", 2),
+    QUEUE_BENCHMARKS(CCEpochGarbageCollector, "epoch", 4),
+    QUEUE_BENCHMARKS(CCEpochGarbageCollector, "epoch", 0),
+    QUEUE_BENCHMARKS(CCLazyGarbageCollector, "lazy", 1),
+    QUEUE_BENCHMARKS(CCLazyGarbageCollector, "lazy", 2),
+    QUEUE_BENCHMARKS(CCLazyGarbageCollector, "lazy", 4),
+    QUEUE_BENCHMARKS(CCLazyGarbageCollector, "lazy", 0)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/FileIOQueue.h>
+#include <CommonC/FileHandle.h>
+#include <CommonC/FileSystem.h>
+#include <CommonC/MemoryAllocation.h>
+
+#define FILE_SIZE (64 * 1024 * 1024)
+#define BLOCK_SIZE 4096
+
+typedef struct {
+    FSPath path;
+    FSHandle handle;
+    FSIOQueue queue;
+    FSIORequest *requests;
+    uint8_t *buffers;
+    size_t depth;
+} QueueDepthContext;
+
+static void *QueueDepthSetup(const size_t *Depth)
+{
+    QueueDepthContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(QueueDepthContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    //The file is created in the current (build) directory, as the temporary directory is often not backed by a disk
+    Context->path = FSPathCopy(FSPathCurrent());
+    FSPathAppendComponent(Context->path, FSPathComponentCreate(FSPathComponentTypeFile, "commonc-io-benchmark"));
+    FSPathAppendComponent(Context->path, FSPathComponentCreate(FSPathComponentTypeExtension, "bin"));
+    
+    FSManagerCreate(Context->path, FALSE);
+    
+    FSHandle Handle;
+    if (FSHandleOpen(Context->path, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+    {
+        uint8_t *Values = CCMalloc(CC_STD_ALLOCATOR, FILE_SIZE, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        for (size_t Loop = 0; Loop < FILE_SIZE; Loop++) Values[Loop] = (uint8_t)(Loop % 251);
+        
+        FSHandleWrite(Handle, FILE_SIZE, Values, FSBehaviourDefault);
+        FSHandleSync(Handle);
+        FSHandleClose(Handle);
+        CCFree(Values);
+    }
+    
+    FSHandleOpen(Context->path, FSHandleTypeRead | FSHandleTypeDirect, &Context->handle);
+    
+    Context->depth = *Depth;
+    Context->queue = FSIOQueueCreate(CC_STD_ALLOCATOR, Context->depth, 0);
+    Context->requests = CCMalloc(CC_STD_ALLOCATOR, sizeof(FSIORequest) * Context->depth, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    Context->buffers = CCMalloc(CC_ALIGNED_ALLOCATOR(BLOCK_SIZE), Context->depth * BLOCK_SIZE, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    return Context;
+}
+
+static void QueueDepthTeardown(QueueDepthContext *Context)
+{
+    FSIOQueueDestroy(Context->queue);
+    FSHandleClose(Context->handle);
+    
+    FSManagerRemove(Context->path);
+    FSPathDestroy(Context->path);
+    
+    CCFree(Context->requests);
+    CCFree(Context->buffers);
+    CCFree(Context);
+}
+
+static void QueueDepthRead(QueueDepthContext *Context, size_t Iterations)
+{
+    const size_t Blocks = FILE_SIZE / BLOCK_SIZE, Depth = Context->depth;
+    size_t Next = 0, Slot = 0;
+    
+    //Keep the queue full by resubmitting each slot as it finishes, reading blocks in a scattered order
+    while ((Next < Iterations) || (FSIOQueueGetPendingCount(Context->queue)))
+    {
+        for ( ; (Next < Iterations) && (FSIOQueueGetPendingCount(Context->queue) < Depth); Next++, Slot = (Slot + 1) % Depth)
+        {
+            while ((Next >= Depth) && (!FSIORequestIsFinished(&Context->requests[Slot]))) FSIOQueuePoll(Context->queue, 1);
+            
+            Context->requests[Slot] = (FSIORequest){
+                .type = FSIORequestTypeRead,
+                .handle = Context->handle,
+                .offset = ((Next * 7919) % Blocks) * BLOCK_SIZE,
+                .size = BLOCK_SIZE,
+                .buffer = Context->buffers + (Slot * BLOCK_SIZE)
+            };
+            
+            FSIOQueueSubmit(Context->queue, (FSIORequest*[1]){ &Context->requests[Slot] }, 1);
+        }
+        
+        FSIOQueuePoll(Context->queue, 1);
+    }
+}
+
+#define QUEUE_DEPTH_BENCHMARK(depth) { .name = "FSIOQueue/random 4KB direct read/depth:" #depth, .run = (CCBenchmarkRun)QueueDepthRead, .setup = (CCBenchmarkSetup)QueueDepthSetup, .teardown = (CCBenchmarkTeardown)QueueDepthTeardown, .arg = &(const size_t){ depth } }
+
+//IOPS are 1e9 / (ns/op)
+static const CCBenchmark Benchmarks[] = {
+    QUEUE_DEPTH_BENCHMARK(1),
+    QUEUE_DEPTH_BENCHMARK(2),
+    QUEUE_DEPTH_BENCHMARK(4),
+    QUEUE_DEPTH_BENCHMARK(8),
+    QUEUE_DEPTH_BENCHMARK(16),
+    QUEUE_DEPTH_BENCHMARK(32),
+    QUEUE_DEPTH_BENCHMARK(64),
+    QUEUE_DEPTH_BENCHMARK(128)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
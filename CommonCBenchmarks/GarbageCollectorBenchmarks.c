@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/ConcurrentGarbageCollector.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+
+typedef struct {
+    const CCConcurrentGarbageCollectorInterface * const *gc;
+    size_t threads;
+} GCArg;
+
+typedef struct {
+    CCConcurrentGarbageCollector gc;
+    size_t threads;
+    size_t iterations;
+} GCContext;
+
+static void *GCSetup(const GCArg *Arg)
+{
+    GCContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(GCContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    Context->gc = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Arg->gc);
+    Context->threads = Arg->threads ? Arg->threads : CCBenchmarkGetThreadCount();
+    
+    return Context;
+}
+
+static void GCTeardown(GCContext *Context)
+{
+    CCConcurrentGarbageCollectorDestroy(Context->gc);
+    CCFree(Context);
+}
+
+static size_t GCThreadIterations(GCContext *Context, size_t Index)
+{
+    return (Context->iterations / Context->threads) + (Index < (Context->iterations % Context->threads));
+}
+
+static void GCSectionThread(GCContext *Context, size_t Index)
+{
+    for (size_t Loop = 0, Iterations = GCThreadIterations(Context, Index); Loop < Iterations; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(Context->gc);
+        CCConcurrentGarbageCollectorEnd(Context->gc);
+    }
+}
+
+static void GCManageThread(GCContext *Context, size_t Index)
+{
+    for (size_t Loop = 0, Iterations = GCThreadIterations(Context, Index); Loop < Iterations; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(Context->gc);
+        CCConcurrentGarbageCollectorManage(Context->gc, CCMalloc(CC_STD_ALLOCATOR, 16, NULL, CC_DEFAULT_ERROR_CALLBACK), CCFree);
+        CCConcurrentGarbageCollectorEnd(Context->gc);
+    }
+}
+
+static void GCSection(GCContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))GCSectionThread, Context);
+}
+
+static void GCManage(GCContext *Context, size_t Iterations)
+{
+    Context->iterations = Iterations;
+    CCBenchmarkRunThreads(Context->threads, (void(*)(void*, size_t))GCManageThread, Context);
+}
+
+#define GC_ARG(collector, count) &(const GCArg){ .gc = &collector, .threads = count }
+
+#define GC_BENCHMARKS(collector, label, count) \
+{ .name = label "/begin+end/threads:" #count, .run = (CCBenchmarkRun)GCSection, .setup = (CCBenchmarkSetup)GCSetup, .teardown = (CCBenchmarkTeardown)GCTeardown, .arg = GC_ARG(collector, count) }, \
+{ .name = label "/begin+manage+end/threads:" #count, .run = (CCBenchmarkRun)GCManage, .setup = (CCBenchmarkSetup)GCSetup, .teardown = (CCBenchmarkTeardown)GCTeardown, .arg = GC_ARG(collector, count) }
+
+//threads:0 uses the --threads option or the number of CPUs
+static const CCBenchmark Benchmarks[] = {
+    GC_BENCHMARKS(CCEpochGarbageCollector, "CCEpochGarbageCollector", 1),
+    GC_BENCHMARKS(CCEpochGarbageCollector, "CCEpochGarbageCollector", 2),
+    GC_BENCHMARKS(CCEpochGarbageCollector, "CCEpochGarbageCollector", 4),
+    GC_BENCHMARKS(CCEpochGarbageCollector, "CCEpochGarbageCollector", 0),
+    GC_BENCHMARKS(CCLazyGarbageCollector, "CCLazyGarbageCollector", 1),
+    GC_BENCHMARKS(CCLazyGarbageCollector, "CCLazyGarbageCollector", 2),
+    GC_BENCHMARKS(CCLazyGarbageCollector, "CCLazyGarbageCollector", 4),
+    GC_BENCHMARKS(CCLazyGarbageCollector, "CCLazyGarbageCollector", 0)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
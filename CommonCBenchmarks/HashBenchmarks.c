@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/Hash.h>
+#include <CommonC/DataBuffer.h>
+#include <CommonC/MemoryAllocation.h>
+
+typedef struct {
+    CCData data;
+    void *buffer;
+    size_t size;
+} HashContext;
+
+static void *HashSetup(const void *Arg)
+{
+    const size_t Size = (size_t)Arg;
+    
+    HashContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(HashContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    Context->size = Size;
+    Context->buffer = CCMalloc(CC_STD_ALLOCATOR, Size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    for (size_t Loop = 0; Loop < Size; Loop++) ((uint8_t*)Context->buffer)[Loop] = (uint8_t)(Loop * 31);
+    
+    Context->data = CCDataBufferCreate(CC_STD_ALLOCATOR, CCDataHintRead, Size, Context->buffer, NULL, NULL);
+    
+    return Context;
+}
+
+static void HashTeardown(HashContext *Context)
+{
+    CCDataDestroy(Context->data);
+    CCFree(Context->buffer);
+    CCFree(Context);
+}
+
+static void HashJenkins32(HashContext *Context, size_t Iterations)
+{
+    uint32_t Hash = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Hash ^= CCHashJenkins32(Context->data);
+    
+    CCBenchmarkKeep(&Hash);
+}
+
+static void HashMurmur32(HashContext *Context, size_t Iterations)
+{
+    uint32_t Hash = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Hash ^= CCHashMurmur32(Context->data);
+    
+    CCBenchmarkKeep(&Hash);
+}
+
+static void HashMurmur32Buffer(HashContext *Context, size_t Iterations)
+{
+    uint32_t Hash = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Hash ^= CCHashMurmur32Buffer(Context->buffer, Context->size, (uint32_t)Loop);
+    
+    CCBenchmarkKeep(&Hash);
+}
+
+#define HASH_BENCHMARKS(function, size) { .name = "CC" #function "/" #size " bytes", .run = (CCBenchmarkRun)function, .setup = HashSetup, .teardown = (CCBenchmarkTeardown)HashTeardown, .arg = (void*)(size_t)size }
+
+static const CCBenchmark Benchmarks[] = {
+    HASH_BENCHMARKS(HashJenkins32, 16),
+    HASH_BENCHMARKS(HashJenkins32, 256),
+    HASH_BENCHMARKS(HashJenkins32, 4096),
+    HASH_BENCHMARKS(HashMurmur32, 16),
+    HASH_BENCHMARKS(HashMurmur32, 256),
+    HASH_BENCHMARKS(HashMurmur32, 4096),
+    HASH_BENCHMARKS(HashMurmur32Buffer, 16),
+    HASH_BENCHMARKS(HashMurmur32Buffer, 256),
+    HASH_BENCHMARKS(HashMurmur32Buffer, 4096)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
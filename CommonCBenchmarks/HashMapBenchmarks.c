@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/MemoryAllocation.h>
+#include <CommonC/HashMap.h>
+#include <CommonC/HashMapSeparateChainingArray.h>
+#include <CommonC/HashMapSeparateChainingArrayDataOrientedHash.h>
+#include <CommonC/HashMapSeparateChainingArrayDataOrientedAll.h>
+
+#define HASH_MAP_COUNT 4096
+#define HASH_MAP_BUCKETS 1024
+
+typedef struct {
+    const CCHashMapInterface * const *interface;
+    CCHashMap map;
+} HashMapContext;
+
+static void *HashMapSetup(const void *Arg)
+{
+    HashMapContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(HashMapContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    Context->interface = Arg;
+    Context->map = CCHashMapCreate(CC_STD_ALLOCATOR, sizeof(uintmax_t), sizeof(uintmax_t), HASH_MAP_BUCKETS, NULL, NULL, *Context->interface);
+    
+    for (uintmax_t Loop = 0; Loop < HASH_MAP_COUNT; Loop++) CCHashMapSetValue(Context->map, &Loop, &Loop);
+    
+    return Context;
+}
+
+static void HashMapTeardown(HashMapContext *Context)
+{
+    CCHashMapDestroy(Context->map);
+    CCFree(Context);
+}
+
+static void HashMapInsert(HashMapContext *Context, size_t Iterations)
+{
+    CCHashMap Map = CCHashMapCreate(CC_STD_ALLOCATOR, sizeof(uintmax_t), sizeof(uintmax_t), HASH_MAP_BUCKETS, NULL, NULL, *Context->interface);
+    for (uintmax_t Loop = 0; Loop < Iterations; Loop++) CCHashMapSetValue(Map, &Loop, &Loop);
+    
+    CCHashMapDestroy(Map);
+}
+
+static void HashMapGet(HashMapContext *Context, size_t Iterations)
+{
+    uintmax_t Sum = 0;
+    for (uintmax_t Loop = 0; Loop < Iterations; Loop++) Sum += *(uintmax_t*)CCHashMapGetValue(Context->map, &(uintmax_t){ Loop & (HASH_MAP_COUNT - 1) });
+    
+    CCBenchmarkKeep(&Sum);
+}
+
+static void HashMapMiss(HashMapContext *Context, size_t Iterations)
+{
+    size_t Found = 0;
+    for (uintmax_t Loop = 0; Loop < Iterations; Loop++) Found += CCHashMapGetValue(Context->map, &(uintmax_t){ HASH_MAP_COUNT + Loop }) != NULL;
+    
+    CCBenchmarkKeep(&Found);
+}
+
+static void HashMapRemoveSet(HashMapContext *Context, size_t Iterations)
+{
+    for (uintmax_t Loop = 0; Loop < Iterations; Loop++)
+    {
+        const uintmax_t Key = Loop & (HASH_MAP_COUNT - 1);
+        CCHashMapRemoveValue(Context->map, &Key);
+        CCHashMapSetValue(Context->map, &Key, &Loop);
+    }
+}
+
+#define HASH_MAP_BENCHMARKS(interface) \
+{ .name = #interface "/insert", .run = (CCBenchmarkRun)HashMapInsert, .setup = HashMapSetup, .teardown = (CCBenchmarkTeardown)HashMapTeardown, .arg = &interface }, \
+{ .name = #interface "/get (hit)", .run = (CCBenchmarkRun)HashMapGet, .setup = HashMapSetup, .teardown = (CCBenchmarkTeardown)HashMapTeardown, .arg = &interface }, \
+{ .name = #interface "/get (miss)", .run = (CCBenchmarkRun)HashMapMiss, .setup = HashMapSetup, .teardown = (CCBenchmarkTeardown)HashMapTeardown, .arg = &interface }, \
+{ .name = #interface "/remove+set", .run = (CCBenchmarkRun)HashMapRemoveSet, .setup = HashMapSetup, .teardown = (CCBenchmarkTeardown)HashMapTeardown, .arg = &interface }
+
+static const CCBenchmark Benchmarks[] = {
+    HASH_MAP_BENCHMARKS(CCHashMapSeparateChainingArray),
+    HASH_MAP_BENCHMARKS(CCHashMapSeparateChainingArrayDataOrientedHash),
+    HASH_MAP_BENCHMARKS(CCHashMapSeparateChainingArrayDataOrientedAll)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/CCString.h>
+#include <CommonC/CCStringEnumerator.h>
+
+#define STRING_SMALL "hello"
+#define STRING_LARGE "The quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog."
+
+typedef struct {
+    CCString string;
+    CCString copy;
+    CCString substring;
+} StringContext;
+
+static StringContext StringFixture;
+
+static void *StringSetup(const void *Arg)
+{
+    StringFixture = (StringContext){
+        .string = CCStringCreate(CC_STD_ALLOCATOR, (CCStringHint)CCStringEncodingUTF8 | CCStringHintCopy, Arg),
+        .copy = CCStringCreate(CC_STD_ALLOCATOR, (CCStringHint)CCStringEncodingUTF8 | CCStringHintCopy, Arg),
+        .substring = CCStringCreate(CC_STD_ALLOCATOR, (CCStringHint)CCStringEncodingUTF8, "lazy")
+    };
+    
+    return &StringFixture;
+}
+
+static void StringTeardown(StringContext *Context)
+{
+    CCStringDestroy(Context->string);
+    CCStringDestroy(Context->copy);
+    CCStringDestroy(Context->substring);
+}
+
+static void StringCreate(void *Context, size_t Iterations)
+{
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCStringDestroy(CCStringCreate(CC_STD_ALLOCATOR, (CCStringHint)CCStringEncodingUTF8 | CCStringHintCopy, Context));
+}
+
+static void StringEqual(StringContext *Context, size_t Iterations)
+{
+    size_t Equal = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Equal += CCStringEqual(Context->string, Context->copy);
+    
+    CCBenchmarkKeep(&Equal);
+}
+
+static void StringHash(StringContext *Context, size_t Iterations)
+{
+    uint32_t Hash = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Hash ^= CCStringGetHash(Context->string);
+    
+    CCBenchmarkKeep(&Hash);
+}
+
+static void StringFind(StringContext *Context, size_t Iterations)
+{
+    size_t Index = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++) Index ^= CCStringFindSubstring(Context->string, 0, Context->substring);
+    
+    CCBenchmarkKeep(&Index);
+}
+
+static void StringCopySubstring(StringContext *Context, size_t Iterations)
+{
+    for (size_t Loop = 0; Loop < Iterations; Loop++) CCStringDestroy(CCStringCopySubstring(Context->string, 4, 15));
+}
+
+static void StringEnumerate(StringContext *Context, size_t Iterations)
+{
+    CCChar Sum = 0;
+    for (size_t Loop = 0; Loop < Iterations; Loop++)
+    {
+        CCEnumerator Enumerator;
+        CCStringGetEnumerator(Context->string, &Enumerator);
+        
+        for (CCChar Character = CCStringEnumeratorGetCurrent(&Enumerator); Character; Character = CCStringEnumeratorNext(&Enumerator)) Sum += Character;
+    }
+    
+    CCBenchmarkKeep(&Sum);
+}
+
+static const CCBenchmark Benchmarks[] = {
+    { .name = "CCString/create (small)", .run = StringCreate, .arg = STRING_SMALL },
+    { .name = "CCString/create (large)", .run = StringCreate, .arg = STRING_LARGE },
+    { .name = "CCString/equal (small)", .run = (CCBenchmarkRun)StringEqual, .setup = StringSetup, .teardown = (CCBenchmarkTeardown)StringTeardown, .arg = STRING_SMALL },
+    { .name = "CCString/equal (large)", .run = (CCBenchmarkRun)StringEqual, .setup = StringSetup, .teardown = (CCBenchmarkTeardown)StringTeardown, .arg = STRING_LARGE },
+    { .name = "CCString/hash (large)", .run = (CCBenchmarkRun)StringHash, .setup = StringSetup, .teardown = (CCBenchmarkTeardown)StringTeardown, .arg = STRING_LARGE },
+    { .name = "CCString/find substring (large)", .run = (CCBenchmarkRun)StringFind, .setup = StringSetup, .teardown = (CCBenchmarkTeardown)StringTeardown, .arg = STRING_LARGE },
+    { .name = "CCString/copy substring (large)", .run = (CCBenchmarkRun)StringCopySubstring, .setup = StringSetup, .teardown = (CCBenchmarkTeardown)StringTeardown, .arg = STRING_LARGE },
+    { .name = "CCString/enumerate (large)", .run = (CCBenchmarkRun)StringEnumerate, .setup = StringSetup, .teardown = (CCBenchmarkTeardown)StringTeardown, .arg = STRING_LARGE }
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
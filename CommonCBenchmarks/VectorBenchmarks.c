@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+#include <CommonC/Vector.h>
+#include <CommonC/Matrix4.h>
+#include <CommonC/MemoryAllocation.h>
+
+#define VECTOR_COUNT 1024
+
+typedef struct {
+    CCVector3D a[VECTOR_COUNT], b[VECTOR_COUNT], result[VECTOR_COUNT];
+    CCVector va[VECTOR_COUNT], vb[VECTOR_COUNT], vresult[VECTOR_COUNT];
+    float dot[VECTOR_COUNT];
+    CCMatrix4 m[VECTOR_COUNT / 16], mresult[VECTOR_COUNT / 16];
+} VectorContext;
+
+static void *VectorSetup(const void *Arg)
+{
+    VectorContext *Context = CCMalloc(CC_STD_ALLOCATOR, sizeof(VectorContext), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    for (size_t Loop = 0; Loop < VECTOR_COUNT; Loop++)
+    {
+        Context->a[Loop] = CCVector3DMake(1.0f + Loop, 2.0f - Loop, 0.5f * Loop);
+        Context->b[Loop] = CCVector3DMake(0.25f * Loop, 3.0f, 1.0f + Loop);
+        Context->va[Loop] = CCVectorizeVector3D(Context->a[Loop]);
+        Context->vb[Loop] = CCVectorizeVector3D(Context->b[Loop]);
+    }
+    
+    for (size_t Loop = 0; Loop < VECTOR_COUNT / 16; Loop++) Context->m[Loop] = CCMatrix4MakeRotation(0.01f * Loop, CCVector3DMake(0.0f, 1.0f, 0.0f));
+    
+    return Context;
+}
+
+static void VectorTeardown(VectorContext *Context)
+{
+    CCFree(Context);
+}
+
+//Each iteration performs the operation once, the arrays are cycled through so the inputs aren't loop invariant
+#define VECTOR_BENCHMARK(function, count, ...) \
+static void function(VectorContext *Context, size_t Iterations) \
+{ \
+    for (size_t Loop = 0; Loop < Iterations; Loop++) \
+    { \
+        const size_t Index = Loop & ((count) - 1); \
+        __VA_ARGS__; \
+    } \
+    \
+    CCBenchmarkKeep(Context); \
+}
+
+VECTOR_BENCHMARK(Vector3Add, VECTOR_COUNT, Context->result[Index] = CCVector3Add(Context->a[Index], Context->b[Index]))
+VECTOR_BENCHMARK(Vector3Dot, VECTOR_COUNT, Context->dot[Index] = CCVector3Dot(Context->a[Index], Context->b[Index]))
+VECTOR_BENCHMARK(Vector3Cross, VECTOR_COUNT, Context->result[Index] = CCVector3Cross(Context->a[Index], Context->b[Index]))
+VECTOR_BENCHMARK(Vector3Normalize, VECTOR_COUNT, Context->result[Index] = CCVector3Normalize(Context->a[Index]))
+VECTOR_BENCHMARK(Vectorize3Add, VECTOR_COUNT, Context->vresult[Index] = CCVectorize3Add(Context->va[Index], Context->vb[Index]))
+VECTOR_BENCHMARK(Vectorize3Dot, VECTOR_COUNT, Context->vresult[Index] = CCVectorize3Dot(Context->va[Index], Context->vb[Index]))
+VECTOR_BENCHMARK(Vectorize3Cross, VECTOR_COUNT, Context->vresult[Index] = CCVectorize3Cross(Context->va[Index], Context->vb[Index]))
+VECTOR_BENCHMARK(Vectorize3Normalize, VECTOR_COUNT, Context->vresult[Index] = CCVectorize3Normalize(Context->va[Index]))
+VECTOR_BENCHMARK(Matrix4Mul, VECTOR_COUNT / 16, Context->mresult[Index] = CCMatrix4Mul(Context->m[Index], Context->m[(Index + 1) & ((VECTOR_COUNT / 16) - 1)]))
+VECTOR_BENCHMARK(Matrix4MulPosition, VECTOR_COUNT, Context->result[Index] = CCMatrix4MulPositionVector3D(Context->m[Index / 16], Context->a[Index]))
+
+#define VECTOR_BENCHMARK_ENTRY(function) { .name = "CC" #function, .run = (CCBenchmarkRun)function, .setup = VectorSetup, .teardown = (CCBenchmarkTeardown)VectorTeardown }
+
+static const CCBenchmark Benchmarks[] = {
+    VECTOR_BENCHMARK_ENTRY(Vector3Add),
+    VECTOR_BENCHMARK_ENTRY(Vector3Dot),
+    VECTOR_BENCHMARK_ENTRY(Vector3Cross),
+    VECTOR_BENCHMARK_ENTRY(Vector3Normalize),
+    VECTOR_BENCHMARK_ENTRY(Vectorize3Add),
+    VECTOR_BENCHMARK_ENTRY(Vectorize3Dot),
+    VECTOR_BENCHMARK_ENTRY(Vectorize3Cross),
+    VECTOR_BENCHMARK_ENTRY(Vectorize3Normalize),
+    VECTOR_BENCHMARK_ENTRY(Matrix4Mul),
+    VECTOR_BENCHMARK_ENTRY(Matrix4MulPosition)
+};
+
+int main(int argc, char *argv[])
+{
+    return CCBenchmarkMain(argc, argv, Benchmarks, sizeof(Benchmarks) / sizeof(*Benchmarks));
+}
@@ -0,0 +1,374 @@
+/*
+ *  Copyright (c) 2018, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#import <XCTest/XCTest.h>
+#import "ConcurrentArray.h"
+#import "EpochGarbageCollector.h"
+#import "LazyGarbageCollector.h"
+#import <stdatomic.h>
+#import <pthread.h>
+
+@interface ConcurrentArrayTests : XCTestCase
+
+@property (readonly) const CCConcurrentGarbageCollectorInterface *gc;
+
+@end
+
+@implementation ConcurrentArrayTests
+
+-(const CCConcurrentGarbageCollectorInterface *) gc
+{
+    return CCEpochGarbageCollector;
+}
+
+-(void) testCreation
+{
+    CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 1, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+    
+    XCTAssertEqual(CCConcurrentArrayGetCount(Array), 0, @"Should be empty");
+    XCTAssertEqual(CCConcurrentArrayGetElementSize(Array), sizeof(int), @"Should be the size specified on creation");
+    
+    CCConcurrentArrayDestroy(Array);
+}
+
+-(void) testAppending
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        XCTAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 1 }), 0, @"Should append the element to the end");
+        XCTAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 2 }), 1, @"Should append the element to the end");
+        XCTAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 3 }), 2, @"Should append the element to the end");
+        
+        int Value;
+        XCTAssertEqual(CCConcurrentArrayGetCount(Array), 3, @"Should contain 3 elements");
+        XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 0, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, 1, @"Should be the first element");
+        XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 1, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, 2, @"Should be the second element");
+        XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 2, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, 3, @"Should be the third element");
+        
+        XCTAssertFalse(CCConcurrentArrayGetElementAtIndex(Array, 3, &Value), @"Should not have an element at the given index");
+        XCTAssertFalse(CCConcurrentArrayGetElementAtIndex(Array, SIZE_MAX, &Value), @"Should not have an element at the given index");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+-(void) testReplacing
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        CCConcurrentArrayAppendElement(Array, &(int){ 1 });
+        CCConcurrentArrayAppendElement(Array, &(int){ 2 });
+        
+        int Value;
+        XCTAssertTrue(CCConcurrentArrayReplaceElementAtIndex(Array, 1, &(int){ 20 }, &Value), @"Should replace the element");
+        XCTAssertEqual(Value, 2, @"Should be the replaced element");
+        XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 1, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, 20, @"Should be the new element");
+        XCTAssertFalse(CCConcurrentArrayReplaceElementAtIndex(Array, 2, &(int){ 30 }, NULL), @"Should not replace an element past the end");
+        XCTAssertEqual(CCConcurrentArrayGetCount(Array), 2, @"Should contain 2 elements");
+        
+        XCTAssertTrue(CCConcurrentArrayReplaceExactElementAtIndex(Array, 0, &(int){ 10 }, &(int){ 1 }), @"Should replace the matching element");
+        XCTAssertFalse(CCConcurrentArrayReplaceExactElementAtIndex(Array, 0, &(int){ 11 }, &(int){ 1 }), @"Should not replace an element that does not match");
+        XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 0, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, 10, @"Should be the new element");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+-(void) testRemoving
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        for (int Loop = 0; Loop < 10; Loop++) CCConcurrentArrayAppendElement(Array, &Loop);
+        
+        int Value;
+        XCTAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 0, &Value), @"Should remove the element");
+        XCTAssertEqual(Value, 0, @"Should be the removed element");
+        XCTAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 8, &Value), @"Should remove the element");
+        XCTAssertEqual(Value, 9, @"Should be the removed element");
+        XCTAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 3, NULL), @"Should remove the element");
+        XCTAssertFalse(CCConcurrentArrayRemoveElementAtIndex(Array, 7, NULL), @"Should not remove an element past the end");
+        XCTAssertEqual(CCConcurrentArrayGetCount(Array), 7, @"Should contain 7 elements");
+        
+        const int Expected[] = { 1, 2, 3, 5, 6, 7, 8 };
+        for (size_t Loop = 0; Loop < sizeof(Expected) / sizeof(*Expected); Loop++)
+        {
+            XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, Loop, &Value), @"Should have an element at the given index");
+            XCTAssertEqual(Value, Expected[Loop], @"Should shift the remaining elements");
+        }
+        
+        XCTAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 10 }), 7, @"Should append the element to the end");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+-(void) testInserting
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        XCTAssertFalse(CCConcurrentArrayInsertElementAtIndex(Array, 1, &(int){ 1 }), @"Should not insert an element past the end");
+        XCTAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 0, &(int){ 3 }), @"Should insert the element");
+        XCTAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 0, &(int){ 1 }), @"Should insert the element");
+        XCTAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 1, &(int){ 2 }), @"Should insert the element");
+        XCTAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 3, &(int){ 4 }), @"Should insert the element at the end");
+        XCTAssertEqual(CCConcurrentArrayGetCount(Array), 4, @"Should contain 4 elements");
+        
+        for (int Loop = 0; Loop < 4; Loop++)
+        {
+            int Value;
+            XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, Loop, &Value), @"Should have an element at the given index");
+            XCTAssertEqual(Value, Loop + 1, @"Should be in order");
+        }
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+-(void) testLargeElements
+{
+    typedef struct {
+        int value;
+        char padding[60];
+    } LargeElement;
+    
+    CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(LargeElement), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+    
+    for (int Loop = 0; Loop < 100; Loop++) CCConcurrentArrayAppendElement(Array, &(LargeElement){ .value = Loop });
+    
+    LargeElement Value;
+    XCTAssertTrue(CCConcurrentArrayReplaceElementAtIndex(Array, 50, &(LargeElement){ .value = -1 }, &Value), @"Should replace the element");
+    XCTAssertEqual(Value.value, 50, @"Should be the replaced element");
+    XCTAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 0, &Value), @"Should remove the element");
+    XCTAssertEqual(Value.value, 0, @"Should be the removed element");
+    XCTAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 10, &(LargeElement){ .value = -2 }), @"Should insert the element");
+    
+    XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 10, &Value), @"Should have an element at the given index");
+    XCTAssertEqual(Value.value, -2, @"Should be the inserted element");
+    XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 50, &Value), @"Should have an element at the given index");
+    XCTAssertEqual(Value.value, -1, @"Should be the replaced element");
+    XCTAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 99, &Value), @"Should have an element at the given index");
+    XCTAssertEqual(Value.value, 99, @"Should be the last element");
+    
+    CCConcurrentArrayDestroy(Array);
+}
+
+-(void) testGrowingSegments
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            XCTAssertEqual(CCConcurrentArrayAppendElement(Array, &Loop), Loop, @"Should append the element to the end");
+        }
+        
+        XCTAssertEqual(CCConcurrentArrayGetCount(Array), 1000, @"Should contain 1000 elements");
+        
+        _Bool Matches = TRUE;
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            int Value;
+            Matches &= CCConcurrentArrayGetElementAtIndex(Array, Loop, &Value) && (Value == Loop);
+        }
+        
+        XCTAssertTrue(Matches, @"Should retain all elements across segments");
+        XCTAssertFalse(CCConcurrentArrayGetElementAtIndex(Array, 1000, &(int){ 0 }), @"Should not have an element at the given index");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+static _Bool SumEnumerator(const void *Element, size_t Index, void *Data)
+{
+    *(size_t*)Data += *(const int*)Element;
+    
+    return Index < 49;
+}
+
+-(void) testEnumerating
+{
+    CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+    
+    size_t Sum = 0;
+    XCTAssertEqual(CCConcurrentArrayEnumerate(Array, SumEnumerator, &Sum), 0, @"Should not enumerate any elements");
+    
+    for (int Loop = 0; Loop < 100; Loop++) CCConcurrentArrayAppendElement(Array, &Loop);
+    
+    XCTAssertEqual(CCConcurrentArrayEnumerate(Array, SumEnumerator, &Sum), 50, @"Should stop enumerating when the enumerator returns false");
+    XCTAssertEqual(Sum, 1225, @"Should enumerate the elements in order");
+    
+    CCConcurrentArrayDestroy(Array);
+}
+
+#define THREAD_COUNT 10
+#define ELEMENT_COUNT 1000
+
+static CCConcurrentArray A;
+static void *Appenders(void *Arg)
+{
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++)
+    {
+        CCConcurrentArrayAppendElement(A, &Loop);
+    }
+    
+    return NULL;
+}
+
+static size_t Sum = 0;
+static void *Summer(void *Arg)
+{
+    Sum = 0;
+    for (int Loop = 0; Loop < ELEMENT_COUNT * THREAD_COUNT; Loop++)
+    {
+        int Element;
+        while (!CCConcurrentArrayGetElementAtIndex(A, Loop, &Element));
+        
+        Sum += Element;
+    }
+    
+    return NULL;
+}
+
+-(void) testMultiThreadedAppends
+{
+    A = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+    
+    pthread_t AppenderThreads[THREAD_COUNT], SummerThread;
+    
+    pthread_create(&SummerThread, NULL, Summer, NULL);
+    
+    for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+    {
+        pthread_create(AppenderThreads + Loop, NULL, Appenders, NULL);
+    }
+    
+    for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+    {
+        pthread_join(AppenderThreads[Loop], NULL);
+    }
+    
+    pthread_join(SummerThread, NULL);
+    
+    XCTAssertEqual(CCConcurrentArrayGetCount(A), ELEMENT_COUNT * THREAD_COUNT, @"Should append all elements");
+    
+    CCConcurrentArrayDestroy(A);
+    
+    size_t CorrectSum = 0;
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++) CorrectSum += Loop;
+    
+    XCTAssertEqual(Sum, (CorrectSum * THREAD_COUNT), @"Should append all elements");
+}
+
+static void *Mutators(void *Arg)
+{
+    for (int Loop = 0; Loop < 100; Loop++)
+    {
+        if (Loop & 1) CCConcurrentArrayRemoveElementAtIndex(A, 0, NULL);
+        else CCConcurrentArrayInsertElementAtIndex(A, 0, &(int){ -1 });
+    }
+    
+    return NULL;
+}
+
+-(void) testMultiThreadedMutations
+{
+    A = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+    
+    pthread_t AppenderThreads[THREAD_COUNT / 2], MutatorThreads[THREAD_COUNT / 2];
+    
+    for (int Loop = 0; Loop < THREAD_COUNT / 2; Loop++)
+    {
+        pthread_create(AppenderThreads + Loop, NULL, Appenders, NULL);
+        pthread_create(MutatorThreads + Loop, NULL, Mutators, NULL);
+    }
+    
+    for (int Loop = 0; Loop < THREAD_COUNT / 2; Loop++)
+    {
+        pthread_join(AppenderThreads[Loop], NULL);
+        pthread_join(MutatorThreads[Loop], NULL);
+    }
+    
+    const size_t Count = CCConcurrentArrayGetCount(A);
+    XCTAssertEqual(Count, ELEMENT_COUNT * (THREAD_COUNT / 2), @"Should balance the insertions and removals");
+    
+    _Bool Contiguous = TRUE;
+    for (size_t Loop = 0; Loop < Count; Loop++) Contiguous &= CCConcurrentArrayGetElementAtIndex(A, Loop, NULL);
+    
+    XCTAssertTrue(Contiguous, @"Should not leave any gaps");
+    XCTAssertFalse(CCConcurrentArrayGetElementAtIndex(A, Count, NULL), @"Should not have an element at the given index");
+    
+    CCConcurrentArrayDestroy(A);
+}
+
+-(void) testContendedAppendPerformance
+{
+    [self measureBlock: ^{
+        A = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 64, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        pthread_t AppenderThreads[THREAD_COUNT];
+        
+        for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+        {
+            pthread_create(AppenderThreads + Loop, NULL, Appenders, NULL);
+        }
+        
+        for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+        {
+            pthread_join(AppenderThreads[Loop], NULL);
+        }
+        
+        CCConcurrentArrayDestroy(A);
+    }];
+}
+
+@end
+
+@interface ConcurrentArrayTestsLazyGC : ConcurrentArrayTests
+@end
+
+@implementation ConcurrentArrayTestsLazyGC
+
+-(const CCConcurrentGarbageCollectorInterface *) gc
+{
+    return CCLazyGarbageCollector;
+}
+
+@end
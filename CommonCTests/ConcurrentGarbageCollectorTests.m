@@ -122,6 +122,27 @@ static void ReclaimationCounter(void *Arg)
 
 #define CYCLE_COUNT 1000000
 
+-(void) testReclaimationProgresses
+{
+    CCConcurrentGarbageCollector GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc);
+    
+    self.reclaimationSum = 0;
+    size_t MaxOutstanding = 0;
+    for (size_t Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        CCConcurrentGarbageCollectorManage(GC, (void*)1, ReclaimationCounter);
+        CCConcurrentGarbageCollectorEnd(GC);
+        
+        const size_t Outstanding = (Loop + 1) - self.reclaimationSum;
+        if (Outstanding > MaxOutstanding) MaxOutstanding = Outstanding;
+    }
+    
+    XCTAssertLessThanOrEqual(MaxOutstanding, 3, "Should keep reclaiming while running, not only when destroyed");
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+}
+
 typedef struct {
     ConcurrentGarbageCollectorTests *test;
     uintptr_t value;
@@ -314,6 +314,44 @@
     }
 }
 
+-(void) testGrowingSegments
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+        
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            XCTAssertEqual(CCConcurrentIndexMapAppendElement(IndexMap, &Loop), Loop, @"Should append the element to the end");
+        }
+        
+        XCTAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 1000, @"Should contain 1000 elements");
+        
+        _Bool Matches = TRUE;
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            int Value;
+            Matches &= CCConcurrentIndexMapGetElementAtIndex(IndexMap, Loop, &Value) && (Value == Loop);
+        }
+        
+        XCTAssertTrue(Matches, @"Should retain all elements across segments");
+        XCTAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1000, &(int){ 0 }), @"Should not have an element at the given index");
+        XCTAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, SIZE_MAX, &(int){ 0 }), @"Should not have an element at the given index");
+        
+        int Value = 0;
+        XCTAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 500, &(int){ -1 }), "Should insert the element at index");
+        XCTAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1000, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, 999, @"Should shift the last element");
+        XCTAssertTrue(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 0, &Value), "Should remove the element at index");
+        XCTAssertEqual(Value, 0, @"Should contain the removed element");
+        XCTAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 499, &Value), @"Should have an element at the given index");
+        XCTAssertEqual(Value, -1, @"Should be the inserted element");
+        XCTAssertEqual(CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1000 }), 1000, @"Should append the element to the end");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
 #define ELEMENT_COUNT 1000
 #define ELEMENT_INC 1000
 
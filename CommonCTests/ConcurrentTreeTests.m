@@ -0,0 +1,230 @@
+/*
+ *  Copyright (c) 2018, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#import <XCTest/XCTest.h>
+#import "ConcurrentTree.h"
+#import "EpochGarbageCollector.h"
+#import "LazyGarbageCollector.h"
+#import <stdatomic.h>
+#import <pthread.h>
+
+@interface ConcurrentTreeTests : XCTestCase
+
+@property (readonly) const CCConcurrentGarbageCollectorInterface *gc;
+
+@end
+
+static CCComparisonResult IntComparator(const int *Left, const int *Right)
+{
+    return *Left == *Right ? CCComparisonResultEqual : (*Left < *Right ? CCComparisonResultAscending : CCComparisonResultDescending);
+}
+
+@implementation ConcurrentTreeTests
+
+-(const CCConcurrentGarbageCollectorInterface *) gc
+{
+    return CCEpochGarbageCollector;
+}
+
+-(CCConcurrentTree) createTree
+{
+    return CCConcurrentTreeCreate(CC_STD_ALLOCATOR, sizeof(int), sizeof(int), (CCComparator)IntComparator, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, self.gc));
+}
+
+-(void) testCreation
+{
+    CCConcurrentTree Tree = [self createTree];
+    
+    XCTAssertEqual(CCConcurrentTreeGetCount(Tree), 0, @"Should be empty");
+    XCTAssertFalse(CCConcurrentTreeFind(Tree, &(int){ 0 }, NULL), @"Should not contain any entries");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+-(void) testInserting
+{
+    CCConcurrentTree Tree = [self createTree];
+    
+    for (int Loop = 0; Loop < 1000; Loop++)
+    {
+        const int Key = (Loop * 7919) % 1000;
+        XCTAssertTrue(CCConcurrentTreeInsert(Tree, &Key, &(int){ -Key }), @"Should insert the entry");
+    }
+    
+    XCTAssertFalse(CCConcurrentTreeInsert(Tree, &(int){ 5 }, &(int){ 0 }), @"Should not insert a duplicate key");
+    XCTAssertEqual(CCConcurrentTreeGetCount(Tree), 1000, @"Should contain 1000 entries");
+    
+    _Bool Matches = TRUE;
+    for (int Loop = 0; Loop < 1000; Loop++)
+    {
+        int Value;
+        Matches &= CCConcurrentTreeFind(Tree, &Loop, &Value) && (Value == -Loop);
+    }
+    
+    XCTAssertTrue(Matches, @"Should find all entries");
+    XCTAssertFalse(CCConcurrentTreeFind(Tree, &(int){ 1000 }, NULL), @"Should not find a key that was not inserted");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+-(void) testRemoving
+{
+    CCConcurrentTree Tree = [self createTree];
+    
+    for (int Loop = 0; Loop < 100; Loop++) CCConcurrentTreeInsert(Tree, &Loop, &(int){ Loop * 2 });
+    
+    int Value;
+    XCTAssertTrue(CCConcurrentTreeRemove(Tree, &(int){ 50 }, &Value), @"Should remove the entry");
+    XCTAssertEqual(Value, 100, @"Should be the removed value");
+    XCTAssertFalse(CCConcurrentTreeRemove(Tree, &(int){ 50 }, NULL), @"Should not remove an entry that does not exist");
+    XCTAssertFalse(CCConcurrentTreeFind(Tree, &(int){ 50 }, NULL), @"Should not find the removed entry");
+    XCTAssertTrue(CCConcurrentTreeFind(Tree, &(int){ 51 }, &Value), @"Should find the neighbouring entry");
+    XCTAssertEqual(Value, 102, @"Should be the neighbouring value");
+    XCTAssertEqual(CCConcurrentTreeGetCount(Tree), 99, @"Should contain 99 entries");
+    
+    XCTAssertTrue(CCConcurrentTreeInsert(Tree, &(int){ 50 }, &(int){ 1 }), @"Should insert a previously removed key");
+    XCTAssertTrue(CCConcurrentTreeFind(Tree, &(int){ 50 }, &Value), @"Should find the reinserted entry");
+    XCTAssertEqual(Value, 1, @"Should be the reinserted value");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+static _Bool OrderEnumerator(const void *Key, const void *Value, void *Data)
+{
+    int *Prev = Data;
+    if (*(const int*)Key <= *Prev) return FALSE;
+    
+    *Prev = *(const int*)Key;
+    
+    return TRUE;
+}
+
+static _Bool StopEnumerator(const void *Key, const void *Value, void *Data)
+{
+    return OrderEnumerator(Key, Value, Data) && (*(const int*)Key != 150);
+}
+
+-(void) testEnumeratingRanges
+{
+    CCConcurrentTree Tree = [self createTree];
+    
+    for (int Loop = 999; Loop >= 0; Loop--) CCConcurrentTreeInsert(Tree, &Loop, &Loop);
+    
+    int Prev = -1;
+    XCTAssertEqual(CCConcurrentTreeEnumerateRange(Tree, NULL, NULL, StopEnumerator, &Prev), 151, @"Should stop enumerating when the enumerator returns false");
+    XCTAssertEqual(Prev, 150, @"Should enumerate the keys in ascending order");
+    
+    Prev = 199;
+    XCTAssertEqual(CCConcurrentTreeEnumerateRange(Tree, &(int){ 200 }, &(int){ 300 }, OrderEnumerator, &Prev), 100, @"Should enumerate the keys in the range");
+    XCTAssertEqual(Prev, 299, @"Should exclude the upper bound");
+    
+    Prev = 899;
+    XCTAssertEqual(CCConcurrentTreeEnumerateRange(Tree, &(int){ 900 }, NULL, OrderEnumerator, &Prev), 100, @"Should enumerate until the last entry");
+    XCTAssertEqual(CCConcurrentTreeEnumerateRange(Tree, &(int){ 2000 }, NULL, OrderEnumerator, &Prev), 0, @"Should not enumerate any entries");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+#define THREAD_COUNT 10
+#define KEY_COUNT 256
+#define OPERATION_COUNT 10000
+
+static CCConcurrentTree T;
+static _Atomic(size_t) InsertCount = ATOMIC_VAR_INIT(0), RemoveCount = ATOMIC_VAR_INIT(0), MismatchCount = ATOMIC_VAR_INIT(0);
+static void *Mutators(void *Arg)
+{
+    uint32_t Seed = (uint32_t)(uintptr_t)Arg;
+    size_t Inserted = 0, Removed = 0, Mismatched = 0;
+    for (int Loop = 0; Loop < OPERATION_COUNT; Loop++)
+    {
+        Seed = (Seed * 1103515245) + 12345;
+        
+        const int Key = (Seed >> 8) % KEY_COUNT;
+        int Value;
+        if (Seed & 0x10000)
+        {
+            if (CCConcurrentTreeInsert(T, &Key, &(int){ Key * 2 })) Inserted++;
+        }
+        
+        else if (CCConcurrentTreeRemove(T, &Key, &Value))
+        {
+            Removed++;
+            Mismatched += Value != (Key * 2);
+        }
+        
+        if (CCConcurrentTreeFind(T, &Key, &Value)) Mismatched += Value != (Key * 2);
+    }
+    
+    atomic_fetch_add_explicit(&InsertCount, Inserted, memory_order_relaxed);
+    atomic_fetch_add_explicit(&RemoveCount, Removed, memory_order_relaxed);
+    atomic_fetch_add_explicit(&MismatchCount, Mismatched, memory_order_relaxed);
+    
+    return NULL;
+}
+
+-(void) testMultiThreadedMutations
+{
+    atomic_store(&InsertCount, 0);
+    atomic_store(&RemoveCount, 0);
+    atomic_store(&MismatchCount, 0);
+    T = [self createTree];
+    
+    pthread_t MutatorThreads[THREAD_COUNT];
+    
+    for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+    {
+        pthread_create(MutatorThreads + Loop, NULL, Mutators, (void*)(uintptr_t)(Loop + 1));
+    }
+    
+    for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+    {
+        pthread_join(MutatorThreads[Loop], NULL);
+    }
+    
+    const size_t Count = CCConcurrentTreeGetCount(T);
+    XCTAssertEqual(Count, atomic_load(&InsertCount) - atomic_load(&RemoveCount), @"Should balance the insertions and removals");
+    XCTAssertEqual(atomic_load(&MismatchCount), 0, @"Should not retrieve any incorrect values");
+    
+    int Prev = -1;
+    XCTAssertEqual(CCConcurrentTreeEnumerateRange(T, NULL, NULL, OrderEnumerator, &Prev), Count, @"Should enumerate all remaining entries in order");
+    
+    CCConcurrentTreeDestroy(T);
+}
+
+@end
+
+@interface ConcurrentTreeTestsLazyGC : ConcurrentTreeTests
+@end
+
+@implementation ConcurrentTreeTestsLazyGC
+
+-(const CCConcurrentGarbageCollectorInterface *) gc
+{
+    return CCLazyGarbageCollector;
+}
+
+@end
@@ -63,6 +63,46 @@
     CCConcurrentIDGeneratorDestroy(Pool);
 }
 
+-(void) testExhaustingLargePool
+{
+    const size_t Sizes[] = { 64, 65, 4096, 4097, 300000 };
+    for (size_t Loop = 0; Loop < sizeof(Sizes) / sizeof(*Sizes); Loop++)
+    {
+        CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, Sizes[Loop], CCConsecutiveIDGenerator);
+        
+        uint8_t *Assigned = calloc(Sizes[Loop], sizeof(uint8_t));
+        _Bool Unique = TRUE;
+        for (size_t Loop2 = 0; Loop2 < Sizes[Loop]; Loop2++)
+        {
+            uintptr_t ID;
+            if ((!CCConcurrentIDGeneratorTryAssign(Pool, &ID)) || (ID >= Sizes[Loop]) || (Assigned[ID]))
+            {
+                Unique = FALSE;
+                break;
+            }
+            
+            Assigned[ID] = 1;
+        }
+        
+        free(Assigned);
+        
+        uintptr_t ID;
+        XCTAssertTrue(Unique, @"Should assign every ID exactly once");
+        XCTAssertFalse(CCConcurrentIDGeneratorTryAssign(Pool, &ID), @"Should not assign an ID");
+        
+        CCConcurrentIDGeneratorRecycle(Pool, Sizes[Loop] - 1);
+        CCConcurrentIDGeneratorRecycle(Pool, 0);
+        
+        XCTAssertTrue(CCConcurrentIDGeneratorTryAssign(Pool, &ID), @"Should assign ID");
+        XCTAssertTrue((ID == 0) || (ID == Sizes[Loop] - 1), @"Should assign a recycled ID");
+        XCTAssertTrue(CCConcurrentIDGeneratorTryAssign(Pool, &ID), @"Should assign ID");
+        XCTAssertTrue((ID == 0) || (ID == Sizes[Loop] - 1), @"Should assign a recycled ID");
+        XCTAssertFalse(CCConcurrentIDGeneratorTryAssign(Pool, &ID), @"Should not assign an ID");
+        
+        CCConcurrentIDGeneratorDestroy(Pool);
+    }
+}
+
 #define THREAD_COUNT 20
 #define IDS_PER_THREAD 500
 #define ID_POOL (IDS_PER_THREAD * THREAD_COUNT)
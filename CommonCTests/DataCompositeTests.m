@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "DataTests.h"
+#import "DataComposite.h"
+#import "DataBuffer.h"
+#import "MemoryAllocation.h"
+
+@interface DataCompositeTests : DataTests
+
+@end
+
+@implementation DataCompositeTests
+
+-(const CCDataInterface*) interface
+{
+    return CCDataComposite;
+}
+
+-(CCData) createDataOfSize: (size_t)size WithHint: (CCDataHint)hint
+{
+    //Split the data across three buffers, with padding around each referenced region
+    CCDataCompositeRange Ranges[3];
+    for (size_t Loop = 0, Offset = 0; Loop < 3; Loop++)
+    {
+        const size_t Size = Loop == 2 ? size - Offset : size / 3;
+        Ranges[Loop] = (CCDataCompositeRange){
+            .data = CCDataBufferCreate(CC_STD_ALLOCATOR, CCDataHintReadWrite | CCDataBufferHintFree, Size + 2, CCMalloc(CC_STD_ALLOCATOR, Size + 2, NULL, CC_DEFAULT_ERROR_CALLBACK), NULL, NULL),
+            .offset = 1,
+            .size = Size
+        };
+        
+        Offset += Size;
+    }
+    
+    CCData Data = CCDataCompositeCreate(CC_STD_ALLOCATOR, hint | CCDataHintRead, Ranges, 3, NULL, NULL);
+    
+    for (size_t Loop = 0; Loop < 3; Loop++) CCDataDestroy(Ranges[Loop].data);
+    
+    return Data;
+}
+
+-(void) testReferencingRanges
+{
+    CCData Header = CCDataBufferCreate(CC_STD_ALLOCATOR, CCDataHintReadWrite | CCDataBufferHintCopy, 4, "abcd", NULL, NULL);
+    CCData Body = CCDataBufferCreate(CC_STD_ALLOCATOR, CCDataHintReadWrite | CCDataBufferHintCopy, 6, "012345", NULL, NULL);
+    
+    CCData Data = CCDataCompositeCreate(CC_STD_ALLOCATOR, CCDataHintReadWrite, (CCDataCompositeRange[3]){
+        { .data = Header, .offset = 0, .size = 4 },
+        { .data = Body, .offset = 0, .size = 0 },
+        { .data = Body, .offset = 1, .size = 4 }
+    }, 3, NULL, NULL);
+    
+    XCTAssertEqual(CCDataGetSize(Data), 8, @"Should be the size of the ranges");
+    
+    CCBufferMap Map = CCDataMapBuffer(Data, 5, 2, CCDataHintReadWrite);
+    XCTAssertEqual(Map.ptr, CCDataGetBuffer(Body) + 2, @"Should map a view of the range");
+    CCDataUnmapBuffer(Data, Map);
+    
+    Map = CCDataMapBuffer(Data, 2, 4, CCDataHintReadWrite);
+    XCTAssertTrue(!memcmp(Map.ptr, "cd12", 4), @"Should gather the ranges");
+    memcpy(Map.ptr, "CD!!", 4);
+    CCDataUnmapBuffer(Data, Map);
+    
+    char Buffer[6];
+    CCDataReadBuffer(Body, 0, 6, Buffer);
+    XCTAssertTrue(!memcmp(Buffer, "0!!345", 6), @"Should scatter writes to the referenced data");
+    
+    struct iovec IOVec[2];
+    XCTAssertEqual(CCDataCompositeMapIOVec(Data, 1, 6, NULL, 0), 2, @"Should require an entry per range");
+    XCTAssertEqual(CCDataCompositeMapIOVec(Data, 1, 6, IOVec, 2), 2, @"Should map an entry per range");
+    XCTAssertEqual(IOVec[0].iov_len, 3, @"Should map the remainder of the first range");
+    XCTAssertEqual(IOVec[1].iov_len, 3, @"Should map the start of the second range");
+    XCTAssertTrue(!memcmp(IOVec[0].iov_base, "bCD", 3), @"Should map the first range");
+    XCTAssertTrue(!memcmp(IOVec[1].iov_base, "!!3", 3), @"Should map the second range");
+    CCDataCompositeUnmapIOVec(Data, 1, 6, IOVec, 2);
+    
+    CCDataDestroy(Data);
+    CCDataDestroy(Body);
+    CCDataDestroy(Header);
+}
+
+@end
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import "DataTests.h"
+#import "DataFile.h"
+#import "FileSystem.h"
+#import "FileHandle.h"
+#import "MemoryAllocation.h"
+
+@interface DataFileTests : DataTests
+
+@end
+
+@implementation DataFileTests
+{
+    FSPath directory;
+    size_t count;
+}
+
+-(void) setUp
+{
+    [super setUp];
+    
+    directory = FSPathCreate("commonc-framework/data-file/");
+    FSManagerRemove(directory);
+    FSManagerCreate(directory, TRUE);
+    count = 0;
+}
+
+-(void) tearDown
+{
+    FSManagerRemove(directory);
+    FSPathDestroy(directory);
+    
+    [super tearDown];
+}
+
+-(const CCDataInterface*) interface
+{
+    return CCDataFile;
+}
+
+-(FSPath) createFileOfSize: (size_t)size
+{
+    char Name[32];
+    snprintf(Name, sizeof(Name), "test%zu", count++);
+    
+    FSPath Path = FSPathCopy(directory);
+    FSPathAppendComponent(Path, FSPathComponentCreate(FSPathComponentTypeFile, Name));
+    FSManagerCreate(Path, FALSE);
+    
+    FSHandle Handle;
+    if (FSHandleOpen(Path, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+    {
+        uint8_t *Values = CCMalloc(CC_STD_ALLOCATOR, size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        for (size_t Loop = 0; Loop < size; Loop++) Values[Loop] = (uint8_t)Loop;
+        
+        FSHandleWrite(Handle, size, Values, FSBehaviourDefault);
+        FSHandleClose(Handle);
+        CCFree(Values);
+    }
+    
+    return Path;
+}
+
+-(CCData) createDataOfSize: (size_t)size WithHint: (CCDataHint)hint
+{
+    FSPath Path = [self createFileOfSize: size];
+    CCData Data = CCDataFileCreate(CC_STD_ALLOCATOR, hint | CCDataHintRead, Path, 0, NULL, NULL);
+    FSPathDestroy(Path);
+    
+    if (Data) CCDataFillBuffer(Data, 0, size, 0);
+    
+    return Data;
+}
+
+-(void) testUnalignedMaps
+{
+    const size_t Size = 100000;
+    FSPath Path = [self createFileOfSize: Size];
+    CCData Data = CCDataFileCreate(CC_STD_ALLOCATOR, CCDataHintReadWrite | CCDataFileHintSequential, Path, 1, NULL, NULL);
+    FSPathDestroy(Path);
+    
+    XCTAssertEqual(CCDataGetSize(Data), Size, @"Should be the size of the file");
+    XCTAssertGreaterThan(CCDataGetPreferredMapSize(Data), 1, @"Should round the window up to the page size");
+    
+    CCBufferMap Map = CCDataMapBuffer(Data, 4097, 10000, CCDataHintRead);
+    _Bool Match = TRUE;
+    for (size_t Loop = 0; Loop < 10000; Loop++) Match &= ((uint8_t*)Map.ptr)[Loop] == (uint8_t)(Loop + 4097);
+    CCDataUnmapBuffer(Data, Map);
+    
+    XCTAssertTrue(Match, @"Should map the correct region of the file");
+    
+    Map = CCDataMapBuffer(Data, 8191, 2, CCDataHintWrite);
+    ((uint8_t*)Map.ptr)[0] = 0xaa;
+    ((uint8_t*)Map.ptr)[1] = 0xbb;
+    CCDataUnmapBuffer(Data, Map);
+    
+    uint8_t Values[2];
+    CCDataReadBuffer(Data, 8191, sizeof(Values), Values);
+    XCTAssertEqual(Values[0], 0xaa, @"Should write back to the file");
+    XCTAssertEqual(Values[1], 0xbb, @"Should write back to the file");
+    
+    CCDataSync(Data);
+    CCDataPurge(Data);
+    CCDataInvalidate(Data);
+    
+    XCTAssertEqual(CCDataGetSize(Data), Size, @"Should remain the size of the file");
+    
+    CCDataReadBuffer(Data, 8191, sizeof(Values), Values);
+    XCTAssertEqual(Values[0], 0xaa, @"Should persist the write");
+    XCTAssertEqual(Values[1], 0xbb, @"Should persist the write");
+    
+    CCDataDestroy(Data);
+}
+
+@end
@@ -179,6 +179,41 @@ static CCDataInterface TestDataInternalSmallBlock = {
     CCDataDestroy(Data);
 }
 
+-(void) testChunkedHash
+{
+    const size_t Size = (CC_DATA_HASH_CHUNK_SIZE * 3) + 5;
+    CCData Data = [self createDataOfSize: Size WithHint: CCDataHintReadWrite];
+    CCData Data2 = [self createDataOfSize: Size WithHint: CCDataHintReadWrite];
+    
+    CCDataFillBuffer(Data, 0, Size, 1);
+    CCDataFillBuffer(Data2, 0, Size, 1);
+    
+    const uint32_t Hash = CCDataGetHash(Data);
+    XCTAssertEqual(CCDataGetHash(Data2), Hash, @"Should have the same hash");
+    
+    CCBufferMap Map = CCDataMapBuffer(Data, 1, 10, CCDataHintRead);
+    CCDataUnmapBuffer(Data, Map);
+    XCTAssertEqual(CCDataGetHash(Data), Hash, @"Should not be modified by a read");
+    
+    CCDataWriteBuffer(Data, CC_DATA_HASH_CHUNK_SIZE * 2, sizeof(uint8_t), &(uint8_t){ 2 });
+    XCTAssertNotEqual(CCDataGetHash(Data), Hash, @"Should rehash the modified chunk");
+    
+    CCDataWriteBuffer(Data2, CC_DATA_HASH_CHUNK_SIZE * 2, sizeof(uint8_t), &(uint8_t){ 2 });
+    XCTAssertEqual(CCDataGetHash(Data2), CCDataGetHash(Data), @"Should have the same hash");
+    
+    Map = CCDataMapBuffer(Data, Size - 2, 2, CCDataHintWrite);
+    ((uint8_t*)Map.ptr)[0] = 3;
+    ((uint8_t*)Map.ptr)[1] = 3;
+    CCDataUnmapBuffer(Data, Map);
+    XCTAssertNotEqual(CCDataGetHash(Data2), CCDataGetHash(Data), @"Should rehash the modified chunk");
+    
+    CCDataCopyBuffer(Data, 0, Size, Data2, 0);
+    XCTAssertEqual(CCDataGetHash(Data2), CCDataGetHash(Data), @"Should have the same hash");
+    
+    CCDataDestroy(Data2);
+    CCDataDestroy(Data);
+}
+
 @end
 
 
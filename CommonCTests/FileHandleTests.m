@@ -27,6 +27,7 @@
 #import "FileSystem.h"
 #import "Path.h"
 #import "FileHandle.h"
+#import "MemoryAllocation.h"
 
 @interface FileHandleTests : XCTestCase
 
@@ -498,4 +499,110 @@
     XCTAssertEqual(FSHandleClose(Handle), FSOperationSuccess, @"Should close the file");
 }
 
+-(void) testShifting
+{
+    const size_t Size = 4 * 1024 * 1024, Insertions[] = { 4096, 65536, (1024 * 1024) + 5 };
+    uint8_t *Expected = CCMalloc(CC_STD_ALLOCATOR, Size, NULL, CC_DEFAULT_ERROR_CALLBACK), *Values = CCMalloc(CC_STD_ALLOCATOR, Size + (1024 * 1024) + 5, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    for (size_t Loop = 0; Loop < Size; Loop++) Expected[Loop] = (uint8_t)(Loop % 251);
+    
+    for (int Loop = 0; Loop < 2; Loop++)
+    {
+        FSHandle Handle;
+        XCTAssertEqual(FSHandleOpen(path, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the file");
+        XCTAssertEqual(FSHandleWrite(Handle, Size, Expected, FSBehaviourDefault), FSOperationSuccess, @"Should write to the file");
+        XCTAssertEqual(FSHandleClose(Handle), FSOperationSuccess, @"Should close the file");
+        
+        XCTAssertEqual(FSHandleOpen(path, FSHandleTypeUpdate | (Loop ? FSHandleTypeUnbuffered : 0), &Handle), FSOperationSuccess, @"Should open the file");
+        
+        //Block sized insertions can shift the file's extents, the edges of unaligned offsets are copied
+        for (size_t Index = 0; Index < sizeof(Insertions) / sizeof(*Insertions); Index++)
+        {
+            memset(Values, 0xff, Insertions[Index]);
+            XCTAssertEqual(FSHandleWriteFromOffset(Handle, 5000, Insertions[Index], Values, FSBehaviourDefault | FSWritingBehaviourInsert), FSOperationSuccess, @"Should insert in the file");
+            XCTAssertEqual(FSManagerGetSize(path), Size + Insertions[Index], @"Should grow the file");
+            
+            size_t Read = Size + Insertions[Index];
+            XCTAssertEqual(FSHandleReadFromOffset(Handle, 0, &Read, Values, FSBehaviourDefault), FSOperationSuccess, @"Should read the file");
+            
+            _Bool Match = !memcmp(Values, Expected, 5000) && !memcmp(Values + 5000 + Insertions[Index], Expected + 5000, Size - 5000);
+            for (size_t Check = 0; Check < Insertions[Index]; Check++) Match &= Values[5000 + Check] == 0xff;
+            XCTAssertTrue(Match, @"Should shift the contents of the file");
+            
+            XCTAssertEqual(FSHandleRemoveFromOffset(Handle, 5000, Insertions[Index], FSBehaviourDefault), FSOperationSuccess, @"Should remove from the file");
+            XCTAssertEqual(FSManagerGetSize(path), Size, @"Should shrink the file");
+            
+            Read = Size;
+            XCTAssertEqual(FSHandleReadFromOffset(Handle, 0, &Read, Values, FSBehaviourDefault), FSOperationSuccess, @"Should read the file");
+            XCTAssertTrue(!memcmp(Values, Expected, Size), @"Should restore the contents of the file");
+        }
+        
+        XCTAssertEqual(FSHandleClose(Handle), FSOperationSuccess, @"Should close the file");
+    }
+    
+    CCFree(Values);
+    CCFree(Expected);
+}
+
+-(void) testUnbufferedHandle
+{
+    for (int Loop = 0; Loop < 2; Loop++)
+    {
+        FSHandle Handle;
+        XCTAssertEqual(FSHandleOpen(path, FSHandleTypeUpdate | (Loop ? FSHandleTypeDirect : FSHandleTypeUnbuffered), &Handle), FSOperationSuccess, @"Should open the file");
+        XCTAssertGreaterThanOrEqual(FSHandleGetAlignment(Handle), 1, @"Should have a valid alignment");
+        
+        size_t Read = 4;
+        uint8_t Values[20];
+        XCTAssertEqual(FSHandleReadFromOffset(Handle, 2, &Read, Values, FSBehaviourDefault), FSOperationSuccess, @"Should read the file");
+        XCTAssertEqual(Read, 4, @"Should read the correct number of bytes");
+        XCTAssertEqual(Values[0], 3, @"Should read the correct value");
+        XCTAssertEqual(Values[3], 6, @"Should read the correct value");
+        XCTAssertEqual(FSHandleGetOffset(Handle), 0, @"Should not change the offset");
+        
+        Read = 2;
+        XCTAssertEqual(FSHandleRead(Handle, &Read, Values, FSBehaviourUpdateOffset), FSOperationSuccess, @"Should read the file");
+        XCTAssertEqual(FSHandleGetOffset(Handle), 2, @"Should update the offset");
+        
+        XCTAssertEqual(FSHandleWriteFromOffset(Handle, 3, 2, (uint8_t[2]){ 40, 50 }, FSBehaviourDefault), FSOperationSuccess, @"Should write to the file");
+        XCTAssertEqual(FSHandleWriteFromOffset(Handle, 1, 2, (uint8_t[2]){ 20, 30 }, FSBehaviourDefault | FSWritingBehaviourInsert), FSOperationSuccess, @"Should insert in the file");
+        //1 20 30 2 3 40 50 6 7 8 9 10 11 12
+        
+        XCTAssertEqual(FSHandleRemoveFromOffset(Handle, 12, 2, FSBehaviourDefault), FSOperationSuccess, @"Should remove from the file");
+        //1 20 30 2 3 40 50 6 7 8 9 10
+        
+        uint8_t Head[5], Tail[10];
+        size_t Count;
+        XCTAssertEqual(FSHandleReadVectorFromOffset(Handle, 0, (struct iovec[2]){ { .iov_base = Head, .iov_len = sizeof(Head) }, { .iov_base = Tail, .iov_len = sizeof(Tail) } }, 2, &Count, FSBehaviourDefault), FSOperationSuccess, @"Should read the file");
+        XCTAssertEqual(Count, 12, @"Should read the correct number of bytes");
+        XCTAssertEqual(Head[0], 1, @"Should read the correct value");
+        XCTAssertEqual(Head[1], 20, @"Should read the correct value");
+        XCTAssertEqual(Head[2], 30, @"Should read the correct value");
+        XCTAssertEqual(Head[3], 2, @"Should read the correct value");
+        XCTAssertEqual(Head[4], 3, @"Should read the correct value");
+        XCTAssertEqual(Tail[0], 40, @"Should read the correct value");
+        XCTAssertEqual(Tail[1], 50, @"Should read the correct value");
+        XCTAssertEqual(Tail[2], 6, @"Should read the correct value");
+        XCTAssertEqual(Tail[6], 10, @"Should read the correct value");
+        
+        XCTAssertEqual(FSHandleRemoveFromOffset(Handle, 1, 2, FSBehaviourDefault), FSOperationSuccess, @"Should remove from the file");
+        XCTAssertEqual(FSHandleRemoveFromOffset(Handle, 3, 2, FSBehaviourDefault), FSOperationSuccess, @"Should remove from the file");
+        XCTAssertEqual(FSHandleWriteFromOffset(Handle, 3, 2, (uint8_t[2]){ 4, 5 }, FSBehaviourDefault | FSWritingBehaviourInsert), FSOperationSuccess, @"Should insert in the file");
+        //1 2 3 4 5 6 7 8 9 10
+        
+        XCTAssertEqual(FSHandleWriteFromOffset(Handle, 10, 2, (uint8_t[2]){ 11, 12 }, FSBehaviourDefault), FSOperationSuccess, @"Should write to the file");
+        
+        XCTAssertEqual(FSHandleClose(Handle), FSOperationSuccess, @"Should close the file");
+        
+        
+        XCTAssertEqual(FSHandleOpen(path, FSHandleTypeRead, &Handle), FSOperationSuccess, @"Should open the file");
+        
+        Read = 20;
+        XCTAssertEqual(FSHandleRead(Handle, &Read, Values, FSBehaviourDefault), FSOperationSuccess, @"Should read the file");
+        XCTAssertEqual(Read, 12, @"Should read the correct number of bytes");
+        for (size_t Index = 0; Index < 12; Index++) XCTAssertEqual(Values[Index], Index + 1, @"Should read the correct value");
+        
+        XCTAssertEqual(FSHandleClose(Handle), FSOperationSuccess, @"Should close the file");
+    }
+}
+
 @end
@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <XCTest/XCTest.h>
+#import "FileIOQueue.h"
+#import "FileHandle.h"
+#import "FileSystem.h"
+#import "EpochGarbageCollector.h"
+#import "MemoryAllocation.h"
+
+#define FILE_SIZE (16 * 1024 * 1024)
+#define BLOCK_SIZE 4096
+
+@interface FileIOQueueTests : XCTestCase
+
+@end
+
+@implementation FileIOQueueTests
+{
+    FSPath path;
+}
+
+-(void) setUp
+{
+    [super setUp];
+    
+    path = FSPathCreate("commonc-framework/");
+    FSManagerRemove(path);
+    
+    FSPathAppendComponent(path, FSPathComponentCreate(FSPathComponentTypeFile, "io"));
+    FSPathAppendComponent(path, FSPathComponentCreate(FSPathComponentTypeExtension, "bin"));
+    
+    FSManagerCreate(path, TRUE);
+    
+    FSHandle Handle;
+    if (FSHandleOpen(path, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+    {
+        uint8_t *Values = CCMalloc(CC_STD_ALLOCATOR, FILE_SIZE, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        for (size_t Loop = 0; Loop < FILE_SIZE; Loop++) Values[Loop] = (uint8_t)(Loop % 251);
+        
+        FSHandleWrite(Handle, FILE_SIZE, Values, FSBehaviourDefault);
+        FSHandleClose(Handle);
+        CCFree(Values);
+    }
+}
+
+-(void) tearDown
+{
+    [super tearDown];
+    
+    FSPathRemoveComponentLast(path);
+    FSPathRemoveComponentLast(path);
+    
+    FSManagerRemove(path);
+    
+    FSPathDestroy(path);
+}
+
+static void Completion(FSIORequest *Request)
+{
+    (*(int*)Request->context)++;
+}
+
+-(void) testReading
+{
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(path, FSHandleTypeRead | FSHandleTypeUnbuffered, &Handle), FSOperationSuccess, @"Should open the file");
+    
+    FSIOQueue Queue = FSIOQueueCreate(CC_STD_ALLOCATOR, 8, 0);
+    
+    static uint8_t Buffers[64][BLOCK_SIZE];
+    FSIORequest Requests[64], *Pending[64];
+    int Completed = 0;
+    
+    for (size_t Loop = 0; Loop < 64; Loop++)
+    {
+        Requests[Loop] = (FSIORequest){
+            .type = FSIORequestTypeRead,
+            .handle = Handle,
+            .offset = (Loop * BLOCK_SIZE) + 7,
+            .size = BLOCK_SIZE,
+            .buffer = Buffers[Loop],
+            .completion = Completion,
+            .context = &Completed
+        };
+        Pending[Loop] = &Requests[Loop];
+    }
+    
+    for (size_t Submitted = 0; Submitted < 64; FSIOQueuePoll(Queue, 1))
+    {
+        const size_t Count = FSIOQueueSubmit(Queue, Pending + Submitted, 64 - Submitted);
+        XCTAssertLessThanOrEqual(FSIOQueueGetPendingCount(Queue), 8, @"Should not exceed the depth of the queue");
+        
+        Submitted += Count;
+    }
+    
+    while (FSIOQueueGetPendingCount(Queue)) FSIOQueuePoll(Queue, 1);
+    
+    XCTAssertEqual(Completed, 64, @"Should invoke the completion of every request");
+    
+    _Bool Match = TRUE;
+    for (size_t Loop = 0; Loop < 64; Loop++)
+    {
+        XCTAssertTrue(FSIORequestIsFinished(&Requests[Loop]), @"Should finish the request");
+        XCTAssertEqual(Requests[Loop].result, FSOperationSuccess, @"Should read the file");
+        XCTAssertEqual(Requests[Loop].transferred, BLOCK_SIZE, @"Should read the correct number of bytes");
+        
+        for (size_t Index = 0; Index < BLOCK_SIZE; Index++) Match &= Buffers[Loop][Index] == (uint8_t)(((Loop * BLOCK_SIZE) + 7 + Index) % 251);
+    }
+    
+    XCTAssertTrue(Match, @"Should read the correct values");
+    
+    FSIORequest Request = { .type = FSIORequestTypeRead, .handle = Handle, .offset = FILE_SIZE - 10, .size = 100, .buffer = Buffers[0] };
+    XCTAssertEqual(FSIOQueueSubmit(Queue, (FSIORequest*[1]){ &Request }, 1), 1, @"Should submit the request");
+    
+    FSIOQueueWait(Queue, &Request);
+    XCTAssertEqual(Request.result, FSOperationSuccess, @"Should read the file");
+    XCTAssertEqual(Request.transferred, 10, @"Should stop at the end of the file");
+    
+    FSIOQueueDestroy(Queue);
+    FSHandleClose(Handle);
+}
+
+static void CompletionTask(const void *In, void *Out)
+{
+    **(FSOperation**)In = FSOperationSuccess;
+}
+
+-(void) testWriting
+{
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(path, FSHandleTypeUpdate | FSHandleTypeUnbuffered, &Handle), FSOperationSuccess, @"Should open the file");
+    
+    FSIOQueue Queue = FSIOQueueCreate(CC_STD_ALLOCATOR, 4, 0);
+    CCTaskQueue TaskQueue = CCTaskQueueCreate(CC_STD_ALLOCATOR, CCTaskQueueExecuteSerially, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, CCEpochGarbageCollector));
+    
+    FSOperation Resumed = FSOperationFailure;
+    FSIORequest Write = {
+        .type = FSIORequestTypeWrite,
+        .handle = Handle,
+        .offset = 5,
+        .size = 5,
+        .buffer = "hello",
+        .task = CCTaskCreate(CC_STD_ALLOCATOR, CompletionTask, 0, NULL, sizeof(FSOperation*), &(FSOperation*){ &Resumed }, NULL),
+        .taskQueue = TaskQueue
+    };
+    FSIORequest Sync = { .type = FSIORequestTypeSync, .handle = Handle };
+    
+    XCTAssertEqual(FSIOQueueSubmit(Queue, (FSIORequest*[2]){ &Write, &Sync }, 2), 2, @"Should submit the requests");
+    
+    FSIOQueueWait(Queue, &Write);
+    FSIOQueueWait(Queue, &Sync);
+    
+    XCTAssertEqual(Write.result, FSOperationSuccess, @"Should write to the file");
+    XCTAssertEqual(Write.transferred, 5, @"Should write the correct number of bytes");
+    XCTAssertEqual(Sync.result, FSOperationSuccess, @"Should sync the file");
+    
+    CCTask Task = CCTaskQueuePop(TaskQueue);
+    XCTAssertTrue(Task != NULL, @"Should push the task once the request has finished");
+    
+    CCTaskRun(Task);
+    CCTaskDestroy(Task);
+    XCTAssertEqual(Resumed, FSOperationSuccess, @"Should run the task");
+    
+    char Values[5];
+    size_t Read = sizeof(Values);
+    FSHandleReadFromOffset(Handle, 5, &Read, Values, FSBehaviourDefault);
+    XCTAssertTrue(!strncmp(Values, "hello", 5), @"Should write the correct values");
+    
+    CCTaskQueueDestroy(TaskQueue);
+    FSIOQueueDestroy(Queue);
+    FSHandleClose(Handle);
+}
+
+-(void) measureQueueDepth: (size_t)depth
+{
+    FSHandle Handle;
+    FSHandleOpen(path, FSHandleTypeRead | FSHandleTypeDirect, &Handle);
+    
+    const size_t Count = FILE_SIZE / BLOCK_SIZE;
+    uint8_t *Buffers = CCMalloc(CC_ALIGNED_ALLOCATOR(BLOCK_SIZE), depth * BLOCK_SIZE, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    FSIORequest *Requests = CCMalloc(CC_STD_ALLOCATOR, sizeof(FSIORequest) * depth, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    FSIOQueue Queue = FSIOQueueCreate(CC_STD_ALLOCATOR, depth, 0);
+    
+    [self measureBlock: ^{
+        size_t Next = 0, Slot = 0;
+        
+        //Keep the queue full by resubmitting each slot as it finishes, reading blocks in a scattered order
+        while ((Next < Count) || (FSIOQueueGetPendingCount(Queue)))
+        {
+            for ( ; (Next < Count) && (FSIOQueueGetPendingCount(Queue) < depth); Next++, Slot = (Slot + 1) % depth)
+            {
+                while ((Next >= depth) && (!FSIORequestIsFinished(&Requests[Slot]))) FSIOQueuePoll(Queue, 1);
+                
+                Requests[Slot] = (FSIORequest){
+                    .type = FSIORequestTypeRead,
+                    .handle = Handle,
+                    .offset = ((Next * 7919) % Count) * BLOCK_SIZE,
+                    .size = BLOCK_SIZE,
+                    .buffer = Buffers + (Slot * BLOCK_SIZE)
+                };
+                
+                FSIOQueueSubmit(Queue, (FSIORequest*[1]){ &Requests[Slot] }, 1);
+            }
+            
+            FSIOQueuePoll(Queue, 1);
+        }
+    }];
+    
+    FSIOQueueDestroy(Queue);
+    CCFree(Requests);
+    CCFree(Buffers);
+    FSHandleClose(Handle);
+}
+
+-(void) testQueueDepth1Performance
+{
+    [self measureQueueDepth: 1];
+}
+
+-(void) testQueueDepth2Performance
+{
+    [self measureQueueDepth: 2];
+}
+
+-(void) testQueueDepth4Performance
+{
+    [self measureQueueDepth: 4];
+}
+
+-(void) testQueueDepth8Performance
+{
+    [self measureQueueDepth: 8];
+}
+
+-(void) testQueueDepth16Performance
+{
+    [self measureQueueDepth: 16];
+}
+
+-(void) testQueueDepth32Performance
+{
+    [self measureQueueDepth: 32];
+}
+
+-(void) testQueueDepth64Performance
+{
+    [self measureQueueDepth: 64];
+}
+
+-(void) testQueueDepth128Performance
+{
+    [self measureQueueDepth: 128];
+}
+
+@end
@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <XCTest/XCTest.h>
+#import "FileReader.h"
+#import "FileHandle.h"
+#import "FileSystem.h"
+#import "MemoryAllocation.h"
+
+#define LINE_COUNT 100000
+#define RECORD_COUNT 2000
+
+@interface FileReaderTests : XCTestCase
+
+@end
+
+@implementation FileReaderTests
+{
+    FSPath path;
+}
+
+-(void) setUp
+{
+    [super setUp];
+    
+    path = FSPathCreate("commonc-framework/");
+    FSManagerRemove(path);
+    
+    FSPathAppendComponent(path, FSPathComponentCreate(FSPathComponentTypeFile, "reader"));
+    FSPathAppendComponent(path, FSPathComponentCreate(FSPathComponentTypeExtension, "txt"));
+    
+    FSManagerCreate(path, TRUE);
+}
+
+-(void) tearDown
+{
+    [super tearDown];
+    
+    FSPathRemoveComponentLast(path);
+    FSPathRemoveComponentLast(path);
+    
+    FSManagerRemove(path);
+    
+    FSPathDestroy(path);
+}
+
+-(void) write: (const void*)data OfSize: (size_t)size
+{
+    FSHandle Handle;
+    if (FSHandleOpen(path, FSHandleTypeWrite, &Handle) == FSOperationSuccess)
+    {
+        FSHandleWrite(Handle, size, data, FSBehaviourDefault);
+        FSHandleClose(Handle);
+    }
+}
+
+-(void) testReadingLines
+{
+    char *Lines = CCMalloc(CC_STD_ALLOCATOR, LINE_COUNT * 32, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    size_t Size = 0;
+    for (size_t Loop = 0; Loop < LINE_COUNT; Loop++) Size += sprintf(Lines + Size, "line %zu%s", Loop, Loop % 2 ? "\r\n" : "\n");
+    
+    [self write: Lines OfSize: Size - 1];
+    CCFree(Lines);
+    
+    const struct { FSHandleType type; size_t size; FSReaderHint hint; } Configurations[] = {
+        { FSHandleTypeRead, 0, FSReaderHintDefault },
+        { FSHandleTypeRead | FSHandleTypeUnbuffered, 5, FSReaderHintDefault },
+        { FSHandleTypeRead, 0, FSReaderHintReadAhead },
+        { FSHandleTypeRead | FSHandleTypeUnbuffered, 5, FSReaderHintReadAhead }
+    };
+    
+    for (size_t Config = 0; Config < sizeof(Configurations) / sizeof(typeof(*Configurations)); Config++)
+    {
+        FSHandle Handle;
+        XCTAssertEqual(FSHandleOpen(path, Configurations[Config].type, &Handle), FSOperationSuccess, @"Should open the file");
+        
+        FSReader Reader = FSReaderCreate(CC_STD_ALLOCATOR, Handle, Configurations[Config].size, Configurations[Config].hint);
+        
+        void *Retained = NULL;
+        FSReaderView First;
+        
+        size_t Count = 0;
+        _Bool Match = TRUE;
+        for (FSReaderView View; FSReaderReadLine(Reader, &View); Count++)
+        {
+            char Expected[32];
+            const int Length = snprintf(Expected, sizeof(Expected), "line %zu", Count);
+            
+            Match &= (View.size == Length) && !memcmp(View.data, Expected, Length);
+            
+            if (!Count)
+            {
+                Retained = FSReaderRetainBuffer(Reader);
+                First = View;
+            }
+        }
+        
+        XCTAssertEqual(FSReaderGetResult(Reader), FSOperationSuccess, @"Should read all the lines");
+        XCTAssertEqual(Count, LINE_COUNT, @"Should read all the lines");
+        XCTAssertTrue(Match, @"Should read the correct lines");
+        
+        CCString String = FSReaderViewCreateString(First, CCStringEncodingASCII);
+        XCTAssertTrue(CCStringEqual(String, CC_STRING("line 0")), @"Should keep the retained view valid");
+        CCStringDestroy(String);
+        CCFree(Retained);
+        
+        FSReaderDestroy(Reader);
+        FSHandleClose(Handle);
+    }
+}
+
+-(void) testReadingRecords
+{
+    uint8_t *Records = CCMalloc(CC_STD_ALLOCATOR, RECORD_COUNT * (RECORD_COUNT + 4), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    size_t Size = 0;
+    for (size_t Loop = 0; Loop < RECORD_COUNT; Loop++)
+    {
+        Records[Size++] = (uint8_t)(Loop >> 8);
+        Records[Size++] = (uint8_t)Loop;
+        memset(Records + Size, (uint8_t)Loop, Loop);
+        Size += Loop;
+    }
+    
+    Records[Size++] = 0xff;
+    [self write: Records OfSize: Size];
+    CCFree(Records);
+    
+    for (int Hint = FSReaderHintDefault; Hint <= FSReaderHintReadAhead; Hint++)
+    {
+        FSHandle Handle;
+        XCTAssertEqual(FSHandleOpen(path, FSHandleTypeRead, &Handle), FSOperationSuccess, @"Should open the file");
+        
+        FSReader Reader = FSReaderCreate(CC_STD_ALLOCATOR, Handle, 256, Hint);
+        
+        size_t Count = 0;
+        _Bool Match = TRUE;
+        for (FSReaderView View; FSReaderReadRecord(Reader, FSReaderRecordLength16 | FSReaderRecordBigEndian, &View); Count++)
+        {
+            Match &= View.size == Count;
+            for (size_t Loop = 0; Loop < View.size; Loop++) Match &= (uint8_t)View.data[Loop] == (uint8_t)Count;
+        }
+        
+        XCTAssertEqual(Count, RECORD_COUNT, @"Should read all the complete records");
+        XCTAssertTrue(Match, @"Should read the correct records");
+        XCTAssertEqual(FSReaderGetResult(Reader), FSOperationFailure, @"Should fail on the truncated record");
+        
+        FSReaderDestroy(Reader);
+        FSHandleClose(Handle);
+    }
+}
+
+@end
@@ -28,6 +28,21 @@
 #import "Path.h"
 #import "FileHandle.h"
 #import "TypeCallbacks.h"
+#import "MemoryAllocation.h"
+#import <stdatomic.h>
+#import <unistd.h>
+#import <sys/stat.h>
+
+typedef struct {
+    _Atomic(size_t) files, directories, limit;
+} FileSystemEnumerationCount;
+
+static _Bool EnumerationCounter(const FSManagerEntry *Entry, FileSystemEnumerationCount *Count)
+{
+    atomic_fetch_add(Entry->directory ? &Count->directories : &Count->files, 1);
+    
+    return atomic_fetch_sub(&Count->limit, 1) > 1;
+}
 
 @interface FileSystemTests : XCTestCase
 
@@ -231,6 +246,115 @@
     FSPathDestroy(Destination);
 }
 
+-(void) testCopyingTree
+{
+    const size_t Sizes[] = { 0, 1, 4096, (1024 * 1024 * 3) + 7 };
+    
+    FSPath Source = FSPathCopy(testFolder);
+    FSPathAppendComponent(Source, FSPathComponentCreate(FSPathComponentTypeDirectory, "tree"));
+    
+    uint8_t *Values = CCMalloc(CC_STD_ALLOCATOR, Sizes[3], NULL, CC_DEFAULT_ERROR_CALLBACK);
+    for (size_t Loop = 0; Loop < Sizes[3]; Loop++) Values[Loop] = (uint8_t)(Loop * 31);
+    
+    for (size_t Loop = 0; Loop < sizeof(Sizes) / sizeof(*Sizes); Loop++)
+    {
+        char Name[32];
+        snprintf(Name, sizeof(Name), "file%zu", Loop);
+        
+        FSPath File = FSPathCopy(Source);
+        if (Loop & 1) FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, "nested"));
+        FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeFile, Name));
+        
+        XCTAssertEqual(FSManagerCreate(File, TRUE), FSOperationSuccess, @"Should create the file");
+        
+        FSHandle Handle;
+        XCTAssertEqual(FSHandleOpen(File, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the file");
+        if (Sizes[Loop]) FSHandleWrite(Handle, Sizes[Loop], Values, FSBehaviourDefault);
+        FSHandleClose(Handle);
+        
+        FSPathDestroy(File);
+    }
+    
+    FSPath Destination = FSPathCopy(testFolder);
+    FSPathAppendComponent(Destination, FSPathComponentCreate(FSPathComponentTypeDirectory, "tree-copy"));
+    
+    XCTAssertEqual(FSManagerCopy(Source, Destination), FSOperationSuccess, @"Should copy the tree");
+    
+    uint8_t *Copy = CCMalloc(CC_STD_ALLOCATOR, Sizes[3], NULL, CC_DEFAULT_ERROR_CALLBACK);
+    for (size_t Loop = 0; Loop < sizeof(Sizes) / sizeof(*Sizes); Loop++)
+    {
+        char Name[32];
+        snprintf(Name, sizeof(Name), "file%zu", Loop);
+        
+        FSPath File = FSPathCopy(Destination);
+        if (Loop & 1) FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, "nested"));
+        FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeFile, Name));
+        
+        XCTAssertTrue(FSManagerExists(File), @"File should be copied");
+        
+        FSHandle Handle;
+        XCTAssertEqual(FSHandleOpen(File, FSHandleTypeRead, &Handle), FSOperationSuccess, @"Should open the copy");
+        XCTAssertEqual(FSManagerGetSize(File), Sizes[Loop], @"Should copy the entire file");
+        
+        size_t Count = Sizes[Loop];
+        if (Count) FSHandleRead(Handle, &Count, Copy, FSBehaviourDefault);
+        XCTAssertEqual(Count, Sizes[Loop], @"Should read the entire copy");
+        XCTAssertFalse(memcmp(Copy, Values, Count), @"Should copy the contents");
+        FSHandleClose(Handle);
+        
+        FSPathDestroy(File);
+    }
+    
+    CCFree(Copy);
+    CCFree(Values);
+    
+    FSPathDestroy(Source);
+    FSPathDestroy(Destination);
+}
+
+-(void) testCopyingCyclicLink
+{
+    FSPath Source = FSPathCopy(testFolder);
+    FSPathAppendComponent(Source, FSPathComponentCreate(FSPathComponentTypeDirectory, "cycle"));
+    FSPathAppendComponent(Source, FSPathComponentCreate(FSPathComponentTypeDirectory, "a"));
+    FSPathAppendComponent(Source, FSPathComponentCreate(FSPathComponentTypeFile, "file"));
+    
+    XCTAssertEqual(FSManagerCreate(Source, TRUE), FSOperationSuccess, @"Should create the file");
+    FSPathRemoveComponentLast(Source);
+    
+    char Link[PATH_MAX];
+    snprintf(Link, sizeof(Link), "%sloop", FSPathGetPathString(Source));
+    XCTAssertFalse(symlink("..", Link), @"Should create the link");
+    
+    FSPathRemoveComponentLast(Source);
+    
+    FSPath Destination = FSPathCopy(testFolder);
+    FSPathAppendComponent(Destination, FSPathComponentCreate(FSPathComponentTypeDirectory, "cycle-copy"));
+    
+    XCTAssertEqual(FSManagerCopy(Source, Destination), FSOperationSuccess, @"Should copy the tree without following the cycle");
+    
+    FSPath File = FSPathCopy(Destination);
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, "a"));
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeFile, "file"));
+    XCTAssertTrue(FSManagerExists(File), @"File should be copied");
+    FSPathRemoveComponentLast(File);
+    
+    snprintf(Link, sizeof(Link), "%sloop", FSPathGetPathString(File));
+    
+    struct stat Info;
+    XCTAssertFalse(lstat(Link, &Info), @"Link should be copied");
+    XCTAssertTrue(S_ISLNK(Info.st_mode), @"Link should be recreated as a link");
+    
+    char Target[PATH_MAX];
+    const ssize_t Length = readlink(Link, Target, sizeof(Target) - 1);
+    XCTAssertEqual(Length, 2, @"Link should keep its target");
+    XCTAssertFalse(strncmp(Target, "..", 2), @"Link should keep its target");
+    
+    FSPathDestroy(File);
+    FSPathDestroy(Source);
+    FSPathDestroy(Destination);
+}
+
 -(void) testRenaming
 {
     FSPath File = FSPathCopy(testFolder);
@@ -305,6 +429,50 @@
     FSPathDestroy(File);
 }
 
+-(void) testFileInfo
+{
+    FSPath File = FSPathCopy(testFolder);
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeFile, "test"));
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeExtension, "txt"));
+    
+    FSFileInfo Info;
+    XCTAssertEqual(FSManagerGetInfo(File, &Info), FSOperationPathNotExist, @"File should not exist");
+    
+    XCTAssertEqual(FSManagerGetInfo(testFolder, &Info), FSOperationSuccess, @"Should retrieve the info");
+    XCTAssertTrue(Info.directory, @"Should be a directory");
+    
+    XCTAssertEqual(FSManagerCreate(File, FALSE), FSOperationSuccess, @"Should be created as well");
+    
+    uint8_t Data[128];
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(File, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open file");
+    XCTAssertEqual(FSHandleWrite(Handle, sizeof(Data), Data, FSBehaviourDefault), FSOperationSuccess, @"Should write data to file");
+    XCTAssertEqual(FSHandleClose(Handle), FSOperationSuccess, @"Should close file");
+    
+    XCTAssertEqual(FSManagerGetInfo(File, &Info), FSOperationSuccess, @"Should retrieve the info");
+    XCTAssertFalse(Info.directory, @"Should be a file");
+    XCTAssertEqual(Info.size, sizeof(Data), @"Should be the correct size");
+    XCTAssertEqual(Info.blockSize, FSManagerGetPreferredIOBlockSize(File), @"Should be the preferred block size");
+    XCTAssertEqual(Info.access, FSManagerGetAccessRights(File), @"Should have the same access rights");
+    XCTAssertNotEqual(Info.modified, 0, @"Should have a modification time");
+    
+    FSManagerSetInfoCacheTTL(10ULL * 1000000000);
+    
+    XCTAssertTrue(FSManagerExists(File), @"File should exist");
+    XCTAssertEqual(FSManagerGetSize(File), sizeof(Data), @"Should be the correct size");
+    
+    XCTAssertEqual(FSManagerRemove(File), FSOperationSuccess, @"Should remove the file");
+    XCTAssertFalse(FSManagerExists(File), @"Should not use the cached info after the file is removed");
+    
+    XCTAssertEqual(FSManagerCreate(File, FALSE), FSOperationSuccess, @"Should be created as well");
+    XCTAssertTrue(FSManagerExists(File), @"Should not use the cached info after the file is created");
+    XCTAssertEqual(FSManagerGetSize(File), 0, @"Should be empty");
+    
+    FSManagerSetInfoCacheTTL(0);
+    
+    FSPathDestroy(File);
+}
+
 -(void) testFileSearch
 {
     FSPath File = FSPathCopy(testFolder);
@@ -564,4 +732,78 @@
     FSPathDestroy(File);
 }
 
+
+-(void) testFileEnumeration
+{
+    FSPath File = FSPathCopy(testFolder);
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, "example"));
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, "blah"));
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeFile, "blah"));
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeExtension, "txt"));
+    
+    XCTAssertEqual(FSManagerCreate(File, TRUE), FSOperationSuccess, @"Should be created as well");
+    
+    FSPathRemoveComponentLast(File);
+    FSPathRemoveComponentLast(File);
+    FSPathRemoveComponentLast(File);
+    
+    for (size_t Loop = 0; Loop < 100; Loop++)
+    {
+        char Name[32];
+        snprintf(Name, sizeof(Name), "test%zu", Loop);
+        
+        FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, Name));
+        FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeFile, "test"));
+        FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeExtension, (Loop & 1) ? "txt" : "bin"));
+        
+        FSManagerCreate(File, TRUE);
+        
+        FSPathRemoveComponentLast(File);
+        FSPathRemoveComponentLast(File);
+        FSPathRemoveComponentLast(File);
+    }
+    
+    /*
+     example/
+     ├── blah/
+     │   └── blah.txt
+     ├── test0/
+     │   └── test.bin
+     ├── test1/
+     │   └── test.txt
+     ...
+     └── test99/
+         └── test.txt
+     */
+    
+    FileSystemEnumerationCount Count = { .limit = SIZE_MAX };
+    XCTAssertEqual(FSManagerEnumerateContentsAtPath(File, NULL, FSMatchDefault, (FSManagerEnumerator)EnumerationCounter, &Count), FSOperationSuccess, @"Should enumerate the path");
+    XCTAssertEqual(Count.directories, 101, @"Should find all folders in example/");
+    XCTAssertEqual(Count.files, 0, @"Should not find any files in example/");
+    
+    Count = (FileSystemEnumerationCount){ .limit = SIZE_MAX };
+    XCTAssertEqual(FSManagerEnumerateContentsAtPath(File, NULL, FSMatchSearchRecursively, (FSManagerEnumerator)EnumerationCounter, &Count), FSOperationSuccess, @"Should enumerate the path");
+    XCTAssertEqual(Count.directories, 101, @"Should find all folders in example/ and its subfolders");
+    XCTAssertEqual(Count.files, 101, @"Should find all files in example/ and its subfolders");
+    
+    CCCollection Paths = CCCollectionCreate(CC_STD_ALLOCATOR, CCCollectionHintSizeSmall, sizeof(FSPath), FSPathDestructorForCollection);
+    CCCollectionInsertElement(Paths, &(FSPath){ FSPathCreate("*.txt") });
+    Count = (FileSystemEnumerationCount){ .limit = SIZE_MAX };
+    XCTAssertEqual(FSManagerEnumerateContentsAtPath(File, Paths, FSMatchSearchRecursively, (FSManagerEnumerator)EnumerationCounter, &Count), FSOperationSuccess, @"Should enumerate the path");
+    CCCollectionDestroy(Paths);
+    
+    XCTAssertEqual(Count.directories, 0, @"Should not find any folders that match *.txt");
+    XCTAssertEqual(Count.files, 51, @"Should find all files that match *.txt in example/ and its subfolders");
+    
+    Count = (FileSystemEnumerationCount){ .limit = 10 };
+    XCTAssertEqual(FSManagerEnumerateContentsAtPath(File, NULL, FSMatchSearchRecursively, (FSManagerEnumerator)EnumerationCounter, &Count), FSOperationSuccess, @"Should enumerate the path");
+    XCTAssertGreaterThanOrEqual(Count.directories + Count.files, 10, @"Should enumerate until the callback returns FALSE");
+    XCTAssertLessThan(Count.directories + Count.files, 202, @"Should stop enumerating once the callback returns FALSE");
+    
+    FSPathAppendComponent(File, FSPathComponentCreate(FSPathComponentTypeDirectory, "missing"));
+    XCTAssertEqual(FSManagerEnumerateContentsAtPath(File, NULL, FSMatchDefault, (FSManagerEnumerator)EnumerationCounter, &Count), FSOperationPathNotExist, @"Should fail to enumerate a missing path");
+    
+    FSPathDestroy(File);
+}
+
 @end
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import "ConcurrentIDGenerator.h"
+#import "GrowableIDGenerator.h"
+#import <stdatomic.h>
+#import <pthread.h>
+
+@interface GrowableIDGeneratorTests : XCTestCase
+
+@end
+
+@implementation GrowableIDGeneratorTests
+
+-(void) testGrowing
+{
+    CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 4, CCGrowableIDGenerator);
+    
+    XCTAssertEqual(4, CCConcurrentIDGeneratorGetMaxID(Pool), @"Should return the initial size");
+    
+    uint8_t *Assigned = calloc(10000, sizeof(uint8_t));
+    _Bool Unique = TRUE;
+    for (size_t Loop = 0; Loop < 10000; Loop++)
+    {
+        uintptr_t ID;
+        if (!CCConcurrentIDGeneratorTryAssign(Pool, &ID))
+        {
+            Unique = FALSE;
+            break;
+        }
+        
+        if (ID < 10000)
+        {
+            Unique &= !Assigned[ID];
+            Assigned[ID] = 1;
+        }
+    }
+    
+    _Bool Consecutive = TRUE;
+    for (size_t Loop = 0; Loop < 10000; Loop++) Consecutive &= Assigned[Loop];
+    
+    free(Assigned);
+    
+    XCTAssertTrue(Unique, @"Should not assign any ID more than once");
+    XCTAssertTrue(Consecutive, @"Should assign IDs from the start of the ID space");
+    XCTAssertGreaterThanOrEqual(CCConcurrentIDGeneratorGetMaxID(Pool), 10000, @"Should grow the ID space");
+    
+    CCConcurrentIDGeneratorDestroy(Pool);
+}
+
+-(void) testRecycling
+{
+    CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 16, CCGrowableIDGenerator);
+    
+    uintptr_t ID[100];
+    for (size_t Loop = 0; Loop < 100; Loop++) ID[Loop] = CCConcurrentIDGeneratorAssign(Pool);
+    
+    const uintptr_t MaxID = CCConcurrentIDGeneratorGetMaxID(Pool);
+    
+    for (size_t Loop = 0; Loop < 100; Loop++) CCConcurrentIDGeneratorRecycle(Pool, ID[Loop]);
+    
+    _Bool Reused = TRUE;
+    for (size_t Loop = 0; Loop < 100; Loop++) Reused &= CCConcurrentIDGeneratorAssign(Pool) < MaxID;
+    
+    XCTAssertTrue(Reused, @"Should reuse the recycled IDs");
+    XCTAssertEqual(CCConcurrentIDGeneratorGetMaxID(Pool), MaxID, @"Should not grow while recycled IDs are available");
+    
+    CCConcurrentIDGeneratorDestroy(Pool);
+}
+
+#define THREAD_COUNT 20
+#define IDS_PER_THREAD 500
+#define ID_POOL (IDS_PER_THREAD * THREAD_COUNT)
+
+static CCConcurrentIDGenerator P;
+static _Atomic(int) Owners[ID_POOL * 2];
+static _Atomic(size_t) ConflictCount = ATOMIC_VAR_INIT(0);
+static void *Worker(void *Arg)
+{
+    uintptr_t ID[IDS_PER_THREAD];
+    for (size_t Loop = 0; Loop < 100; Loop++)
+    {
+        const size_t Count = (Loop * 37) % IDS_PER_THREAD;
+        for (size_t Loop2 = 0; Loop2 < Count; Loop2++)
+        {
+            ID[Loop2] = CCConcurrentIDGeneratorAssign(P);
+            
+            if ((ID[Loop2] >= (ID_POOL * 2)) || (atomic_fetch_add_explicit(&Owners[ID[Loop2]], 1, memory_order_relaxed))) atomic_fetch_add_explicit(&ConflictCount, 1, memory_order_relaxed);
+        }
+        
+        for (size_t Loop2 = 0; Loop2 < Count; Loop2++)
+        {
+            if (ID[Loop2] < (ID_POOL * 2)) atomic_fetch_sub_explicit(&Owners[ID[Loop2]], 1, memory_order_relaxed);
+            
+            CCConcurrentIDGeneratorRecycle(P, ID[Loop2]);
+        }
+    }
+    
+    return NULL;
+}
+
+-(void) testMultiThreading
+{
+    atomic_store(&ConflictCount, 0);
+    P = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 16, CCGrowableIDGenerator);
+    
+    pthread_t Threads[THREAD_COUNT];
+    for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+    {
+        pthread_create(Threads + Loop, NULL, Worker, NULL);
+    }
+    
+    for (int Loop = 0; Loop < THREAD_COUNT; Loop++)
+    {
+        pthread_join(Threads[Loop], NULL);
+    }
+    
+    XCTAssertEqual(atomic_load(&ConflictCount), 0, @"Should not assign any ID more than once, or grow beyond the IDs in use");
+    
+    CCConcurrentIDGeneratorDestroy(P);
+}
+
+@end
@@ -25,6 +25,70 @@
 
 #import "LoggingTests.h"
 #import "Logging.h"
+#import "FileSystem.h"
+#import "FileHandle.h"
+#import "MemoryAllocation.h"
+#import "CCString.h"
+#import <pthread.h>
+
+#define ASYNC_THREADS 4
+#define ASYNC_MESSAGES 5000
+
+static void *AsyncLogger(void *Thread)
+{
+    for (size_t Loop = 0; Loop < ASYNC_MESSAGES; Loop++) CCLog(CCLogOptionOutputFile | CCLogOptionAsync, CCTagInfo, NULL, NULL, NULL, 0, "async-test %zu %zu", (size_t)Thread, Loop);
+    
+    return NULL;
+}
+
+static int Evaluated = 0;
+
+static int EvaluateArgument(void)
+{
+    return ++Evaluated;
+}
+
+#define FILTER_THREADS 2
+#define FILTER_COUNT 100
+
+static atomic_size_t FilterCalls = ATOMIC_VAR_INIT(0);
+
+static size_t CountingFilter(const CCLogData *LogData, const CCLogMessageData *Data)
+{
+    atomic_fetch_add_explicit(&FilterCalls, 1, memory_order_relaxed);
+    
+    return 0;
+}
+
+static void *FilterRegistration(void *Thread)
+{
+    for (size_t Loop = 0; Loop < FILTER_COUNT; Loop++) CCLogAddFilter(CCLogFilterMessage, (CCLogFilter)CountingFilter);
+    
+    return NULL;
+}
+
+static void *BinaryLogger(void *Thread)
+{
+    for (size_t Loop = 0; Loop < ASYNC_MESSAGES; Loop++)
+    {
+        static CCLogBinarySite Site;
+        CCLogBinary(&Site, CCLogOptionOutputFile | CCLogOptionAsync, CCTagInfo, NULL, NULL, NULL, 0, "binary-test %zu %zu %s %.1f", (size_t)Thread, Loop, "value", 1.5);
+    }
+    
+    return NULL;
+}
+
+static void *MixedLogger(void *Thread)
+{
+    for (size_t Loop = 0; Loop < ASYNC_MESSAGES; Loop++)
+    {
+        static CCLogBinarySite Site;
+        if (Loop % 3) CCLogBinary(&Site, CCLogOptionOutputFile | CCLogOptionAsync, CCTagInfo, NULL, NULL, NULL, 0, "mixed-test %zu %zu", (size_t)Thread, Loop);
+        else CCLog(CCLogOptionOutputFile | CCLogOptionAsync, CCTagInfo, NULL, NULL, NULL, 0, "mixed-test %zu %zu", (size_t)Thread, Loop);
+    }
+    
+    return NULL;
+}
 
 
 @implementation LoggingTests
@@ -36,4 +100,337 @@
      */
 }
 
+-(void) testFileOutput
+{
+    FSPath Path = FSPathCreate("commonc-framework/logging/file.log");
+    FSManagerRemove(Path);
+    FSManagerCreate(Path, TRUE);
+    
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the log file");
+    FSHandleWrite(Handle, 7, "header\n", FSBehaviourUpdateOffset);
+    CCLogAddFile(Handle);
+    
+    for (int Loop = 0; Loop < 3; Loop++) CCLog(CCLogOptionOutputFile, CCTagInfo, NULL, "file.c", "function", 10, "file-test %d", Loop);
+    
+    FSHandle Reader;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeRead, &Reader), FSOperationSuccess, @"Should open the log file");
+    
+    size_t Size = FSManagerGetSize(Path);
+    char *Log = CCMalloc(CC_STD_ALLOCATOR, Size + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    FSHandleRead(Reader, &Size, Log, FSBehaviourDefault);
+    FSHandleClose(Reader);
+    Log[Size] = 0;
+    
+    XCTAssertTrue(!strncmp(Log, "header\n", 7), @"Should write after the existing contents");
+    
+    const char *Line = Log + 7;
+    for (int Loop = 0; Loop < 3; Loop++)
+    {
+        const char *End = strchr(Line, '\n');
+        XCTAssertTrue(End != NULL, @"Should end each message with a newline");
+        if (!End) break;
+        
+        char Expected[64];
+        const size_t Length = snprintf(Expected, sizeof(Expected), "]: INFO:[file.c:10]:function: file-test %d", Loop);
+        XCTAssertTrue((End - Line > Length) && (!strncmp(End - Length, Expected, Length)), @"Should prefix the message with the timestamp, host and process");
+        
+        Line = End + 1;
+    }
+    
+    CCFree(Log);
+    FSPathDestroy(Path);
+}
+
+-(void) testRotatingFileOutput
+{
+    FSPath Directory = FSPathCreate("commonc-framework/logging/rotating/");
+    FSManagerRemove(Directory);
+    FSManagerCreate(Directory, TRUE);
+    
+    FSPath Path = FSPathCreate("commonc-framework/logging/rotating/rotating.log");
+    XCTAssertTrue(CCLogAddRotatingFile(Path, (CCLogRotation){ .size = 4096, .interval = 0, .retain = 0, .compress = FALSE }), @"Should open the log file");
+    
+    for (size_t Loop = 0; Loop < 1000; Loop++) CCLog(CCLogOptionOutputFile, CCTagInfo, NULL, NULL, NULL, 0, "rotating-test %zu", Loop);
+    
+    size_t Next = 0, Segments = 0;
+    _Bool Complete = TRUE, Sized = TRUE;
+    for (size_t Segment = 1; ; Segment++)
+    {
+        char Name[32];
+        snprintf(Name, sizeof(Name), "rotating.log.%zu", Segment);
+        
+        FSPath SegmentPath = FSPathCopy(Directory);
+        FSPathAppendComponent(SegmentPath, FSPathComponentCreate(FSPathComponentTypeFile, Name));
+        
+        const _Bool Current = !FSManagerExists(SegmentPath);
+        if (Current)
+        {
+            FSPathDestroy(SegmentPath);
+            SegmentPath = FSPathCopy(Path);
+        }
+        
+        else Segments++;
+        
+        size_t Size = FSManagerGetSize(SegmentPath);
+        if (!Current) Sized &= Size >= 4096;
+        
+        FSHandle Reader;
+        XCTAssertEqual(FSHandleOpen(SegmentPath, FSHandleTypeRead, &Reader), FSOperationSuccess, @"Should open the segment");
+        
+        char *Log = CCMalloc(CC_STD_ALLOCATOR, Size + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        FSHandleRead(Reader, &Size, Log, FSBehaviourDefault);
+        FSHandleClose(Reader);
+        Log[Size] = 0;
+        
+        for (const char *Line = Log, *End; (End = strchr(Line, '\n')); Line = End + 1)
+        {
+            const char *Message = strstr(Line, "rotating-test ");
+            if ((Message) && (Message < End)) Complete &= strtoul(Message + 14, NULL, 10) == Next++;
+        }
+        
+        CCFree(Log);
+        FSPathDestroy(SegmentPath);
+        
+        if (Current) break;
+    }
+    
+    XCTAssertGreaterThan(Segments, 1, @"Should rotate the file once it reaches the size");
+    XCTAssertTrue(Sized, @"Should only rotate once the file reaches the size");
+    XCTAssertEqual(Next, 1000, @"Should write all the messages");
+    XCTAssertTrue(Complete, @"Should write the messages in order across the segments");
+    
+    FSPathDestroy(Path);
+    FSPathDestroy(Directory);
+}
+
+-(void) testRotatingFileKeepsForeignSegments
+{
+    FSPath Directory = FSPathCreate("commonc-framework/logging/foreign/");
+    FSManagerRemove(Directory);
+    FSManagerCreate(Directory, TRUE);
+    
+    //segments are numbered from 1, so a ".0" segment was created by something else (e.g. newsyslog)
+    FSPath Foreign[2] = { FSPathCopy(Directory), FSPathCopy(Directory) };
+    FSPathAppendComponent(Foreign[0], FSPathComponentCreate(FSPathComponentTypeFile, "rotating.log.0"));
+    FSPathAppendComponent(Foreign[1], FSPathComponentCreate(FSPathComponentTypeFile, "rotating.log.0.gz"));
+    
+    for (size_t Loop = 0; Loop < 2; Loop++) XCTAssertEqual(FSManagerCreate(Foreign[Loop], FALSE), FSOperationSuccess, @"Should create the segment");
+    
+    FSPath Path = FSPathCreate("commonc-framework/logging/foreign/rotating.log");
+    XCTAssertTrue(CCLogAddRotatingFile(Path, (CCLogRotation){ .size = 4096, .interval = 0, .retain = 2, .compress = FALSE }), @"Should open the log file");
+    
+    for (size_t Loop = 0; Loop < 2; Loop++)
+    {
+        XCTAssertTrue(FSManagerExists(Foreign[Loop]), @"Should not remove segments when adding the file");
+        FSPathDestroy(Foreign[Loop]);
+    }
+    
+    FSPathDestroy(Path);
+    FSPathDestroy(Directory);
+}
+
+-(void) testGating
+{
+    CCLogSetLevel(CCLogLevelWarning);
+    XCTAssertFalse(CCLogLevelIsEnabled(CCLogLevelDebug), @"Should disable less severe levels");
+    XCTAssertTrue(CCLogLevelIsEnabled(CCLogLevelError), @"Should enable more severe levels");
+    
+    Evaluated = 0;
+    CC_LOG_DEBUG("gating %d", EvaluateArgument());
+    XCTAssertEqual(Evaluated, 0, @"Should not evaluate the arguments of disabled levels");
+    
+    CCLogSetLevel(CCLogLevelDebug);
+    
+    CCLogLimitSite Site = { .state = 0, .suppressed = 0 };
+    size_t Sampled = 0;
+    for (int Loop = 0; Loop < 1000; Loop++) Sampled += CCLogSample(&Site, 100);
+    XCTAssertEqual(Sampled, 10, @"Should allow 1 in every 100 messages");
+    
+    Site = (CCLogLimitSite){ .state = 0, .suppressed = 0 };
+    size_t Limited = 0;
+    for (int Loop = 0; Loop < 1000; Loop++) Limited += CCLogLimit(&Site, 5, CCLogOptionNone, CCTagDebug, NULL, NULL, NULL, 0);
+    XCTAssertTrue((Limited >= 5) && (Limited <= 10), @"Should allow 5 messages per second");
+    XCTAssertTrue((atomic_load(&Site.suppressed) > 0) && (atomic_load(&Site.suppressed) <= 1000 - Limited), @"Should count the suppressed messages");
+}
+
+-(void) testAsyncOutput
+{
+    FSPath Path = FSPathCreate("commonc-framework/logging/async.log");
+    FSManagerRemove(Path);
+    FSManagerCreate(Path, TRUE);
+    
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the log file");
+    CCLogAddFile(Handle);
+    
+    pthread_t Threads[ASYNC_THREADS];
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_create(Threads + Loop, NULL, AsyncLogger, (void*)Loop);
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_join(Threads[Loop], NULL);
+    
+    CCLogFlush();
+    
+    FSHandle Reader;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeRead, &Reader), FSOperationSuccess, @"Should open the log file");
+    
+    size_t Size = FSManagerGetSize(Path);
+    char *Log = CCMalloc(CC_STD_ALLOCATOR, Size + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    FSHandleRead(Reader, &Size, Log, FSBehaviourDefault);
+    FSHandleClose(Reader);
+    Log[Size] = 0;
+    
+    size_t Next[ASYNC_THREADS] = { 0 }, Count = 0;
+    _Bool Ordered = TRUE;
+    for (const char *Message = Log; (Message = strstr(Message, "async-test ")); Message++, Count++)
+    {
+        size_t Thread, Index;
+        sscanf(Message, "async-test %zu %zu", &Thread, &Index);
+        
+        Ordered &= Index == Next[Thread]++;
+    }
+    
+    XCTAssertEqual(Count, ASYNC_THREADS * ASYNC_MESSAGES, @"Should write all the messages");
+    XCTAssertTrue(Ordered, @"Should write the messages of each thread in order");
+    
+    CCFree(Log);
+    FSPathDestroy(Path);
+}
+
+-(void) testConcurrentFilters
+{
+    pthread_t Threads[ASYNC_THREADS + FILTER_THREADS];
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_create(Threads + Loop, NULL, AsyncLogger, (void*)Loop);
+    for (size_t Loop = 0; Loop < FILTER_THREADS; Loop++) pthread_create(Threads + ASYNC_THREADS + Loop, NULL, FilterRegistration, NULL);
+    for (size_t Loop = 0; Loop < ASYNC_THREADS + FILTER_THREADS; Loop++) pthread_join(Threads[Loop], NULL);
+    
+    CCLogFlush();
+    
+    atomic_store(&FilterCalls, 0);
+    CCLog(CCLogOptionOutputFile, CCTagInfo, NULL, NULL, NULL, 0, "filter-test");
+    XCTAssertEqual(atomic_load(&FilterCalls), FILTER_THREADS * FILTER_COUNT, @"Should keep every filter added while logging");
+}
+
+-(void) testBinaryOutput
+{
+    FSPath Path = FSPathCreate("commonc-framework/logging/binary.log");
+    FSManagerRemove(Path);
+    FSManagerCreate(Path, TRUE);
+    
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the log file");
+    CCLogAddFile(Handle);
+    
+    pthread_t Threads[ASYNC_THREADS];
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_create(Threads + Loop, NULL, BinaryLogger, (void*)Loop);
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_join(Threads[Loop], NULL);
+    
+    CCString String = CCStringCreate(CC_STD_ALLOCATOR, CCStringHintCopy | CCStringEncodingUTF8, "a string that is not tagged");
+    static CCLogBinarySite Site, StarSite;
+    CCLogBinary(&Site, CCLogOptionOutputFile | CCLogOptionAsync, CCTagInfo, NULL, NULL, NULL, 0, "binary-custom %S %#B 100%%", String, 5);
+    CCLogBinary(&StarSite, CCLogOptionOutputFile | CCLogOptionAsync, CCTagInfo, NULL, NULL, NULL, 0, "binary-star [%*d] [%.*s]", 4, 7, 3, "abcdef");
+    CCStringDestroy(String);
+    
+    CCLogFlush();
+    
+    FSHandle Reader;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeRead, &Reader), FSOperationSuccess, @"Should open the log file");
+    
+    size_t Size = FSManagerGetSize(Path);
+    char *Log = CCMalloc(CC_STD_ALLOCATOR, Size + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    FSHandleRead(Reader, &Size, Log, FSBehaviourDefault);
+    FSHandleClose(Reader);
+    Log[Size] = 0;
+    
+    size_t Next[ASYNC_THREADS] = { 0 }, Count = 0;
+    _Bool Ordered = TRUE, Formatted = TRUE;
+    for (const char *Message = Log; (Message = strstr(Message, "binary-test ")); Message++, Count++)
+    {
+        size_t Thread, Index;
+        char Value[6];
+        float Float;
+        Formatted &= sscanf(Message, "binary-test %zu %zu %5s %f", &Thread, &Index, Value, &Float) == 4;
+        Formatted &= (!strcmp(Value, "value")) && (Float == 1.5f);
+        
+        Ordered &= Index == Next[Thread]++;
+    }
+    
+    XCTAssertEqual(Count, ASYNC_THREADS * ASYNC_MESSAGES, @"Should write all the messages");
+    XCTAssertTrue(Ordered, @"Should write the messages of each thread in order");
+    XCTAssertTrue(Formatted, @"Should format the recorded arguments");
+    XCTAssertTrue(strstr(Log, "binary-custom a string that is not tagged 101 100%") != NULL, @"Should format custom specifiers");
+    XCTAssertTrue(strstr(Log, "binary-star [   7] [abc]") != NULL, @"Should format width and precision arguments");
+    
+    CCFree(Log);
+    FSPathDestroy(Path);
+}
+
+-(void) testMixedOutputOrder
+{
+    FSPath Path = FSPathCreate("commonc-framework/logging/mixed.log");
+    FSManagerRemove(Path);
+    FSManagerCreate(Path, TRUE);
+    
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the log file");
+    CCLogAddFile(Handle);
+    
+    pthread_t Threads[ASYNC_THREADS];
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_create(Threads + Loop, NULL, MixedLogger, (void*)Loop);
+    for (size_t Loop = 0; Loop < ASYNC_THREADS; Loop++) pthread_join(Threads[Loop], NULL);
+    
+    CCLogFlush();
+    
+    FSHandle Reader;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeRead, &Reader), FSOperationSuccess, @"Should open the log file");
+    
+    size_t Size = FSManagerGetSize(Path);
+    char *Log = CCMalloc(CC_STD_ALLOCATOR, Size + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    FSHandleRead(Reader, &Size, Log, FSBehaviourDefault);
+    FSHandleClose(Reader);
+    Log[Size] = 0;
+    
+    size_t Next[ASYNC_THREADS] = { 0 }, Count = 0;
+    _Bool Ordered = TRUE;
+    for (const char *Message = Log; (Message = strstr(Message, "mixed-test ")); Message++, Count++)
+    {
+        size_t Thread, Index;
+        if (sscanf(Message, "mixed-test %zu %zu", &Thread, &Index) == 2) Ordered &= Index == Next[Thread]++;
+    }
+    
+    XCTAssertEqual(Count, ASYNC_THREADS * ASYNC_MESSAGES, @"Should write all the messages");
+    XCTAssertTrue(Ordered, @"Should write the binary and formatted messages of each thread in order");
+    
+    CCFree(Log);
+    FSPathDestroy(Path);
+}
+
+-(void) testSynchronousBinaryOutput
+{
+    FSPath Path = FSPathCreate("commonc-framework/logging/binary-sync.log");
+    FSManagerRemove(Path);
+    FSManagerCreate(Path, TRUE);
+    
+    FSHandle Handle;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeWrite, &Handle), FSOperationSuccess, @"Should open the log file");
+    CCLogAddFile(Handle);
+    
+    static CCLogBinarySite Site;
+    CCLogBinary(&Site, CCLogOptionOutputFile, CCTagInfo, NULL, NULL, NULL, 0, "binary-sync %d", 42);
+    
+    //without CCLogOptionAsync the message must be written before returning, so no flush
+    FSHandle Reader;
+    XCTAssertEqual(FSHandleOpen(Path, FSHandleTypeRead, &Reader), FSOperationSuccess, @"Should open the log file");
+    
+    size_t Size = FSManagerGetSize(Path);
+    char *Log = CCMalloc(CC_STD_ALLOCATOR, Size + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    FSHandleRead(Reader, &Size, Log, FSBehaviourDefault);
+    FSHandleClose(Reader);
+    Log[Size] = 0;
+    
+    XCTAssertTrue(strstr(Log, "binary-sync 42") != NULL, @"Should write a synchronous binary message immediately");
+    
+    CCFree(Log);
+    FSPathDestroy(Path);
+}
+
 @end
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <XCTest/XCTest.h>
+#import "Metrics.h"
+#import "MemoryAllocation.h"
+#import <pthread.h>
+#import <string.h>
+
+#define METRICS_THREADS 4
+#define METRICS_COUNT 100000
+
+@interface MetricsTests : XCTestCase
+
+@end
+
+static CCMetric Counter, Gauge, Histogram;
+
+static void *MetricsUpdater(void *Arg)
+{
+    for (uint64_t Loop = 0; Loop < METRICS_COUNT; Loop++)
+    {
+        CCMetricsCounterAdd(Counter, 1);
+        CCMetricsGaugeAdd(Gauge, Loop & 1 ? -1 : 2);
+        CCMetricsHistogramRecord(Histogram, Loop);
+    }
+    
+    return NULL;
+}
+
+@implementation MetricsTests
+
+-(void) testRegistration
+{
+    CCMetric Metric = CCMetricsRegister("tests.registration", CCMetricTypeCounter);
+    
+    XCTAssertNotEqual(Metric, NULL, @"Should register the metric");
+    XCTAssertEqual(CCMetricsRegister("tests.registration", CCMetricTypeCounter), Metric, @"Should return the existing metric");
+    XCTAssertEqual(CCMetricsRegister("tests.registration", CCMetricTypeGauge), NULL, @"Should not register the same name with a different type");
+    
+    _Atomic(CCMetric) Site = NULL;
+    XCTAssertEqual(CCMetricsSiteGet(&Site, "tests.registration", CCMetricTypeCounter), Metric, @"Should register the call site");
+    XCTAssertEqual(atomic_load(&Site), Metric, @"Should cache the metric in the call site");
+}
+
+-(void) testConcurrentUpdates
+{
+    Counter = CCMetricsRegister("tests.concurrent.counter", CCMetricTypeCounter);
+    Gauge = CCMetricsRegister("tests.concurrent.gauge", CCMetricTypeGauge);
+    Histogram = CCMetricsRegister("tests.concurrent.histogram", CCMetricTypeHistogram);
+    
+    pthread_t Threads[METRICS_THREADS];
+    for (size_t Loop = 0; Loop < METRICS_THREADS; Loop++) pthread_create(Threads + Loop, NULL, MetricsUpdater, NULL);
+    for (size_t Loop = 0; Loop < METRICS_THREADS; Loop++) pthread_join(Threads[Loop], NULL);
+    
+    CCMetricsSnapshot Snapshot = CCMetricsSnapshotCreate(CC_STD_ALLOCATOR);
+    
+    XCTAssertEqual(CCMetricsSnapshotGetValueNamed(Snapshot, "tests.concurrent.counter")->counter, METRICS_THREADS * METRICS_COUNT, @"Should aggregate the counter from every thread");
+    XCTAssertEqual(CCMetricsSnapshotGetValueNamed(Snapshot, "tests.concurrent.gauge")->gauge, METRICS_THREADS * METRICS_COUNT / 2, @"Should aggregate the gauge from every thread");
+    
+    const CCMetricsHistogram *Values = CCMetricsSnapshotGetValueNamed(Snapshot, "tests.concurrent.histogram")->histogram;
+    XCTAssertEqual(Values->count, METRICS_THREADS * METRICS_COUNT, @"Should aggregate the histogram from every thread");
+    XCTAssertEqual(Values->min, 0, @"Should record the minimum");
+    XCTAssertEqual(Values->max, METRICS_COUNT - 1, @"Should record the maximum");
+    
+    CCMetricsSnapshotDestroy(Snapshot);
+}
+
+-(void) testHistogramQuantiles
+{
+    CCMetric Metric = CCMetricsRegister("tests.quantiles", CCMetricTypeHistogram);
+    for (uint64_t Loop = 1; Loop <= 10000; Loop++) CCMetricsHistogramRecord(Metric, Loop);
+    
+    CCMetricsSnapshot Snapshot = CCMetricsSnapshotCreate(CC_STD_ALLOCATOR);
+    const CCMetricsHistogram *Values = CCMetricsSnapshotGetValueNamed(Snapshot, "tests.quantiles")->histogram;
+    
+    XCTAssertEqual(CCMetricsHistogramGetQuantile(Values, 0.0), 1, @"Should be the minimum");
+    XCTAssertEqual(CCMetricsHistogramGetQuantile(Values, 1.0), 10000, @"Should be the maximum");
+    XCTAssertEqualWithAccuracy((double)CCMetricsHistogramGetQuantile(Values, 0.5), 5000.0, 5000.0 / 16, @"Should be within the precision of a bucket");
+    XCTAssertEqualWithAccuracy((double)CCMetricsHistogramGetQuantile(Values, 0.99), 9900.0, 9900.0 / 16, @"Should be within the precision of a bucket");
+    
+    CCMetricsSnapshotDestroy(Snapshot);
+}
+
+-(void) testFormat
+{
+    CCMetricsCounterAdd(CCMetricsRegister("tests.format.counter", CCMetricTypeCounter), 3);
+    CCMetricsGaugeAdd(CCMetricsRegister("tests.format.gauge", CCMetricTypeGauge), -2);
+    
+    CCMetricsSnapshot Snapshot = CCMetricsSnapshotCreate(CC_STD_ALLOCATOR);
+    
+    const size_t Length = CCMetricsSnapshotFormat(Snapshot, NULL, 0);
+    char *Text = CCMalloc(CC_STD_ALLOCATOR, Length + 1, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    XCTAssertEqual(CCMetricsSnapshotFormat(Snapshot, Text, Length + 1), Length, @"Should return the same length");
+    XCTAssertTrue(strstr(Text, "counter tests.format.counter 3\n"), @"Should format the counter");
+    XCTAssertTrue(strstr(Text, "gauge tests.format.gauge -2\n"), @"Should format the gauge");
+    
+    char Truncated[8];
+    XCTAssertEqual(CCMetricsSnapshotFormat(Snapshot, Truncated, sizeof(Truncated)), Length, @"Should return the full length when truncated");
+    XCTAssertEqual(strlen(Truncated), sizeof(Truncated) - 1, @"Should null terminate when truncated");
+    
+    CCFree(Text);
+    CCMetricsSnapshotDestroy(Snapshot);
+}
+
+@end
@@ -0,0 +1,437 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentArray.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+typedef const CCConcurrentGarbageCollectorInterface * const *GCInterface;
+
+static void TestCreation(GCInterface GC)
+{
+    CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 1, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    CCTestAssertEqual(CCConcurrentArrayGetCount(Array), 0, "Should be empty");
+    CCTestAssertEqual(CCConcurrentArrayGetElementSize(Array), sizeof(int), "Should be the size specified on creation");
+    
+    CCConcurrentArrayDestroy(Array);
+}
+
+static void TestAppending(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        CCTestAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 1 }), 0, "Should append the element to the end");
+        CCTestAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 2 }), 1, "Should append the element to the end");
+        CCTestAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 3 }), 2, "Should append the element to the end");
+        
+        int Value;
+        CCTestAssertEqual(CCConcurrentArrayGetCount(Array), 3, "Should contain 3 elements");
+        CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should be the first element");
+        CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should be the second element");
+        CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should be the third element");
+        
+        CCTestAssertFalse(CCConcurrentArrayGetElementAtIndex(Array, 3, &Value), "Should not have an element at the given index");
+        CCTestAssertFalse(CCConcurrentArrayGetElementAtIndex(Array, SIZE_MAX, &Value), "Should not have an element at the given index");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+static void TestReplacing(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        CCConcurrentArrayAppendElement(Array, &(int){ 1 });
+        CCConcurrentArrayAppendElement(Array, &(int){ 2 });
+        
+        int Value;
+        CCTestAssertTrue(CCConcurrentArrayReplaceElementAtIndex(Array, 1, &(int){ 20 }, &Value), "Should replace the element");
+        CCTestAssertEqual(Value, 2, "Should be the replaced element");
+        CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should be the new element");
+        CCTestAssertFalse(CCConcurrentArrayReplaceElementAtIndex(Array, 2, &(int){ 30 }, NULL), "Should not replace an element past the end");
+        CCTestAssertEqual(CCConcurrentArrayGetCount(Array), 2, "Should contain 2 elements");
+        
+        CCTestAssertTrue(CCConcurrentArrayReplaceExactElementAtIndex(Array, 0, &(int){ 10 }, &(int){ 1 }), "Should replace the matching element");
+        CCTestAssertFalse(CCConcurrentArrayReplaceExactElementAtIndex(Array, 0, &(int){ 11 }, &(int){ 1 }), "Should not replace an element that does not match");
+        CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should be the new element");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+static void TestRemoving(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        for (int Loop = 0; Loop < 10; Loop++) CCConcurrentArrayAppendElement(Array, &Loop);
+        
+        int Value;
+        CCTestAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 0, &Value), "Should remove the element");
+        CCTestAssertEqual(Value, 0, "Should be the removed element");
+        CCTestAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 8, &Value), "Should remove the element");
+        CCTestAssertEqual(Value, 9, "Should be the removed element");
+        CCTestAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 3, NULL), "Should remove the element");
+        CCTestAssertFalse(CCConcurrentArrayRemoveElementAtIndex(Array, 7, NULL), "Should not remove an element past the end");
+        CCTestAssertEqual(CCConcurrentArrayGetCount(Array), 7, "Should contain 7 elements");
+        
+        const int Expected[] = { 1, 2, 3, 5, 6, 7, 8 };
+        for (size_t Loop = 0; Loop < sizeof(Expected) / sizeof(*Expected); Loop++)
+        {
+            CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, Loop, &Value), "Should have an element at the given index");
+            CCTestAssertEqual(Value, Expected[Loop], "Should shift the remaining elements");
+        }
+        
+        CCTestAssertEqual(CCConcurrentArrayAppendElement(Array, &(int){ 10 }), 7, "Should append the element to the end");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+static void TestInserting(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        CCTestAssertFalse(CCConcurrentArrayInsertElementAtIndex(Array, 1, &(int){ 1 }), "Should not insert an element past the end");
+        CCTestAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 0, &(int){ 3 }), "Should insert the element");
+        CCTestAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 0, &(int){ 1 }), "Should insert the element");
+        CCTestAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 1, &(int){ 2 }), "Should insert the element");
+        CCTestAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 3, &(int){ 4 }), "Should insert the element at the end");
+        CCTestAssertEqual(CCConcurrentArrayGetCount(Array), 4, "Should contain 4 elements");
+        
+        for (int Loop = 0; Loop < 4; Loop++)
+        {
+            int Value;
+            CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, Loop, &Value), "Should have an element at the given index");
+            CCTestAssertEqual(Value, Loop + 1, "Should be in order");
+        }
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+static void TestLargeElements(GCInterface GC)
+{
+    typedef struct {
+        int value;
+        char padding[60];
+    } LargeElement;
+    
+    CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(LargeElement), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    for (int Loop = 0; Loop < 100; Loop++) CCConcurrentArrayAppendElement(Array, &(LargeElement){ .value = Loop });
+    
+    LargeElement Value;
+    CCTestAssertTrue(CCConcurrentArrayReplaceElementAtIndex(Array, 50, &(LargeElement){ .value = -1 }, &Value), "Should replace the element");
+    CCTestAssertEqual(Value.value, 50, "Should be the replaced element");
+    CCTestAssertTrue(CCConcurrentArrayRemoveElementAtIndex(Array, 0, &Value), "Should remove the element");
+    CCTestAssertEqual(Value.value, 0, "Should be the removed element");
+    CCTestAssertTrue(CCConcurrentArrayInsertElementAtIndex(Array, 10, &(LargeElement){ .value = -2 }), "Should insert the element");
+    
+    CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 10, &Value), "Should have an element at the given index");
+    CCTestAssertEqual(Value.value, -2, "Should be the inserted element");
+    CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 50, &Value), "Should have an element at the given index");
+    CCTestAssertEqual(Value.value, -1, "Should be the replaced element");
+    CCTestAssertTrue(CCConcurrentArrayGetElementAtIndex(Array, 99, &Value), "Should have an element at the given index");
+    CCTestAssertEqual(Value.value, 99, "Should be the last element");
+    
+    CCConcurrentArrayDestroy(Array);
+}
+
+static void TestGrowingSegments(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        _Bool Appended = TRUE;
+        for (int Loop = 0; Loop < 1000; Loop++) Appended &= CCConcurrentArrayAppendElement(Array, &Loop) == (size_t)Loop;
+        
+        CCTestAssertTrue(Appended, "Should append the elements to the end");
+        CCTestAssertEqual(CCConcurrentArrayGetCount(Array), 1000, "Should contain 1000 elements");
+        
+        _Bool Matches = TRUE;
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            int Value;
+            Matches &= CCConcurrentArrayGetElementAtIndex(Array, Loop, &Value) && (Value == Loop);
+        }
+        
+        CCTestAssertTrue(Matches, "Should retain all elements across segments");
+        CCTestAssertFalse(CCConcurrentArrayGetElementAtIndex(Array, 1000, &(int){ 0 }), "Should not have an element at the given index");
+        
+        CCConcurrentArrayDestroy(Array);
+    }
+}
+
+static _Bool SumEnumerator(const void *Element, size_t Index, void *Data)
+{
+    *(size_t*)Data += *(const int*)Element;
+    
+    return Index < 49;
+}
+
+static void TestEnumerating(GCInterface GC)
+{
+    CCConcurrentArray Array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    size_t Sum = 0;
+    CCTestAssertEqual(CCConcurrentArrayEnumerate(Array, SumEnumerator, &Sum), 0, "Should not enumerate any elements");
+    
+    for (int Loop = 0; Loop < 100; Loop++) CCConcurrentArrayAppendElement(Array, &Loop);
+    
+    CCTestAssertEqual(CCConcurrentArrayEnumerate(Array, SumEnumerator, &Sum), 50, "Should stop enumerating when the enumerator returns false");
+    CCTestAssertEqual(Sum, 1225, "Should enumerate the elements in order");
+    
+    CCConcurrentArrayDestroy(Array);
+}
+
+#define THREAD_COUNT 10
+#define ELEMENT_COUNT 1000
+
+static CCConcurrentArray A;
+static void *Appenders(void *Arg)
+{
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++)
+    {
+        CCConcurrentArrayAppendElement(A, &Loop);
+    }
+    
+    return NULL;
+}
+
+static size_t AppenderCount = 0;
+static void *Summer(void *Arg)
+{
+    size_t Sum = 0;
+    for (size_t Loop = 0; Loop < ELEMENT_COUNT * AppenderCount; Loop++)
+    {
+        int Element;
+        while (!CCConcurrentArrayGetElementAtIndex(A, Loop, &Element));
+        
+        Sum += Element;
+    }
+    
+    return (void*)(uintptr_t)Sum;
+}
+
+static void TestMultiThreadedAppends(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    AppenderCount = Threads;
+    A = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    pthread_t AppenderThreads[Threads], SummerThread;
+    
+    pthread_create(&SummerThread, NULL, Summer, NULL);
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(AppenderThreads + Loop, NULL, Appenders, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(AppenderThreads[Loop], NULL);
+    }
+    
+    uintptr_t Sum = 0;
+    pthread_join(SummerThread, (void**)&Sum);
+    
+    CCTestAssertEqual(CCConcurrentArrayGetCount(A), ELEMENT_COUNT * Threads, "Should append all elements");
+    
+    CCConcurrentArrayDestroy(A);
+    
+    size_t CorrectSum = 0;
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++) CorrectSum += Loop;
+    
+    CCTestAssertEqual(Sum, (CorrectSum * Threads), "Should append all elements");
+}
+
+static void *Mutators(void *Arg)
+{
+    for (int Loop = 0; Loop < 100; Loop++)
+    {
+        if (Loop & 1) CCConcurrentArrayRemoveElementAtIndex(A, 0, NULL);
+        else CCConcurrentArrayInsertElementAtIndex(A, 0, &(int){ -1 });
+    }
+    
+    return NULL;
+}
+
+static void TestMultiThreadedMutations(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT) < 2 ? 1 : CCTestGetThreadCount(THREAD_COUNT) / 2;
+    
+    A = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    pthread_t AppenderThreads[Threads], MutatorThreads[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(AppenderThreads + Loop, NULL, Appenders, NULL);
+        pthread_create(MutatorThreads + Loop, NULL, Mutators, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(AppenderThreads[Loop], NULL);
+        pthread_join(MutatorThreads[Loop], NULL);
+    }
+    
+    const size_t Count = CCConcurrentArrayGetCount(A);
+    CCTestAssertEqual(Count, ELEMENT_COUNT * Threads, "Should balance the insertions and removals");
+    
+    _Bool Contiguous = TRUE;
+    for (size_t Loop = 0; Loop < Count; Loop++) Contiguous &= CCConcurrentArrayGetElementAtIndex(A, Loop, NULL);
+    
+    CCTestAssertTrue(Contiguous, "Should not leave any gaps");
+    CCTestAssertFalse(CCConcurrentArrayGetElementAtIndex(A, Count, NULL), "Should not have an element at the given index");
+    
+    CCConcurrentArrayDestroy(A);
+}
+
+#pragma mark - Stress
+
+typedef struct {
+    CCConcurrentArray array;
+    _Atomic(size_t) added;
+    _Atomic(size_t) removed;
+} StressState;
+
+static StressState Stress;
+static void *StressMutator(void *Arg)
+{
+    size_t Added = 0, Removed = 0, Invalid = 0;
+    while (CCTestIsRunning())
+    {
+        const uint32_t Random = CCTestRandom();
+        const size_t Count = CCConcurrentArrayGetCount(Stress.array);
+        const size_t Index = Count ? (Random >> 3) % Count : 0;
+        
+        //every element is non-negative, so reading anything else means a torn or uninitialised element
+        int Value;
+        switch (Random & 7)
+        {
+            case 0:
+            case 1:
+                if (CCConcurrentArrayAppendElement(Stress.array, &(int){ (int)(Random >> 3) }) != SIZE_MAX) Added++;
+                break;
+                
+            case 2:
+                if (CCConcurrentArrayInsertElementAtIndex(Stress.array, Index, &(int){ (int)(Random >> 3) })) Added++;
+                break;
+                
+            case 3:
+            case 4:
+                if (CCConcurrentArrayRemoveElementAtIndex(Stress.array, Index, &Value))
+                {
+                    Removed++;
+                    Invalid += Value < 0;
+                }
+                break;
+                
+            case 5:
+                if (CCConcurrentArrayReplaceElementAtIndex(Stress.array, Index, &(int){ (int)(Random >> 3) }, &Value)) Invalid += Value < 0;
+                break;
+                
+            default:
+                if (CCConcurrentArrayGetElementAtIndex(Stress.array, Index, &Value)) Invalid += Value < 0;
+                break;
+        }
+    }
+    
+    CCTestAssertEqual(Invalid, 0, "Should only read elements that were added");
+    
+    atomic_fetch_add_explicit(&Stress.added, Added, memory_order_relaxed);
+    atomic_fetch_add_explicit(&Stress.removed, Removed, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestStressMutations(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(0);
+    
+    Stress.array = CCConcurrentArrayCreate(CC_STD_ALLOCATOR, sizeof(int), 16, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    atomic_store(&Stress.added, 0);
+    atomic_store(&Stress.removed, 0);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressMutator, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    const size_t Count = CCConcurrentArrayGetCount(Stress.array);
+    CCTestAssertEqual(Count, atomic_load(&Stress.added) - atomic_load(&Stress.removed), "Should contain every element added and not removed");
+    
+    _Bool Contiguous = TRUE;
+    for (size_t Loop = 0; Loop < Count; Loop++) Contiguous &= CCConcurrentArrayGetElementAtIndex(Stress.array, Loop, NULL);
+    
+    CCTestAssertTrue(Contiguous, "Should not leave any gaps");
+    CCTestAssertFalse(CCConcurrentArrayGetElementAtIndex(Stress.array, Count, NULL), "Should not have an element at the given index");
+    
+    CCConcurrentArrayDestroy(Stress.array);
+}
+
+#define ARRAY_TESTS(gc, label) \
+{ .name = "ConcurrentArray/" label "/Creation", .run = (CCTestRun)TestCreation, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/Appending", .run = (CCTestRun)TestAppending, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/Replacing", .run = (CCTestRun)TestReplacing, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/Removing", .run = (CCTestRun)TestRemoving, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/Inserting", .run = (CCTestRun)TestInserting, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/LargeElements", .run = (CCTestRun)TestLargeElements, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/GrowingSegments", .run = (CCTestRun)TestGrowingSegments, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/Enumerating", .run = (CCTestRun)TestEnumerating, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/MultiThreadedAppends", .run = (CCTestRun)TestMultiThreadedAppends, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/MultiThreadedMutations", .run = (CCTestRun)TestMultiThreadedMutations, .arg = &gc }, \
+{ .name = "ConcurrentArray/" label "/StressMutations", .run = (CCTestRun)TestStressMutations, .arg = &gc, .stress = TRUE }
+
+static const CCTest Tests[] = {
+    ARRAY_TESTS(CCEpochGarbageCollector, "EpochGC"),
+    ARRAY_TESTS(CCLazyGarbageCollector, "LazyGC")
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentBuffer.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+static void TestReadWithoutWrite(const void *Arg)
+{
+    CCConcurrentBuffer Buffer = CCConcurrentBufferCreate(CC_STD_ALLOCATOR, NULL);
+    
+    CCTestAssertEqual(CCConcurrentBufferReadData(Buffer), NULL, "Should return NULL if no buffer was written to");
+    CCTestAssertEqual(CCConcurrentBufferReadData(Buffer), NULL, "Should return NULL if no buffer was written to");
+    
+    CCConcurrentBufferDestroy(Buffer);
+}
+
+static void TestReadWithWrite(const void *Arg)
+{
+    CCConcurrentBuffer Buffer = CCConcurrentBufferCreate(CC_STD_ALLOCATOR, NULL);
+    
+    CCConcurrentBufferWriteData(Buffer, (void*)1);
+    CCTestAssertEqual(CCConcurrentBufferReadData(Buffer), (void*)1, "Should read the correct buffer");
+    CCTestAssertEqual(CCConcurrentBufferReadData(Buffer), NULL, "Should read the correct buffer");
+    
+    CCConcurrentBufferWriteData(Buffer, (void*)2);
+    CCConcurrentBufferWriteData(Buffer, (void*)3);
+    CCTestAssertEqual(CCConcurrentBufferReadData(Buffer), (void*)3, "Should read the correct buffer");
+    
+    CCConcurrentBufferDestroy(Buffer);
+}
+
+static int DestructorCount = 0, DestructorSum = 0;
+static void Destructor(void *Data)
+{
+    DestructorCount++;
+    DestructorSum += (uintptr_t)Data;
+}
+
+static void TestDestructorCallback(const void *Arg)
+{
+    DestructorCount = 0;
+    DestructorSum = 0;
+    CCConcurrentBuffer Buffer = CCConcurrentBufferCreate(CC_STD_ALLOCATOR, Destructor);
+    
+    CCConcurrentBufferWriteData(Buffer, (void*)1); //destroyed
+    CCConcurrentBufferWriteData(Buffer, (void*)2); //destroyed
+    CCConcurrentBufferWriteData(Buffer, (void*)4);
+    
+    CCTestAssertEqual(DestructorCount, 2, "Should have called the destructor 2 times");
+    CCTestAssertEqual(DestructorSum, 3, "Should receive the correct buffers");
+    
+    CCConcurrentBufferReadData(Buffer);
+    CCConcurrentBufferWriteData(Buffer, (void*)8);
+    
+    CCTestAssertEqual(DestructorCount, 2, "Should have called the destructor 2 times");
+    CCTestAssertEqual(DestructorSum, 3, "Should receive the correct buffers");
+    
+    CCConcurrentBufferDestroy(Buffer);
+}
+
+#define READ_THREADS 20
+#define WRITE_THREADS 10
+
+#define COUNT 100000
+#define NULL_READ_ALLOWANCE 1000
+
+static _Atomic(size_t) DestroyedBuffers = ATOMIC_VAR_INIT(0);
+static void BufferDestructor(void *Ptr)
+{
+    atomic_fetch_add_explicit(&DestroyedBuffers, 1, memory_order_relaxed);
+}
+
+static CCConcurrentBuffer B;
+static void *Writer(void *Arg)
+{
+    for (int Loop = 0; Loop < COUNT; Loop++)
+    {
+        CCConcurrentBufferWriteData(B, (void*)1);
+    }
+    
+    return NULL;
+}
+
+static void *Reader(void *Arg)
+{
+    uintptr_t Sum = 0;
+    for (int NullCount = 0; NullCount < NULL_READ_ALLOWANCE; NullCount++)
+    {
+        uintptr_t Value = (uintptr_t)CCConcurrentBufferReadData(B);
+        Sum += Value;
+        if (Value == 0) NullCount++;
+    }
+    
+    return (void*)Sum;
+}
+
+static void TestMultiThreading(const void *Arg)
+{
+    const size_t WriteThreads = CCTestGetThreadCount(WRITE_THREADS), ReadThreads = CCTestGetThreadCount(READ_THREADS);
+    
+    atomic_store(&DestroyedBuffers, 0);
+    B = CCConcurrentBufferCreate(CC_STD_ALLOCATOR, BufferDestructor);
+    
+    pthread_t Write[WriteThreads], Read[ReadThreads];
+    for (size_t Loop = 0; Loop < WriteThreads; Loop++)
+    {
+        pthread_create(Write + Loop, NULL, Writer, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < ReadThreads; Loop++)
+    {
+        pthread_create(Read + Loop, NULL, Reader, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < WriteThreads; Loop++)
+    {
+        pthread_join(Write[Loop], NULL);
+    }
+    
+    uintptr_t Sum = 0;
+    for (size_t Loop = 0; Loop < ReadThreads; Loop++)
+    {
+        uintptr_t Result = 0;
+        pthread_join(Read[Loop], (void**)&Result);
+        Sum += Result;
+    }
+    
+    Sum += atomic_load_explicit(&DestroyedBuffers, memory_order_relaxed);
+    Sum += (uintptr_t)CCConcurrentBufferReadData(B);
+    
+    CCConcurrentBufferDestroy(B);
+    
+    CCTestAssertEqual(Sum, (WriteThreads * COUNT), "No buffers should be over-retained");
+}
+
+#pragma mark - Stress
+
+static _Atomic(size_t) StressWritten = ATOMIC_VAR_INIT(0);
+static _Atomic(size_t) StressRead = ATOMIC_VAR_INIT(0);
+
+static void *StressWriter(void *Arg)
+{
+    size_t Written = 0;
+    while (CCTestIsRunning())
+    {
+        CCConcurrentBufferWriteData(B, (void*)1);
+        Written++;
+    }
+    
+    atomic_fetch_add_explicit(&StressWritten, Written, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void *StressReader(void *Arg)
+{
+    size_t Read = 0;
+    while (CCTestIsRunning())
+    {
+        Read += (uintptr_t)CCConcurrentBufferReadData(B);
+    }
+    
+    atomic_fetch_add_explicit(&StressRead, Read, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestStressReadWrite(const void *Arg)
+{
+    const size_t Threads = CCTestGetThreadCount(0) < 2 ? 2 : CCTestGetThreadCount(0);
+    const size_t Writers = Threads / 2;
+    
+    atomic_store(&DestroyedBuffers, 0);
+    atomic_store(&StressWritten, 0);
+    atomic_store(&StressRead, 0);
+    B = CCConcurrentBufferCreate(CC_STD_ALLOCATOR, BufferDestructor);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Writers; Loop++) pthread_create(&Handles[Loop], NULL, StressWriter, NULL);
+    for (size_t Loop = Writers; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressReader, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    const size_t Sum = atomic_load(&StressRead) + atomic_load(&DestroyedBuffers) + (uintptr_t)CCConcurrentBufferReadData(B);
+    
+    CCConcurrentBufferDestroy(B);
+    
+    CCTestAssertEqual(Sum, atomic_load(&StressWritten), "Every written buffer should be read or destroyed exactly once");
+}
+
+static const CCTest Tests[] = {
+    { .name = "ConcurrentBuffer/ReadWithoutWrite", .run = TestReadWithoutWrite },
+    { .name = "ConcurrentBuffer/ReadWithWrite", .run = TestReadWithWrite },
+    { .name = "ConcurrentBuffer/DestructorCallback", .run = TestDestructorCallback },
+    { .name = "ConcurrentBuffer/MultiThreading", .run = TestMultiThreading },
+    { .name = "ConcurrentBuffer/StressReadWrite", .run = TestStressReadWrite, .stress = TRUE }
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
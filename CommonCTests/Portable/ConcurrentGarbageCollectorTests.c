@@ -0,0 +1,513 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentGarbageCollector.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <string.h>
+
+typedef const CCConcurrentGarbageCollectorInterface * const *GCInterface;
+
+static void ForceFlush(CCConcurrentGarbageCollector GC)
+{
+    CCConcurrentGarbageCollectorBegin(GC);
+    CCConcurrentGarbageCollectorEnd(GC);
+    
+    CCConcurrentGarbageCollectorBegin(GC);
+    CCConcurrentGarbageCollectorEnd(GC);
+}
+
+#define THREAD_COUNT 10
+
+static _Atomic(uintptr_t) ReclaimationSum = ATOMIC_VAR_INIT(0);
+static void ReclaimationCounter(void *Arg)
+{
+    atomic_fetch_add_explicit(&ReclaimationSum, (uintptr_t)Arg, memory_order_relaxed);
+}
+
+static void TestManagement(GCInterface Interface)
+{
+    CCConcurrentGarbageCollector GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    atomic_store(&ReclaimationSum, 0);
+    CCConcurrentGarbageCollectorBegin(GC);
+    CCConcurrentGarbageCollectorEnd(GC);
+    
+    ForceFlush(GC);
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), 0, "Should have nothing to reclaim");
+    
+    
+    atomic_store(&ReclaimationSum, 0);
+    CCConcurrentGarbageCollectorBegin(GC);
+    CCConcurrentGarbageCollectorManage(GC, (void*)1, ReclaimationCounter);
+    CCConcurrentGarbageCollectorEnd(GC);
+    
+    ForceFlush(GC);
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), 1, "Should have reclaimed");
+    
+    
+    atomic_store(&ReclaimationSum, 0);
+    CCConcurrentGarbageCollectorBegin(GC);
+    CCConcurrentGarbageCollectorManage(GC, (void*)2, ReclaimationCounter);
+    CCConcurrentGarbageCollectorManage(GC, (void*)3, ReclaimationCounter);
+    CCConcurrentGarbageCollectorEnd(GC);
+    
+    ForceFlush(GC);
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), 5, "Should have reclaimed");
+    
+    
+    atomic_store(&ReclaimationSum, 0);
+    CCConcurrentGarbageCollectorBegin(GC);
+    CCConcurrentGarbageCollectorManage(GC, (void*)4, ReclaimationCounter);
+    
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), 0, "Should not reclaim");
+    
+    CCConcurrentGarbageCollectorEnd(GC);
+    
+    ForceFlush(GC);
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), 4, "Should have reclaimed");
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+}
+
+#define CYCLE_COUNT 100000
+
+static CCConcurrentGarbageCollector GC;
+static void *Cycles(void *Arg)
+{
+    for (int Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        CCConcurrentGarbageCollectorEnd(GC);
+    }
+    
+    ForceFlush(GC);
+    
+    return NULL;
+}
+
+static void *ManagedCycles(void *Arg)
+{
+    for (int Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        CCConcurrentGarbageCollectorManage(GC, (void*)((uintptr_t)Arg + Loop), ReclaimationCounter);
+        CCConcurrentGarbageCollectorEnd(GC);
+    }
+    
+    ForceFlush(GC);
+    
+    return NULL;
+}
+
+static void TestSingleThreadedManage(GCInterface Interface)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    atomic_store(&ReclaimationSum, 0);
+    GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    pthread_t Handles[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads - 1; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, Cycles, NULL);
+    }
+    
+    ManagedCycles((void*)1);
+    
+    for (size_t Loop = 0; Loop < Threads - 1; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+    
+    uintptr_t CorrectSum = 0;
+    for (int Loop2 = 0; Loop2 < CYCLE_COUNT; Loop2++)
+    {
+        CorrectSum += Loop2 + 1;
+    }
+    
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), CorrectSum, "Should have reclaimed all managed entities");
+}
+
+static void TestMultiThreadedManage(GCInterface Interface)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    atomic_store(&ReclaimationSum, 0);
+    GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    pthread_t Handles[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, ManagedCycles, (void*)(uintptr_t)(Loop + 1));
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+    
+    uintptr_t CorrectSum = 0;
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        for (int Loop2 = 0; Loop2 < CYCLE_COUNT; Loop2++)
+        {
+            CorrectSum += Loop + (Loop2 + 1);
+        }
+    }
+    
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), CorrectSum, "Should have reclaimed all managed entities");
+}
+
+static void Spin(uint32_t Max)
+{
+    for (volatile uint32_t Loop = 0, Wait = CCTestRandom() % Max; Loop < Wait; Loop++);
+}
+
+static void *ManagedCycles2(void *Arg)
+{
+    for (int Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        Spin(20);
+        CCConcurrentGarbageCollectorManage(GC, (void*)((uintptr_t)Arg + Loop), ReclaimationCounter);
+        Spin(20);
+        CCConcurrentGarbageCollectorEnd(GC);
+    }
+    
+    ForceFlush(GC);
+    
+    return NULL;
+}
+
+static void TestMultiThreadedManage2(GCInterface Interface)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    atomic_store(&ReclaimationSum, 0);
+    GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    pthread_t Handles[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, ManagedCycles2, (void*)(uintptr_t)(Loop + 1));
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+    
+    uintptr_t CorrectSum = 0;
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        for (int Loop2 = 0; Loop2 < CYCLE_COUNT; Loop2++)
+        {
+            CorrectSum += Loop + (Loop2 + 1);
+        }
+    }
+    
+    CCTestAssertEqual(atomic_load(&ReclaimationSum), CorrectSum, "Should have reclaimed all managed entities");
+}
+
+static _Atomic(_Bool) *References = NULL;
+static void ReclaimReference(void *Ref)
+{
+    atomic_store_explicit(&References[(uintptr_t)Ref], TRUE, memory_order_relaxed);
+}
+
+static _Atomic(_Bool) EarlyRecycle = ATOMIC_VAR_INIT(FALSE);
+static void *ManagedCycles3(void *Arg)
+{
+    for (int Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        CCConcurrentGarbageCollectorManage(GC, (void*)(uintptr_t)Loop, ReclaimReference);
+        
+        Spin(30);
+        if (atomic_load_explicit(&References[Loop], memory_order_relaxed)) atomic_store(&EarlyRecycle, TRUE);
+        
+        CCConcurrentGarbageCollectorEnd(GC);
+    }
+    
+    ForceFlush(GC);
+    
+    return NULL;
+}
+
+static void TestEarlyReclaimation(GCInterface Interface)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    References = CCMalloc(CC_STD_ALLOCATOR, sizeof(_Atomic(_Bool)) * CYCLE_COUNT, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    for (size_t Loop = 0; Loop < CYCLE_COUNT; Loop++) atomic_init(&References[Loop], FALSE);
+    
+    atomic_store(&EarlyRecycle, FALSE);
+    GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    pthread_t Handles[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads - 1; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, Cycles, NULL);
+    }
+    
+    ManagedCycles3(NULL);
+    
+    for (size_t Loop = 0; Loop < Threads - 1; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+    CCFree(References);
+    
+    CCTestAssertFalse(atomic_load(&EarlyRecycle), "Should not have reclaimed entities still in use");
+}
+
+static _Atomic(size_t) RefIndex = ATOMIC_VAR_INIT(SIZE_MAX);
+static _Atomic(int) *Refs = NULL;
+static _Atomic(_Bool) Retry = ATOMIC_VAR_INIT(FALSE);
+static void *Cycles2(void *Arg)
+{
+    while (atomic_load_explicit(&Retry, memory_order_relaxed))
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        
+        size_t Index = atomic_load_explicit(&RefIndex, memory_order_acquire);
+        
+        Spin(30);
+        
+        if (Index != SIZE_MAX) atomic_fetch_add_explicit(&Refs[Index], 1, memory_order_relaxed);
+        
+        CCConcurrentGarbageCollectorEnd(GC);
+        
+        Spin(5);
+    }
+    
+    ForceFlush(GC);
+    
+    return NULL;
+}
+
+static void ReclaimReference2(void *Ref)
+{
+    atomic_store_explicit((_Atomic(int)*)Ref, 0, memory_order_release);
+}
+
+static void *ManagedCycles4(void *Arg)
+{
+    for (int Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        
+        atomic_store_explicit(&Refs[Loop], 0, memory_order_relaxed);
+        atomic_store_explicit(&RefIndex, Loop, memory_order_release);
+        
+        Spin(30);
+        
+        atomic_store_explicit(&RefIndex, SIZE_MAX, memory_order_relaxed);
+        
+        CCConcurrentGarbageCollectorManage(GC, &Refs[Loop], ReclaimReference2);
+        
+        CCConcurrentGarbageCollectorEnd(GC);
+        
+        Spin(3);
+    }
+    
+    ForceFlush(GC);
+    
+    return NULL;
+}
+
+static void TestReferences(GCInterface Interface)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    Refs = CCMalloc(CC_STD_ALLOCATOR, sizeof(_Atomic(int)) * CYCLE_COUNT, NULL, CC_DEFAULT_ERROR_CALLBACK);
+    
+    GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    pthread_t Handles[Threads];
+    
+    atomic_store(&Retry, TRUE);
+    for (size_t Loop = 0; Loop < Threads - 1; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, Cycles2, NULL);
+    }
+    
+    ManagedCycles4(NULL);
+    atomic_store(&Retry, FALSE);
+    
+    for (size_t Loop = 0; Loop < Threads - 1; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+    
+    _Bool Referenced = FALSE;
+    for (int Loop = 0; Loop < CYCLE_COUNT; Loop++)
+    {
+        if (atomic_load(&Refs[Loop]))
+        {
+            Referenced = TRUE;
+            break;
+        }
+    }
+    
+    CCFree(Refs);
+    
+    CCTestAssertFalse(Referenced, "Should not have reclaimed entities still referenced");
+}
+
+#pragma mark - Stress
+
+#define STRESS_ITEM_LIVE 0x5ca1ab1e
+#define STRESS_ITEM_RECLAIMED 0xdeadbeef
+
+typedef struct {
+    _Atomic(uint32_t) state;
+} StressItem;
+
+static _Atomic(StressItem*) StressShared = ATOMIC_VAR_INIT(NULL);
+static _Atomic(size_t) StressManaged = ATOMIC_VAR_INIT(0);
+static _Atomic(size_t) StressReclaimed = ATOMIC_VAR_INIT(0);
+
+static StressItem *StressItemCreate(void)
+{
+    StressItem *Item = CCMalloc(CC_STD_ALLOCATOR, sizeof(StressItem), NULL, CC_DEFAULT_ERROR_CALLBACK);
+    atomic_init(&Item->state, STRESS_ITEM_LIVE);
+    
+    return Item;
+}
+
+static void StressItemReclaim(StressItem *Item)
+{
+    atomic_store_explicit(&Item->state, STRESS_ITEM_RECLAIMED, memory_order_relaxed);
+    atomic_fetch_add_explicit(&StressReclaimed, 1, memory_order_relaxed);
+    
+    CCFree(Item);
+}
+
+static void *StressReader(void *Arg)
+{
+    size_t Invalid = 0;
+    while (CCTestIsRunning())
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        
+        StressItem *Item = atomic_load_explicit(&StressShared, memory_order_acquire);
+        
+        Spin(16);
+        
+        //reading a reclaimed item is also caught as a use after free in ASan builds
+        if (atomic_load_explicit(&Item->state, memory_order_relaxed) != STRESS_ITEM_LIVE) Invalid++;
+        
+        CCConcurrentGarbageCollectorEnd(GC);
+    }
+    
+    ForceFlush(GC);
+    
+    CCTestAssertEqual(Invalid, 0, "Should not reclaim items that may still be read");
+    
+    return NULL;
+}
+
+static void *StressWriter(void *Arg)
+{
+    size_t Managed = 0;
+    while (CCTestIsRunning())
+    {
+        CCConcurrentGarbageCollectorBegin(GC);
+        
+        StressItem *Item = atomic_exchange_explicit(&StressShared, StressItemCreate(), memory_order_acq_rel);
+        CCConcurrentGarbageCollectorManage(GC, Item, (CCConcurrentGarbageCollectorReclaimer)StressItemReclaim);
+        Managed++;
+        
+        CCConcurrentGarbageCollectorEnd(GC);
+        
+        Spin(8);
+    }
+    
+    ForceFlush(GC);
+    
+    atomic_fetch_add_explicit(&StressManaged, Managed, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestStressReclaimation(GCInterface Interface)
+{
+    const size_t Threads = CCTestGetThreadCount(0) < 2 ? 2 : CCTestGetThreadCount(0);
+    const size_t Writers = (Threads / 4) ? Threads / 4 : 1;
+    
+    atomic_store(&StressManaged, 0);
+    atomic_store(&StressReclaimed, 0);
+    atomic_store(&StressShared, StressItemCreate());
+    GC = CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *Interface);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Writers; Loop++) pthread_create(&Handles[Loop], NULL, StressWriter, NULL);
+    for (size_t Loop = Writers; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressReader, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    CCConcurrentGarbageCollectorDestroy(GC);
+    CCFree(atomic_load(&StressShared));
+    
+    CCTestAssertEqual(atomic_load(&StressReclaimed), atomic_load(&StressManaged), "Should have reclaimed all managed entities");
+}
+
+#define GC_TESTS(gc, label) \
+{ .name = label "/Management", .run = (CCTestRun)TestManagement, .arg = &gc }, \
+{ .name = label "/SingleThreadedManage", .run = (CCTestRun)TestSingleThreadedManage, .arg = &gc }, \
+{ .name = label "/MultiThreadedManage", .run = (CCTestRun)TestMultiThreadedManage, .arg = &gc }, \
+{ .name = label "/MultiThreadedManage2", .run = (CCTestRun)TestMultiThreadedManage2, .arg = &gc }, \
+{ .name = label "/EarlyReclaimation", .run = (CCTestRun)TestEarlyReclaimation, .arg = &gc }, \
+{ .name = label "/References", .run = (CCTestRun)TestReferences, .arg = &gc }, \
+{ .name = label "/StressReclaimation", .run = (CCTestRun)TestStressReclaimation, .arg = &gc, .stress = TRUE }
+
+static const CCTest Tests[] = {
+    GC_TESTS(CCEpochGarbageCollector, "EpochGarbageCollector"),
+    GC_TESTS(CCLazyGarbageCollector, "LazyGarbageCollector")
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
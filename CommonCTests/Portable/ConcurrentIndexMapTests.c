@@ -0,0 +1,664 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentIndexMap.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+typedef const CCConcurrentGarbageCollectorInterface * const *GCInterface;
+
+static void TestCreation(GCInterface GC)
+{
+    CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), 1, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 0, "Should be empty");
+    CCTestAssertEqual(CCConcurrentIndexMapGetElementSize(IndexMap), sizeof(int), "Should be the size specified on creation");
+    
+    CCConcurrentIndexMapDestroy(IndexMap);
+}
+
+static void TestAppending(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 2 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 3 });
+        
+        int Value;
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 3, "Should contain 3 elements");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should be the first element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should be the second element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should be the third element");
+        
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should not have an element at the given index");
+        
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 4 });
+        
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 4, "Should be the fourth element");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
+static void TestReplacing(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 2 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 3 });
+        
+        int Value;
+        CCTestAssertTrue(CCConcurrentIndexMapReplaceElementAtIndex(IndexMap, 0, &(int){ 10 }, &Value), "Should replace the element");
+        CCTestAssertEqual(Value, 1, "Should retrieve the previous element");
+        CCTestAssertTrue(CCConcurrentIndexMapReplaceElementAtIndex(IndexMap, 1, &(int){ 20 }, &Value), "Should replace the element");
+        CCTestAssertEqual(Value, 2, "Should retrieve the previous element");
+        CCTestAssertTrue(CCConcurrentIndexMapReplaceElementAtIndex(IndexMap, 2, &(int){ 30 }, &Value), "Should replace the element");
+        CCTestAssertEqual(Value, 3, "Should retrieve the previous element");
+        
+        CCTestAssertFalse(CCConcurrentIndexMapReplaceElementAtIndex(IndexMap, 3, &(int){ 40 }, &Value), "Should not replace an element that does not exist");
+        
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 3, "Should contain 3 elements");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should be the first element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should be the second element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 30, "Should be the third element");
+        
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should not have an element at the given index");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
+static void TestReplacingMatches(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 2 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 3 });
+        
+        CCTestAssertTrue(CCConcurrentIndexMapReplaceExactElementAtIndex(IndexMap, 0, &(int){ 10 }, &(int){ 1 }), "Should replace the element");
+        CCTestAssertFalse(CCConcurrentIndexMapReplaceExactElementAtIndex(IndexMap, 1, &(int){ 20 }, &(int){ 5 }), "Should replace the element");
+        CCTestAssertFalse(CCConcurrentIndexMapReplaceExactElementAtIndex(IndexMap, 2, &(int){ 30 }, &(int){ 2 }), "Should replace the element");
+        
+        CCTestAssertFalse(CCConcurrentIndexMapReplaceElementAtIndex(IndexMap, 3, &(int){ 40 }, &(int){ 3 }), "Should not replace an element that does not exist");
+        
+        int Value;
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 3, "Should contain 3 elements");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should be the first element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should be the second element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should be the third element");
+        
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should not have an element at the given index");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
+static void TestRemoving(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        int Value = 0;
+        CCTestAssertFalse(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 0, &Value), "Should not remove the element at index");
+        CCTestAssertEqual(Value, 0, "Should not have been set");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 0, "Should have the correct number of elements");
+        
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 2 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 3 });
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 0, &Value), "Should remove the element at index");
+        CCTestAssertEqual(Value, 1, "Should contain the removed element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 2, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 1, &Value), "Should remove the element at index");
+        CCTestAssertEqual(Value, 3, "Should contain the removed element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 1, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertFalse(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 2, &Value), "Should not remove the element at index");
+        CCTestAssertEqual(Value, 0, "Should not have been set");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 1, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 0, &Value), "Should remove the element at index");
+        CCTestAssertEqual(Value, 2, "Should contain the removed element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 0, "Should have the correct number of elements");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
+static void TestInserting(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        int Value = 0;
+        CCTestAssertFalse(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 0, &(int){ 1 }), "Should not insert the element at index");
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should not have an element at the given index");
+        CCTestAssertEqual(Value, 0, "Should not have been set");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 0, "Should have the correct number of elements");
+        
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 2 });
+        CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 3 });
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 0, &(int){ 10 }), "Should insert the element at index");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should contain the inserted element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 4, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should not contain a value");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 2, &(int){ 20 }), "Should insert the element at index");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should contain the inserted element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 5, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 4, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should not contain a value");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 4, &(int){ 30 }), "Should insert the element at index");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 4, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 30, "Should contain the inserted element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 6, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 4, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 30, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 5, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should not contain a value");
+        
+        Value = 0;
+        CCTestAssertFalse(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 6, &(int){ 40 }), "Should not insert the element at index");
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 6, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 0, "Should not contain a value");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 6, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 5, &(int){ 40 }), "Should insert the element at index");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 5, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 40, "Should contain the inserted element");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 7, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 4, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 30, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 5, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 40, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 6, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should not contain a value");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 0, &(int){ 50 }), "Should insert the element at index");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 50, "Should not contain a value");
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 8, "Should have the correct number of elements");
+        
+        Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 0, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 50, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 10, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 2, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 1, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 3, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 20, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 4, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 2, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 5, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 30, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 6, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 40, "Should not contain a value");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 7, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 3, "Should not contain a value");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
+static void TestGrowingSegments(GCInterface GC)
+{
+    for (size_t ChunkSize = 1; ChunkSize <= 5; ChunkSize++)
+    {
+        CCConcurrentIndexMap IndexMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), ChunkSize, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+        
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            CCTestAssertEqual(CCConcurrentIndexMapAppendElement(IndexMap, &Loop), (size_t)Loop, "Should append the element to the end");
+        }
+        
+        CCTestAssertEqual(CCConcurrentIndexMapGetCount(IndexMap), 1000, "Should contain 1000 elements");
+        
+        _Bool Matches = TRUE;
+        for (int Loop = 0; Loop < 1000; Loop++)
+        {
+            int Value;
+            Matches &= CCConcurrentIndexMapGetElementAtIndex(IndexMap, Loop, &Value) && (Value == Loop);
+        }
+        
+        CCTestAssertTrue(Matches, "Should retain all elements across segments");
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1000, &(int){ 0 }), "Should not have an element at the given index");
+        CCTestAssertFalse(CCConcurrentIndexMapGetElementAtIndex(IndexMap, SIZE_MAX, &(int){ 0 }), "Should not have an element at the given index");
+        
+        int Value = 0;
+        CCTestAssertTrue(CCConcurrentIndexMapInsertElementAtIndex(IndexMap, 500, &(int){ -1 }), "Should insert the element at index");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 1000, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, 999, "Should shift the last element");
+        CCTestAssertTrue(CCConcurrentIndexMapRemoveElementAtIndex(IndexMap, 0, &Value), "Should remove the element at index");
+        CCTestAssertEqual(Value, 0, "Should contain the removed element");
+        CCTestAssertTrue(CCConcurrentIndexMapGetElementAtIndex(IndexMap, 499, &Value), "Should have an element at the given index");
+        CCTestAssertEqual(Value, -1, "Should be the inserted element");
+        CCTestAssertEqual(CCConcurrentIndexMapAppendElement(IndexMap, &(int){ 1000 }), 1000, "Should append the element to the end");
+        
+        CCConcurrentIndexMapDestroy(IndexMap);
+    }
+}
+
+#define ELEMENT_COUNT 1000
+#define ELEMENT_INC 1000
+
+#define THREAD_COUNT 10
+
+static CCConcurrentIndexMap M;
+static _Atomic(int) ReplaceCount = ATOMIC_VAR_INIT(0);
+static _Atomic(int) CorrectCount = ATOMIC_VAR_INIT(0);
+static _Atomic(int) GetElementFailureCount = ATOMIC_VAR_INIT(0);
+static _Atomic(int) ReplaceElementFailureCount = ATOMIC_VAR_INIT(0);
+static void *Counters(void *Arg)
+{
+    size_t Indexes[ELEMENT_COUNT];
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++)
+    {
+        Indexes[Loop] = CCConcurrentIndexMapAppendElement(M, &(int){ Loop + 1 });
+    }
+    
+    int LocalReplaceCount = 0;
+    for (int Loop = 0; Loop < ELEMENT_INC; Loop++)
+    {
+        for (int Loop2 = 0; Loop2 < ELEMENT_COUNT; Loop2++)
+        {
+            int Element;
+            if (CCConcurrentIndexMapGetElementAtIndex(M, Indexes[Loop2], &Element))
+            {
+                int ReplacedElement;
+                if (CCConcurrentIndexMapReplaceElementAtIndex(M, Indexes[Loop2], &(int){ Element + 1 }, &ReplacedElement))
+                {
+                    LocalReplaceCount++;
+                }
+                
+                else
+                {
+                    atomic_fetch_add_explicit(&ReplaceElementFailureCount, 1, memory_order_relaxed);
+                }
+            }
+            
+            else
+            {
+                atomic_fetch_add_explicit(&GetElementFailureCount, 1, memory_order_relaxed);
+            }
+        }
+    }
+    
+    int Matches = 0;
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++)
+    {
+        int Element;
+        if (CCConcurrentIndexMapGetElementAtIndex(M, Indexes[Loop], &Element))
+        {
+            if (Element == (ELEMENT_INC + Loop + 1))
+            {
+                Matches++;
+            }
+        }
+        
+        else
+        {
+            atomic_fetch_add_explicit(&GetElementFailureCount, 1, memory_order_relaxed);
+        }
+    }
+    
+    if (Matches == ELEMENT_COUNT) atomic_fetch_add_explicit(&CorrectCount, 1, memory_order_relaxed);
+    
+    atomic_fetch_add_explicit(&ReplaceCount, LocalReplaceCount, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestMultiThreadedReplacements(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    atomic_store(&ReplaceCount, 0);
+    atomic_store(&CorrectCount, 0);
+    atomic_store(&GetElementFailureCount, 0);
+    atomic_store(&ReplaceElementFailureCount, 0);
+    M = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    pthread_t CounterThreads[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(CounterThreads + Loop, NULL, Counters, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(CounterThreads[Loop], NULL);
+    }
+    
+    
+    CCConcurrentIndexMapDestroy(M);
+    
+    CCTestAssertEqual(atomic_load(&ReplaceCount), ELEMENT_INC * ELEMENT_COUNT * (int)Threads, "Should cause this many replacements");
+    CCTestAssertEqual(atomic_load(&CorrectCount), (int)Threads, "All threads should end up in the correct state");
+    CCTestAssertEqual(atomic_load(&GetElementFailureCount), 0, "Should not fail to retrieve any elements");
+    CCTestAssertEqual(atomic_load(&ReplaceElementFailureCount), 0, "Should not fail to replace any elements");
+}
+
+static CCConcurrentIndexMap M2;
+static void *Appenders(void *Arg)
+{
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++)
+    {
+        CCConcurrentIndexMapAppendElement(M2, &Loop);
+    }
+    
+    return NULL;
+}
+
+static size_t Sum = 0;
+static void *Summer(void *Arg)
+{
+    const size_t Count = ELEMENT_COUNT * (uintptr_t)Arg;
+    
+    Sum = 0;
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        int Element;
+        while (!CCConcurrentIndexMapGetElementAtIndex(M2, Loop, &Element));
+        
+        Sum += Element;
+    }
+    
+    return NULL;
+}
+
+static void TestMultiThreadedAppends(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    M2 = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    pthread_t AppenderThreads[Threads], SummerThread;
+    
+    pthread_create(&SummerThread, NULL, Summer, (void*)(uintptr_t)Threads);
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(AppenderThreads + Loop, NULL, Appenders, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(AppenderThreads[Loop], NULL);
+    }
+    
+    pthread_join(SummerThread, NULL);
+    
+    CCConcurrentIndexMapDestroy(M2);
+    
+    size_t CorrectSum = 0;
+    for (int Loop = 0; Loop < ELEMENT_COUNT; Loop++) CorrectSum += Loop;
+    
+    CCTestAssertEqual(Sum, (CorrectSum * Threads), "Should append all elements");
+}
+
+static CCConcurrentIndexMap M3;
+static _Atomic(size_t) ReplacerSum = ATOMIC_VAR_INIT(0);
+static void *Replacers(void *Arg)
+{
+    size_t LocalSum = 0;
+    for (int Loop = 0; Loop < ELEMENT_INC; Loop++)
+    {
+        int ReplacedElement;
+        if (CCConcurrentIndexMapReplaceElementAtIndex(M3, 0, &(int){ (int)(uintptr_t)Arg }, &ReplacedElement))
+        {
+            LocalSum += ReplacedElement;
+        }
+    }
+    
+    atomic_fetch_add_explicit(&ReplacerSum, LocalSum, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestMultiThreadedSingleElementReplacement(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    atomic_store(&ReplacerSum, 0);
+    
+    M3 = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    CCConcurrentIndexMapAppendElement(M3, &(int){ 1 });
+    
+    pthread_t ReplacerThreads[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(ReplacerThreads + Loop, NULL, Replacers, (void*)(uintptr_t)(Loop + 1));
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(ReplacerThreads[Loop], NULL);
+    }
+    
+    size_t CorrectSum = 1;
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        for (int Loop2 = 0; Loop2 < ELEMENT_INC; Loop2++)
+        {
+            CorrectSum += (Loop + 1);
+        }
+    }
+    
+    int ReplacedElement;
+    if (CCConcurrentIndexMapReplaceElementAtIndex(M3, 0, &(int){ 0 }, &ReplacedElement))
+    {
+        CorrectSum -= ReplacedElement;
+    }
+    
+    CCConcurrentIndexMapDestroy(M3);
+    
+    CCTestAssertEqual(atomic_load(&ReplacerSum), CorrectSum, "Should cause this many replacements");
+}
+
+#pragma mark - Stress
+
+static CCConcurrentIndexMap StressMap;
+static _Atomic(size_t) StressIncrements = ATOMIC_VAR_INIT(0);
+
+/*
+ Each thread appends its own elements and increments them while also contending on a shared counter
+ at index 0 (using compare and swap replacements), and verifies its own elements never go backwards.
+ */
+static void *StressMutator(void *Arg)
+{
+    size_t Indexes[64], Count = 0, Increments = 0, Regressions = 0, Failures = 0;
+    int Expected[64];
+    
+    while (CCTestIsRunning())
+    {
+        if ((Count < 64) && !(CCTestRandom() % 16))
+        {
+            Indexes[Count] = CCConcurrentIndexMapAppendElement(StressMap, &(int){ 0 });
+            Expected[Count++] = 0;
+        }
+        
+        if (Count)
+        {
+            const size_t Local = CCTestRandom() % Count;
+            
+            int Element;
+            if (CCConcurrentIndexMapGetElementAtIndex(StressMap, Indexes[Local], &Element))
+            {
+                if (Element != Expected[Local]) Regressions++;
+                if (CCConcurrentIndexMapReplaceExactElementAtIndex(StressMap, Indexes[Local], &(int){ Element + 1 }, &Element)) Expected[Local] = Element + 1;
+                else Failures++;
+            }
+            
+            else Failures++;
+        }
+        
+        int Shared;
+        if (CCConcurrentIndexMapGetElementAtIndex(StressMap, 0, &Shared))
+        {
+            if (CCConcurrentIndexMapReplaceExactElementAtIndex(StressMap, 0, &(int){ Shared + 1 }, &Shared)) Increments++;
+        }
+        
+        else Failures++;
+    }
+    
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        int Element;
+        if ((!CCConcurrentIndexMapGetElementAtIndex(StressMap, Indexes[Loop], &Element)) || (Element != Expected[Loop])) Regressions++;
+    }
+    
+    CCTestAssertEqual(Regressions, 0, "Elements only modified by this thread should hold the last value it wrote");
+    CCTestAssertEqual(Failures, 0, "Should not fail to retrieve or replace elements only modified by this thread");
+    
+    atomic_fetch_add_explicit(&StressIncrements, Increments, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestStressMutations(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(0);
+    
+    atomic_store(&StressIncrements, 0);
+    StressMap = CCConcurrentIndexMapCreate(CC_STD_ALLOCATOR, sizeof(int), 4, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    CCConcurrentIndexMapAppendElement(StressMap, &(int){ 0 });
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressMutator, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    int Shared = 0;
+    CCConcurrentIndexMapGetElementAtIndex(StressMap, 0, &Shared);
+    
+    CCConcurrentIndexMapDestroy(StressMap);
+    
+    CCTestAssertEqual((size_t)Shared, atomic_load(&StressIncrements), "Each successful compare and swap should increment the shared element once");
+}
+
+#define INDEX_MAP_TESTS(gc, label) \
+{ .name = "ConcurrentIndexMap/" label "/Creation", .run = (CCTestRun)TestCreation, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/Appending", .run = (CCTestRun)TestAppending, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/Replacing", .run = (CCTestRun)TestReplacing, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/ReplacingMatches", .run = (CCTestRun)TestReplacingMatches, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/Removing", .run = (CCTestRun)TestRemoving, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/Inserting", .run = (CCTestRun)TestInserting, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/GrowingSegments", .run = (CCTestRun)TestGrowingSegments, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/MultiThreadedReplacements", .run = (CCTestRun)TestMultiThreadedReplacements, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/MultiThreadedAppends", .run = (CCTestRun)TestMultiThreadedAppends, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/MultiThreadedSingleElementReplacement", .run = (CCTestRun)TestMultiThreadedSingleElementReplacement, .arg = &gc }, \
+{ .name = "ConcurrentIndexMap/" label "/StressMutations", .run = (CCTestRun)TestStressMutations, .arg = &gc, .stress = TRUE }
+
+static const CCTest Tests[] = {
+    INDEX_MAP_TESTS(CCEpochGarbageCollector, "EpochGC"),
+    INDEX_MAP_TESTS(CCLazyGarbageCollector, "LazyGC")
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
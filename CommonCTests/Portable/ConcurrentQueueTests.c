@@ -0,0 +1,480 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentQueue.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+typedef const CCConcurrentGarbageCollectorInterface * const *GCInterface;
+
+static int DestroyedNode2 = 0;
+static void NodeDestructor2(void *Ptr)
+{
+    DestroyedNode2++;
+}
+
+static void TestNodeDestruction(GCInterface GC)
+{
+    DestroyedNode2 = 0;
+    CCConcurrentQueue Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    CCConcurrentQueueNode *N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    
+    CCConcurrentQueueDestroy(Queue);
+    
+    CCTestAssertEqual(DestroyedNode2, 1, "No nodes should be over-retained");
+    
+    
+    DestroyedNode2 = 0;
+    Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    CCConcurrentQueueDestroyNode(CCConcurrentQueuePop(Queue));
+    
+    CCConcurrentQueueDestroy(Queue);
+    
+    CCTestAssertEqual(DestroyedNode2, 1, "No nodes should be over-retained");
+    
+    
+    DestroyedNode2 = 0;
+    Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    CCConcurrentQueueDestroyNode(CCConcurrentQueuePop(Queue));
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    CCConcurrentQueueDestroyNode(CCConcurrentQueuePop(Queue));
+    
+    CCConcurrentQueueDestroy(Queue);
+    
+    CCTestAssertEqual(DestroyedNode2, 2, "No nodes should be over-retained");
+    
+    
+    DestroyedNode2 = 0;
+    Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    CCConcurrentQueueDestroyNode(CCConcurrentQueuePop(Queue));
+    
+    CCConcurrentQueueDestroy(Queue);
+    
+    CCTestAssertEqual(DestroyedNode2, 2, "No nodes should be over-retained");
+    
+    
+    DestroyedNode2 = 0;
+    Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    
+    N = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, 0, NULL);
+    CCMemorySetDestructor(N, NodeDestructor2);
+    
+    CCConcurrentQueuePush(Queue, N);
+    CCConcurrentQueueDestroyNode(CCConcurrentQueuePop(Queue));
+    CCConcurrentQueueDestroyNode(CCConcurrentQueuePop(Queue));
+    
+    CCConcurrentQueueDestroy(Queue);
+    
+    CCTestAssertEqual(DestroyedNode2, 2, "No nodes should be over-retained");
+}
+
+static void TestEmptyDequeues(GCInterface GC)
+{
+    CCConcurrentQueue Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    CCTestAssertEqual(CCConcurrentQueuePop(Queue), NULL, "Should return null when nothing left to dequeue");
+    CCTestAssertEqual(CCConcurrentQueuePop(Queue), NULL, "Should return null when nothing left to dequeue");
+    CCTestAssertEqual(CCConcurrentQueuePop(Queue), NULL, "Should return null when nothing left to dequeue");
+    
+    CCConcurrentQueueDestroy(Queue);
+}
+
+static void TestNodeReuse(GCInterface GC)
+{
+    CCConcurrentQueue Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 1 }));
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 2 }));
+    
+    CCConcurrentQueuePush(Queue, CCConcurrentQueuePop(Queue));
+    
+    CCConcurrentQueueNode *N = CCConcurrentQueuePop(Queue);
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N), 2, "Should return the correct element");
+    CCConcurrentQueueDestroyNode(N);
+    
+    N = CCConcurrentQueuePop(Queue);
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N), 1, "Should return the correct element");
+    CCConcurrentQueueDestroyNode(N);
+    
+    CCConcurrentQueueDestroy(Queue);
+}
+
+static void TestOrdering(GCInterface GC)
+{
+    CCConcurrentQueueNode *N[10] = { NULL };
+    CCConcurrentQueue Queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    N[0] = CCConcurrentQueuePop(Queue);
+    
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 1 }));
+    N[1] = CCConcurrentQueuePop(Queue);
+    
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 2 }));
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 3 }));
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 4 }));
+    
+    N[2] = CCConcurrentQueuePop(Queue);
+    
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 5 }));
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 6 }));
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 7 }));
+    
+    N[3] = CCConcurrentQueuePop(Queue);
+    N[4] = CCConcurrentQueuePop(Queue);
+    N[5] = CCConcurrentQueuePop(Queue);
+    N[6] = CCConcurrentQueuePop(Queue);
+    N[7] = CCConcurrentQueuePop(Queue);
+    N[8] = CCConcurrentQueuePop(Queue);
+    N[9] = CCConcurrentQueuePop(Queue);
+    
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 8 }));
+    CCConcurrentQueuePush(Queue, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ 9 }));
+    
+    CCConcurrentQueueDestroy(Queue);
+    
+    CCTestAssertEqual(N[0], NULL, "Should return null when nothing left to dequeue");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[1]), 1, "Should return the first element");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[2]), 2, "Should return the second element");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[3]), 3, "Should return the third element");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[4]), 4, "Should return the fourth element");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[5]), 5, "Should return the fifth element");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[6]), 6, "Should return the sixth element");
+    CCTestAssertEqual(*(int*)CCConcurrentQueueGetNodeData(N[7]), 7, "Should return the seventh element");
+    CCTestAssertEqual(N[8], NULL, "Should return null when nothing left to dequeue");
+    CCTestAssertEqual(N[9], NULL, "Should return null when nothing left to dequeue");
+    
+    for (int Loop = 0; Loop < 10; Loop++)
+    {
+        if (N[Loop])
+        {
+            CCConcurrentQueueDestroyNode(N[Loop]);
+        }
+    }
+}
+
+#define PUSH_THREADS 20
+#define POP_THREADS 15
+
+#define NODE_COUNT 100000
+
+static _Atomic(size_t) DestroyedNodes = ATOMIC_VAR_INIT(0);
+static void NodeDestructor(void *Ptr)
+{
+    atomic_fetch_add_explicit(&DestroyedNodes, 1, memory_order_relaxed);
+}
+
+static CCConcurrentQueue Q;
+static void *Pusher(void *Arg)
+{
+    for (int Loop = 0; Loop < NODE_COUNT; Loop++)
+    {
+        CCConcurrentQueueNode *Node = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ *(int*)Arg + Loop });
+        CCMemorySetDestructor(Node, NodeDestructor);
+        CCConcurrentQueuePush(Q, Node);
+    }
+    
+    return NULL;
+}
+
+static _Atomic(size_t) Count = ATOMIC_VAR_INIT(0);
+static size_t PushedCount = 0;
+static void *Popper(void *Arg)
+{
+    uintptr_t Sum = 0;
+    for ( ; atomic_load_explicit(&Count, memory_order_relaxed) < PushedCount; )
+    {
+        CCConcurrentQueueNode *Node = CCConcurrentQueuePop(Q);
+        if (Node)
+        {
+            atomic_fetch_add_explicit(&Count, 1, memory_order_relaxed);
+            Sum += *(int*)CCConcurrentQueueGetNodeData(Node);
+            CCConcurrentQueueDestroyNode(Node);
+        }
+    }
+    
+    return (void*)Sum;
+}
+
+static void TestMultiThreading(GCInterface GC)
+{
+    const size_t PushThreads = CCTestGetThreadCount(PUSH_THREADS), PopThreads = CCTestGetThreadCount(POP_THREADS);
+    
+    atomic_store(&DestroyedNodes, 0);
+    atomic_store(&Count, 0);
+    PushedCount = PushThreads * NODE_COUNT;
+    Q = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    pthread_t Push[PushThreads], Pop[PopThreads];
+    int PushArgs[PushThreads];
+    
+    for (size_t Loop = 0; Loop < PushThreads; Loop++)
+    {
+        PushArgs[Loop] = (int)Loop * 100;
+        pthread_create(Push + Loop, NULL, Pusher, PushArgs + Loop);
+    }
+    
+    for (size_t Loop = 0; Loop < PopThreads; Loop++)
+    {
+        pthread_create(Pop + Loop, NULL, Popper, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < PushThreads; Loop++)
+    {
+        pthread_join(Push[Loop], NULL);
+    }
+    
+    uintptr_t Sum = 0;
+    for (size_t Loop = 0; Loop < PopThreads; Loop++)
+    {
+        uintptr_t Result = 0;
+        pthread_join(Pop[Loop], (void**)&Result);
+        Sum += Result;
+    }
+    
+    uintptr_t Actual = 0;
+    for (size_t Loop = 0; Loop < PushThreads; Loop++)
+    {
+        for (int Loop2 = 0; Loop2 < NODE_COUNT; Loop2++)
+        {
+            Actual += PushArgs[Loop] + Loop2;
+        }
+    }
+    
+    CCConcurrentQueueDestroy(Q);
+    
+    CCTestAssertEqual(Sum, Actual, "Should calculate the correct result");
+    CCTestAssertEqual(atomic_load_explicit(&DestroyedNodes, memory_order_relaxed), PushedCount, "No nodes should be over-retained");
+}
+
+#undef PUSH_THREADS
+#define PUSH_THREADS 9
+
+#undef NODE_COUNT
+#define NODE_COUNT 80
+
+static CCConcurrentQueue Q2;
+static void *Pusher2(void *Arg)
+{
+    for (int Loop = 0; Loop < NODE_COUNT; Loop++)
+    {
+        CCConcurrentQueuePush(Q2, CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(int), &(int){ *(int*)Arg + Loop }));
+    }
+    
+    return NULL;
+}
+
+static void TestMultiThreadedOrdering(GCInterface GC)
+{
+    Q2 = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    
+    pthread_t Push[PUSH_THREADS];
+    int PushArgs[PUSH_THREADS];
+    
+    for (int Loop = 0; Loop < PUSH_THREADS; Loop++)
+    {
+        PushArgs[Loop] = Loop * 100;
+        pthread_create(Push + Loop, NULL, Pusher2, PushArgs + Loop);
+    }
+    
+    for (int Loop = 0; Loop < PUSH_THREADS; Loop++)
+    {
+        pthread_join(Push[Loop], NULL);
+        PushArgs[Loop] = -1;
+    }
+    
+    for (int Loop = 0; Loop < PUSH_THREADS; Loop++)
+    {
+        for (int Loop2 = 0; Loop2 < NODE_COUNT; Loop2++)
+        {
+            CCConcurrentQueueNode *Node = CCConcurrentQueuePop(Q2);
+            int Value = *(int*)CCConcurrentQueueGetNodeData(Node);
+            CCConcurrentQueueDestroyNode(Node);
+            
+            CCTestAssertLessThan(PushArgs[Value / 100], Value, "Thread enqueued items should be ordered sequentially");
+            PushArgs[Value / 100] = Value;
+        }
+    }
+    
+    CCConcurrentQueueDestroy(Q2);
+}
+
+#pragma mark - Stress
+
+typedef struct {
+    size_t producer;
+    size_t sequence;
+} StressValue;
+
+typedef struct {
+    CCConcurrentQueue queue;
+    size_t producers;
+    _Atomic(size_t) activeProducers;
+    _Atomic(size_t) pushed;
+    _Atomic(size_t) popped;
+    _Atomic(size_t) destroyed;
+} StressState;
+
+static StressState Stress;
+static void StressNodeDestructor(void *Ptr)
+{
+    atomic_fetch_add_explicit(&Stress.destroyed, 1, memory_order_relaxed);
+}
+
+static void *StressProducer(void *Arg)
+{
+    const size_t Producer = (uintptr_t)Arg;
+    
+    size_t Sequence = 0;
+    while (CCTestIsRunning())
+    {
+        //push in small bursts so consumers see both empty and non-empty queues
+        for (size_t Loop = 0, Burst = CCTestRandom() % 64; Loop < Burst; Loop++)
+        {
+            CCConcurrentQueueNode *Node = CCConcurrentQueueCreateNode(CC_STD_ALLOCATOR, sizeof(StressValue), &(StressValue){ .producer = Producer, .sequence = Sequence++ });
+            CCMemorySetDestructor(Node, StressNodeDestructor);
+            CCConcurrentQueuePush(Stress.queue, Node);
+        }
+    }
+    
+    atomic_fetch_add_explicit(&Stress.pushed, Sequence, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&Stress.activeProducers, 1, memory_order_release);
+    
+    return NULL;
+}
+
+static void *StressConsumer(void *Arg)
+{
+    size_t Last[Stress.producers];
+    for (size_t Loop = 0; Loop < Stress.producers; Loop++) Last[Loop] = SIZE_MAX;
+    
+    size_t Popped = 0, Unordered = 0;
+    for ( ; ; )
+    {
+        const _Bool Finished = !atomic_load_explicit(&Stress.activeProducers, memory_order_acquire);
+        
+        CCConcurrentQueueNode *Node = CCConcurrentQueuePop(Stress.queue);
+        if (Node)
+        {
+            const StressValue *Value = CCConcurrentQueueGetNodeData(Node);
+            
+            //FIFO means any one consumer must see each producer's values in the order they were pushed
+            if ((Last[Value->producer] != SIZE_MAX) && (Last[Value->producer] >= Value->sequence)) Unordered++;
+            
+            Last[Value->producer] = Value->sequence;
+            Popped++;
+            
+            CCConcurrentQueueDestroyNode(Node);
+        }
+        
+        else if (Finished) break;
+    }
+    
+    CCTestAssertEqual(Unordered, 0, "Each producer's values should be popped in the order they were pushed");
+    
+    atomic_fetch_add_explicit(&Stress.popped, Popped, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestStressPushPop(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(0) < 2 ? 2 : CCTestGetThreadCount(0);
+    const size_t Producers = Threads / 2;
+    
+    Stress.queue = CCConcurrentQueueCreate(CC_STD_ALLOCATOR, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+    Stress.producers = Producers;
+    atomic_store(&Stress.activeProducers, Producers);
+    atomic_store(&Stress.pushed, 0);
+    atomic_store(&Stress.popped, 0);
+    atomic_store(&Stress.destroyed, 0);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Producers; Loop++) pthread_create(&Handles[Loop], NULL, StressProducer, (void*)(uintptr_t)Loop);
+    for (size_t Loop = Producers; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressConsumer, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    CCTestAssertEqual(CCConcurrentQueuePop(Stress.queue), NULL, "Should have popped every node");
+    
+    CCConcurrentQueueDestroy(Stress.queue);
+    
+    CCTestAssertEqual(atomic_load(&Stress.popped), atomic_load(&Stress.pushed), "Should pop every pushed node");
+    CCTestAssertEqual(atomic_load(&Stress.destroyed), atomic_load(&Stress.pushed), "No nodes should be over-retained");
+}
+
+#define QUEUE_TESTS(gc, label) \
+{ .name = "ConcurrentQueue/" label "/NodeDestruction", .run = (CCTestRun)TestNodeDestruction, .arg = &gc }, \
+{ .name = "ConcurrentQueue/" label "/EmptyDequeues", .run = (CCTestRun)TestEmptyDequeues, .arg = &gc }, \
+{ .name = "ConcurrentQueue/" label "/NodeReuse", .run = (CCTestRun)TestNodeReuse, .arg = &gc }, \
+{ .name = "ConcurrentQueue/" label "/Ordering", .run = (CCTestRun)TestOrdering, .arg = &gc }, \
+{ .name = "ConcurrentQueue/" label "/MultiThreading", .run = (CCTestRun)TestMultiThreading, .arg = &gc }, \
+{ .name = "ConcurrentQueue/" label "/MultiThreadedOrdering", .run = (CCTestRun)TestMultiThreadedOrdering, .arg = &gc }, \
+{ .name = "ConcurrentQueue/" label "/StressPushPop", .run = (CCTestRun)TestStressPushPop, .arg = &gc, .stress = TRUE }
+
+static const CCTest Tests[] = {
+    QUEUE_TESTS(CCEpochGarbageCollector, "EpochGC"),
+    QUEUE_TESTS(CCLazyGarbageCollector, "LazyGC")
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
@@ -0,0 +1,300 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentTree.h>
+#include <CommonC/EpochGarbageCollector.h>
+#include <CommonC/LazyGarbageCollector.h>
+#include <CommonC/MemoryAllocation.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <limits.h>
+
+typedef const CCConcurrentGarbageCollectorInterface * const *GCInterface;
+
+static CCComparisonResult IntComparator(const int *Left, const int *Right)
+{
+    return *Left == *Right ? CCComparisonResultEqual : (*Left < *Right ? CCComparisonResultAscending : CCComparisonResultDescending);
+}
+
+static CCConcurrentTree CreateTree(GCInterface GC)
+{
+    return CCConcurrentTreeCreate(CC_STD_ALLOCATOR, sizeof(int), sizeof(int), (CCComparator)IntComparator, CCConcurrentGarbageCollectorCreate(CC_STD_ALLOCATOR, *GC));
+}
+
+static void TestCreation(GCInterface GC)
+{
+    CCConcurrentTree Tree = CreateTree(GC);
+    
+    CCTestAssertEqual(CCConcurrentTreeGetCount(Tree), 0, "Should be empty");
+    CCTestAssertFalse(CCConcurrentTreeFind(Tree, &(int){ 0 }, NULL), "Should not contain any entries");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+static void TestInserting(GCInterface GC)
+{
+    CCConcurrentTree Tree = CreateTree(GC);
+    
+    _Bool Inserted = TRUE;
+    for (int Loop = 0; Loop < 1000; Loop++)
+    {
+        const int Key = (Loop * 7919) % 1000;
+        Inserted &= CCConcurrentTreeInsert(Tree, &Key, &(int){ -Key });
+    }
+    
+    CCTestAssertTrue(Inserted, "Should insert the entries");
+    CCTestAssertFalse(CCConcurrentTreeInsert(Tree, &(int){ 5 }, &(int){ 0 }), "Should not insert a duplicate key");
+    CCTestAssertEqual(CCConcurrentTreeGetCount(Tree), 1000, "Should contain 1000 entries");
+    
+    _Bool Matches = TRUE;
+    for (int Loop = 0; Loop < 1000; Loop++)
+    {
+        int Value;
+        Matches &= CCConcurrentTreeFind(Tree, &Loop, &Value) && (Value == -Loop);
+    }
+    
+    CCTestAssertTrue(Matches, "Should find all entries");
+    CCTestAssertFalse(CCConcurrentTreeFind(Tree, &(int){ 1000 }, NULL), "Should not find a key that was not inserted");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+static void TestRemoving(GCInterface GC)
+{
+    CCConcurrentTree Tree = CreateTree(GC);
+    
+    for (int Loop = 0; Loop < 100; Loop++) CCConcurrentTreeInsert(Tree, &Loop, &(int){ Loop * 2 });
+    
+    int Value;
+    CCTestAssertTrue(CCConcurrentTreeRemove(Tree, &(int){ 50 }, &Value), "Should remove the entry");
+    CCTestAssertEqual(Value, 100, "Should be the removed value");
+    CCTestAssertFalse(CCConcurrentTreeRemove(Tree, &(int){ 50 }, NULL), "Should not remove an entry that does not exist");
+    CCTestAssertFalse(CCConcurrentTreeFind(Tree, &(int){ 50 }, NULL), "Should not find the removed entry");
+    CCTestAssertTrue(CCConcurrentTreeFind(Tree, &(int){ 51 }, &Value), "Should find the neighbouring entry");
+    CCTestAssertEqual(Value, 102, "Should be the neighbouring value");
+    CCTestAssertEqual(CCConcurrentTreeGetCount(Tree), 99, "Should contain 99 entries");
+    
+    CCTestAssertTrue(CCConcurrentTreeInsert(Tree, &(int){ 50 }, &(int){ 1 }), "Should insert a previously removed key");
+    CCTestAssertTrue(CCConcurrentTreeFind(Tree, &(int){ 50 }, &Value), "Should find the reinserted entry");
+    CCTestAssertEqual(Value, 1, "Should be the reinserted value");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+static _Bool OrderEnumerator(const void *Key, const void *Value, void *Data)
+{
+    int *Prev = Data;
+    if (*(const int*)Key <= *Prev) return FALSE;
+    
+    *Prev = *(const int*)Key;
+    
+    return TRUE;
+}
+
+static _Bool StopEnumerator(const void *Key, const void *Value, void *Data)
+{
+    return OrderEnumerator(Key, Value, Data) && (*(const int*)Key != 150);
+}
+
+static void TestEnumeratingRanges(GCInterface GC)
+{
+    CCConcurrentTree Tree = CreateTree(GC);
+    
+    for (int Loop = 999; Loop >= 0; Loop--) CCConcurrentTreeInsert(Tree, &Loop, &Loop);
+    
+    int Prev = -1;
+    CCTestAssertEqual(CCConcurrentTreeEnumerateRange(Tree, NULL, NULL, StopEnumerator, &Prev), 151, "Should stop enumerating when the enumerator returns false");
+    CCTestAssertEqual(Prev, 150, "Should enumerate the keys in ascending order");
+    
+    Prev = 199;
+    CCTestAssertEqual(CCConcurrentTreeEnumerateRange(Tree, &(int){ 200 }, &(int){ 300 }, OrderEnumerator, &Prev), 100, "Should enumerate the keys in the range");
+    CCTestAssertEqual(Prev, 299, "Should exclude the upper bound");
+    
+    Prev = 899;
+    CCTestAssertEqual(CCConcurrentTreeEnumerateRange(Tree, &(int){ 900 }, NULL, OrderEnumerator, &Prev), 100, "Should enumerate until the last entry");
+    CCTestAssertEqual(CCConcurrentTreeEnumerateRange(Tree, &(int){ 2000 }, NULL, OrderEnumerator, &Prev), 0, "Should not enumerate any entries");
+    
+    CCConcurrentTreeDestroy(Tree);
+}
+
+#define THREAD_COUNT 10
+#define KEY_COUNT 256
+#define OPERATION_COUNT 10000
+
+static CCConcurrentTree T;
+static _Atomic(size_t) InsertCount = ATOMIC_VAR_INIT(0), RemoveCount = ATOMIC_VAR_INIT(0), MismatchCount = ATOMIC_VAR_INIT(0);
+
+/*
+ Apply a random insertion or removal to the shared tree, checking any value that is read. Values are always twice
+ their key, so any other value was torn or belongs to another entry.
+ */
+static void Mutate(uint32_t *Seed, size_t *Inserted, size_t *Removed, size_t *Mismatched)
+{
+    *Seed = (*Seed * 1103515245) + 12345;
+    
+    const int Key = (*Seed >> 8) % KEY_COUNT;
+    int Value;
+    if (*Seed & 0x10000)
+    {
+        if (CCConcurrentTreeInsert(T, &Key, &(int){ Key * 2 })) (*Inserted)++;
+    }
+    
+    else if (CCConcurrentTreeRemove(T, &Key, &Value))
+    {
+        (*Removed)++;
+        *Mismatched += Value != (Key * 2);
+    }
+    
+    if (CCConcurrentTreeFind(T, &Key, &Value)) *Mismatched += Value != (Key * 2);
+}
+
+static void *Mutators(void *Arg)
+{
+    uint32_t Seed = (uint32_t)(uintptr_t)Arg;
+    size_t Inserted = 0, Removed = 0, Mismatched = 0;
+    for (int Loop = 0; Loop < OPERATION_COUNT; Loop++) Mutate(&Seed, &Inserted, &Removed, &Mismatched);
+    
+    atomic_fetch_add_explicit(&InsertCount, Inserted, memory_order_relaxed);
+    atomic_fetch_add_explicit(&RemoveCount, Removed, memory_order_relaxed);
+    atomic_fetch_add_explicit(&MismatchCount, Mismatched, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestMultiThreadedMutations(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    atomic_store(&InsertCount, 0);
+    atomic_store(&RemoveCount, 0);
+    atomic_store(&MismatchCount, 0);
+    T = CreateTree(GC);
+    
+    pthread_t MutatorThreads[Threads];
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(MutatorThreads + Loop, NULL, Mutators, (void*)(uintptr_t)(Loop + 1));
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(MutatorThreads[Loop], NULL);
+    }
+    
+    const size_t Count = CCConcurrentTreeGetCount(T);
+    CCTestAssertEqual(Count, atomic_load(&InsertCount) - atomic_load(&RemoveCount), "Should balance the insertions and removals");
+    CCTestAssertEqual(atomic_load(&MismatchCount), 0, "Should not retrieve any incorrect values");
+    
+    int Prev = -1;
+    CCTestAssertEqual(CCConcurrentTreeEnumerateRange(T, NULL, NULL, OrderEnumerator, &Prev), Count, "Should enumerate all remaining entries in order");
+    
+    CCConcurrentTreeDestroy(T);
+}
+
+#pragma mark - Stress
+
+static _Bool StressEnumerator(const void *Key, const void *Value, void *Data)
+{
+    //values are always twice their key, and keys must be ascending, otherwise mark the enumeration as failed
+    int *Prev = Data;
+    if ((*(const int*)Key <= *Prev) || (*(const int*)Value != (*(const int*)Key * 2)))
+    {
+        *Prev = INT_MAX;
+        return FALSE;
+    }
+    
+    *Prev = *(const int*)Key;
+    
+    return TRUE;
+}
+
+static void *StressMutator(void *Arg)
+{
+    uint32_t Seed = CCTestRandom();
+    size_t Inserted = 0, Removed = 0, Mismatched = 0, Unordered = 0;
+    while (CCTestIsRunning())
+    {
+        //occasionally enumerate while the other threads mutate, which must still see ascending keys
+        if ((CCTestRandom() % 64) == 0)
+        {
+            int Prev = -1;
+            CCConcurrentTreeEnumerateRange(T, NULL, NULL, StressEnumerator, &Prev);
+            Unordered += Prev == INT_MAX;
+        }
+        
+        else Mutate(&Seed, &Inserted, &Removed, &Mismatched);
+    }
+    
+    CCTestAssertEqual(Unordered, 0, "Should enumerate the entries in ascending order");
+    
+    atomic_fetch_add_explicit(&InsertCount, Inserted, memory_order_relaxed);
+    atomic_fetch_add_explicit(&RemoveCount, Removed, memory_order_relaxed);
+    atomic_fetch_add_explicit(&MismatchCount, Mismatched, memory_order_relaxed);
+    
+    return NULL;
+}
+
+static void TestStressMutations(GCInterface GC)
+{
+    const size_t Threads = CCTestGetThreadCount(0);
+    
+    atomic_store(&InsertCount, 0);
+    atomic_store(&RemoveCount, 0);
+    atomic_store(&MismatchCount, 0);
+    T = CreateTree(GC);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressMutator, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    const size_t Count = CCConcurrentTreeGetCount(T);
+    CCTestAssertEqual(Count, atomic_load(&InsertCount) - atomic_load(&RemoveCount), "Should balance the insertions and removals");
+    CCTestAssertEqual(atomic_load(&MismatchCount), 0, "Should not retrieve any incorrect values");
+    
+    int Prev = -1;
+    CCTestAssertEqual(CCConcurrentTreeEnumerateRange(T, NULL, NULL, OrderEnumerator, &Prev), Count, "Should enumerate all remaining entries in order");
+    
+    CCConcurrentTreeDestroy(T);
+}
+
+#define TREE_TESTS(gc, label) \
+{ .name = "ConcurrentTree/" label "/Creation", .run = (CCTestRun)TestCreation, .arg = &gc }, \
+{ .name = "ConcurrentTree/" label "/Inserting", .run = (CCTestRun)TestInserting, .arg = &gc }, \
+{ .name = "ConcurrentTree/" label "/Removing", .run = (CCTestRun)TestRemoving, .arg = &gc }, \
+{ .name = "ConcurrentTree/" label "/EnumeratingRanges", .run = (CCTestRun)TestEnumeratingRanges, .arg = &gc }, \
+{ .name = "ConcurrentTree/" label "/MultiThreadedMutations", .run = (CCTestRun)TestMultiThreadedMutations, .arg = &gc }, \
+{ .name = "ConcurrentTree/" label "/StressMutations", .run = (CCTestRun)TestStressMutations, .arg = &gc, .stress = TRUE }
+
+static const CCTest Tests[] = {
+    TREE_TESTS(CCEpochGarbageCollector, "EpochGC"),
+    TREE_TESTS(CCLazyGarbageCollector, "LazyGC")
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
@@ -0,0 +1,283 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentIDGenerator.h>
+#include <CommonC/ConsecutiveIDGenerator.h>
+#include <CommonC/MemoryAllocation.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+static void TestExhaustingPool(const void *Arg)
+{
+    size_t ID[17];
+    CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, sizeof(ID) / sizeof(size_t), CCConsecutiveIDGenerator);
+    
+    CCTestAssertEqual(17, CCConcurrentIDGeneratorGetMaxID(Pool), "Should return the correct size");
+    
+    size_t Sum = 0, ExpectedSum = 0, MaxID = 0, MinID = SIZE_MAX;
+    for (size_t Loop = 0; Loop < sizeof(ID) / sizeof(size_t); Loop++)
+    {
+        CCTestAssertTrue(CCConcurrentIDGeneratorTryAssign(Pool, &ID[Loop]), "Should assign ID");
+        Sum += ID[Loop];
+        ExpectedSum += Loop;
+        if (MaxID < ID[Loop]) MaxID = ID[Loop];
+        if (MinID > ID[Loop]) MinID = ID[Loop];
+    }
+    
+    CCTestAssertEqual(MinID, 0, "IDs should start from 0");
+    CCTestAssertEqual(MaxID, 16, "IDs should end at size - 1");
+    CCTestAssertEqual(Sum, ExpectedSum, "Should not assign any ID more than once");
+    CCTestAssertFalse(CCConcurrentIDGeneratorTryAssign(Pool, &Sum), "Should not assign an ID");
+    
+    CCConcurrentIDGeneratorRecycle(Pool, ID[0]);
+    CCTestAssertTrue(CCConcurrentIDGeneratorTryAssign(Pool, &Sum), "Should assign ID");
+    
+    CCConcurrentIDGeneratorDestroy(Pool);
+}
+
+static void TestExhaustingLargePool(const void *Arg)
+{
+    const size_t Sizes[] = { 64, 65, 4096, 4097, 300000 };
+    for (size_t Loop = 0; Loop < sizeof(Sizes) / sizeof(*Sizes); Loop++)
+    {
+        CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, Sizes[Loop], CCConsecutiveIDGenerator);
+        
+        uint8_t *Assigned = calloc(Sizes[Loop], sizeof(uint8_t));
+        _Bool Unique = TRUE;
+        for (size_t Loop2 = 0; Loop2 < Sizes[Loop]; Loop2++)
+        {
+            uintptr_t ID;
+            if ((!CCConcurrentIDGeneratorTryAssign(Pool, &ID)) || (ID >= Sizes[Loop]) || (Assigned[ID]))
+            {
+                Unique = FALSE;
+                break;
+            }
+            
+            Assigned[ID] = 1;
+        }
+        
+        free(Assigned);
+        
+        uintptr_t ID;
+        CCTestAssertTrue(Unique, "Should assign every ID exactly once");
+        CCTestAssertFalse(CCConcurrentIDGeneratorTryAssign(Pool, &ID), "Should not assign an ID");
+        
+        CCConcurrentIDGeneratorRecycle(Pool, Sizes[Loop] - 1);
+        CCConcurrentIDGeneratorRecycle(Pool, 0);
+        
+        CCTestAssertTrue(CCConcurrentIDGeneratorTryAssign(Pool, &ID), "Should assign ID");
+        CCTestAssertTrue((ID == 0) || (ID == Sizes[Loop] - 1), "Should assign a recycled ID");
+        CCTestAssertTrue(CCConcurrentIDGeneratorTryAssign(Pool, &ID), "Should assign ID");
+        CCTestAssertTrue((ID == 0) || (ID == Sizes[Loop] - 1), "Should assign a recycled ID");
+        CCTestAssertFalse(CCConcurrentIDGeneratorTryAssign(Pool, &ID), "Should not assign an ID");
+        
+        CCConcurrentIDGeneratorDestroy(Pool);
+    }
+}
+
+#define THREAD_COUNT 20
+#define IDS_PER_THREAD 500
+
+static CCConcurrentIDGenerator P;
+static _Atomic(size_t) Assigned = ATOMIC_VAR_INIT(0);
+static void *Worker(void *Arg)
+{
+    uintptr_t Sum = 0;
+    size_t ID[IDS_PER_THREAD];
+    for (size_t Loop = 0; Loop < IDS_PER_THREAD; Loop++)
+    {
+        ID[Loop] = CCConcurrentIDGeneratorAssign(P);
+        Sum += ID[Loop];
+    }
+    
+    //every ID has to be assigned before any are recycled, otherwise IDs could legitimately be assigned twice
+    atomic_fetch_sub_explicit(&Assigned, 1, memory_order_release);
+    while (atomic_load_explicit(&Assigned, memory_order_acquire));
+    
+    for (size_t Loop = 0; Loop < IDS_PER_THREAD; Loop++) CCConcurrentIDGeneratorRecycle(P, ID[Loop]);
+    
+    return (void*)Sum;
+}
+
+static void TestMultiThreading(const void *Arg)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT), IDPool = IDS_PER_THREAD * Threads;
+    
+    atomic_store(&Assigned, Threads);
+    P = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, IDPool, CCConsecutiveIDGenerator);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, Worker, NULL);
+    }
+    
+    uintptr_t Sum = 0, Expected = 0;
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        uintptr_t Result = 0;
+        pthread_join(Handles[Loop], (void**)&Result);
+        Sum += Result;
+    }
+    
+    for (size_t Loop = 0; Loop < IDPool; Loop++) Expected += Loop;
+    
+    CCTestAssertEqual(Sum, Expected, "Should not assign any ID more than once");
+    
+    Sum = 0;
+    for (size_t Loop = 0; Loop < IDPool; Loop++)
+    {
+        Sum += CCConcurrentIDGeneratorAssign(P);
+    }
+    
+    CCTestAssertEqual(Sum, Expected, "All IDs should have been recycled");
+    
+    CCConcurrentIDGeneratorDestroy(P);
+}
+
+static void *Worker2(void *Arg)
+{
+    size_t ID[IDS_PER_THREAD], Count = 0, FailureCount = 0;
+    for (size_t Loop = 0; Loop < IDS_PER_THREAD; )
+    {
+        if (CCConcurrentIDGeneratorTryAssign(P, &ID[Count]))
+        {
+            Loop++;
+            Count++;
+        }
+        
+        else if (FailureCount == 10)
+        {
+            for (size_t Loop = 0; Loop < Count; Loop++) CCConcurrentIDGeneratorRecycle(P, ID[Loop]);
+            FailureCount = 0;
+            Count = 0;
+        }
+        
+        else FailureCount++;
+    }
+    
+    for (size_t Loop = 0; Loop < Count; Loop++) CCConcurrentIDGeneratorRecycle(P, ID[Loop]);
+    
+    return NULL;
+}
+
+static void TestSmallPoolMultiThreading(const void *Arg)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT), IDPool = (IDS_PER_THREAD / 5) * Threads;
+    
+    P = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, IDPool, CCConsecutiveIDGenerator);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, Worker2, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    uintptr_t Sum = 0, Expected = 0;
+    for (size_t Loop = 0; Loop < IDPool; Loop++)
+    {
+        Sum += CCConcurrentIDGeneratorAssign(P);
+        Expected += Loop;
+    }
+    
+    CCTestAssertEqual(Sum, Expected, "All IDs should have been recycled");
+    
+    CCConcurrentIDGeneratorDestroy(P);
+}
+
+#pragma mark - Stress
+
+#define STRESS_POOL 4096
+
+static _Atomic(uint8_t) Owners[STRESS_POOL];
+static void *StressWorker(void *Arg)
+{
+    uintptr_t ID[64];
+    size_t Conflicts = 0;
+    while (CCTestIsRunning())
+    {
+        //hold a random batch so the pool is repeatedly drained and refilled by the other threads
+        size_t Count = 0;
+        for (size_t Loop = 0, Batch = CCTestRandom() % 64; (Loop < Batch) && (CCConcurrentIDGeneratorTryAssign(P, &ID[Count])); Loop++, Count++)
+        {
+            if ((ID[Count] >= STRESS_POOL) || (atomic_fetch_add_explicit(&Owners[ID[Count]], 1, memory_order_relaxed))) Conflicts++;
+        }
+        
+        for (size_t Loop = 0; Loop < Count; Loop++)
+        {
+            if (ID[Loop] < STRESS_POOL) atomic_fetch_sub_explicit(&Owners[ID[Loop]], 1, memory_order_relaxed);
+            
+            CCConcurrentIDGeneratorRecycle(P, ID[Loop]);
+        }
+    }
+    
+    CCTestAssertEqual(Conflicts, 0, "Should not assign any ID more than once");
+    
+    return NULL;
+}
+
+static void TestStressAssignRecycle(const void *Arg)
+{
+    const size_t Threads = CCTestGetThreadCount(0);
+    
+    for (size_t Loop = 0; Loop < STRESS_POOL; Loop++) atomic_store(&Owners[Loop], 0);
+    P = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, STRESS_POOL, CCConsecutiveIDGenerator);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressWorker, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    uintptr_t Sum = 0, Expected = 0;
+    for (size_t Loop = 0; Loop < STRESS_POOL; Loop++)
+    {
+        uintptr_t ID;
+        if (CCConcurrentIDGeneratorTryAssign(P, &ID)) Sum += ID;
+        Expected += Loop;
+    }
+    
+    CCTestAssertEqual(Sum, Expected, "All IDs should have been recycled");
+    
+    CCConcurrentIDGeneratorDestroy(P);
+}
+
+static const CCTest Tests[] = {
+    { .name = "ConsecutiveIDGenerator/ExhaustingPool", .run = TestExhaustingPool },
+    { .name = "ConsecutiveIDGenerator/ExhaustingLargePool", .run = TestExhaustingLargePool },
+    { .name = "ConsecutiveIDGenerator/MultiThreading", .run = TestMultiThreading },
+    { .name = "ConsecutiveIDGenerator/SmallPoolMultiThreading", .run = TestSmallPoolMultiThreading },
+    { .name = "ConsecutiveIDGenerator/StressAssignRecycle", .run = TestStressAssignRecycle, .stress = TRUE }
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
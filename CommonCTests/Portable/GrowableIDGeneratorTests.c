@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/ConcurrentIDGenerator.h>
+#include <CommonC/GrowableIDGenerator.h>
+#include <CommonC/MemoryAllocation.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+static void TestGrowing(const void *Arg)
+{
+    CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 4, CCGrowableIDGenerator);
+    
+    CCTestAssertEqual(4, CCConcurrentIDGeneratorGetMaxID(Pool), "Should return the initial size");
+    
+    uint8_t *Assigned = calloc(10000, sizeof(uint8_t));
+    _Bool Unique = TRUE;
+    for (size_t Loop = 0; Loop < 10000; Loop++)
+    {
+        uintptr_t ID;
+        if (!CCConcurrentIDGeneratorTryAssign(Pool, &ID))
+        {
+            Unique = FALSE;
+            break;
+        }
+        
+        if (ID < 10000)
+        {
+            Unique &= !Assigned[ID];
+            Assigned[ID] = 1;
+        }
+    }
+    
+    _Bool Consecutive = TRUE;
+    for (size_t Loop = 0; Loop < 10000; Loop++) Consecutive &= Assigned[Loop];
+    
+    free(Assigned);
+    
+    CCTestAssertTrue(Unique, "Should not assign any ID more than once");
+    CCTestAssertTrue(Consecutive, "Should assign IDs from the start of the ID space");
+    CCTestAssertTrue(CCConcurrentIDGeneratorGetMaxID(Pool) >= 10000, "Should grow the ID space");
+    
+    CCConcurrentIDGeneratorDestroy(Pool);
+}
+
+static void TestRecycling(const void *Arg)
+{
+    CCConcurrentIDGenerator Pool = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 16, CCGrowableIDGenerator);
+    
+    uintptr_t ID[100];
+    for (size_t Loop = 0; Loop < 100; Loop++) ID[Loop] = CCConcurrentIDGeneratorAssign(Pool);
+    
+    const uintptr_t MaxID = CCConcurrentIDGeneratorGetMaxID(Pool);
+    
+    for (size_t Loop = 0; Loop < 100; Loop++) CCConcurrentIDGeneratorRecycle(Pool, ID[Loop]);
+    
+    _Bool Reused = TRUE;
+    for (size_t Loop = 0; Loop < 100; Loop++) Reused &= CCConcurrentIDGeneratorAssign(Pool) < MaxID;
+    
+    CCTestAssertTrue(Reused, "Should reuse the recycled IDs");
+    CCTestAssertEqual(CCConcurrentIDGeneratorGetMaxID(Pool), MaxID, "Should not grow while recycled IDs are available");
+    
+    CCConcurrentIDGeneratorDestroy(Pool);
+}
+
+#define THREAD_COUNT 20
+#define IDS_PER_THREAD 500
+
+/*
+ Each thread holds at most IDS_PER_THREAD IDs at once, so the ID space should never need to grow much beyond the
+ IDs in use. Any ID outside of this bound (or owned by two threads at once) is counted as a conflict.
+ */
+#define OWNER_COUNT (IDS_PER_THREAD * 256)
+
+static CCConcurrentIDGenerator P;
+static size_t MaxOwner;
+static _Atomic(int) Owners[OWNER_COUNT];
+static _Atomic(size_t) ConflictCount = ATOMIC_VAR_INIT(0);
+
+static void Own(uintptr_t ID)
+{
+    if ((ID >= MaxOwner) || (atomic_fetch_add_explicit(&Owners[ID], 1, memory_order_relaxed))) atomic_fetch_add_explicit(&ConflictCount, 1, memory_order_relaxed);
+}
+
+static void Disown(uintptr_t ID)
+{
+    if (ID < MaxOwner) atomic_fetch_sub_explicit(&Owners[ID], 1, memory_order_relaxed);
+    
+    CCConcurrentIDGeneratorRecycle(P, ID);
+}
+
+static void *Worker(void *Arg)
+{
+    uintptr_t ID[IDS_PER_THREAD];
+    for (size_t Loop = 0; Loop < 100; Loop++)
+    {
+        const size_t Count = (Loop * 37) % IDS_PER_THREAD;
+        for (size_t Loop2 = 0; Loop2 < Count; Loop2++) Own(ID[Loop2] = CCConcurrentIDGeneratorAssign(P));
+        for (size_t Loop2 = 0; Loop2 < Count; Loop2++) Disown(ID[Loop2]);
+    }
+    
+    return NULL;
+}
+
+static void ResetOwners(size_t Threads)
+{
+    MaxOwner = IDS_PER_THREAD * Threads * 2;
+    if (MaxOwner > OWNER_COUNT) MaxOwner = OWNER_COUNT;
+    
+    for (size_t Loop = 0; Loop < OWNER_COUNT; Loop++) atomic_store(&Owners[Loop], 0);
+    atomic_store(&ConflictCount, 0);
+}
+
+static void TestMultiThreading(const void *Arg)
+{
+    const size_t Threads = CCTestGetThreadCount(THREAD_COUNT);
+    
+    ResetOwners(Threads);
+    P = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 16, CCGrowableIDGenerator);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_create(Handles + Loop, NULL, Worker, NULL);
+    }
+    
+    for (size_t Loop = 0; Loop < Threads; Loop++)
+    {
+        pthread_join(Handles[Loop], NULL);
+    }
+    
+    CCTestAssertEqual(atomic_load(&ConflictCount), 0, "Should not assign any ID more than once, or grow beyond the IDs in use");
+    
+    CCConcurrentIDGeneratorDestroy(P);
+}
+
+#pragma mark - Stress
+
+static void *StressWorker(void *Arg)
+{
+    uintptr_t ID[IDS_PER_THREAD];
+    while (CCTestIsRunning())
+    {
+        const size_t Count = CCTestRandom() % IDS_PER_THREAD;
+        for (size_t Loop = 0; Loop < Count; Loop++) Own(ID[Loop] = CCConcurrentIDGeneratorAssign(P));
+        
+        //recycle in a random order so the thread caches and shared pool see IDs out of sequence
+        for (size_t Loop = Count; Loop > 1; Loop--)
+        {
+            const size_t Index = CCTestRandom() % Loop;
+            const uintptr_t Temp = ID[Index];
+            ID[Index] = ID[Loop - 1];
+            ID[Loop - 1] = Temp;
+        }
+        
+        for (size_t Loop = 0; Loop < Count; Loop++) Disown(ID[Loop]);
+    }
+    
+    return NULL;
+}
+
+static void TestStressAssignRecycle(const void *Arg)
+{
+    const size_t Threads = CCTestGetThreadCount(0);
+    
+    ResetOwners(Threads);
+    P = CCConcurrentIDGeneratorCreate(CC_STD_ALLOCATOR, 16, CCGrowableIDGenerator);
+    
+    pthread_t Handles[Threads];
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_create(&Handles[Loop], NULL, StressWorker, NULL);
+    for (size_t Loop = 0; Loop < Threads; Loop++) pthread_join(Handles[Loop], NULL);
+    
+    CCTestAssertEqual(atomic_load(&ConflictCount), 0, "Should not assign any ID more than once, or grow beyond the IDs in use");
+    
+    CCConcurrentIDGeneratorDestroy(P);
+}
+
+static const CCTest Tests[] = {
+    { .name = "GrowableIDGenerator/Growing", .run = TestGrowing },
+    { .name = "GrowableIDGenerator/Recycling", .run = TestRecycling },
+    { .name = "GrowableIDGenerator/MultiThreading", .run = TestMultiThreading },
+    { .name = "GrowableIDGenerator/StressAssignRecycle", .run = TestStressAssignRecycle, .stress = TRUE }
+};
+
+int main(int argc, char *argv[])
+{
+    return CCTestMain(argc, argv, Tests, sizeof(Tests) / sizeof(*Tests));
+}
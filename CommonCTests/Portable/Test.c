@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+#include <CommonC/Metrics.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+static struct {
+    const char *filter;
+    _Bool stress;
+    _Bool list;
+    size_t threads;
+    uint64_t duration;
+} Options = {
+    .filter = NULL,
+    .stress = FALSE,
+    .list = FALSE,
+    .threads = 0,
+    .duration = 1000000000
+};
+
+static _Atomic(size_t) Failures = ATOMIC_VAR_INIT(0);
+static uint64_t Deadline = 0;
+
+#pragma mark - Assertions
+
+void CCTestFail(const char *File, int Line, const char *Condition, const char *Message)
+{
+    atomic_fetch_add_explicit(&Failures, 1, memory_order_relaxed);
+    
+    fprintf(stderr, "%s:%d: error: (%s) failed: %s\n", File, Line, Condition, Message);
+}
+
+#pragma mark - Test State
+
+size_t CCTestGetThreadCount(size_t Default)
+{
+    if (Options.threads) return Options.threads;
+    if (Default) return Default;
+    
+    const long CPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    return CPUs > 0 ? (size_t)CPUs : 1;
+}
+
+uint64_t CCTestGetDeadline(void)
+{
+    return Deadline;
+}
+
+_Bool CCTestIsRunning(void)
+{
+    return CCMetricsTimestamp() < Deadline;
+}
+
+uint32_t CCTestRandom(void)
+{
+    static _Thread_local uint32_t State = 0;
+    
+    if (!State) State = (uint32_t)(((uintptr_t)&State >> 4) ^ CCMetricsTimestamp()) | 1;
+    
+    //xorshift32
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+    
+    return State;
+}
+
+#pragma mark - Running
+
+static size_t CCTestParseCount(const char *Option, const char *Value)
+{
+    char *End;
+    const unsigned long long Count = strtoull(Value, &End, 10);
+    
+    if ((End == Value) || (*End))
+    {
+        fprintf(stderr, "Invalid value for %s: %s\n", Option, Value);
+        exit(EXIT_FAILURE);
+    }
+    
+    return (size_t)Count;
+}
+
+int CCTestMain(int argc, char *argv[], const CCTest *Tests, size_t Count)
+{
+    for (int Loop = 1; Loop < argc; Loop++)
+    {
+        const char *Arg = argv[Loop];
+        
+        if (!strncmp(Arg, "--filter=", 9)) Options.filter = Arg + 9;
+        else if (!strcmp(Arg, "--stress")) Options.stress = TRUE;
+        else if (!strcmp(Arg, "--list")) Options.list = TRUE;
+        else if (!strncmp(Arg, "--threads=", 10)) Options.threads = CCTestParseCount("--threads", Arg + 10);
+        else if (!strncmp(Arg, "--duration=", 11)) Options.duration = (uint64_t)CCTestParseCount("--duration", Arg + 11) * 1000000;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--filter=<text>] [--stress] [--threads=<count>] [--duration=<ms>] [--list]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    
+    size_t Run = 0, Failed = 0;
+    for (size_t Loop = 0; Loop < Count; Loop++)
+    {
+        const CCTest *Test = &Tests[Loop];
+        
+        if ((Test->stress != Options.stress) || ((Options.filter) && (!strstr(Test->name, Options.filter)))) continue;
+        
+        if (Options.list)
+        {
+            printf("%s\n", Test->name);
+            continue;
+        }
+        
+        printf("[ RUN      ] %s\n", Test->name);
+        fflush(stdout);
+        
+        const size_t PreviousFailures = atomic_load_explicit(&Failures, memory_order_relaxed);
+        const uint64_t Start = CCMetricsTimestamp();
+        
+        Deadline = Start + Options.duration;
+        Test->run(Test->arg);
+        
+        const uint64_t Elapsed = CCMetricsTimestamp() - Start;
+        const _Bool Passed = atomic_load_explicit(&Failures, memory_order_relaxed) == PreviousFailures;
+        
+        printf("[ %8s ] %s (%llu ms)\n", Passed ? "OK" : "FAILED", Test->name, (unsigned long long)(Elapsed / 1000000));
+        fflush(stdout);
+        
+        Run++;
+        if (!Passed) Failed++;
+    }
+    
+    if (!Options.list) printf("%zu tests, %zu failed\n", Run, Failed);
+    
+    return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
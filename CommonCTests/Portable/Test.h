@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CommonC_Test_h
+#define CommonC_Test_h
+
+#include <CommonC/Base.h>
+
+/*!
+ * @brief Run a test.
+ * @param Arg The argument of the test.
+ */
+typedef void (*CCTestRun)(const void *Arg);
+
+/*!
+ * @brief A test.
+ * @description Tests are the portable equivalent of the XCTest cases, so they can be run on
+ *              platforms without XCTest. Stress tests are only run when requested, and run
+ *              for a configurable duration across a configurable number of threads.
+ */
+typedef struct {
+    /// The name of the test.
+    const char *name;
+    /// The callback to run the test.
+    CCTestRun run;
+    /// The argument passed to the run callback.
+    const void *arg;
+    /// Whether the test is a stress test.
+    _Bool stress;
+} CCTest;
+
+
+/*!
+ * @brief Run the tests according to the command line options.
+ * @description The options are:
+ *
+ *              --filter=<text>: Only run tests whose name contains the text.
+ *              --stress: Run the stress tests instead of the regular tests.
+ *              --threads=<count>: The number of threads multi-threaded tests use.
+ *              --duration=<ms>: How long each stress test runs for (default 1000).
+ *              --list: List the tests instead of running them.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param Tests The tests.
+ * @param Count The number of tests.
+ * @return The exit status, failure if any test failed.
+ */
+int CCTestMain(int argc, char *argv[], const CCTest *Tests, size_t Count);
+
+/*!
+ * @brief Get the number of threads a multi-threaded test should use.
+ * @param Default The number of threads to use when no count was specified. A value of
+ *        0 uses the number of CPUs.
+ *
+ * @return The value of --threads, or the default.
+ */
+size_t CCTestGetThreadCount(size_t Default);
+
+/*!
+ * @brief Get the deadline a stress test should run until.
+ * @return The timestamp (see @b CCMetricsTimestamp) the current stress test should stop at.
+ */
+uint64_t CCTestGetDeadline(void);
+
+/*!
+ * @brief Check whether a stress test should continue running.
+ * @return TRUE if the deadline hasn't passed, otherwise FALSE.
+ */
+_Bool CCTestIsRunning(void);
+
+/*!
+ * @brief Get a random value.
+ * @description The generator is per thread, so it can be used from multiple threads.
+ * @return The random value.
+ */
+uint32_t CCTestRandom(void);
+
+/*!
+ * @brief Record a failed assertion against the current test.
+ * @param File The file of the assertion.
+ * @param Line The line of the assertion.
+ * @param Condition The condition that failed.
+ * @param Message The message describing the expectation.
+ */
+void CCTestFail(const char *File, int Line, const char *Condition, const char *Message);
+
+/*!
+ * @define CCTestAssert
+ * @abstract Assert that a condition holds.
+ * @description Like XCTest a failure does not stop the test, and may be asserted from any thread.
+ * @param condition The condition.
+ * @param message The message describing the expectation.
+ */
+#define CCTestAssert(condition, message) CC_TEST_ASSERT(condition, #condition, message)
+
+#define CCTestAssertTrue(condition, message) CC_TEST_ASSERT(condition, #condition, message)
+#define CCTestAssertFalse(condition, message) CC_TEST_ASSERT(!(condition), "!(" #condition ")", message)
+#define CCTestAssertEqual(a, b, message) CC_TEST_ASSERT((a) == (b), #a " == " #b, message)
+#define CCTestAssertLessThan(a, b, message) CC_TEST_ASSERT((a) < (b), #a " < " #b, message)
+
+#define CC_TEST_ASSERT(condition, string, message) do { if (!(condition)) CCTestFail(__FILE__, __LINE__, string, message); } while (0)
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2019, Stefan Johnson
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this list
+ *     of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice, this
+ *     list of conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#import <XCTest/XCTest.h>
+#import "Trace.h"
+#import "MemoryAllocation.h"
+#import <pthread.h>
+#import <string.h>
+
+#define TRACE_THREADS 4
+#define TRACE_SPANS (CC_TRACE_BUFFER_SIZE * 2)
+
+@interface TraceTests : XCTestCase
+
+@end
+
+static void *TraceRecorder(void *Arg)
+{
+    for (size_t Loop = 0; Loop < TRACE_SPANS; Loop++)
+    {
+        const CCTraceSpan Span = CCTraceSpanBegin("tests.recorder");
+        CCTraceSpanEnd(&Span);
+    }
+    
+    return NULL;
+}
+
+static size_t TraceCount(const char *Text, const char *Name)
+{
+    size_t Count = 0;
+    for (const char *Match = Text; (Match = strstr(Match, Name)); Match++) Count++;
+    
+    return Count;
+}
+
+@implementation TraceTests
+
+-(void) tearDown
+{
+    CCTraceSetEnabled(FALSE);
+    
+    [super tearDown];
+}
+
+-(char*) format
+{
+    size_t Length = 0;
+    char *Text = NULL;
+    for (size_t Size = CCTraceFormat(NULL, 0) + 1; ; Size = Length + 1)
+    {
+        Text = CCRealloc(CC_STD_ALLOCATOR, Text, Size, NULL, CC_DEFAULT_ERROR_CALLBACK);
+        Length = CCTraceFormat(Text, Size);
+        
+        if (Length < Size) break;
+    }
+    
+    return Text;
+}
+
+-(void) testSpans
+{
+    const CCTraceSpan Disabled = CCTraceSpanBegin("tests.disabled");
+    CCTraceSpanEnd(&Disabled);
+    
+    CCTraceSetEnabled(TRUE);
+    XCTAssertTrue(CCTraceIsEnabled(), @"Should be enabled");
+    
+    const CCTraceSpan Outer = CCTraceSpanBegin("tests.outer");
+    const CCTraceSpan Inner = CCTraceSpanBegin("tests.\"inner\"");
+    CCTraceSpanEnd(&Inner);
+    CCTraceSpanEnd(&Outer);
+    
+    char *Text = [self format];
+    
+    XCTAssertEqual(strncmp(Text, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 39), 0, @"Should be a trace event object");
+    XCTAssertEqual(TraceCount(Text, "\"name\":\"tests.disabled\""), 0, @"Should not record spans started while disabled");
+    XCTAssertEqual(TraceCount(Text, "\"name\":\"tests.outer\",\"ph\":\"X\""), 1, @"Should record the span as a complete event");
+    XCTAssertEqual(TraceCount(Text, "\"name\":\"tests.\\u0022inner\\u0022\""), 1, @"Should escape the name");
+    
+    CCFree(Text);
+}
+
+-(void) testConcurrentSpans
+{
+    CCTraceSetEnabled(TRUE);
+    
+    pthread_t Threads[TRACE_THREADS];
+    for (size_t Loop = 0; Loop < TRACE_THREADS; Loop++) pthread_create(Threads + Loop, NULL, TraceRecorder, NULL);
+    for (size_t Loop = 0; Loop < TRACE_THREADS; Loop++) pthread_join(Threads[Loop], NULL);
+    
+    char *Text = [self format];
+    
+    const size_t Count = TraceCount(Text, "\"name\":\"tests.recorder\"");
+    XCTAssertGreaterThanOrEqual(Count, TRACE_THREADS * (CC_TRACE_BUFFER_SIZE - 1), @"Should keep the most recent spans of each thread");
+    XCTAssertLessThanOrEqual(Count, TRACE_THREADS * CC_TRACE_BUFFER_SIZE, @"Should overwrite the oldest spans");
+    
+    CCFree(Text);
+}
+
+@end